@@ -16,19 +16,17 @@ static crossbowBufferPoolP pool;
 static jclass class;
 static jmethodID writeMethod, readMethod;
 
-static jclass    mappedDataByteBufferClassRef  = NULL;
-static jfieldID  mappedDataBufferAddressField  = NULL;
-static jfieldID  mappedDataBufferCapacityField = NULL;
-
-static jclass    dataBufferClassRef = NULL;
-static jfieldID  dataBufferByteBufferField = NULL;
-
 void writeInput (JNIEnv *, jobject, int, crossbowByteBufferP);
 void readOutput (JNIEnv *, jobject, int, crossbowByteBufferP);
 
 void blas_init (int size, int capacity) {
 	pool = crossbowBufferPoolCreate (size, capacity);
-	/* Setup OpenBLAS threading */
+	/*
+	 * Setup OpenBLAS threading: calls are single-threaded, since large GEMMs
+	 * are split across idle workers and intra-op threads by the caller (see
+	 * `BLAS.sgemm` and `IdleWorkerQueue`). OpenBLAS threads would oversubscribe
+	 * the cores to which these are bound.
+	 */
 	openblas_set_num_threads(1);
 }
 
@@ -37,31 +35,8 @@ void blas_free () {
 	return;
 }
 
-void *getObjectBufferAddress (JNIEnv *env, jobject obj, int offset) {
-	jobject buffer;
-	nullPointerException(obj);
-	if ((*env)->IsInstanceOf(env, obj, mappedDataByteBufferClassRef)) {
-		return (void *) ((intptr_t) (*env)->GetLongField (env, obj, mappedDataBufferAddressField) + offset);
-	}
-	else {
-		/* Assume that object is an instance of a DataBuffer,
-		 * backed by a direct byte buffer */
-		buffer = (*env)->GetObjectField (env, obj, dataBufferByteBufferField);
-		return (void *) ((*env)->GetDirectBufferAddress(env, buffer) + offset);
-	}
-}
-
-enum CBLAS_TRANSPOSE getCblasTrans (const char *s) {
-	// printf("C: transpose string is %s\n", s);
-	switch (s[0]) {
-		case 'N': return CblasNoTrans;
-		case 'n': return CblasNoTrans;
-		case 'T': return CblasTrans;
-		case 't': return CblasTrans;
-		default:  return -1;
-	}
-	return -1;
-}
+/* Transpose codes are CBLAS_TRANSPOSE values (checked on the Java side) */
+#define CBLAS_TRANS(x) ((enum CBLAS_TRANSPOSE) (x))
 
 JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_init
 (JNIEnv *env, jobject obj, jint size, jint bufferSize) {
@@ -76,18 +51,6 @@ JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_init
 	readMethod = (*env)->GetMethodID (env, class, "outputDataMovementCallback",  "(IJI)V");
 	nullPointerException (readMethod);
 
-	/* Static references to Crossbow's MappedDataBuffer class */
-	mappedDataByteBufferClassRef  = (jclass) (*env)->NewGlobalRef
-		(env, (*env)->FindClass (env, "uk/ac/imperial/lsds/crossbow/data/MappedDataBuffer"));
-
-	mappedDataBufferAddressField  = (*env)->GetFieldID(env, mappedDataByteBufferClassRef, "address",  "J");
-	mappedDataBufferCapacityField = (*env)->GetFieldID(env, mappedDataByteBufferClassRef, "capacity", "I");
-
-	dataBufferClassRef = (jclass) (*env)->NewGlobalRef
-		(env, (*env)->FindClass (env, "uk/ac/imperial/lsds/crossbow/data/DataBuffer"));
-
-	dataBufferByteBufferField = (*env)->GetFieldID(env, dataBufferClassRef, "buffer", "Ljava/nio/ByteBuffer;");
-
 	blas_init (size, bufferSize);
 
 	return 0;
@@ -104,10 +67,16 @@ JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_destro
 	return 0;
 }
 
-JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemm__Ljava_lang_String_2Ljava_lang_String_2IIIFIIIIFII
+/*
+ * Buffer pool entry points, used when variable buffers are not direct:
+ * operands are copied in and out of pooled native buffers by calling
+ * back into Java.
+ */
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemm
 	(JNIEnv *env, jobject obj,
-	jstring TransA,
-	jstring TransB,
+	jint TransA,
+	jint TransB,
 	jint M,
 	jint N,
 	jint K,
@@ -120,15 +89,6 @@ JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemm
 	jint c,
 	jint ldc) {
 
-	(void) env;
-	(void) obj;
-
-	const char *_TransA = (*env)->GetStringUTFChars(env, TransA, NULL);
-	const char *_TransB = (*env)->GetStringUTFChars(env, TransB, NULL);
-
-	enum CBLAS_TRANSPOSE transA = getCblasTrans (_TransA);
-	enum CBLAS_TRANSPOSE transB = getCblasTrans (_TransB);
-
 	/* Get buffers */
 	crossbowByteBufferP _A = crossbowBufferPoolGet (pool, a);
 	crossbowByteBufferP _B = crossbowBufferPoolGet (pool, b);
@@ -149,7 +109,7 @@ JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemm
 	float *B = (float *) crossbowByteBufferData (_B);
 	float *C = (float *) crossbowByteBufferData (_C);
 
-	cblas_sgemm (CblasRowMajor, transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+	cblas_sgemm (CblasRowMajor, CBLAS_TRANS(TransA), CBLAS_TRANS(TransB), M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
 
 	/* Copy output buffer(s) */
 	readOutput (env, obj, c, _C);
@@ -159,203 +119,222 @@ JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemm
 	crossbowBufferPoolRelease (pool, b, _B);
 	crossbowBufferPoolRelease (pool, c, _C);
 
-	(*env)->ReleaseStringUTFChars (env, TransA, _TransA);
-	(*env)->ReleaseStringUTFChars (env, TransB, _TransB);
-
 	return 0;
 }
 
-JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemm__Ljava_lang_String_2Ljava_lang_String_2IIIFLuk_ac_imperial_lsds_crossbow_data_IDataBuffer_2IIILuk_ac_imperial_lsds_crossbow_data_IDataBuffer_2IIIFLuk_ac_imperial_lsds_crossbow_data_IDataBuffer_2III
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemv
 	(JNIEnv *env, jobject obj,
-	jstring TransA,
-	jstring TransB,
+	jint TransA,
 	jint M,
 	jint N,
-	jint K,
 	jfloat alpha,
-	jobject a,
-	jint startA,
-	jint endA,
+	jint a,
 	jint lda,
-	jobject b,
-	jint startB,
-	jint endB,
-	jint ldb,
+	jint x,
+	jint incX,
 	jfloat beta,
-	jobject c,
-	jint startC,
-	jint endC,
-	jint ldc) {
+	jint y,
+	jint incY) {
 
-	(void) env;
-	(void) obj;
+	// Get buffers
+	crossbowByteBufferP _A = crossbowBufferPoolGet (pool, a);
+	crossbowByteBufferP _X = crossbowBufferPoolGet (pool, x);
+	crossbowByteBufferP _Y = crossbowBufferPoolGet (pool, y);
 
-	(void) endA;
-	(void) endB;
-	(void) endC;
+	nullPointerException (_A);
+	nullPointerException (_X);
+	nullPointerException (_Y);
 
-	const char *_TransA = (*env)->GetStringUTFChars(env, TransA, NULL);
-	const char *_TransB = (*env)->GetStringUTFChars(env, TransB, NULL);
+	writeInput (env, obj, a, _A);
+	writeInput (env, obj, x, _X);
+	if (beta != 0.) {
+		writeInput (env, obj, y, _Y);
+	}
 
-	enum CBLAS_TRANSPOSE transA = getCblasTrans (_TransA);
-	enum CBLAS_TRANSPOSE transB = getCblasTrans (_TransB);
+	float *A = (float *) crossbowByteBufferData (_A);
+	float *X = (float *) crossbowByteBufferData (_X);
+	float *Y = (float *) crossbowByteBufferData (_Y);
 
-	void *A = getObjectBufferAddress (env, a, startA);
-	void *B = getObjectBufferAddress (env, b, startB);
-	void *C = getObjectBufferAddress (env, c, startC);
+	cblas_sgemv (CblasRowMajor, CBLAS_TRANS(TransA), M, N, alpha, A, lda, X, incX, beta, Y, incY);
 
-	cblas_sgemm (CblasRowMajor, transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+	readOutput (env, obj, y, _Y);
 
-	(*env)->ReleaseStringUTFChars (env, TransA, _TransA);
-	(*env)->ReleaseStringUTFChars (env, TransB, _TransB);
+	crossbowBufferPoolRelease (pool, a, _A);
+	crossbowBufferPoolRelease (pool, x, _X);
+	crossbowBufferPoolRelease (pool, y, _Y);
 
 	return 0;
 }
 
-JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemv__Ljava_lang_String_2IIFIIIIFII
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csaxpby
 	(JNIEnv *env, jobject obj,
-	jstring TransA,
-	jint M,
 	jint N,
 	jfloat alpha,
-	jint a,
-	jint lda,
 	jint x,
 	jint incX,
 	jfloat beta,
 	jint y,
 	jint incY) {
 
-	(void) env;
-	(void) obj;
-
-	const char *_TransA = (*env)->GetStringUTFChars(env, TransA, NULL);
-	enum CBLAS_TRANSPOSE transA = getCblasTrans (_TransA);
-
-	// Get buffers
-	crossbowByteBufferP _A = crossbowBufferPoolGet (pool, a);
 	crossbowByteBufferP _X = crossbowBufferPoolGet (pool, x);
 	crossbowByteBufferP _Y = crossbowBufferPoolGet (pool, y);
 
-	nullPointerException (_A);
 	nullPointerException (_X);
 	nullPointerException (_Y);
 
-	writeInput (env, obj, a, _A);
 	writeInput (env, obj, x, _X);
-	if (beta != 0.) {
+	if (beta != 0)
 		writeInput (env, obj, y, _Y);
-	}
 
-	float *A = (float *) crossbowByteBufferData (_A);
 	float *X = (float *) crossbowByteBufferData (_X);
 	float *Y = (float *) crossbowByteBufferData (_Y);
 
-	cblas_sgemv (CblasRowMajor, transA, M, N, alpha, A, lda, X, incX, beta, Y, incY);
+	cblas_saxpby (N, alpha, X, incX, beta, Y, incY);
 
 	readOutput (env, obj, y, _Y);
 
-	crossbowBufferPoolRelease (pool, a, _A);
 	crossbowBufferPoolRelease (pool, x, _X);
 	crossbowBufferPoolRelease (pool, y, _Y);
 
-	(*env)->ReleaseStringUTFChars (env, TransA, _TransA);
-
 	return 0;
 }
 
-JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemv__Ljava_lang_String_2IIFLuk_ac_imperial_lsds_crossbow_data_IDataBuffer_2IIILuk_ac_imperial_lsds_crossbow_data_IDataBuffer_2IFLuk_ac_imperial_lsds_crossbow_data_IDataBuffer_2I
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csomatcopy
 	(JNIEnv *env, jobject obj,
-	jstring TransA,
-	jint M,
-	jint N,
+	jint Trans,
+	jint rows,
+	jint cols,
 	jfloat alpha,
-	jobject a,
-	jint start,
-	jint end,
+	jint a,
 	jint lda,
-	jobject x,
-	jint incX,
-	jfloat beta,
-	jobject y,
-	jint incY) {
+	jint b,
+	jint ldb) {
 
-	(void) env;
-	(void) obj;
+	crossbowByteBufferP _A = crossbowBufferPoolGet (pool, a);
+	crossbowByteBufferP _B = crossbowBufferPoolGet (pool, b);
 
-	(void) end;
+	nullPointerException (_A);
+	nullPointerException (_B);
+
+	writeInput (env, obj, a, _A);
+	/* B may be strided: copy it in first, so that gaps are preserved */
+	writeInput (env, obj, b, _B);
 
-	const char *_TransA = (*env)->GetStringUTFChars(env, TransA, NULL);
-	enum CBLAS_TRANSPOSE transA = getCblasTrans (_TransA);
+	float *A = (float *) crossbowByteBufferData (_A);
+	float *B = (float *) crossbowByteBufferData (_B);
 
-	void *A = getObjectBufferAddress (env, a, start);
-	void *X = getObjectBufferAddress (env, x, 0);
-	void *Y = getObjectBufferAddress (env, y, 0);
+	cblas_somatcopy (CblasRowMajor, CBLAS_TRANS(Trans), rows, cols, alpha, A, lda, B, ldb);
 
-	cblas_sgemv (CblasRowMajor, transA, M, N, alpha, A, lda, X, incX, beta, Y, incY);
+	readOutput (env, obj, b, _B);
 
-	(*env)->ReleaseStringUTFChars (env, TransA, _TransA);
+	crossbowBufferPoolRelease (pool, a, _A);
+	crossbowBufferPoolRelease (pool, b, _B);
 
 	return 0;
 }
 
-JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csaxpby__IFIIFII
-	(JNIEnv *env, jobject obj,
+/*
+ * Direct entry points: operands are native addresses (already offset
+ * by the caller), so a call makes no JNI calls of its own.
+ */
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemmDirect
+	(JNIEnv *env, jclass cls,
+	jint TransA,
+	jint TransB,
+	jint M,
 	jint N,
+	jint K,
 	jfloat alpha,
-	jint x,
-	jint incX,
+	jlong A,
+	jint lda,
+	jlong B,
+	jint ldb,
 	jfloat beta,
-	jint y,
-	jint incY) {
+	jlong C,
+	jint ldc) {
 
 	(void) env;
-	(void) obj;
+	(void) cls;
 
-	crossbowByteBufferP _X = crossbowBufferPoolGet (pool, x);
-	crossbowByteBufferP _Y = crossbowBufferPoolGet (pool, y);
+	cblas_sgemm (CblasRowMajor, CBLAS_TRANS(TransA), CBLAS_TRANS(TransB), M, N, K, alpha,
+		(float *) (intptr_t) A, lda, (float *) (intptr_t) B, ldb, beta, (float *) (intptr_t) C, ldc);
 
-	nullPointerException (_X);
-	nullPointerException (_Y);
+	return 0;
+}
 
-	writeInput (env, obj, x, _X);
-	if (beta != 0)
-		writeInput (env, obj, y, _Y);
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemmBatch
+	(JNIEnv *env, jclass cls, jlong descriptors, jint count) {
 
-	float *X = (float *) crossbowByteBufferData (_X);
-	float *Y = (float *) crossbowByteBufferData (_Y);
+	(void) env;
+	(void) cls;
 
-	cblas_saxpby (N, alpha, X, incX, beta, Y, incY);
+	crossbowSgemmDescriptorP d = (crossbowSgemmDescriptorP) (intptr_t) descriptors;
+	int i;
+	/* In order, since a GEMM may accumulate into the result of a previous one */
+	for (i = 0; i < count; ++i, ++d)
+		cblas_sgemm (CblasRowMajor, CBLAS_TRANS(d->TransA), CBLAS_TRANS(d->TransB), d->M, d->N, d->K, d->alpha,
+			d->A, d->lda, d->B, d->ldb, d->beta, d->C, d->ldc);
 
-	readOutput (env, obj, y, _Y);
+	return 0;
+}
 
-	crossbowBufferPoolRelease (pool, x, _X);
-	crossbowBufferPoolRelease (pool, y, _Y);
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemvDirect
+	(JNIEnv *env, jclass cls,
+	jint TransA,
+	jint M,
+	jint N,
+	jfloat alpha,
+	jlong A,
+	jint lda,
+	jlong X,
+	jint incX,
+	jfloat beta,
+	jlong Y,
+	jint incY) {
+
+	(void) env;
+	(void) cls;
+
+	cblas_sgemv (CblasRowMajor, CBLAS_TRANS(TransA), M, N, alpha,
+		(float *) (intptr_t) A, lda, (float *) (intptr_t) X, incX, beta, (float *) (intptr_t) Y, incY);
 
 	return 0;
 }
 
-JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csaxpby__IFLuk_ac_imperial_lsds_crossbow_data_IDataBuffer_2IIIFLuk_ac_imperial_lsds_crossbow_data_IDataBuffer_2I
-	(JNIEnv *env, jobject obj,
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csaxpbyDirect
+	(JNIEnv *env, jclass cls,
 	jint N,
 	jfloat alpha,
-	jobject x,
-	jint start,
-	jint end,
+	jlong X,
 	jint incX,
 	jfloat beta,
-	jobject y,
+	jlong Y,
 	jint incY) {
 
 	(void) env;
-	(void) obj;
+	(void) cls;
 
-	(void) end;
+	cblas_saxpby (N, alpha, (float *) (intptr_t) X, incX, beta, (float *) (intptr_t) Y, incY);
 
-	void *X = getObjectBufferAddress (env, x, start);
-	void *Y = getObjectBufferAddress (env, y, 0);
+	return 0;
+}
 
-	cblas_saxpby (N, alpha, X, incX, beta, Y, incY);
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csomatcopyDirect
+	(JNIEnv *env, jclass cls,
+	jint Trans,
+	jint rows,
+	jint cols,
+	jfloat alpha,
+	jlong A,
+	jint lda,
+	jlong B,
+	jint ldb) {
+
+	(void) env;
+	(void) cls;
+
+	cblas_somatcopy (CblasRowMajor, CBLAS_TRANS(Trans), rows, cols, alpha, (float *) (intptr_t) A, lda, (float *) (intptr_t) B, ldb);
 
 	return 0;
 }
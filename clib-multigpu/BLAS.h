@@ -5,12 +5,22 @@
 
 #include <jni.h>
 
+/*
+ * A GEMM call in a batch (see `GemmBatch.java`, whose 64-byte
+ * descriptors have the same layout). Transpose codes are CBLAS
+ * values and operands are native addresses.
+ */
+typedef struct crossbow_sgemm_descriptor *crossbowSgemmDescriptorP;
+typedef struct crossbow_sgemm_descriptor {
+	int TransA, TransB;
+	int M, N, K;
+	int lda, ldb, ldc;
+	float alpha, beta;
+	float *A, *B, *C;
+} crossbow_sgemm_descriptor_t;
+
 void blas_init (int size, int bufferSize);
 
 void blas_free ();
 
-enum CBLAS_TRANSPOSE getCblasTrans (const char *);
-
-void *getObjectBufferAddress (JNIEnv *, jobject, int);
-
 #endif /* __CROSSBOW_BLAS_H_ */
@@ -4,6 +4,11 @@
 #include <unistd.h>
 #include <sched.h>
 
+#include <stdio.h>
+#include <dirent.h>
+#include <string.h>
+#include <stdlib.h>
+
 /* Thread affinity library calls */
 
 #ifndef __APPLE__
@@ -81,3 +86,31 @@ JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_TheCPU_getCpuId
 	return 0;
 #endif
 }
+
+/* Returns the NUMA node of a core (0 if unknown, e.g. on single-node systems) */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_TheCPU_getNumaNode
+(JNIEnv *env, jobject obj, jint core) {
+	(void) env;
+	(void) obj;
+#ifndef __APPLE__
+	int node = 0;
+	char path [64];
+	DIR *dir;
+	struct dirent *entry;
+	snprintf (path, sizeof(path), "/sys/devices/system/cpu/cpu%d", core);
+	dir = opendir (path);
+	if (! dir)
+		return node;
+	while ((entry = readdir (dir)) != NULL) {
+		if (strncmp (entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+			node = atoi (entry->d_name + 4);
+			break;
+		}
+	}
+	closedir (dir);
+	return node;
+#else
+	(void) core;
+	return 0;
+#endif
+}
@@ -0,0 +1,574 @@
+#include "uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels.h"
+
+#include <jni.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h> /* intptr_t */
+
+#include "cpukernels/relu.h"
+#include "cpukernels/pool.h"
+#include "cpukernels/softmax.h"
+#include "cpukernels/batchnorm.h"
+#include "cpukernels/lrn.h"
+#include "cpukernels/matfact.h"
+#include "cpukernels/sgd.h"
+#include "cpukernels/merge.h"
+#include "cpukernels/datatransform.h"
+#include "cpukernels/philox.h"
+#include "cpukernels/dropout.h"
+
+#include "debug.h"
+
+static jclass    mappedDataByteBufferClassRef = NULL;
+static jfieldID  mappedDataBufferAddressField = NULL;
+
+static jclass    dataBufferClassRef = NULL;
+static jfieldID  dataBufferByteBufferField = NULL;
+
+/*
+ * Returns the address of the `offset`-th byte of a MappedDataBuffer or of
+ * a DataBuffer backed by a direct byte buffer; or NULL, if `obj` is null.
+ */
+static void *getBufferAddress (JNIEnv *env, jobject obj, int offset) {
+	jobject buffer;
+	if (obj == NULL)
+		return NULL;
+	if ((*env)->IsInstanceOf(env, obj, mappedDataByteBufferClassRef)) {
+		return (void *) ((intptr_t) (*env)->GetLongField (env, obj, mappedDataBufferAddressField) + offset);
+	}
+	else {
+		buffer = (*env)->GetObjectField (env, obj, dataBufferByteBufferField);
+		return (void *) ((char *) (*env)->GetDirectBufferAddress(env, buffer) + offset);
+	}
+}
+
+static void setPoolConf (crossbow_cpu_pool_conf_t *conf,
+	int planes,
+	int height, int width,
+	int pooledHeight, int pooledWidth,
+	int kernelHeight, int kernelWidth,
+	int strideHeight, int strideWidth,
+	int paddingHeight, int paddingWidth) {
+
+	conf->planes        = planes;
+	conf->height        = height;
+	conf->width         = width;
+	conf->pooledHeight  = pooledHeight;
+	conf->pooledWidth   = pooledWidth;
+	conf->kernelHeight  = kernelHeight;
+	conf->kernelWidth   = kernelWidth;
+	conf->strideHeight  = strideHeight;
+	conf->strideWidth   = strideWidth;
+	conf->paddingHeight = paddingHeight;
+	conf->paddingWidth  = paddingWidth;
+	return;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_init
+	(JNIEnv *env, jobject obj) {
+
+	(void) obj;
+
+	/* Static references to Crossbow's MappedDataBuffer and DataBuffer classes */
+	mappedDataByteBufferClassRef = (jclass) (*env)->NewGlobalRef
+		(env, (*env)->FindClass (env, "uk/ac/imperial/lsds/crossbow/data/MappedDataBuffer"));
+
+	mappedDataBufferAddressField = (*env)->GetFieldID(env, mappedDataByteBufferClassRef, "address", "J");
+	nullPointerException (mappedDataBufferAddressField);
+
+	dataBufferClassRef = (jclass) (*env)->NewGlobalRef
+		(env, (*env)->FindClass (env, "uk/ac/imperial/lsds/crossbow/data/DataBuffer"));
+
+	dataBufferByteBufferField = (*env)->GetFieldID(env, dataBufferClassRef, "buffer", "Ljava/nio/ByteBuffer;");
+	nullPointerException (dataBufferByteBufferField);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_destroy
+	(JNIEnv *env, jobject obj) {
+
+	(void) obj;
+
+	(*env)->DeleteGlobalRef(env, mappedDataByteBufferClassRef);
+	(*env)->DeleteGlobalRef(env, dataBufferClassRef);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_relu
+	(JNIEnv *env, jobject obj, jobject X, jint startX, jobject Y, jint startY, jint count, jfloat slope) {
+
+	(void) obj;
+
+	float *x = (float *) getBufferAddress (env, X, startX);
+	float *y = (float *) getBufferAddress (env, Y, startY);
+
+	crossbowCPUKernelReLU (x, y, count, slope);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_reluGradient
+	(JNIEnv *env, jobject obj, jobject dY, jint startdY, jobject X, jint startX, jobject dX, jint startdX, jint count, jfloat slope) {
+
+	(void) obj;
+
+	float *dy = (float *) getBufferAddress (env, dY, startdY);
+	float *x  = (float *) getBufferAddress (env,  X,  startX);
+	float *dx = (float *) getBufferAddress (env, dX, startdX);
+
+	crossbowCPUKernelReLUGradient (dy, x, dx, count, slope);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_maxPool
+	(JNIEnv *env, jobject obj,
+	jobject X, jint startX,
+	jobject Y, jint startY,
+	jobject indices, jint startIndices,
+	jint planes,
+	jint height, jint width,
+	jint pooledHeight, jint pooledWidth,
+	jint kernelHeight, jint kernelWidth,
+	jint strideHeight, jint strideWidth,
+	jint paddingHeight, jint paddingWidth) {
+
+	(void) obj;
+
+	crossbow_cpu_pool_conf_t conf;
+
+	float *x = (float *) getBufferAddress (env, X, startX);
+	float *y = (float *) getBufferAddress (env, Y, startY);
+	int *idx = (int   *) getBufferAddress (env, indices, startIndices);
+
+	setPoolConf (&conf, planes, height, width, pooledHeight, pooledWidth,
+		kernelHeight, kernelWidth, strideHeight, strideWidth, paddingHeight, paddingWidth);
+
+	crossbowCPUKernelMaxPool (x, startX, y, idx, &conf);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_averagePool
+	(JNIEnv *env, jobject obj,
+	jobject X, jint startX,
+	jobject Y, jint startY,
+	jint planes,
+	jint height, jint width,
+	jint pooledHeight, jint pooledWidth,
+	jint kernelHeight, jint kernelWidth,
+	jint strideHeight, jint strideWidth,
+	jint paddingHeight, jint paddingWidth) {
+
+	(void) obj;
+
+	crossbow_cpu_pool_conf_t conf;
+
+	float *x = (float *) getBufferAddress (env, X, startX);
+	float *y = (float *) getBufferAddress (env, Y, startY);
+
+	setPoolConf (&conf, planes, height, width, pooledHeight, pooledWidth,
+		kernelHeight, kernelWidth, strideHeight, strideWidth, paddingHeight, paddingWidth);
+
+	crossbowCPUKernelAveragePool (x, y, &conf);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_maxPoolGradient
+	(JNIEnv *env, jobject obj, jobject dY, jint startdY, jobject indices, jint count, jint offset, jobject dX, jint startdX, jint elements) {
+
+	(void) obj;
+
+	float *dy = (float *) getBufferAddress (env, dY, startdY);
+	int  *idx = (int   *) getBufferAddress (env, indices, 0);
+	float *dx = (float *) getBufferAddress (env, dX, startdX);
+
+	crossbowCPUKernelMaxPoolGradient (dy, idx, count, offset, dx, elements);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_averagePoolGradient
+	(JNIEnv *env, jobject obj,
+	jobject dY, jint startdY,
+	jobject dX, jint startdX,
+	jint planes,
+	jint height, jint width,
+	jint pooledHeight, jint pooledWidth,
+	jint kernelHeight, jint kernelWidth,
+	jint strideHeight, jint strideWidth,
+	jint paddingHeight, jint paddingWidth) {
+
+	(void) obj;
+
+	crossbow_cpu_pool_conf_t conf;
+
+	float *dy = (float *) getBufferAddress (env, dY, startdY);
+	float *dx = (float *) getBufferAddress (env, dX, startdX);
+
+	setPoolConf (&conf, planes, height, width, pooledHeight, pooledWidth,
+		kernelHeight, kernelWidth, strideHeight, strideWidth, paddingHeight, paddingWidth);
+
+	crossbowCPUKernelAveragePoolGradient (dy, dx, &conf);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_softmax
+	(JNIEnv *env, jobject obj, jobject X, jint startX, jobject Y, jint startY, jint examples, jint classes) {
+
+	(void) obj;
+
+	float *x = (float *) getBufferAddress (env, X, startX);
+	float *y = (float *) getBufferAddress (env, Y, startY);
+
+	crossbowCPUKernelSoftMax (x, y, examples, classes);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_copy
+	(JNIEnv *env, jobject obj, jobject X, jint startX, jobject Y, jint startY, jint count) {
+
+	(void) obj;
+
+	void *x = getBufferAddress (env, X, startX);
+	void *y = getBufferAddress (env, Y, startY);
+
+	memcpy (y, x, count);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_batchNorm
+	(JNIEnv *env, jobject obj,
+	jobject X, jint startX,
+	jobject Y, jint startY,
+	jobject weights, jobject bias,
+	jobject mean, jobject variance,
+	jobject averageMean, jobject averageVariance,
+	jobject invVar, jobject xnorm,
+	jint batchsize, jint channels, jint spatial,
+	jint fromChannel, jint toChannel,
+	jboolean training, jboolean first,
+	jfloat fraction, jfloat epsilon) {
+
+	(void) obj;
+
+	crossbow_cpu_batchnorm_conf_t conf;
+
+	conf.batchsize = batchsize;
+	conf.channels  = channels;
+	conf.spatial   = spatial;
+	conf.from      = fromChannel;
+	conf.to        = toChannel;
+	conf.training  = (training == JNI_TRUE);
+	conf.first     = (first    == JNI_TRUE);
+	conf.fraction  = fraction;
+	conf.epsilon   = epsilon;
+
+	crossbowCPUKernelBatchNorm (
+		(float *) getBufferAddress (env, X, startX),
+		(float *) getBufferAddress (env, Y, startY),
+		(float *) getBufferAddress (env, weights, 0),
+		(float *) getBufferAddress (env, bias, 0),
+		(float *) getBufferAddress (env, mean, 0),
+		(float *) getBufferAddress (env, variance, 0),
+		(float *) getBufferAddress (env, averageMean, 0),
+		(float *) getBufferAddress (env, averageVariance, 0),
+		(float *) getBufferAddress (env, invVar, 0),
+		(float *) getBufferAddress (env, xnorm, 0),
+		&conf);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_batchNormGradient
+	(JNIEnv *env, jobject obj,
+	jobject dY, jint startdY,
+	jobject xnorm, jobject weights, jobject invVar,
+	jobject dX, jint startdX,
+	jobject weightGradient, jobject biasGradient,
+	jint batchsize, jint channels, jint spatial,
+	jint fromChannel, jint toChannel) {
+
+	(void) obj;
+
+	crossbow_cpu_batchnorm_conf_t conf;
+
+	memset (&conf, 0, sizeof(crossbow_cpu_batchnorm_conf_t));
+	conf.batchsize = batchsize;
+	conf.channels  = channels;
+	conf.spatial   = spatial;
+	conf.from      = fromChannel;
+	conf.to        = toChannel;
+	conf.training  = 1;
+
+	crossbowCPUKernelBatchNormGradient (
+		(float *) getBufferAddress (env, dY, startdY),
+		(float *) getBufferAddress (env, xnorm, 0),
+		(float *) getBufferAddress (env, weights, 0),
+		(float *) getBufferAddress (env, invVar, 0),
+		(float *) getBufferAddress (env, dX, startdX),
+		(float *) getBufferAddress (env, weightGradient, 0),
+		(float *) getBufferAddress (env, biasGradient, 0),
+		&conf);
+
+	return 0;
+}
+
+static void setLRNConf (crossbow_cpu_lrn_conf_t *conf,
+	int batchsize, int channels, int spatial,
+	int size, float alpha, float beta, float kappa) {
+
+	conf->batchsize = batchsize;
+	conf->channels  = channels;
+	conf->spatial   = spatial;
+	conf->size      = size;
+	conf->alpha     = alpha;
+	conf->beta      = beta;
+	conf->kappa     = kappa;
+	return;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_lrn
+	(JNIEnv *env, jobject obj,
+	jobject X, jint startX,
+	jobject Y, jint startY,
+	jobject scale,
+	jint batchsize, jint channels, jint spatial,
+	jint size, jfloat alpha, jfloat beta, jfloat kappa) {
+
+	(void) obj;
+
+	crossbow_cpu_lrn_conf_t conf;
+
+	setLRNConf (&conf, batchsize, channels, spatial, size, alpha, beta, kappa);
+
+	crossbowCPUKernelLRN (
+		(float *) getBufferAddress (env, X, startX),
+		(float *) getBufferAddress (env, Y, startY),
+		(float *) getBufferAddress (env, scale, 0),
+		&conf);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_lrnGradient
+	(JNIEnv *env, jobject obj,
+	jobject dY, jint startdY,
+	jobject X, jint startX,
+	jobject scale,
+	jobject dX, jint startdX,
+	jint batchsize, jint channels, jint spatial,
+	jint size, jfloat alpha, jfloat beta, jfloat kappa) {
+
+	(void) obj;
+
+	crossbow_cpu_lrn_conf_t conf;
+
+	setLRNConf (&conf, batchsize, channels, spatial, size, alpha, beta, kappa);
+
+	crossbowCPUKernelLRNGradient (
+		(float *) getBufferAddress (env, dY, startdY),
+		(float *) getBufferAddress (env,  X,  startX),
+		(float *) getBufferAddress (env, scale, 0),
+		(float *) getBufferAddress (env, dX, startdX),
+		&conf);
+
+	return 0;
+}
+
+JNIEXPORT jfloat JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_matFact
+	(JNIEnv *env, jobject obj,
+	jobject X, jint startX,
+	jobject labels, jint startLabels,
+	jobject users, jobject items,
+	jint examples, jint latents,
+	jfloat lambda, jfloat rate,
+	jboolean locking) {
+
+	(void) obj;
+
+	crossbow_cpu_matfact_conf_t conf;
+
+	conf.examples = examples;
+	conf.latents  = latents;
+	conf.lambda   = lambda;
+	conf.rate     = rate;
+	conf.locking  = (locking == JNI_TRUE);
+
+	return crossbowCPUKernelMatFact (
+		(int   *) getBufferAddress (env, X, startX),
+		(float *) getBufferAddress (env, labels, startLabels),
+		(float *) getBufferAddress (env, users, 0),
+		(float *) getBufferAddress (env, items, 0),
+		&conf);
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_sgdUpdate
+	(JNIEnv *env, jobject obj,
+	jobject weights, jobject gradient, jobject last,
+	jint count,
+	jfloat scale, jfloat decay, jfloat rate, jfloat momentum) {
+
+	(void) obj;
+
+	crossbow_cpu_sgd_conf_t conf;
+
+	conf.count    = count;
+	conf.scale    = scale;
+	conf.decay    = decay;
+	conf.rate     = rate;
+	conf.momentum = momentum;
+
+	crossbowCPUKernelSGDUpdate (
+		(float *) getBufferAddress (env, weights, 0),
+		(float *) getBufferAddress (env, gradient, 0),
+		(float *) getBufferAddress (env, last, 0),
+		&conf);
+
+	return 0;
+}
+
+JNIEXPORT jfloat JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_sumOfSquares
+	(JNIEnv *env, jobject obj, jobject X, jint count) {
+
+	(void) obj;
+
+	return crossbowCPUKernelSumOfSquares ((float *) getBufferAddress (env, X, 0), count);
+}
+
+/* Returns the addresses of the `offset`-th byte of the first `n` buffers in `objs` */
+static float **getBufferAddresses (JNIEnv *env, jobjectArray objs, int n, int offset) {
+	int i;
+	jobject obj;
+	float **addresses = (float **) malloc (n * sizeof(float *));
+	nullPointerException (addresses);
+	for (i = 0; i < n; ++i) {
+		obj = (*env)->GetObjectArrayElement (env, objs, i);
+		addresses[i] = (float *) getBufferAddress (env, obj, offset);
+		(*env)->DeleteLocalRef (env, obj);
+	}
+	return addresses;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_modelAverage
+	(JNIEnv *env, jobject obj, jobject base, jobjectArray replicas, jint n, jint offset, jint count) {
+
+	(void) obj;
+
+	float **r = getBufferAddresses (env, replicas, n, offset);
+
+	crossbowCPUKernelModelAverage ((float *) getBufferAddress (env, base, offset), r, n, count);
+
+	free (r);
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_elasticAverage
+	(JNIEnv *env, jobject obj, jobject base, jobjectArray replicas, jint n, jint offset, jint count, jfloat alpha) {
+
+	(void) obj;
+
+	float **r = getBufferAddresses (env, replicas, n, offset);
+
+	crossbowCPUKernelElasticAverage ((float *) getBufferAddress (env, base, offset), r, n, count, alpha);
+
+	free (r);
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_dataTransform
+	(JNIEnv *env, jobject obj,
+	jobject X, jint startX, jint type,
+	jobject Y, jint startY,
+	jintArray offsets, jint first,
+	jint examples, jint channels, jint height, jint width, jint croppedHeight, jint croppedWidth,
+	jobject means, jboolean meanImage,
+	jfloat scale, jfloat shift, jfloat factor) {
+
+	(void) obj;
+
+	crossbow_cpu_datatransform_conf_t conf;
+
+	conf.examples      = examples;
+	conf.channels      = channels;
+	conf.height        = height;
+	conf.width         = width;
+	conf.croppedHeight = croppedHeight;
+	conf.croppedWidth  = croppedWidth;
+	conf.type          = (crossbowCPUDataType_t) type;
+	conf.scale         = scale;
+	conf.shift         = shift;
+	conf.meanImage     = (meanImage == JNI_TRUE);
+	conf.factor        = factor;
+
+	jint *p = (*env)->GetIntArrayElements (env, offsets, NULL);
+
+	crossbowCPUKernelDataTransform (
+		getBufferAddress (env, X, startX),
+		(float *) getBufferAddress (env, Y, startY),
+		(const int *) (p + 3 * first),
+		(const float *) getBufferAddress (env, means, 0),
+		&conf);
+
+	(*env)->ReleaseIntArrayElements (env, offsets, p, JNI_ABORT);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_philox
+	(JNIEnv *env, jobject obj, jintArray Y, jint blocks, jint first, jint epoch, jint stream, jlong seed) {
+
+	(void) obj;
+
+	jint *p = (*env)->GetIntArrayElements (env, Y, NULL);
+
+	crossbowCPUKernelPhilox ((unsigned *) p, blocks, (unsigned) first, (unsigned) epoch, (unsigned) stream, (unsigned long long) seed);
+
+	(*env)->ReleaseIntArrayElements (env, Y, p, 0);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_dropout
+	(JNIEnv *env, jobject obj,
+	jobject X, jint startX,
+	jobject Y, jint startY,
+	jobject mask, jint startMask,
+	jint count, jfloat ratio,
+	jint first, jint task, jint stream, jlong seed) {
+
+	(void) obj;
+
+	float *x = (float *) getBufferAddress (env, X, startX);
+	float *y = (float *) getBufferAddress (env, Y, startY);
+	unsigned *m = (unsigned *) getBufferAddress (env, mask, startMask);
+
+	crossbowCPUKernelDropout (x, y, m, count, ratio, (unsigned) first, (unsigned) task, (unsigned) stream, (unsigned long long) seed);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_dropoutGradient
+	(JNIEnv *env, jobject obj,
+	jobject dY, jint startdY,
+	jobject mask, jint startMask,
+	jobject dX, jint startdX,
+	jint count, jfloat ratio) {
+
+	(void) obj;
+
+	float *dy = (float *) getBufferAddress (env, dY, startdY);
+	unsigned *m = (unsigned *) getBufferAddress (env, mask, startMask);
+	float *dx = (float *) getBufferAddress (env, dX, startdX);
+
+	crossbowCPUKernelDropoutGradient (dy, m, dx, count, ratio);
+
+	return 0;
+}
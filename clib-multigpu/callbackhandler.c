@@ -76,8 +76,8 @@ static void *handle (void *args) {
 	pthread_barrier_wait (&(self->barrier));
 
 	while (! self->exit) {
-		/* Busy wait for an event */
-		s = (crossbowStreamP) crossbowWaitFreeQueueDequeueOrWait (self->events);
+		/* Spin, then sleep, waiting for an event */
+		s = (crossbowStreamP) crossbowLockFreeQueueDequeueOrWait (self->events);
         if (! s)
             break;
         
@@ -169,7 +169,7 @@ crossbowCallbackHandlerP crossbowCallbackHandlerCreate (crossbowModelManagerP mo
 	/* Create a barrier between the main thread and a callback handler */
 	pthread_barrier_init(&(p->barrier), NULL, 2);
 	/* Only 1 event should suffice */
-    p->events = crossbowWaitFreeQueueCreate(10);
+    p->events = crossbowLockFreeQueueCreate (MPMC, 16);
     
 	/* Pointers to execution context's members */
 	p->modelmanager = modelmanager;
@@ -191,19 +191,19 @@ crossbowCallbackHandlerP crossbowCallbackHandlerCreate (crossbowModelManagerP mo
 
 void crossbowCallbackHandlerPublish (crossbowCallbackHandlerP p, crossbowStreamP args) {
 	/* Should we wait for a slot to be freed? */
-    crossbowWaitFreeQueueEnqueueOrWait(p->events, args);
+    crossbowLockFreeQueueEnqueueOrWait (p->events, args);
 }
 
 void crossbowCallbackHandlerFree (crossbowCallbackHandlerP p) {
 	if (! p->exited) {
         p->exit = 1;
-        /* Unblock thread */
-        crossbowWaitFreeQueueEnqueue(p->events, NULL);
+        /* Unblock thread (if the queue is full, it will see `exit` after its next item) */
+        crossbowLockFreeQueueTryEnqueue (p->events, NULL);
     }
     /* Wait until thread has exited */
     pthread_join(p->thread, NULL);
     /* Queue of events should be empty */
-	crossbowWaitFreeQueueFree (p->events);
+	crossbowLockFreeQueueFree (p->events);
 	/* Clean-up pthread_* */
 	pthread_barrier_destroy (&(p->barrier));
 #ifdef INTRA_TASK_MEASUREMENTS
@@ -6,7 +6,7 @@
 #include "measurementlist.h"
 
 #include "list.h"
-#include "waitfreequeue.h"
+#include "lockfreequeue.h"
 #include "modelmanager.h"
 #include "resulthandler.h"
 #include "stream.h"
@@ -22,7 +22,7 @@ typedef struct crossbow_callbackhandler {
 
 	pthread_barrier_t barrier;
 
-	crossbowWaitFreeQueueP events;
+	crossbowLockFreeQueueP events;
 
 	crossbowModelManagerP modelmanager;
 	crossbowResultHandlerP resulthandler;
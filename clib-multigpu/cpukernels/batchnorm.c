@@ -0,0 +1,196 @@
+#include "batchnorm.h"
+
+#include <math.h>
+
+#include "simd.h"
+
+static inline float sum (const float *x, int count) {
+	int i = 0;
+	crossbowVector_t s = crossbowVectorZero ();
+	for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH)
+		s = crossbowVectorAdd (s, crossbowVectorLoad (x + i));
+	float result = crossbowVectorSum (s);
+	for (; i < count; ++i)
+		result += x[i];
+	return result;
+}
+
+static inline float sumOfSquaredDifferences (const float *x, float mean, int count) {
+	int i = 0;
+	crossbowVector_t m = crossbowVectorSet (mean);
+	crossbowVector_t s = crossbowVectorZero ();
+	for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+		crossbowVector_t d = crossbowVectorSub (crossbowVectorLoad (x + i), m);
+		s = crossbowVectorFma (d, d, s);
+	}
+	float result = crossbowVectorSum (s);
+	for (; i < count; ++i)
+		result += (x[i] - mean) * (x[i] - mean);
+	return result;
+}
+
+static inline void sumOfProducts (const float *x, const float *y, int count, float *sx, float *sxy) {
+	int i = 0;
+	crossbowVector_t s1 = crossbowVectorZero ();
+	crossbowVector_t s2 = crossbowVectorZero ();
+	for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+		crossbowVector_t v = crossbowVectorLoad (x + i);
+		s1 = crossbowVectorAdd (s1, v);
+		s2 = crossbowVectorFma (v, crossbowVectorLoad (y + i), s2);
+	}
+	float r1 = crossbowVectorSum (s1);
+	float r2 = crossbowVectorSum (s2);
+	for (; i < count; ++i) {
+		r1 += x[i];
+		r2 += x[i] * y[i];
+	}
+	*sx  += r1;
+	*sxy += r2;
+	return;
+}
+
+void crossbowCPUKernelBatchNorm (
+	const float *x, float *y,
+	const float *weights, const float *bias,
+	float *mean, float *variance, float *averageMean, float *averageVariance,
+	float *invvar, float *xnorm,
+	crossbow_cpu_batchnorm_conf_t *conf) {
+
+	int n, c, i;
+	float s;
+
+	int N = conf->batchsize;
+	int C = conf->channels;
+	int S = conf->spatial;
+
+	float factor = 1.0F / ((float) N * S);
+
+	if (conf->training) {
+
+		for (c = conf->from; c < conf->to; ++c) {
+			/* Mean */
+			s = 0;
+			for (n = 0; n < N; ++n)
+				s += sum (x + (n * C + c) * S, S);
+			mean[c] = s * factor;
+			/* Variance, E (X - EX)^2 */
+			s = 0;
+			for (n = 0; n < N; ++n)
+				s += sumOfSquaredDifferences (x + (n * C + c) * S, mean[c], S);
+			variance[c] = s * factor;
+		}
+
+		/* Update moving averages */
+		for (c = conf->from; c < conf->to; ++c) {
+			if (conf->first) {
+				averageMean    [c] = mean    [c];
+				averageVariance[c] = variance[c];
+			} else {
+				averageMean    [c] = (1.0F - conf->fraction) * mean    [c] + conf->fraction * averageMean    [c];
+				averageVariance[c] = (1.0F - conf->fraction) * variance[c] + conf->fraction * averageVariance[c];
+			}
+		}
+	}
+	else {
+		for (c = conf->from; c < conf->to; ++c) {
+			mean    [c] = averageMean    [c];
+			variance[c] = averageVariance[c];
+		}
+	}
+
+	for (c = conf->from; c < conf->to; ++c)
+		invvar[c] = 1.0F / sqrtf (variance[c] + conf->epsilon);
+
+	/* Y = ((X - EX) * invvar) * scale + shift, in one pass */
+	for (n = 0; n < N; ++n) {
+		for (c = conf->from; c < conf->to; ++c) {
+
+			int offset = (n * C + c) * S;
+
+			const float *input = x + offset;
+			float *output = y + offset;
+			float *normalised = xnorm + offset;
+
+			float shift = (bias) ? bias[c] : 0;
+
+			crossbowVector_t m = crossbowVectorSet (mean[c]);
+			crossbowVector_t v = crossbowVectorSet (invvar[c]);
+			crossbowVector_t w = crossbowVectorSet (weights[c]);
+			crossbowVector_t b = crossbowVectorSet (shift);
+
+			i = 0;
+			for (; i <= S - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+				crossbowVector_t t = crossbowVectorMul (crossbowVectorSub (crossbowVectorLoad (input + i), m), v);
+				crossbowVectorStore (normalised + i, t);
+				crossbowVectorStore (output + i, crossbowVectorFma (t, w, b));
+			}
+			for (; i < S; ++i) {
+				normalised[i] = (input[i] - mean[c]) * invvar[c];
+				output[i] = normalised[i] * weights[c] + shift;
+			}
+		}
+	}
+	return;
+}
+
+void crossbowCPUKernelBatchNormGradient (
+	const float *dy, const float *xnorm,
+	const float *weights, const float *invvar,
+	float *dx, float *weightGradient, float *biasGradient,
+	crossbow_cpu_batchnorm_conf_t *conf) {
+
+	int n, c, i;
+
+	int N = conf->batchsize;
+	int C = conf->channels;
+	int S = conf->spatial;
+
+	float factor = 1.0F / ((float) N * S);
+
+	for (c = conf->from; c < conf->to; ++c) {
+
+		/* Reduce sum (dE/dY) and sum (dE/dY .* Xn) for this channel */
+		float sdy = 0, sdyx = 0;
+		for (n = 0; n < N; ++n) {
+			int offset = (n * C + c) * S;
+			sumOfProducts (dy + offset, xnorm + offset, S, &sdy, &sdyx);
+		}
+
+		weightGradient[c] = sdyx;
+		if (biasGradient)
+			biasGradient[c] = sdy;
+
+		/*
+		 * Since dE/dXn = scale * dE/dY, then
+		 *
+		 * dE/dX = a * dE/dY + b * Xn + d
+		 *
+		 * where a = scale * invvar, b = - a * mean(dE/dY .* Xn), and d = - a * mean(dE/dY)
+		 */
+		float a = weights[c] * invvar[c];
+		float b = -a * sdyx * factor;
+		float d = -a * sdy  * factor;
+
+		crossbowVector_t va = crossbowVectorSet (a);
+		crossbowVector_t vb = crossbowVectorSet (b);
+		crossbowVector_t vd = crossbowVectorSet (d);
+
+		for (n = 0; n < N; ++n) {
+
+			int offset = (n * C + c) * S;
+
+			const float *gradient = dy + offset;
+			const float *normalised = xnorm + offset;
+			float *output = dx + offset;
+
+			i = 0;
+			for (; i <= S - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+				crossbowVector_t t = crossbowVectorFma (va, crossbowVectorLoad (gradient + i), vd);
+				crossbowVectorStore (output + i, crossbowVectorFma (vb, crossbowVectorLoad (normalised + i), t));
+			}
+			for (; i < S; ++i)
+				output[i] = a * gradient[i] + b * normalised[i] + d;
+		}
+	}
+	return;
+}
@@ -0,0 +1,48 @@
+#ifndef __CROSSBOW_CPU_KERNEL_BATCHNORM_H_
+#define __CROSSBOW_CPU_KERNEL_BATCHNORM_H_
+
+/*
+ * Batch normalisation over an (N x C x S) input, where S is the spatial
+ * dimension. Statistics are computed per channel.
+ *
+ * During training, `mean` and `variance` are computed from the batch and
+ * folded into the moving averages: on the first call, they are copied;
+ * otherwise, average = (1 - fraction) x new + fraction x average.
+ *
+ * During testing, the moving averages are used instead.
+ *
+ * On exit, `xnorm` and `invvar` hold the normalised input and the inverse
+ * standard deviation, respectively, for the backward pass. `bias` may be
+ * null.
+ *
+ * Both kernels only process channels [from, to), so that disjoint ranges of
+ * channels can be processed in parallel.
+ */
+typedef struct crossbow_cpu_batchnorm_conf {
+	int batchsize, channels, spatial;
+	int from, to;
+	int training;
+	int first;
+	float fraction;
+	float epsilon;
+} crossbow_cpu_batchnorm_conf_t;
+
+void crossbowCPUKernelBatchNorm (
+	const float *x, float *y,
+	const float *weights, const float *bias,
+	float *mean, float *variance, float *averageMean, float *averageVariance,
+	float *invvar, float *xnorm,
+	crossbow_cpu_batchnorm_conf_t *conf);
+
+/*
+ * Computes dE/d(scale), dE/d(shift) (if `biasGradient` is not null), and
+ * dE/dX = (dE/dXn - mean(dE/dXn) - mean(dE/dXn .* Xn) .* Xn) .* invvar,
+ * where dE/dXn = dE/dY .* scale.
+ */
+void crossbowCPUKernelBatchNormGradient (
+	const float *dy, const float *xnorm,
+	const float *weights, const float *invvar,
+	float *dx, float *weightGradient, float *biasGradient,
+	crossbow_cpu_batchnorm_conf_t *conf);
+
+#endif /* __CROSSBOW_CPU_KERNEL_BATCHNORM_H_ */
@@ -0,0 +1,113 @@
+#include "datatransform.h"
+
+#include <stddef.h>
+
+#include "simd.h"
+
+/* y[i] = a x x[i] + b - f x m[i], for x of type T loaded (widened) by `load` and `cast` */
+#define CROSSBOW_TRANSFORM_ROW(T, load, cast) { \
+	const T *p = (const T *) x; \
+	for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) \
+		crossbowVectorStore (y + i, crossbowVectorFma (A, load (p + i), crossbowVectorFma (F, crossbowVectorLoad (m + i), B))); \
+	for (; i < count; ++i) \
+		y[i] = a * cast (p[i]) + b - f * m[i]; \
+}
+
+#define CROSSBOW_CAST(v) ((float) (v))
+
+static void crossbowDataTransformRow (const void *x, crossbowCPUDataType_t type, const float *m, float *y, int count, float a, float b, float f) {
+
+	int i = 0;
+
+	crossbowVector_t A, B, F;
+
+	if (m == NULL) {
+		crossbowCPUKernelWiden (x, type, y, count, a, b);
+		return;
+	}
+
+	A = crossbowVectorSet (a);
+	B = crossbowVectorSet (b);
+	F = crossbowVectorSet (-f);
+
+	switch (type) {
+	case CROSSBOW_UINT8: CROSSBOW_TRANSFORM_ROW (unsigned char,  crossbowVectorLoadUInt8, CROSSBOW_CAST);       break;
+	case CROSSBOW_INT8:  CROSSBOW_TRANSFORM_ROW (signed char,    crossbowVectorLoadInt8,  CROSSBOW_CAST);       break;
+	case CROSSBOW_FP16:  CROSSBOW_TRANSFORM_ROW (unsigned short, crossbowVectorLoadHalf,  crossbowHalfToFloat); break;
+	default:
+		CROSSBOW_TRANSFORM_ROW (float, crossbowVectorLoad, CROSSBOW_CAST);
+		break;
+	}
+	return;
+}
+
+static void crossbowDataTransformReverse (float *y, int count) {
+	int i, j;
+	float t;
+	for (i = 0, j = count - 1; i < j; ++i, --j) {
+		t = y[i];
+		y[i] = y[j];
+		y[j] = t;
+	}
+	return;
+}
+
+void crossbowCPUKernelDataTransform (const void *x, float *y, const int *offsets, const float *means, crossbow_cpu_datatransform_conf_t *conf) {
+
+	int n, c, h;
+
+	int C = conf->channels;
+	int H = conf->height;
+	int W = conf->width;
+	int outH = conf->croppedHeight;
+	int outW = conf->croppedWidth;
+
+	int size = crossbowCPUDataTypeSize (conf->type);
+
+	/* Folding widening and scaling: y = a x x + b - f x mean */
+	float f = conf->factor;
+	float a = conf->scale * f;
+	float b = conf->shift * f;
+
+	const char *input;
+	float *output;
+	const float *m;
+	float bc;
+
+	int hOffset, wOffset, mirror, inputIndex;
+
+	for (n = 0; n < conf->examples; ++n) {
+
+		input  = (const char *) x + (size_t) n * C * H * W * size;
+		output = y + (size_t) n * C * outH * outW;
+
+		hOffset = offsets[3 * n];
+		wOffset = offsets[3 * n + 1];
+		mirror  = offsets[3 * n + 2];
+
+		for (c = 0; c < C; ++c) {
+
+			/* Per-channel means are folded into the shift */
+			bc = b;
+			if (means != NULL && (! conf->meanImage))
+				bc -= f * means[c];
+
+			if (outH == H && outW == W && (! mirror)) {
+				/* Channel planes are contiguous */
+				inputIndex = c * H * W;
+				m = (means != NULL && conf->meanImage) ? (means + inputIndex) : NULL;
+				crossbowDataTransformRow (input + (size_t) inputIndex * size, conf->type, m, output + (size_t) c * H * W, H * W, a, bc, f);
+				continue;
+			}
+
+			for (h = 0; h < outH; ++h) {
+				inputIndex = (c * H + hOffset + h) * W + wOffset;
+				m = (means != NULL && conf->meanImage) ? (means + inputIndex) : NULL;
+				crossbowDataTransformRow (input + (size_t) inputIndex * size, conf->type, m, output + ((size_t) c * outH + h) * outW, outW, a, bc, f);
+				if (mirror)
+					crossbowDataTransformReverse (output + ((size_t) c * outH + h) * outW, outW);
+			}
+		}
+	}
+	return;
+}
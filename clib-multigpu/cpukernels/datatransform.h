@@ -0,0 +1,32 @@
+#ifndef __CROSSBOW_CPU_KERNEL_DATATRANSFORM_H_
+#define __CROSSBOW_CPU_KERNEL_DATATRANSFORM_H_
+
+#include "widen.h"
+
+/*
+ * Fused data transformation (crop, mirror, mean subtraction and scaling)
+ * of `examples` images, one output row at a time:
+ *
+ * y = factor x ((scale x x + shift) - mean)
+ *
+ * where `scale` and `shift` widen compact inputs (1 and 0 for floats), and
+ * `means` is either NULL, one value per channel or, if `meanImage` is set,
+ * an input-sized (channels x height x width) mean image.
+ *
+ * `offsets` holds 3 values per example: the crop's height and width offset,
+ * and whether the output image is mirrored (non-zero) or not.
+ */
+typedef struct crossbow_cpu_datatransform_conf {
+	int examples;
+	int channels;
+	int height, width;
+	int croppedHeight, croppedWidth;
+	crossbowCPUDataType_t type;
+	float scale, shift;
+	int meanImage;
+	float factor;
+} crossbow_cpu_datatransform_conf_t;
+
+void crossbowCPUKernelDataTransform (const void *x, float *y, const int *offsets, const float *means, crossbow_cpu_datatransform_conf_t *conf);
+
+#endif /* __CROSSBOW_CPU_KERNEL_DATATRANSFORM_H_ */
@@ -0,0 +1,82 @@
+#include "dropout.h"
+
+#include "philox.h"
+#include "simd.h"
+
+/* Mask words generated (and applied) at a time */
+#define CROSSBOW_DROPOUT_WORDS 16
+
+static inline float getScale (float ratio) {
+	return (ratio < 1.0F) ? (1.0F / (1.0F - ratio)) : 0.0F;
+}
+
+/* An element is kept if its 16-bit random value is at least `threshold` */
+static inline unsigned getThreshold (float ratio) {
+	if (ratio <= 0.0F)
+		return 0;
+	if (ratio >= 1.0F)
+		return 65536;
+	return (unsigned) (ratio * 65536.0F);
+}
+
+/* y = x * scale, masked, for elements [0, count); `mask` starts at element 0 */
+static void scaleAndMask (const float *x, const unsigned *mask, float *y, int count, float scale) {
+
+	int i = 0;
+
+	crossbowVector_t s = crossbowVectorSet (scale);
+
+	/* CROSSBOW_SIMD_WIDTH divides 32, so vectors never straddle mask words */
+	for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+		unsigned bits = mask[i >> 5] >> (i & 31);
+		crossbowVectorStore (y + i, crossbowVectorMaskBits (bits, crossbowVectorMul (crossbowVectorLoad (x + i), s)));
+	}
+	/* Remainder */
+	for (; i < count; ++i)
+		y[i] = ((mask[i >> 5] >> (i & 31)) & 1) ? x[i] * scale : 0;
+
+	return;
+}
+
+void crossbowCPUKernelDropout (const float *x, float *y, unsigned *mask, int count, float ratio,
+	unsigned first, unsigned task, unsigned stream, unsigned long long seed) {
+
+	int w, j, b, n;
+
+	unsigned random [4 * 4 * CROSSBOW_DROPOUT_WORDS];
+
+	int words = (count + 31) / 32;
+
+	unsigned threshold = getThreshold (ratio);
+	float scale = getScale (ratio);
+
+	for (w = 0; w < words; w += CROSSBOW_DROPOUT_WORDS) {
+
+		n = (words - w < CROSSBOW_DROPOUT_WORDS) ? (words - w) : CROSSBOW_DROPOUT_WORDS;
+
+		/* 4 blocks (16 words, or 32 16-bit values) per mask word */
+		crossbowCPUKernelPhilox (random, 4 * n, 4 * (first + (unsigned) w), task, stream, seed);
+
+		for (j = 0; j < n; ++j) {
+			const unsigned *r = random + 16 * j;
+			unsigned bits = 0;
+			for (b = 0; b < 16; ++b) {
+				bits |= (unsigned) ((r[b] & 0xFFFF) >= threshold) << (2 * b);
+				bits |= (unsigned) ((r[b] >>    16) >= threshold) << (2 * b + 1);
+			}
+			mask[w + j] = bits;
+		}
+
+		/* Apply the mask while it is in cache */
+		int offset = 32 * w;
+		int elements = (count - offset < 32 * n) ? (count - offset) : (32 * n);
+		scaleAndMask (x + offset, mask + w, y + offset, elements, scale);
+	}
+	return;
+}
+
+void crossbowCPUKernelDropoutGradient (const float *dy, const unsigned *mask, float *dx, int count, float ratio) {
+
+	scaleAndMask (dy, mask, dx, count, getScale (ratio));
+	return;
+}
@@ -0,0 +1,22 @@
+#ifndef __CROSSBOW_CPU_KERNEL_DROPOUT_H_
+#define __CROSSBOW_CPU_KERNEL_DROPOUT_H_
+
+/*
+ * Inverted dropout: y = x * scale, where an element is kept with probability
+ * (1 - ratio), and scale = 1 / (1 - ratio); dropped elements are 0.
+ *
+ * The keep mask is bit-packed (bit i % 32 of word i / 32 is set if element
+ * i is kept). Mask word w is drawn from Philox blocks (4w, ..., 4w + 3) of
+ * stream (task, stream) under key `seed`: every block yields 8 16-bit random
+ * values, one per element. Since the mask of a range of words does not depend
+ * on other words, ranges can be generated in any order (and in parallel):
+ * `first` is the index of the first mask word of `mask`, and `x` and `y`
+ * start at element 32 x `first`.
+ */
+void crossbowCPUKernelDropout (const float *x, float *y, unsigned *mask, int count, float ratio,
+	unsigned first, unsigned task, unsigned stream, unsigned long long seed);
+
+/* dx = dy * scale, for the elements kept by the forward pass, and 0 elsewhere */
+void crossbowCPUKernelDropoutGradient (const float *dy, const unsigned *mask, float *dx, int count, float ratio);
+
+#endif /* __CROSSBOW_CPU_KERNEL_DROPOUT_H_ */
@@ -0,0 +1,284 @@
+#include "lrn.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "simd.h"
+
+/*
+ * Both kernels slide a window over the channels of a block of spatial
+ * positions at a time, so that the running sum (one float per position)
+ * and the channel rows touched by the window stay in L1 cache.
+ */
+#define CROSSBOW_LRN_BLOCK 64
+
+/*
+ * The gradient's ring buffers are per-thread scratch, reused across calls
+ * (and grown when the window size grows). They are released by a
+ * thread-specific data destructor when the thread exits.
+ */
+typedef struct crossbow_lrn_thread_scratch {
+	float *buffer;
+	int capacity; /* In floats */
+	unsigned registered;
+} crossbow_lrn_thread_scratch_t;
+
+static __thread crossbow_lrn_thread_scratch_t scratch;
+
+static pthread_key_t scratchkey;
+static pthread_once_t scratchkeyonce = PTHREAD_ONCE_INIT;
+
+static void crossbowCPUKernelLRNScratchFree (void *args) {
+	crossbow_lrn_thread_scratch_t *t = (crossbow_lrn_thread_scratch_t *) args;
+	free (t->buffer);
+	t->buffer = NULL;
+	t->capacity = 0;
+	t->registered = 0;
+	return;
+}
+
+static void crossbowCPUKernelLRNScratchCreateKey (void) {
+	pthread_key_create (&scratchkey, crossbowCPUKernelLRNScratchFree);
+	return;
+}
+
+/* Returns this thread's scratch buffer, with at least `count` floats */
+static float *crossbowCPUKernelLRNScratch (int count) {
+	if (! scratch.registered) {
+		pthread_once (&scratchkeyonce, crossbowCPUKernelLRNScratchCreateKey);
+		pthread_setspecific (scratchkey, &scratch);
+		scratch.registered = 1;
+	}
+	if (scratch.capacity < count) {
+		free (scratch.buffer);
+		scratch.buffer = (float *) malloc (count * sizeof(float));
+		if (! scratch.buffer) {
+			fprintf(stderr, "error: failed to allocate LRN gradient buffers\n");
+			exit(1);
+		}
+		scratch.capacity = count;
+	}
+	return scratch.buffer;
+}
+
+/* p = s^(-beta); beta = 0.75 (the default) and 0.5 avoid powf */
+static inline void crossbowCPUKernelLRNPower (const float *s, float *p, int count, float beta) {
+
+	int i = 0;
+
+	crossbowVector_t one = crossbowVectorSet (1.0F);
+
+	if (beta == 0.75F) {
+		for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+			crossbowVector_t v = crossbowVectorLoad (s + i);
+			crossbowVectorStore (p + i, crossbowVectorDiv (one, crossbowVectorSqrt (crossbowVectorMul (v, crossbowVectorSqrt (v)))));
+		}
+		for (; i < count; ++i)
+			p[i] = 1.0F / sqrtf (s[i] * sqrtf (s[i]));
+	}
+	else if (beta == 0.5F) {
+		for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH)
+			crossbowVectorStore (p + i, crossbowVectorDiv (one, crossbowVectorSqrt (crossbowVectorLoad (s + i))));
+		for (; i < count; ++i)
+			p[i] = 1.0F / sqrtf (s[i]);
+	}
+	else {
+		for (; i < count; ++i)
+			p[i] = powf (s[i], -beta);
+	}
+	return;
+}
+
+/* acc += sign x x^2 */
+static inline void crossbowCPUKernelLRNAccumulateSquares (float *acc, const float *x, int count, float sign) {
+
+	int i = 0;
+
+	crossbowVector_t m = crossbowVectorSet (sign);
+
+	for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+		crossbowVector_t v = crossbowVectorLoad (x + i);
+		crossbowVectorStore (acc + i, crossbowVectorFma (crossbowVectorMul (m, v), v, crossbowVectorLoad (acc + i)));
+	}
+	for (; i < count; ++i)
+		acc[i] += sign * x[i] * x[i];
+
+	return;
+}
+
+void crossbowCPUKernelLRN (const float *x, float *y, float *scale, crossbow_cpu_lrn_conf_t *conf) {
+
+	int n, c, b, i, count;
+
+	int N = conf->batchsize;
+	int C = conf->channels;
+	int S = conf->spatial;
+
+	int pre  = (conf->size - 1) / 2;
+	int post = conf->size - pre - 1;
+
+	float factor = conf->alpha / conf->size;
+
+	float acc [CROSSBOW_LRN_BLOCK];
+	float p   [CROSSBOW_LRN_BLOCK];
+
+	crossbowVector_t k = crossbowVectorSet (conf->kappa);
+	crossbowVector_t f = crossbowVectorSet (factor);
+
+	for (n = 0; n < N; ++n) {
+
+		const float *input = x + n * C * S;
+		float *output = y + n * C * S;
+		float *s = scale + n * C * S;
+
+		for (b = 0; b < S; b += CROSSBOW_LRN_BLOCK) {
+
+			count = (S - b < CROSSBOW_LRN_BLOCK) ? (S - b) : CROSSBOW_LRN_BLOCK;
+
+			for (i = 0; i < count; ++i)
+				acc[i] = 0;
+
+			/* Channels [0, post) enter the window of channel 0 */
+			for (c = 0; c < post && c < C; ++c)
+				crossbowCPUKernelLRNAccumulateSquares (acc, input + c * S + b, count, 1.0F);
+
+			for (c = 0; c < C; ++c) {
+
+				const float *xc = input + c * S + b;
+				float *yc = output + c * S + b;
+				float *sc = s + c * S + b;
+
+				if (c + post < C)
+					crossbowCPUKernelLRNAccumulateSquares (acc, input + (c + post) * S + b, count, 1.0F);
+
+				/* scale = kappa + (alpha / size) x acc */
+				i = 0;
+				for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH)
+					crossbowVectorStore (sc + i, crossbowVectorFma (f, crossbowVectorLoad (acc + i), k));
+				for (; i < count; ++i)
+					sc[i] = conf->kappa + factor * acc[i];
+
+				crossbowCPUKernelLRNPower (sc, p, count, conf->beta);
+
+				i = 0;
+				for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH)
+					crossbowVectorStore (yc + i, crossbowVectorMul (crossbowVectorLoad (xc + i), crossbowVectorLoad (p + i)));
+				for (; i < count; ++i)
+					yc[i] = xc[i] * p[i];
+
+				if (c - pre >= 0)
+					crossbowCPUKernelLRNAccumulateSquares (acc, input + (c - pre) * S + b, count, -1.0F);
+			}
+		}
+	}
+	return;
+}
+
+void crossbowCPUKernelLRNGradient (const float *dy, const float *x, const float *scale, float *dx, crossbow_cpu_lrn_conf_t *conf) {
+
+	int n, c, b, i, j, count;
+
+	int N = conf->batchsize;
+	int C = conf->channels;
+	int S = conf->spatial;
+	int L = conf->size;
+
+	int pre  = (L - 1) / 2;
+	int post = L - pre - 1;
+
+	float coefficient = 2.0F * conf->alpha * conf->beta / L;
+
+	float acc [CROSSBOW_LRN_BLOCK];
+
+	/*
+	 * Ring buffers of L rows, indexed by channel modulo L: `ratio` holds
+	 * dy x y / scale for the channels in the sum; `power` holds
+	 * scale^(-beta) for channels that have entered the sum but whose
+	 * gradient is not yet computed.
+	 */
+	float *ratio = crossbowCPUKernelLRNScratch (2 * L * CROSSBOW_LRN_BLOCK);
+	float *power = ratio + L * CROSSBOW_LRN_BLOCK;
+
+	crossbowVector_t m = crossbowVectorSet (-coefficient);
+
+	for (n = 0; n < N; ++n) {
+
+		const float *gradient = dy + n * C * S;
+		const float *input = x + n * C * S;
+		const float *s = scale + n * C * S;
+		float *output = dx + n * C * S;
+
+		for (b = 0; b < S; b += CROSSBOW_LRN_BLOCK) {
+
+			count = (S - b < CROSSBOW_LRN_BLOCK) ? (S - b) : CROSSBOW_LRN_BLOCK;
+
+			for (i = 0; i < count; ++i)
+				acc[i] = 0;
+
+			/*
+			 * The gradient of channel c sums over channels [c - post, c + pre],
+			 * i.e. those whose window includes c. Channel j enters the sum:
+			 * compute its power and ratio, and add the latter to acc.
+			 */
+			for (c = -pre; c < C; ++c) {
+
+				j = c + pre;
+				if (j < C) {
+
+					float *r = ratio + (j % L) * CROSSBOW_LRN_BLOCK;
+					float *p = power + (j % L) * CROSSBOW_LRN_BLOCK;
+
+					const float *dyj = gradient + j * S + b;
+					const float  *xj =    input + j * S + b;
+					const float  *sj =        s + j * S + b;
+
+					crossbowCPUKernelLRNPower (sj, p, count, conf->beta);
+
+					i = 0;
+					for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+						crossbowVector_t v = crossbowVectorDiv (
+							crossbowVectorMul (crossbowVectorMul (crossbowVectorLoad (dyj + i), crossbowVectorLoad (xj + i)), crossbowVectorLoad (p + i)),
+							crossbowVectorLoad (sj + i));
+						crossbowVectorStore (r + i, v);
+						crossbowVectorStore (acc + i, crossbowVectorAdd (crossbowVectorLoad (acc + i), v));
+					}
+					for (; i < count; ++i) {
+						r[i] = dyj[i] * xj[i] * p[i] / sj[i];
+						acc[i] += r[i];
+					}
+				}
+
+				if (c < 0)
+					continue;
+
+				/* dx = dy x scale^(-beta) - coefficient x x x acc */
+				const float *dyc = gradient + c * S + b;
+				const float  *xc =    input + c * S + b;
+				const float  *pc =    power + (c % L) * CROSSBOW_LRN_BLOCK;
+				float *dxc = output + c * S + b;
+
+				i = 0;
+				for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+					crossbowVector_t t = crossbowVectorMul (crossbowVectorMul (m, crossbowVectorLoad (xc + i)), crossbowVectorLoad (acc + i));
+					crossbowVectorStore (dxc + i, crossbowVectorFma (crossbowVectorLoad (dyc + i), crossbowVectorLoad (pc + i), t));
+				}
+				for (; i < count; ++i)
+					dxc[i] = dyc[i] * pc[i] - coefficient * xc[i] * acc[i];
+
+				/* Channel c - post leaves the sum */
+				if (c - post >= 0) {
+					const float *r = ratio + ((c - post) % L) * CROSSBOW_LRN_BLOCK;
+					i = 0;
+					for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH)
+						crossbowVectorStore (acc + i, crossbowVectorSub (crossbowVectorLoad (acc + i), crossbowVectorLoad (r + i)));
+					for (; i < count; ++i)
+						acc[i] -= r[i];
+				}
+			}
+		}
+	}
+
+	return;
+}
@@ -0,0 +1,32 @@
+#ifndef __CROSSBOW_CPU_KERNEL_LRN_H_
+#define __CROSSBOW_CPU_KERNEL_LRN_H_
+
+/*
+ * Cross-channel local response normalisation over an (N x C x S) input,
+ * where S is the spatial dimension (as in Caffe's LRN layer):
+ *
+ * scale[n,c,s] = kappa + (alpha / size) x sum (x[n,c',s]^2), c' in [c - pre, c + post]
+ * y[n,c,s] = x[n,c,s] x scale[n,c,s]^(-beta)
+ *
+ * where pre = (size - 1) / 2 and post = size - pre - 1.
+ *
+ * The forward kernel stores `scale` for the backward pass.
+ */
+typedef struct crossbow_cpu_lrn_conf {
+	int batchsize, channels, spatial;
+	int size;
+	float alpha, beta, kappa;
+} crossbow_cpu_lrn_conf_t;
+
+void crossbowCPUKernelLRN (const float *x, float *y, float *scale, crossbow_cpu_lrn_conf_t *conf);
+
+/*
+ * dx[n,c,s] = dy[n,c,s] x scale[n,c,s]^(-beta) -
+ *     (2 alpha beta / size) x x[n,c,s] x sum (dy[n,c',s] x y[n,c',s] / scale[n,c',s])
+ *
+ * for c' in [c - post, c + pre], i.e. the channels whose window includes c.
+ * The output y is recomputed from x and scale.
+ */
+void crossbowCPUKernelLRNGradient (const float *dy, const float *x, const float *scale, float *dx, crossbow_cpu_lrn_conf_t *conf);
+
+#endif /* __CROSSBOW_CPU_KERNEL_LRN_H_ */
@@ -0,0 +1,118 @@
+#include "matfact.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "simd.h"
+
+/*
+ * Stripe locks, shared by all matrix factorisation operators (and model
+ * replicas). A row only ever maps to one stripe, so holding two locks at
+ * a time, always user stripe first, cannot deadlock.
+ */
+static volatile int userlocks [CROSSBOW_MATFACT_STRIPES];
+static volatile int itemlocks [CROSSBOW_MATFACT_STRIPES];
+
+static inline void crossbowCPUKernelMatFactLock (volatile int *lock) {
+	while (__atomic_exchange_n (lock, 1, __ATOMIC_ACQUIRE)) {
+		while (__atomic_load_n (lock, __ATOMIC_RELAXED))
+			_mm_pause ();
+	}
+	return;
+}
+
+static inline void crossbowCPUKernelMatFactUnlock (volatile int *lock) {
+	__atomic_store_n (lock, 0, __ATOMIC_RELEASE);
+	return;
+}
+
+static inline float crossbowCPUKernelMatFactDot (const float *x, const float *y, int count) {
+
+	int k = 0;
+	float result;
+
+	crossbowVector_t sum = crossbowVectorZero ();
+
+	for (; k <= count - CROSSBOW_SIMD_WIDTH; k += CROSSBOW_SIMD_WIDTH)
+		sum = crossbowVectorFma (crossbowVectorLoad (x + k), crossbowVectorLoad (y + k), sum);
+	result = crossbowVectorSum (sum);
+	for (; k < count; ++k)
+		result += x[k] * y[k];
+
+	return result;
+}
+
+/* Both rows are updated from their values before the update */
+static inline void crossbowCPUKernelMatFactUpdate (float *u, float *v, int count, float error, float lambda, float rate) {
+
+	int k = 0;
+	float a = 2.0F * rate * error;
+	float b = 1.0F - 2.0F * rate * lambda;
+	float x, y;
+
+	crossbowVector_t A = crossbowVectorSet (a);
+	crossbowVector_t B = crossbowVectorSet (b);
+
+	/* u = b u + a v; v = b v + a u */
+	for (; k <= count - CROSSBOW_SIMD_WIDTH; k += CROSSBOW_SIMD_WIDTH) {
+		crossbowVector_t U = crossbowVectorLoad (u + k);
+		crossbowVector_t V = crossbowVectorLoad (v + k);
+		crossbowVectorStore (u + k, crossbowVectorFma (B, U, crossbowVectorMul (A, V)));
+		crossbowVectorStore (v + k, crossbowVectorFma (B, V, crossbowVectorMul (A, U)));
+	}
+	for (; k < count; ++k) {
+		x = u[k];
+		y = v[k];
+		u[k] = b * x + a * y;
+		v[k] = b * y + a * x;
+	}
+	return;
+}
+
+float crossbowCPUKernelMatFact (const int *examples, const float *ratings, float *users, float *items, crossbow_cpu_matfact_conf_t *conf) {
+
+	int n;
+	int user, item;
+	float *u, *v;
+	float error;
+	float loss = 0;
+
+	volatile int *userlock = NULL;
+	volatile int *itemlock = NULL;
+
+	int K = conf->latents;
+
+	for (n = 0; n < conf->examples; ++n) {
+
+		user = examples[2 * n];
+		item = examples[2 * n + 1];
+
+		u = users + (size_t) user * K;
+		v = items + (size_t) item * K;
+
+		/* Fetch the next pair of rows while this one is being updated */
+		if (n + 1 < conf->examples) {
+			__builtin_prefetch (users + (size_t) examples[2 * n + 2] * K, 1);
+			__builtin_prefetch (items + (size_t) examples[2 * n + 3] * K, 1);
+		}
+
+		if (conf->locking) {
+			userlock = &userlocks [user & (CROSSBOW_MATFACT_STRIPES - 1)];
+			itemlock = &itemlocks [item & (CROSSBOW_MATFACT_STRIPES - 1)];
+			crossbowCPUKernelMatFactLock (userlock);
+			crossbowCPUKernelMatFactLock (itemlock);
+		}
+
+		error = ratings[n] - crossbowCPUKernelMatFactDot (u, v, K);
+		crossbowCPUKernelMatFactUpdate (u, v, K, error, conf->lambda, conf->rate);
+
+		if (conf->locking) {
+			crossbowCPUKernelMatFactUnlock (itemlock);
+			crossbowCPUKernelMatFactUnlock (userlock);
+		}
+
+		loss += error * error;
+	}
+
+	return loss;
+}
@@ -0,0 +1,32 @@
+#ifndef __CROSSBOW_CPU_KERNEL_MATFACT_H_
+#define __CROSSBOW_CPU_KERNEL_MATFACT_H_
+
+/*
+ * Sparse (Hogwild) matrix factorisation. For every example (u, i) with
+ * rating r, the kernel computes e = r - users[u] . items[i] and updates
+ * the two rows in place:
+ *
+ * users[u] += rate x (2 e items[i] - 2 lambda users[u])
+ * items[i] += rate x (2 e users[u] - 2 lambda items[i])
+ *
+ * Only the rows touched by the batch are read or written. If `locking` is
+ * set, each update holds the stripe locks of its user and item rows (see
+ * CROSSBOW_MATFACT_STRIPES); otherwise, concurrent updates to the same row
+ * may race, as in Hogwild.
+ *
+ * Returns the sum of squared errors over the batch.
+ */
+typedef struct crossbow_cpu_matfact_conf {
+	int examples;
+	int latents;
+	float lambda, rate;
+	int locking;
+} crossbow_cpu_matfact_conf_t;
+
+/* Number of locks per model variable; a power of 2 */
+#define CROSSBOW_MATFACT_STRIPES 1024
+
+/* `examples` holds pairs of (user, item) ids, which are not range-checked */
+float crossbowCPUKernelMatFact (const int *examples, const float *ratings, float *users, float *items, crossbow_cpu_matfact_conf_t *conf);
+
+#endif /* __CROSSBOW_CPU_KERNEL_MATFACT_H_ */
@@ -0,0 +1,64 @@
+#include "merge.h"
+
+#include "simd.h"
+
+void crossbowCPUKernelModelAverage (float *base, float **replicas, int n, int count) {
+
+	int i = 0, r;
+	float scale = 1.0F / (float) n;
+	float sum;
+
+	crossbowVector_t S = crossbowVectorSet (scale);
+
+	for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+		crossbowVector_t B = crossbowVectorLoad (replicas[0] + i);
+		for (r = 1; r < n; ++r)
+			B = crossbowVectorAdd (B, crossbowVectorLoad (replicas[r] + i));
+		B = crossbowVectorMul (B, S);
+		crossbowVectorStore (base + i, B);
+		for (r = 0; r < n; ++r)
+			crossbowVectorStore (replicas[r] + i, B);
+	}
+	for (; i < count; ++i) {
+		sum = replicas[0][i];
+		for (r = 1; r < n; ++r)
+			sum += replicas[r][i];
+		sum *= scale;
+		base[i] = sum;
+		for (r = 0; r < n; ++r)
+			replicas[r][i] = sum;
+	}
+	return;
+}
+
+void crossbowCPUKernelElasticAverage (float *base, float **replicas, int n, int count, float alpha) {
+
+	int i = 0, r;
+	float b, d, acc;
+
+	crossbowVector_t A = crossbowVectorSet (alpha);
+
+	for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+		crossbowVector_t B = crossbowVectorLoad (base + i);
+		crossbowVector_t C = crossbowVectorZero ();
+		for (r = 0; r < n; ++r) {
+			crossbowVector_t R = crossbowVectorLoad (replicas[r] + i);
+			/* D = alpha x (R - B) */
+			crossbowVector_t D = crossbowVectorMul (A, crossbowVectorSub (R, B));
+			crossbowVectorStore (replicas[r] + i, crossbowVectorSub (R, D));
+			C = crossbowVectorAdd (C, D);
+		}
+		crossbowVectorStore (base + i, crossbowVectorAdd (B, C));
+	}
+	for (; i < count; ++i) {
+		b = base[i];
+		acc = 0;
+		for (r = 0; r < n; ++r) {
+			d = alpha * (replicas[r][i] - b);
+			replicas[r][i] -= d;
+			acc += d;
+		}
+		base[i] = b + acc;
+	}
+	return;
+}
@@ -0,0 +1,24 @@
+#ifndef __CROSSBOW_CPU_KERNEL_MERGE_H_
+#define __CROSSBOW_CPU_KERNEL_MERGE_H_
+
+/*
+ * Synchronisation of `n` CPU model replicas with their base model, over
+ * `count` elements. Both kernels read every replica once per element block
+ * and keep the running result in registers.
+ *
+ * Model averaging:
+ *
+ * base = (1 / n) x sum (replica[r])
+ * replica[r] = base
+ *
+ * Elastic averaging (as in the GPU synchronous EA-SGD model):
+ *
+ * diff[r] = replica[r] - base
+ * replica[r] = replica[r] - alpha x diff[r]
+ * base = base + alpha x sum (diff[r])
+ */
+void crossbowCPUKernelModelAverage (float *base, float **replicas, int n, int count);
+
+void crossbowCPUKernelElasticAverage (float *base, float **replicas, int n, int count, float alpha);
+
+#endif /* __CROSSBOW_CPU_KERNEL_MERGE_H_ */
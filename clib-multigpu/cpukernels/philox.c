@@ -0,0 +1,64 @@
+#include "philox.h"
+
+/*
+ * Blocks are generated `CROSSBOW_PHILOX_LANES` at a time, with each counter
+ * word in its own array, so that the rounds compile to vector (32 x 32-bit
+ * to 64-bit) multiplies across lanes.
+ */
+#define CROSSBOW_PHILOX_LANES 16
+
+void crossbowCPUKernelPhilox (unsigned *y, int blocks, unsigned first, unsigned epoch, unsigned stream, unsigned long long seed) {
+
+	int i, j, round;
+
+	unsigned c0 [CROSSBOW_PHILOX_LANES];
+	unsigned c1 [CROSSBOW_PHILOX_LANES];
+	unsigned c2 [CROSSBOW_PHILOX_LANES];
+	unsigned c3 [CROSSBOW_PHILOX_LANES];
+
+	unsigned key [2] = { (unsigned) seed, (unsigned) (seed >> 32) };
+
+	for (i = 0; i <= blocks - CROSSBOW_PHILOX_LANES; i += CROSSBOW_PHILOX_LANES) {
+
+		for (j = 0; j < CROSSBOW_PHILOX_LANES; ++j) {
+			c0[j] = first + (unsigned) (i + j);
+			c1[j] = epoch;
+			c2[j] = stream;
+			c3[j] = 0;
+		}
+
+		unsigned k0 = key[0], k1 = key[1];
+		for (round = 0; round < 10; ++round) {
+			for (j = 0; j < CROSSBOW_PHILOX_LANES; ++j) {
+				unsigned long long p0 = (unsigned long long) CROSSBOW_PHILOX_M0 * c0[j];
+				unsigned long long p1 = (unsigned long long) CROSSBOW_PHILOX_M1 * c2[j];
+				unsigned t1 = c1[j], t3 = c3[j];
+				c0[j] = (unsigned) (p1 >> 32) ^ t1 ^ k0;
+				c1[j] = (unsigned) p1;
+				c2[j] = (unsigned) (p0 >> 32) ^ t3 ^ k1;
+				c3[j] = (unsigned) p0;
+			}
+			k0 += CROSSBOW_PHILOX_W0;
+			k1 += CROSSBOW_PHILOX_W1;
+		}
+
+		unsigned *p = y + 4 * i;
+		for (j = 0; j < CROSSBOW_PHILOX_LANES; ++j) {
+			p[4 * j    ] = c0[j];
+			p[4 * j + 1] = c1[j];
+			p[4 * j + 2] = c2[j];
+			p[4 * j + 3] = c3[j];
+		}
+	}
+
+	/* Remaining blocks */
+	for (; i < blocks; ++i) {
+		unsigned *p = y + 4 * i;
+		p[0] = first + (unsigned) i;
+		p[1] = epoch;
+		p[2] = stream;
+		p[3] = 0;
+		crossbowPhilox (p, key);
+	}
+	return;
+}
@@ -0,0 +1,54 @@
+#ifndef __CROSSBOW_CPU_KERNEL_PHILOX_H_
+#define __CROSSBOW_CPU_KERNEL_PHILOX_H_
+
+/*
+ * Philox-4x32-10, a counter-based random number generator (Salmon et al.,
+ * SC'11): block i of a stream is a pure function of a 128-bit counter and
+ * a 64-bit key, so streams need no state and can be generated in any order
+ * (and in parallel). The Java implementation (`utils.Philox`) produces the
+ * same values.
+ *
+ * Streams are keyed by the random seed; counters are (index, epoch, stream,
+ * 0), where `index` typically is the example index.
+ */
+
+#define CROSSBOW_PHILOX_M0 0xD2511F53U
+#define CROSSBOW_PHILOX_M1 0xCD9E8D57U
+#define CROSSBOW_PHILOX_W0 0x9E3779B9U
+#define CROSSBOW_PHILOX_W1 0xBB67AE85U
+
+/* Computes block `c` (4 words) under key `k`, in place */
+static inline void crossbowPhilox (unsigned *c, const unsigned *k) {
+	int round;
+	unsigned k0 = k[0], k1 = k[1];
+	for (round = 0; round < 10; ++round) {
+		unsigned long long p0 = (unsigned long long) CROSSBOW_PHILOX_M0 * c[0];
+		unsigned long long p1 = (unsigned long long) CROSSBOW_PHILOX_M1 * c[2];
+		unsigned c1 = c[1], c3 = c[3];
+		c[0] = (unsigned) (p1 >> 32) ^ c1 ^ k0;
+		c[1] = (unsigned) p1;
+		c[2] = (unsigned) (p0 >> 32) ^ c3 ^ k1;
+		c[3] = (unsigned) p0;
+		k0 += CROSSBOW_PHILOX_W0;
+		k1 += CROSSBOW_PHILOX_W1;
+	}
+	return;
+}
+
+/* Maps a random word to [0, 1), with 24 bits of precision */
+static inline float crossbowPhiloxUniform (unsigned x) {
+	return (float) (x >> 8) * 5.9604644775390625e-8F;
+}
+
+/* Maps a random word to [0, n) */
+static inline unsigned crossbowPhiloxBounded (unsigned x, unsigned n) {
+	return (unsigned) (((unsigned long long) x * n) >> 32);
+}
+
+/*
+ * Fills `y` with `blocks` consecutive blocks (4 words each), for counters
+ * (first + i, epoch, stream, 0) under key `seed`.
+ */
+void crossbowCPUKernelPhilox (unsigned *y, int blocks, unsigned first, unsigned epoch, unsigned stream, unsigned long long seed);
+
+#endif /* __CROSSBOW_CPU_KERNEL_PHILOX_H_ */
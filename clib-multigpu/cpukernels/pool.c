@@ -0,0 +1,199 @@
+#include "pool.h"
+
+#include <string.h>
+#include <float.h>
+
+#include "simd.h"
+
+#define __max(a, b) (((a) > (b)) ? (a) : (b))
+#define __min(a, b) (((a) < (b)) ? (a) : (b))
+
+static inline float crossbowCPUKernelPlaneSum (const float *x, int count) {
+	int i = 0;
+	crossbowVector_t sum = crossbowVectorZero ();
+	for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH)
+		sum = crossbowVectorAdd (sum, crossbowVectorLoad (x + i));
+	float result = crossbowVectorSum (sum);
+	for (; i < count; ++i)
+		result += x[i];
+	return result;
+}
+
+void crossbowCPUKernelMaxPool (const float *x, int offset, float *y, int *indices, crossbow_cpu_pool_conf_t *conf) {
+
+	int n, ph, pw, h, w;
+	int hstart, hend, wstart, wend;
+	int ndx, pos;
+	float value;
+
+	int inputPlane  = conf->height * conf->width;
+	int outputPlane = conf->pooledHeight * conf->pooledWidth;
+
+	for (n = 0; n < conf->planes; ++n) {
+
+		const float *input = x + n * inputPlane;
+		float *output = y + n * outputPlane;
+		int *index = indices + n * outputPlane;
+
+		for (ph = 0; ph < conf->pooledHeight; ++ph) {
+
+			hstart = ph * conf->strideHeight - conf->paddingHeight;
+			hend = __min (hstart + conf->kernelHeight, conf->height);
+			hstart = __max (hstart, 0);
+
+			for (pw = 0; pw < conf->pooledWidth; ++pw) {
+
+				wstart = pw * conf->strideWidth - conf->paddingWidth;
+				wend = __min (wstart + conf->kernelWidth, conf->width);
+				wstart = __max (wstart, 0);
+
+				value = -FLT_MAX;
+				pos = -1;
+
+				for (h = hstart; h < hend; ++h) {
+					for (w = wstart; w < wend; ++w) {
+						ndx = h * conf->width + w;
+						/* Strictly greater: the first maximum wins */
+						if (pos < 0 || input[ndx] > value) {
+							value = input[ndx];
+							pos = ndx;
+						}
+					}
+				}
+
+				output[ph * conf->pooledWidth + pw] = value;
+				index [ph * conf->pooledWidth + pw] = (pos < 0) ? -1 : offset + (n * inputPlane + pos) * (int) sizeof(float);
+			}
+		}
+	}
+	return;
+}
+
+void crossbowCPUKernelAveragePool (const float *x, float *y, crossbow_cpu_pool_conf_t *conf) {
+
+	int n, ph, pw, h, w;
+	int hstart, hend, wstart, wend;
+	int size;
+	float sum;
+
+	int inputPlane  = conf->height * conf->width;
+	int outputPlane = conf->pooledHeight * conf->pooledWidth;
+
+	if (outputPlane == 1 && conf->kernelHeight == conf->height && conf->kernelWidth == conf->width &&
+		conf->paddingHeight == 0 && conf->paddingWidth == 0) {
+		/* Global pooling: each plane is reduced to a single value */
+		for (n = 0; n < conf->planes; ++n)
+			y[n] = crossbowCPUKernelPlaneSum (x + n * inputPlane, inputPlane) / inputPlane;
+		return;
+	}
+
+	for (n = 0; n < conf->planes; ++n) {
+
+		const float *input = x + n * inputPlane;
+		float *output = y + n * outputPlane;
+
+		for (ph = 0; ph < conf->pooledHeight; ++ph) {
+			for (pw = 0; pw < conf->pooledWidth; ++pw) {
+
+				hstart = ph * conf->strideHeight - conf->paddingHeight;
+				wstart = pw * conf->strideWidth  - conf->paddingWidth;
+
+				hend = __min (hstart + conf->kernelHeight, conf->height + conf->paddingHeight);
+				wend = __min (wstart + conf->kernelWidth,  conf->width  + conf->paddingWidth);
+
+				/* Pool size includes padding */
+				size = (hend - hstart) * (wend - wstart);
+
+				hstart = __max (hstart, 0);
+				wstart = __max (wstart, 0);
+
+				hend = __min (hend, conf->height);
+				wend = __min (wend, conf->width);
+
+				sum = 0;
+				for (h = hstart; h < hend; ++h)
+					for (w = wstart; w < wend; ++w)
+						sum += input[h * conf->width + w];
+
+				output[ph * conf->pooledWidth + pw] = sum / size;
+			}
+		}
+	}
+	return;
+}
+
+void crossbowCPUKernelMaxPoolGradient (const float *dy, const int *indices, int count, int offset, float *dx, int elements) {
+
+	int i, ndx;
+
+	memset (dx, 0, elements * sizeof(float));
+
+	for (i = 0; i < count; ++i) {
+		if (indices[i] < 0)
+			continue;
+		ndx = (indices[i] - offset) / (int) sizeof(float);
+		/* Accumulate, since windows may overlap */
+		dx[ndx] += dy[i];
+	}
+	return;
+}
+
+void crossbowCPUKernelAveragePoolGradient (const float *dy, float *dx, crossbow_cpu_pool_conf_t *conf) {
+
+	int n, ph, pw, h, w;
+	int hstart, hend, wstart, wend;
+	int size;
+	float value;
+
+	int inputPlane  = conf->height * conf->width;
+	int outputPlane = conf->pooledHeight * conf->pooledWidth;
+
+	if (outputPlane == 1 && conf->kernelHeight == conf->height && conf->kernelWidth == conf->width &&
+		conf->paddingHeight == 0 && conf->paddingWidth == 0) {
+		/* Global pooling: broadcast each gradient value to its plane */
+		for (n = 0; n < conf->planes; ++n) {
+			int i = 0;
+			float *output = dx + n * inputPlane;
+			crossbowVector_t v = crossbowVectorSet (dy[n] / inputPlane);
+			for (; i <= inputPlane - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH)
+				crossbowVectorStore (output + i, v);
+			for (; i < inputPlane; ++i)
+				output[i] = dy[n] / inputPlane;
+		}
+		return;
+	}
+
+	memset (dx, 0, conf->planes * inputPlane * sizeof(float));
+
+	for (n = 0; n < conf->planes; ++n) {
+
+		const float *gradient = dy + n * outputPlane;
+		float *output = dx + n * inputPlane;
+
+		for (ph = 0; ph < conf->pooledHeight; ++ph) {
+			for (pw = 0; pw < conf->pooledWidth; ++pw) {
+
+				hstart = ph * conf->strideHeight - conf->paddingHeight;
+				wstart = pw * conf->strideWidth  - conf->paddingWidth;
+
+				hend = __min (hstart + conf->kernelHeight, conf->height + conf->paddingHeight);
+				wend = __min (wstart + conf->kernelWidth,  conf->width  + conf->paddingWidth);
+
+				size = (hend - hstart) * (wend - wstart);
+
+				hstart = __max (hstart, 0);
+				wstart = __max (wstart, 0);
+
+				hend = __min (hend, conf->height);
+				wend = __min (wend, conf->width);
+
+				value = gradient[ph * conf->pooledWidth + pw] / size;
+
+				for (h = hstart; h < hend; ++h)
+					for (w = wstart; w < wend; ++w)
+						output[h * conf->width + w] += value;
+			}
+		}
+	}
+	return;
+}
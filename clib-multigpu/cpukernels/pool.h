@@ -0,0 +1,30 @@
+#ifndef __CROSSBOW_CPU_KERNEL_POOL_H_
+#define __CROSSBOW_CPU_KERNEL_POOL_H_
+
+/*
+ * Pooling over `planes` (examples x channels) independent 2-D planes.
+ *
+ * Max pooling records, for every output element, the position of the
+ * selected input element as a byte offset into the input buffer (i.e.
+ * `offset` + 4 x element index), which is what the Java implementation
+ * stores in its local `indices` variable. Empty windows keep -1.
+ */
+typedef struct crossbow_cpu_pool_conf {
+	int planes;
+	int height, width;
+	int pooledHeight, pooledWidth;
+	int kernelHeight, kernelWidth;
+	int strideHeight, strideWidth;
+	int paddingHeight, paddingWidth;
+} crossbow_cpu_pool_conf_t;
+
+void crossbowCPUKernelMaxPool (const float *x, int offset, float *y, int *indices, crossbow_cpu_pool_conf_t *conf);
+
+void crossbowCPUKernelAveragePool (const float *x, float *y, crossbow_cpu_pool_conf_t *conf);
+
+/* Routes `dy` back to the input positions stored in `indices`; `offset` is the start of the peer input */
+void crossbowCPUKernelMaxPoolGradient (const float *dy, const int *indices, int count, int offset, float *dx, int elements);
+
+void crossbowCPUKernelAveragePoolGradient (const float *dy, float *dx, crossbow_cpu_pool_conf_t *conf);
+
+#endif /* __CROSSBOW_CPU_KERNEL_POOL_H_ */
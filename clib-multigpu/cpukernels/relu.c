@@ -0,0 +1,40 @@
+#include "relu.h"
+
+#include "simd.h"
+
+void crossbowCPUKernelReLU (const float *x, float *y, int count, float slope) {
+
+	int i = 0;
+
+	crossbowVector_t zero = crossbowVectorZero ();
+	crossbowVector_t s = crossbowVectorSet (slope);
+
+	for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+		crossbowVector_t v = crossbowVectorLoad (x + i);
+		crossbowVector_t p = crossbowVectorMax (v, zero);
+		crossbowVector_t n = crossbowVectorMin (v, zero);
+		crossbowVectorStore (y + i, crossbowVectorFma (s, n, p));
+	}
+	/* Remainder */
+	for (; i < count; ++i)
+		y[i] = ((x[i] > 0) ? x[i] : 0) + slope * ((x[i] < 0) ? x[i] : 0);
+
+	return;
+}
+
+void crossbowCPUKernelReLUGradient (const float *dy, const float *x, float *dx, int count, float slope) {
+
+	int i = 0;
+
+	crossbowVector_t s = crossbowVectorSet (slope);
+
+	for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+		crossbowVector_t g = crossbowVectorLoad (dy + i);
+		crossbowVector_t v = crossbowVectorLoad ( x + i);
+		crossbowVectorStore (dx + i, crossbowVectorSelectPositive (v, g, crossbowVectorMul (s, g)));
+	}
+	for (; i < count; ++i)
+		dx[i] = (x[i] > 0) ? dy[i] : slope * dy[i];
+
+	return;
+}
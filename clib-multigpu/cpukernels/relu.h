@@ -0,0 +1,10 @@
+#ifndef __CROSSBOW_CPU_KERNEL_RELU_H_
+#define __CROSSBOW_CPU_KERNEL_RELU_H_
+
+/* y = max(x, 0) + slope * min(x, 0) */
+void crossbowCPUKernelReLU (const float *x, float *y, int count, float slope);
+
+/* dx = (x > 0) ? dy : slope * dy */
+void crossbowCPUKernelReLUGradient (const float *dy, const float *x, float *dx, int count, float slope);
+
+#endif /* __CROSSBOW_CPU_KERNEL_RELU_H_ */
@@ -0,0 +1,68 @@
+#include "sgd.h"
+
+#include <stddef.h>
+
+#include "simd.h"
+
+void crossbowCPUKernelSGDUpdate (float *w, float *g, const float *last, crossbow_cpu_sgd_conf_t *conf) {
+
+	int i = 0;
+	int count = conf->count;
+
+	/* rate x (scale x g + decay x w) = a x g + b x w */
+	float a = conf->rate * conf->scale;
+	float b = conf->rate * conf->decay;
+	float m = conf->momentum;
+	float u;
+
+	crossbowVector_t A = crossbowVectorSet (a);
+	crossbowVector_t B = crossbowVectorSet (b);
+	crossbowVector_t M = crossbowVectorSet (m);
+
+	if (last == NULL || m == 0) {
+		for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+			crossbowVector_t W = crossbowVectorLoad (w + i);
+			crossbowVector_t U = crossbowVectorFma (A, crossbowVectorLoad (g + i), crossbowVectorMul (B, W));
+			crossbowVectorStore (g + i, U);
+			crossbowVectorStore (w + i, crossbowVectorSub (W, U));
+		}
+		for (; i < count; ++i) {
+			u = a * g[i] + b * w[i];
+			g[i] = u;
+			w[i] -= u;
+		}
+	}
+	else {
+		for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+			crossbowVector_t W = crossbowVectorLoad (w + i);
+			crossbowVector_t U = crossbowVectorFma (A, crossbowVectorLoad (g + i), crossbowVectorMul (B, W));
+			U = crossbowVectorFma (M, crossbowVectorLoad (last + i), U);
+			crossbowVectorStore (g + i, U);
+			crossbowVectorStore (w + i, crossbowVectorSub (W, U));
+		}
+		for (; i < count; ++i) {
+			u = a * g[i] + b * w[i] + m * last[i];
+			g[i] = u;
+			w[i] -= u;
+		}
+	}
+	return;
+}
+
+float crossbowCPUKernelSumOfSquares (const float *x, int count) {
+
+	int i = 0;
+	float result;
+
+	crossbowVector_t sum = crossbowVectorZero ();
+
+	for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+		crossbowVector_t v = crossbowVectorLoad (x + i);
+		sum = crossbowVectorFma (v, v, sum);
+	}
+	result = crossbowVectorSum (sum);
+	for (; i < count; ++i)
+		result += x[i] * x[i];
+
+	return result;
+}
@@ -0,0 +1,30 @@
+#ifndef __CROSSBOW_CPU_KERNEL_SGD_H_
+#define __CROSSBOW_CPU_KERNEL_SGD_H_
+
+/*
+ * Fused gradient descent update of one model variable, in a single pass:
+ *
+ * g = rate x (scale x g + decay x w) + momentum x last
+ * w = w - g
+ *
+ * where `scale` is the gradient clipping factor (1, if the gradient is not
+ * clipped), `rate` includes the variable's learning rate multiplier, and
+ * `last` (which may be NULL) is the last gradient applied to the model.
+ *
+ * The updated gradient is stored back, so that it can be accumulated (or
+ * serve as the next `last`), as with the unfused update.
+ */
+typedef struct crossbow_cpu_sgd_conf {
+	int count;
+	float scale;
+	float decay;
+	float rate;
+	float momentum;
+} crossbow_cpu_sgd_conf_t;
+
+void crossbowCPUKernelSGDUpdate (float *w, float *g, const float *last, crossbow_cpu_sgd_conf_t *conf);
+
+/* Returns the sum of x[i]^2, for gradient clipping */
+float crossbowCPUKernelSumOfSquares (const float *x, int count);
+
+#endif /* __CROSSBOW_CPU_KERNEL_SGD_H_ */
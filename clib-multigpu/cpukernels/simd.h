@@ -0,0 +1,223 @@
+#ifndef __CROSSBOW_CPU_KERNEL_SIMD_H_
+#define __CROSSBOW_CPU_KERNEL_SIMD_H_
+
+/*
+ * A thin vector abstraction over AVX-512, AVX2 (with FMA) and SSE.
+ *
+ * The instruction set is selected at compile time (the library is built
+ * with `-march=native`). All loads and stores are unaligned, since Java
+ * buffers offer no alignment guarantees beyond 4 bytes.
+ */
+
+#include <immintrin.h>
+#include <string.h>
+
+/* Converts an IEEE 754 half-precision value to single precision */
+static inline float crossbowHalfToFloat (unsigned short h) {
+	unsigned int sign = ((unsigned int) (h & 0x8000)) << 16;
+	unsigned int exponent = (h >> 10) & 0x1F;
+	unsigned int mantissa = h & 0x3FF;
+	unsigned int bits;
+	float f;
+	if (exponent == 0x1F) {
+		/* Infinity or NaN */
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else if (exponent == 0) {
+		/* Zero or subnormal: mantissa x 2^-24 */
+		f = (float) mantissa * 5.9604644775390625e-8F;
+		memcpy (&bits, &f, 4);
+		bits |= sign;
+	}
+	else {
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	memcpy (&f, &bits, 4);
+	return f;
+}
+
+#if defined(__AVX512F__)
+
+#define CROSSBOW_SIMD_WIDTH 16
+
+typedef __m512 crossbowVector_t;
+
+#define crossbowVectorLoad(p)         _mm512_loadu_ps (p)
+#define crossbowVectorStore(p, x)     _mm512_storeu_ps (p, x)
+#define crossbowVectorSet(v)          _mm512_set1_ps (v)
+#define crossbowVectorZero()          _mm512_setzero_ps ()
+#define crossbowVectorAdd(x, y)       _mm512_add_ps (x, y)
+#define crossbowVectorSub(x, y)       _mm512_sub_ps (x, y)
+#define crossbowVectorMul(x, y)       _mm512_mul_ps (x, y)
+#define crossbowVectorDiv(x, y)       _mm512_div_ps (x, y)
+#define crossbowVectorSqrt(x)         _mm512_sqrt_ps (x)
+#define crossbowVectorMax(x, y)       _mm512_max_ps (x, y)
+#define crossbowVectorMin(x, y)       _mm512_min_ps (x, y)
+#define crossbowVectorFma(x, y, z)    _mm512_fmadd_ps (x, y, z)
+
+/* Returns (x > 0) ? a : b, element-wise */
+static inline crossbowVector_t crossbowVectorSelectPositive (crossbowVector_t x, crossbowVector_t a, crossbowVector_t b) {
+	__mmask16 mask = _mm512_cmp_ps_mask (x, _mm512_setzero_ps (), _CMP_GT_OQ);
+	return _mm512_mask_blend_ps (mask, b, a);
+}
+
+static inline float crossbowVectorSum (crossbowVector_t x) {
+	return _mm512_reduce_add_ps (x);
+}
+
+static inline float crossbowVectorHorizontalMax (crossbowVector_t x) {
+	return _mm512_reduce_max_ps (x);
+}
+
+/* Load CROSSBOW_SIMD_WIDTH compact values and widen them to floats */
+static inline crossbowVector_t crossbowVectorLoadUInt8 (const unsigned char *p) {
+	return _mm512_cvtepi32_ps (_mm512_cvtepu8_epi32 (_mm_loadu_si128 ((const __m128i *) p)));
+}
+
+static inline crossbowVector_t crossbowVectorLoadInt8 (const signed char *p) {
+	return _mm512_cvtepi32_ps (_mm512_cvtepi8_epi32 (_mm_loadu_si128 ((const __m128i *) p)));
+}
+
+static inline crossbowVector_t crossbowVectorLoadHalf (const unsigned short *p) {
+	return _mm512_cvtph_ps (_mm256_loadu_si256 ((const __m256i *) p));
+}
+
+/* Returns x where bit i of `bits` is set, and 0 elsewhere (for lanes i = 0, ..., 15) */
+static inline crossbowVector_t crossbowVectorMaskBits (unsigned bits, crossbowVector_t x) {
+	return _mm512_maskz_mov_ps ((__mmask16) bits, x);
+}
+
+#elif defined(__AVX2__) && defined(__FMA__)
+
+#define CROSSBOW_SIMD_WIDTH 8
+
+typedef __m256 crossbowVector_t;
+
+#define crossbowVectorLoad(p)         _mm256_loadu_ps (p)
+#define crossbowVectorStore(p, x)     _mm256_storeu_ps (p, x)
+#define crossbowVectorSet(v)          _mm256_set1_ps (v)
+#define crossbowVectorZero()          _mm256_setzero_ps ()
+#define crossbowVectorAdd(x, y)       _mm256_add_ps (x, y)
+#define crossbowVectorSub(x, y)       _mm256_sub_ps (x, y)
+#define crossbowVectorMul(x, y)       _mm256_mul_ps (x, y)
+#define crossbowVectorDiv(x, y)       _mm256_div_ps (x, y)
+#define crossbowVectorSqrt(x)         _mm256_sqrt_ps (x)
+#define crossbowVectorMax(x, y)       _mm256_max_ps (x, y)
+#define crossbowVectorMin(x, y)       _mm256_min_ps (x, y)
+#define crossbowVectorFma(x, y, z)    _mm256_fmadd_ps (x, y, z)
+
+static inline crossbowVector_t crossbowVectorSelectPositive (crossbowVector_t x, crossbowVector_t a, crossbowVector_t b) {
+	__m256 mask = _mm256_cmp_ps (x, _mm256_setzero_ps (), _CMP_GT_OQ);
+	return _mm256_blendv_ps (b, a, mask);
+}
+
+static inline float crossbowVectorSum (crossbowVector_t x) {
+	__m128 lo = _mm256_castps256_ps128 (x);
+	__m128 hi = _mm256_extractf128_ps (x, 1);
+	lo = _mm_add_ps (lo, hi);
+	lo = _mm_add_ps (lo, _mm_movehl_ps (lo, lo));
+	lo = _mm_add_ss (lo, _mm_shuffle_ps (lo, lo, 0x55));
+	return _mm_cvtss_f32 (lo);
+}
+
+static inline float crossbowVectorHorizontalMax (crossbowVector_t x) {
+	__m128 lo = _mm256_castps256_ps128 (x);
+	__m128 hi = _mm256_extractf128_ps (x, 1);
+	lo = _mm_max_ps (lo, hi);
+	lo = _mm_max_ps (lo, _mm_movehl_ps (lo, lo));
+	lo = _mm_max_ss (lo, _mm_shuffle_ps (lo, lo, 0x55));
+	return _mm_cvtss_f32 (lo);
+}
+
+static inline crossbowVector_t crossbowVectorLoadUInt8 (const unsigned char *p) {
+	return _mm256_cvtepi32_ps (_mm256_cvtepu8_epi32 (_mm_loadl_epi64 ((const __m128i *) p)));
+}
+
+static inline crossbowVector_t crossbowVectorLoadInt8 (const signed char *p) {
+	return _mm256_cvtepi32_ps (_mm256_cvtepi8_epi32 (_mm_loadl_epi64 ((const __m128i *) p)));
+}
+
+static inline crossbowVector_t crossbowVectorLoadHalf (const unsigned short *p) {
+#if defined(__F16C__)
+	return _mm256_cvtph_ps (_mm_loadu_si128 ((const __m128i *) p));
+#else
+	return _mm256_setr_ps (
+		crossbowHalfToFloat (p[0]), crossbowHalfToFloat (p[1]), crossbowHalfToFloat (p[2]), crossbowHalfToFloat (p[3]),
+		crossbowHalfToFloat (p[4]), crossbowHalfToFloat (p[5]), crossbowHalfToFloat (p[6]), crossbowHalfToFloat (p[7]));
+#endif
+}
+
+static inline crossbowVector_t crossbowVectorMaskBits (unsigned bits, crossbowVector_t x) {
+	__m256i lanes = _mm256_setr_epi32 (1, 2, 4, 8, 16, 32, 64, 128);
+	__m256i mask = _mm256_cmpeq_epi32 (_mm256_and_si256 (_mm256_set1_epi32 ((int) bits), lanes), lanes);
+	return _mm256_and_ps (_mm256_castsi256_ps (mask), x);
+}
+
+#else /* SSE2 is always available on x86-64 */
+
+#define CROSSBOW_SIMD_WIDTH 4
+
+typedef __m128 crossbowVector_t;
+
+#define crossbowVectorLoad(p)         _mm_loadu_ps (p)
+#define crossbowVectorStore(p, x)     _mm_storeu_ps (p, x)
+#define crossbowVectorSet(v)          _mm_set1_ps (v)
+#define crossbowVectorZero()          _mm_setzero_ps ()
+#define crossbowVectorAdd(x, y)       _mm_add_ps (x, y)
+#define crossbowVectorSub(x, y)       _mm_sub_ps (x, y)
+#define crossbowVectorMul(x, y)       _mm_mul_ps (x, y)
+#define crossbowVectorDiv(x, y)       _mm_div_ps (x, y)
+#define crossbowVectorSqrt(x)         _mm_sqrt_ps (x)
+#define crossbowVectorMax(x, y)       _mm_max_ps (x, y)
+#define crossbowVectorMin(x, y)       _mm_min_ps (x, y)
+#define crossbowVectorFma(x, y, z)    _mm_add_ps (_mm_mul_ps (x, y), z)
+
+static inline crossbowVector_t crossbowVectorSelectPositive (crossbowVector_t x, crossbowVector_t a, crossbowVector_t b) {
+	__m128 mask = _mm_cmpgt_ps (x, _mm_setzero_ps ());
+	return _mm_or_ps (_mm_and_ps (mask, a), _mm_andnot_ps (mask, b));
+}
+
+static inline float crossbowVectorSum (crossbowVector_t x) {
+	x = _mm_add_ps (x, _mm_movehl_ps (x, x));
+	x = _mm_add_ss (x, _mm_shuffle_ps (x, x, 0x55));
+	return _mm_cvtss_f32 (x);
+}
+
+static inline float crossbowVectorHorizontalMax (crossbowVector_t x) {
+	x = _mm_max_ps (x, _mm_movehl_ps (x, x));
+	x = _mm_max_ss (x, _mm_shuffle_ps (x, x, 0x55));
+	return _mm_cvtss_f32 (x);
+}
+
+/* Zero-extends 4 bytes to 32-bit integers (SSE2 lacks `pmovzxbd`) */
+static inline __m128i crossbowVectorLoadBytes (const void *p) {
+	int v;
+	__m128i x, zero = _mm_setzero_si128 ();
+	memcpy (&v, p, 4);
+	x = _mm_cvtsi32_si128 (v);
+	x = _mm_unpacklo_epi8  (x, zero);
+	return _mm_unpacklo_epi16 (x, zero);
+}
+
+static inline crossbowVector_t crossbowVectorLoadUInt8 (const unsigned char *p) {
+	return _mm_cvtepi32_ps (crossbowVectorLoadBytes (p));
+}
+
+static inline crossbowVector_t crossbowVectorLoadInt8 (const signed char *p) {
+	/* Sign-extend the low byte of every 32-bit integer */
+	return _mm_cvtepi32_ps (_mm_srai_epi32 (_mm_slli_epi32 (crossbowVectorLoadBytes (p), 24), 24));
+}
+
+static inline crossbowVector_t crossbowVectorLoadHalf (const unsigned short *p) {
+	return _mm_setr_ps (crossbowHalfToFloat (p[0]), crossbowHalfToFloat (p[1]), crossbowHalfToFloat (p[2]), crossbowHalfToFloat (p[3]));
+}
+
+static inline crossbowVector_t crossbowVectorMaskBits (unsigned bits, crossbowVector_t x) {
+	__m128i lanes = _mm_setr_epi32 (1, 2, 4, 8);
+	__m128i mask = _mm_cmpeq_epi32 (_mm_and_si128 (_mm_set1_epi32 ((int) bits), lanes), lanes);
+	return _mm_and_ps (_mm_castsi128_ps (mask), x);
+}
+
+#endif
+
+#endif /* __CROSSBOW_CPU_KERNEL_SIMD_H_ */
@@ -0,0 +1,48 @@
+#include "softmax.h"
+
+#include <math.h>
+#include <float.h>
+
+#include "simd.h"
+
+void crossbowCPUKernelSoftMax (const float *x, float *y, int examples, int classes) {
+
+	int n, j;
+	float max, sum, scale;
+
+	for (n = 0; n < examples; ++n) {
+
+		const float *input = x + n * classes;
+		float *output = y + n * classes;
+
+		/* Find maximum */
+		j = 0;
+		max = -FLT_MAX;
+		if (classes >= CROSSBOW_SIMD_WIDTH) {
+			crossbowVector_t m = crossbowVectorSet (-FLT_MAX);
+			for (; j <= classes - CROSSBOW_SIMD_WIDTH; j += CROSSBOW_SIMD_WIDTH)
+				m = crossbowVectorMax (m, crossbowVectorLoad (input + j));
+			max = crossbowVectorHorizontalMax (m);
+		}
+		for (; j < classes; ++j)
+			if (input[j] > max)
+				max = input[j];
+
+		/* Subtract maximum and exponentiate */
+		sum = 0;
+		for (j = 0; j < classes; ++j) {
+			output[j] = expf (input[j] - max);
+			sum += output[j];
+		}
+
+		/* Normalise */
+		scale = 1.0F / sum;
+		j = 0;
+		crossbowVector_t s = crossbowVectorSet (scale);
+		for (; j <= classes - CROSSBOW_SIMD_WIDTH; j += CROSSBOW_SIMD_WIDTH)
+			crossbowVectorStore (output + j, crossbowVectorMul (crossbowVectorLoad (output + j), s));
+		for (; j < classes; ++j)
+			output[j] *= scale;
+	}
+	return;
+}
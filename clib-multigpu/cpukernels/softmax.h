@@ -0,0 +1,7 @@
+#ifndef __CROSSBOW_CPU_KERNEL_SOFTMAX_H_
+#define __CROSSBOW_CPU_KERNEL_SOFTMAX_H_
+
+/* Row-wise softmax over an (examples x classes) matrix */
+void crossbowCPUKernelSoftMax (const float *x, float *y, int examples, int classes);
+
+#endif /* __CROSSBOW_CPU_KERNEL_SOFTMAX_H_ */
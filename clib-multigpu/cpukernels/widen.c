@@ -0,0 +1,57 @@
+#include "widen.h"
+
+#include "simd.h"
+
+int crossbowCPUDataTypeSize (crossbowCPUDataType_t type) {
+	switch (type) {
+	case CROSSBOW_UINT8:
+	case CROSSBOW_INT8: return 1;
+	case CROSSBOW_FP16: return 2;
+	default:
+		return 4;
+	}
+}
+
+void crossbowCPUKernelWiden (const void *x, crossbowCPUDataType_t type, float *y, int count, float scale, float shift) {
+
+	int i = 0;
+
+	crossbowVector_t A = crossbowVectorSet (scale);
+	crossbowVector_t B = crossbowVectorSet (shift);
+
+	switch (type) {
+	case CROSSBOW_UINT8: {
+		const unsigned char *p = (const unsigned char *) x;
+		for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH)
+			crossbowVectorStore (y + i, crossbowVectorFma (A, crossbowVectorLoadUInt8 (p + i), B));
+		for (; i < count; ++i)
+			y[i] = scale * (float) p[i] + shift;
+		break;
+	}
+	case CROSSBOW_INT8: {
+		const signed char *p = (const signed char *) x;
+		for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH)
+			crossbowVectorStore (y + i, crossbowVectorFma (A, crossbowVectorLoadInt8 (p + i), B));
+		for (; i < count; ++i)
+			y[i] = scale * (float) p[i] + shift;
+		break;
+	}
+	case CROSSBOW_FP16: {
+		const unsigned short *p = (const unsigned short *) x;
+		for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH)
+			crossbowVectorStore (y + i, crossbowVectorFma (A, crossbowVectorLoadHalf (p + i), B));
+		for (; i < count; ++i)
+			y[i] = scale * crossbowHalfToFloat (p[i]) + shift;
+		break;
+	}
+	default: {
+		const float *p = (const float *) x;
+		for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH)
+			crossbowVectorStore (y + i, crossbowVectorFma (A, crossbowVectorLoad (p + i), B));
+		for (; i < count; ++i)
+			y[i] = scale * p[i] + shift;
+		break;
+	}
+	}
+	return;
+}
@@ -0,0 +1,21 @@
+#ifndef __CROSSBOW_CPU_KERNEL_WIDEN_H_
+#define __CROSSBOW_CPU_KERNEL_WIDEN_H_
+
+/*
+ * Element types of dataset examples (their values match the ids of Java's
+ * `DataType`). Compact types are widened to floats before use.
+ */
+typedef enum crossbow_cpu_data_type {
+	CROSSBOW_FLOAT = 1,
+	CROSSBOW_UINT8,
+	CROSSBOW_INT8,
+	CROSSBOW_FP16
+} crossbowCPUDataType_t;
+
+/* Returns the size of an element of the given type, in bytes */
+int crossbowCPUDataTypeSize (crossbowCPUDataType_t type);
+
+/* y[i] = scale x x[i] + shift, where `x` holds `count` elements of the given type */
+void crossbowCPUKernelWiden (const void *x, crossbowCPUDataType_t type, float *y, int count, float scale, float shift);
+
+#endif /* __CROSSBOW_CPU_KERNEL_WIDEN_H_ */
@@ -87,7 +87,7 @@ void crossbowDatasetFileRegister (crossbowDatasetFileP p, int blocksize) {
 	for (i = 0; i < blocks; ++i) {
 		if (mlock (ptr, blocksize) < 0)
 			err ("Call to mlock() failed: %s\n", strerror(errno));
-		checkCudaErrors(cudaHostRegister(ptr, blocksize, cudaHostRegisterMapped | cudaHostRegisterPortable));
+		crossbowHostRegister (ptr, blocksize);
 		ptr = (void *) ((char *) (ptr) + (blocksize));
 	}
 	p->locked = blocks;
@@ -99,7 +99,7 @@ void crossbowDatasetFileRegisterRegion (crossbowDatasetFileP p, int offset, int
 	if (mlock (ptr, length) < 0)
 		err ("Call to mlock() failed: %s\n", strerror(errno));
     /* dbg("Register %s: %p offset %d length %d\n", p->filename, ptr, offset, length); */
-	checkCudaErrors(cudaHostRegister(ptr, length, cudaHostRegisterMapped | cudaHostRegisterPortable));
+	crossbowHostRegister (ptr, length);
 	/* Atomically increment counter */
 	__sync_add_and_fetch (&(p->locked), 1);
 	return;
@@ -179,7 +179,7 @@ void crossbowDatasetFileUnregister (crossbowDatasetFileP p, int blocksize) {
 	dbg("Unregister %s: %p %d blocks\n", p->filename, ptr, blocks);
 	for (i = 0; i < blocks; ++i) {
         dbg("Unregister block #%03d\n", i);
-		checkCudaErrors(cudaHostUnregister(ptr));
+		crossbowHostUnregister (ptr);
 		if (munlock (ptr, blocksize) < 0)
 			err("Call to munlock() failed: %s\n", strerror(errno));
 		ptr = (void *) ((char *) (ptr) + (blocksize));
@@ -193,7 +193,7 @@ void crossbowDatasetFileUnregisterRegion (crossbowDatasetFileP p, int offset, in
 	void *ptr = (void *) ((char *) (p->data) + offset);
 	if (munlock (ptr, length) < 0)
 		err ("Call to munlock() failed: %s\n", strerror(errno));
-	checkCudaErrors(cudaHostUnregister(ptr));
+	crossbowHostUnregister (ptr);
 	/* Atomically increment counter */
 	__sync_sub_and_fetch (&(p->locked), 1);
 	return;
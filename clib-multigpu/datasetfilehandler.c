@@ -29,20 +29,14 @@ static void *handle (void *args) {
 		info("Dataset handler #%lu pinned on core %d\n", self->id, core);
 	}
 
-	pthread_mutex_lock(&(self->lock));
-
 	dbg("Dataset file handler #%lu starts\n", self->id);
 
 	while (! self->exit) {
-		/* Block, waiting for an event */
-		while (!self->exit && crossbowListSize(self->events) == 0) {
-			pthread_cond_wait(&(self->cond), &(self->lock));
-		}
-		if (self->exit) {
+		/* Spin, then sleep, waiting for an event */
+		block = (crossbowDatasetFileBlockP) crossbowLockFreeQueueDequeueOrWait (self->events);
+		if (! block) {
 			break;
 		}
-		/* Get event */
-		block = (crossbowDatasetFileBlockP) crossbowListRemoveFirst (self->events);
 
 		if (block->op == 1) { /* Register block */
 
@@ -108,9 +102,7 @@ crossbowDatasetFileHandlerP crossbowDatasetFileHandlerCreate (int offset) {
 	p->exit = 0;
 	p->exited = 0;
 	p->id = autoincrement++;
-	pthread_mutex_init (&(p->lock), NULL);
-	pthread_cond_init  (&(p->cond), NULL);
-	p->events = crossbowListCreate ();
+	p->events = crossbowLockFreeQueueCreate (MPMC, FREE_LIST_STASH);
 	p->offset = offset;
 
 	/* Manage free list */
@@ -171,21 +163,17 @@ void crossbowDatasetFileHandlerPutBlockSafely (crossbowDatasetFileHandlerP handl
 }
 
 void crossbowDatasetFileHandlerPublish (crossbowDatasetFileHandlerP p, crossbowDatasetFileBlockP args) {
-	pthread_mutex_lock (&(p->lock));
 	if (! p->exit) {
-		crossbowListAppend (p->events, args);
-		pthread_cond_signal (&(p->cond));
+		crossbowLockFreeQueueEnqueueOrWait (p->events, args);
 	}
-	pthread_mutex_unlock(&(p->lock));
 }
 
 void crossbowDatasetFileHandlerFree (crossbowDatasetFileHandlerP p) {
-	pthread_mutex_lock(&(p->lock));
 	if (! p->exited) {
 		p->exit = 1;
-		pthread_cond_signal (&(p->cond));
+		/* Unblock thread (if the queue is full, it will see `exit` after its next event) */
+		crossbowLockFreeQueueTryEnqueue (p->events, NULL);
 	}
-	pthread_mutex_unlock(&(p->lock));
 	/* Wait until thread has exited */
 	pthread_join(p->thread, NULL);
 	/* Free pool of nodes */
@@ -211,7 +199,7 @@ void crossbowDatasetFileHandlerFree (crossbowDatasetFileHandlerP p) {
 	}
 	dbg("%2d/%2d nodes in pool\n", available, allocated);
 	invalidConditionException(available == allocated);
-	/* List should be empty */
-	crossbowListFree (p->events);
+	/* Queue should be empty */
+	crossbowLockFreeQueueFree (p->events);
 	crossbowFree (p, sizeof(crossbow_datasetfilehandler_t));
 }
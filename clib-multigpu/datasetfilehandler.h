@@ -2,6 +2,7 @@
 #define __CROSSBOW_DATASETFILEHANDLER_H_
 
 #include "list.h"
+#include "lockfreequeue.h"
 
 #include "datasetfileblock.h"
 
@@ -18,14 +19,11 @@ typedef struct crossbow_datasetfilehandler {
 
 	unsigned long id;
 
-	pthread_mutex_t lock;
-	pthread_cond_t cond;
-
 	pthread_mutex_t sync; /* Mutex to protect freeList */
 	crossbowDatasetFileBlockP freeList;
 	crossbowDatasetFileBlockPoolP pool;
 
-	crossbowListP events;
+	crossbowLockFreeQueueP events;
 
 	int offset;
 
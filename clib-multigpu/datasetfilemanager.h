@@ -2,7 +2,6 @@
 #define __CROSSBOW_DATASETFILEMANAGER_H_
 
 #include "memoryregistry.h"
-#include "waitfreequeue.h"
 
 #include "memoryregionpool.h"
 
@@ -1,12 +1,17 @@
 #ifndef __CROSSBOW_DEBUG_H_
 #define __CROSSBOW_DEBUG_H_
 
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef CROSSBOW_CPU_ONLY
 #include <cuda_runtime.h>
 #include "cublas_v2.h"
 
 #include <cudnn.h>
 
 #include <nccl.h>
+#endif
 
 #undef GPU_VERBOSE
 // #define GPU_VERBOSE
@@ -76,6 +81,8 @@
 
 /* CUDA error handling */
 
+#ifndef CROSSBOW_CPU_ONLY
+
 static const char *mycudaGetErrorEnum(cublasStatus_t error) {
     switch (error)
     {
@@ -122,4 +129,6 @@ static const char *mycudaGetErrorEnum(cublasStatus_t error) {
 
 #define checkNcclErrors(x) do { if (x != ncclSuccess) { fprintf(stderr, "nccl error: %s (in %s, %s:%d)\n", ncclGetErrorString(x), __func__, __FILE__, __LINE__); exit (1); } } while (0)
 
+#endif /* CROSSBOW_CPU_ONLY */
+
 #endif /* __GPU_DEBUG_H_ */
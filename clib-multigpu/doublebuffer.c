@@ -7,9 +7,6 @@
 
 #include <errno.h>
 
-#include <cuda.h>
-#include <cuda_runtime.h>
-
 #include <sys/mman.h> /* mlock, etc. */
 #include <unistd.h>
 
@@ -102,7 +99,7 @@ void crossbowDoubleBufferRegister (crossbowDoubleBufferP p) {
     	if (mlock (p->theImages[i], p->capacity[0]) < 0)
     		err ("Call to mlock() failed: %s\n", strerror(errno));
 
-    	checkCudaErrors(cudaHostRegister(p->theImages[i], p->capacity[0], cudaHostRegisterMapped | cudaHostRegisterPortable));
+    	crossbowHostRegister (p->theImages[i], p->capacity[0]);
 
     	/* Register buffers for labels */
 
@@ -111,7 +108,7 @@ void crossbowDoubleBufferRegister (crossbowDoubleBufferP p) {
     	if (mlock (p->theLabels[i], p->capacity[1]) < 0)
     	    err ("Call to mlock() failed: %s\n", strerror(errno));
 
-    	checkCudaErrors(cudaHostRegister(p->theLabels[i], p->capacity[1], cudaHostRegisterMapped | cudaHostRegisterPortable));
+    	crossbowHostRegister (p->theLabels[i], p->capacity[1]);
     }
 
     p->locked = 1;
@@ -143,10 +140,10 @@ void crossbowDoubleBufferUnregister (crossbowDoubleBufferP p) {
     nullPointerException (p);
     invalidConditionException (p->locked);
 
-    checkCudaErrors(cudaHostUnregister(p->theImages[0]));
-    checkCudaErrors(cudaHostUnregister(p->theImages[1]));
-    checkCudaErrors(cudaHostUnregister(p->theLabels[0]));
-    checkCudaErrors(cudaHostUnregister(p->theLabels[1]));
+    crossbowHostUnregister (p->theImages[0]);
+    crossbowHostUnregister (p->theImages[1]);
+    crossbowHostUnregister (p->theLabels[0]);
+    crossbowHostUnregister (p->theLabels[1]);
 
     p->locked = 0;
     return;
@@ -0,0 +1,312 @@
+#include "decoderpool.h"
+
+#include "../memorymanager.h"
+
+#include "../debug.h"
+#include "../utils.h"
+
+#include <sched.h>
+
+typedef struct crossbow_decoder_worker {
+	crossbowDecoderPoolP pool;
+	int id;
+} crossbow_decoder_worker_t;
+
+static void crossbowDecoderDequeInit (crossbowDecoderDequeP q, int capacity) {
+	pthread_mutex_init (&(q->lock), NULL);
+	q->items = (crossbow_decoder_work_t *) crossbowMalloc (capacity * sizeof(crossbow_decoder_work_t));
+	q->capacity = capacity;
+	q->head = 0;
+	q->size = 0;
+	return;
+}
+
+/* Must be called with the deque locked */
+static void crossbowDecoderDequeGrow (crossbowDecoderDequeP q) {
+	int ndx;
+	int capacity = 2 * q->capacity;
+	crossbow_decoder_work_t *items = (crossbow_decoder_work_t *) crossbowMalloc (capacity * sizeof(crossbow_decoder_work_t));
+	for (ndx = 0; ndx < q->size; ++ndx)
+		items[ndx] = q->items[(q->head + ndx) % q->capacity];
+	crossbowFree (q->items, q->capacity * sizeof(crossbow_decoder_work_t));
+	q->items = items;
+	q->capacity = capacity;
+	q->head = 0;
+	return;
+}
+
+static void crossbowDecoderDequePush (crossbowDecoderDequeP q, crossbowDecoderJobP job, int ndx) {
+	pthread_mutex_lock (&(q->lock));
+	if (q->size == q->capacity)
+		crossbowDecoderDequeGrow (q);
+	q->items[(q->head + q->size) % q->capacity].job = job;
+	q->items[(q->head + q->size) % q->capacity].ndx = ndx;
+	q->size ++;
+	pthread_mutex_unlock (&(q->lock));
+	return;
+}
+
+/* Owner end */
+static int crossbowDecoderDequePop (crossbowDecoderDequeP q, crossbow_decoder_work_t *work) {
+	int found = 0;
+	pthread_mutex_lock (&(q->lock));
+	if (q->size > 0) {
+		q->size --;
+		*work = q->items[(q->head + q->size) % q->capacity];
+		found = 1;
+	}
+	pthread_mutex_unlock (&(q->lock));
+	return found;
+}
+
+/* Thief end */
+static int crossbowDecoderDequeSteal (crossbowDecoderDequeP q, crossbow_decoder_work_t *work) {
+	int found = 0;
+	/* Avoid taking the lock of an empty deque */
+	if (q->size == 0)
+		return 0;
+	pthread_mutex_lock (&(q->lock));
+	if (q->size > 0) {
+		*work = q->items[q->head];
+		q->head = (q->head + 1) % q->capacity;
+		q->size --;
+		found = 1;
+	}
+	pthread_mutex_unlock (&(q->lock));
+	return found;
+}
+
+static void crossbowDecoderDequeDestroy (crossbowDecoderDequeP q) {
+	pthread_mutex_destroy (&(q->lock));
+	crossbowFree (q->items, q->capacity * sizeof(crossbow_decoder_work_t));
+	return;
+}
+
+static int crossbowDecoderPoolGetWork (crossbowDecoderPoolP p, int id, crossbow_decoder_work_t *work) {
+	int ndx;
+	if (crossbowDecoderDequePop (&(p->deques[id]), work))
+		return 1;
+	/* Steal, starting from the next worker */
+	for (ndx = 1; ndx < p->workers; ++ndx) {
+		if (crossbowDecoderDequeSteal (&(p->deques[(id + ndx) % p->workers]), work))
+			return 1;
+	}
+	return 0;
+}
+
+/*
+ * A decoder thread
+ */
+static void *handle (void *args) {
+
+	crossbow_decoder_worker_t *worker = (crossbow_decoder_worker_t *) args;
+	crossbowDecoderPoolP p = worker->pool;
+	int id = worker->id;
+
+	crossbow_decoder_work_t work;
+	crossbowDecoderJobP job;
+
+	/* Pin thread to a particular core based on worker id */
+	cpu_set_t set;
+	int core = p->core + id;
+	CPU_ZERO (&set);
+	CPU_SET  (core, &set);
+	sched_setaffinity (0, sizeof(set), &set);
+	dbg("Decoder #%02d pinned on core %02d\n", id, core);
+
+	while (1) {
+
+		if (crossbowDecoderPoolGetWork (p, id, &work)) {
+
+			__sync_fetch_and_sub (&(p->pending), 1);
+
+			job = work.job;
+			p->handler (id, job->items[work.ndx]);
+
+			/* The worker that completes the last item hands the job over to its callback */
+			if (__sync_sub_and_fetch (&(job->remaining), 1) == 0)
+				job->callback (job->args);
+
+			continue;
+		}
+
+		/* No work to do or to steal: block until a job is submitted */
+		pthread_mutex_lock (&(p->lock));
+		while (p->pending == 0 && (! p->exit))
+			pthread_cond_wait (&(p->cond), &(p->lock));
+		if (p->pending == 0 && p->exit) {
+			pthread_mutex_unlock (&(p->lock));
+			break;
+		}
+		pthread_mutex_unlock (&(p->lock));
+	}
+
+	crossbowFree (worker, sizeof(crossbow_decoder_worker_t));
+	return NULL;
+}
+
+/* Callback for synchronous jobs */
+static void crossbowDecoderJobSignal (void *args) {
+	crossbowDecoderJobP job = (crossbowDecoderJobP) args;
+	crossbowDecoderPoolP p = job->pool;
+	pthread_mutex_lock (&(p->lock));
+	job->done = 1;
+	pthread_cond_broadcast (&(p->done));
+	pthread_mutex_unlock (&(p->lock));
+	return;
+}
+
+crossbowDecoderPoolP crossbowDecoderPoolCreate (int workers, int core, crossbowDecoderPoolHandler handler) {
+
+	int id;
+	crossbow_decoder_worker_t *worker;
+
+	invalidArgumentException (workers > 0);
+	nullPointerException (handler);
+
+	crossbowDecoderPoolP p = (crossbowDecoderPoolP) crossbowMalloc (sizeof(crossbow_decoder_pool_t));
+	p->workers = workers;
+	p->core = core;
+	p->handler = handler;
+	p->next = 0;
+	p->pending = 0;
+	p->exit = 0;
+
+	pthread_mutex_init (&(p->lock), NULL);
+	pthread_cond_init  (&(p->cond), NULL);
+	pthread_cond_init  (&(p->done), NULL);
+
+	p->deques = (crossbowDecoderDequeP) crossbowMalloc (workers * sizeof(crossbow_decoder_deque_t));
+	for (id = 0; id < workers; ++id)
+		crossbowDecoderDequeInit (&(p->deques[id]), 256);
+
+	p->threads = (pthread_t *) crossbowMalloc (workers * sizeof(pthread_t));
+	for (id = 0; id < workers; ++id) {
+		worker = (crossbow_decoder_worker_t *) crossbowMalloc (sizeof(crossbow_decoder_worker_t));
+		worker->pool = p;
+		worker->id = id;
+		pthread_create (&(p->threads[id]), NULL, handle, (void *) worker);
+	}
+	return p;
+}
+
+crossbowDecoderJobP crossbowDecoderJobCreate (int count, crossbowDecoderJobCallback callback, void *args) {
+	invalidArgumentException (count > 0);
+	crossbowDecoderJobP job = (crossbowDecoderJobP) crossbowMalloc (sizeof(crossbow_decoder_job_t));
+	job->items = (void **) crossbowMalloc (count * sizeof(void *));
+	job->count = count;
+	job->remaining = count;
+	job->callback = callback;
+	job->args = args;
+	job->pool = NULL;
+	job->done = 0;
+	return job;
+}
+
+void crossbowDecoderJobFree (crossbowDecoderJobP job) {
+	if (! job)
+		return;
+	crossbowFree (job->items, job->count * sizeof(void *));
+	crossbowFree (job, sizeof(crossbow_decoder_job_t));
+	return;
+}
+
+void crossbowDecoderPoolSubmit (crossbowDecoderPoolP p, crossbowDecoderJobP job) {
+
+	int id, ndx, start, end;
+	int count, partition, first;
+
+	nullPointerException (p);
+	nullPointerException (job);
+	nullPointerException (job->callback);
+	invalidConditionException (! p->exit);
+
+	/*
+	 * Workers may complete (and free) the job before the last item is
+	 * pushed, so the job must not be read once its first item is pushed.
+	 */
+	count = job->count;
+
+	job->pool = p;
+	job->remaining = count;
+
+	/*
+	 * Account for the job's items before they are visible to workers,
+	 * so that `pending` never goes negative. The first range goes to a
+	 * different worker every time, so that uneven splits do not always
+	 * favour the same workers.
+	 */
+	pthread_mutex_lock (&(p->lock));
+	__sync_fetch_and_add (&(p->pending), count);
+	first = p->next;
+	p->next = (p->next + 1) % p->workers;
+	pthread_mutex_unlock (&(p->lock));
+
+	/* Give each worker a contiguous range of items */
+	partition = (count + p->workers - 1) / p->workers;
+	for (ndx = 0; ndx < p->workers; ++ndx) {
+		start = ndx * partition;
+		if (start >= count)
+			break;
+		end = min (start + partition, count);
+		id = (first + ndx) % p->workers;
+		/* Push in reverse order: the owner pops from the tail, so it processes items in order */
+		while (end > start)
+			crossbowDecoderDequePush (&(p->deques[id]), job, --end);
+	}
+
+	/* Wake up workers */
+	pthread_mutex_lock (&(p->lock));
+	pthread_cond_broadcast (&(p->cond));
+	pthread_mutex_unlock (&(p->lock));
+
+	return;
+}
+
+void crossbowDecoderPoolSubmitAndWait (crossbowDecoderPoolP p, crossbowDecoderJobP job) {
+
+	nullPointerException (p);
+	nullPointerException (job);
+
+	job->callback = crossbowDecoderJobSignal;
+	job->args = job;
+	job->done = 0;
+
+	crossbowDecoderPoolSubmit (p, job);
+
+	pthread_mutex_lock (&(p->lock));
+	while (! job->done)
+		pthread_cond_wait (&(p->done), &(p->lock));
+	pthread_mutex_unlock (&(p->lock));
+
+	return;
+}
+
+void crossbowDecoderPoolFree (crossbowDecoderPoolP p) {
+
+	int id;
+
+	if (! p)
+		return;
+
+	pthread_mutex_lock (&(p->lock));
+	p->exit = 1;
+	pthread_cond_broadcast (&(p->cond));
+	pthread_mutex_unlock (&(p->lock));
+
+	for (id = 0; id < p->workers; ++id)
+		pthread_join (p->threads[id], NULL);
+
+	for (id = 0; id < p->workers; ++id)
+		crossbowDecoderDequeDestroy (&(p->deques[id]));
+
+	crossbowFree (p->deques, p->workers * sizeof(crossbow_decoder_deque_t));
+	crossbowFree (p->threads, p->workers * sizeof(pthread_t));
+
+	pthread_mutex_destroy (&(p->lock));
+	pthread_cond_destroy  (&(p->cond));
+	pthread_cond_destroy  (&(p->done));
+
+	crossbowFree (p, sizeof(crossbow_decoder_pool_t));
+	return;
+}
@@ -0,0 +1,88 @@
+#ifndef __CROSSBOW_DECODERPOOL_H_
+#define __CROSSBOW_DECODERPOOL_H_
+
+#include <pthread.h>
+
+/*
+ * A long-lived pool of decoder threads.
+ *
+ * A job is an array of independent items (e.g. records to decode). On
+ * submission, items are spread across per-worker deques; a worker pops
+ * items from the tail of its own deque and, when that is empty, steals
+ * from the head of the others'. Thus, a worker that drew small images
+ * keeps helping the one that drew large images, instead of idling until
+ * the batch is over.
+ *
+ * When the last item of a job has been processed, the pool invokes the
+ * job's callback (from the worker thread that completed it). From then
+ * on, the job belongs to the callback, which may free it.
+ */
+
+typedef void (*crossbowDecoderPoolHandler) (int, void *);
+
+typedef void (*crossbowDecoderJobCallback) (void *);
+
+typedef struct crossbow_decoder_pool *crossbowDecoderPoolP;
+
+typedef struct crossbow_decoder_job *crossbowDecoderJobP;
+typedef struct crossbow_decoder_job {
+	void **items;
+	int count;
+	/* Number of items not yet processed */
+	volatile int remaining;
+	crossbowDecoderJobCallback callback;
+	void *args;
+	/* Used by crossbowDecoderPoolSubmitAndWait */
+	crossbowDecoderPoolP pool;
+	volatile int done;
+} crossbow_decoder_job_t;
+
+/* An item of a job, as it is stored in a deque */
+typedef struct crossbow_decoder_work {
+	crossbowDecoderJobP job;
+	int ndx;
+} crossbow_decoder_work_t;
+
+typedef struct crossbow_decoder_deque *crossbowDecoderDequeP;
+typedef struct crossbow_decoder_deque {
+	pthread_mutex_t lock;
+	crossbow_decoder_work_t *items;
+	int capacity;
+	/* Items are stolen from the head and popped from the tail */
+	int head;
+	int size;
+} crossbow_decoder_deque_t;
+
+typedef struct crossbow_decoder_pool {
+	int workers;
+	int core; /* Pin workers to cores, starting from core `core` */
+	crossbowDecoderPoolHandler handler;
+	crossbowDecoderDequeP deques;
+	pthread_t *threads;
+	/* Round-robin pointer for spreading items of the next job */
+	int next;
+	/* Sleep/wake-up mechanism for idle workers */
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	pthread_cond_t done;
+	volatile int pending;
+	volatile int exit;
+} crossbow_decoder_pool_t;
+
+/* Starts `workers` threads that call `handler (worker id, item)` for every item */
+crossbowDecoderPoolP crossbowDecoderPoolCreate (int, int, crossbowDecoderPoolHandler);
+
+crossbowDecoderJobP crossbowDecoderJobCreate (int, crossbowDecoderJobCallback, void *);
+
+void crossbowDecoderJobFree (crossbowDecoderJobP);
+
+/* Asynchronous submission; the job's callback signals completion */
+void crossbowDecoderPoolSubmit (crossbowDecoderPoolP, crossbowDecoderJobP);
+
+/* Submits a job (without a callback) and blocks until it completes */
+void crossbowDecoderPoolSubmitAndWait (crossbowDecoderPoolP, crossbowDecoderJobP);
+
+/* Waits for queued jobs to drain, then stops the workers */
+void crossbowDecoderPoolFree (crossbowDecoderPoolP);
+
+#endif /* __CROSSBOW_DECODERPOOL_H_ */
@@ -10,6 +10,11 @@
 
 #include "yarng.h"
 
+#include "../cpukernels/simd.h"
+
+#include <pthread.h>
+#include <math.h>
+
 crossbowImageP crossbowImageCreate (int channels, int height, int width) {
 	crossbowImageP p = NULL;
 	p = (crossbowImageP) crossbowMalloc (sizeof(crossbow_image_t));
@@ -33,6 +38,12 @@ crossbowImageP crossbowImageCreate (int channels, int height, int width) {
 	p->data = NULL;
 	p->height = p->width = 0;
 
+	p->img = NULL;
+	p->imgcapacity = 0;
+	p->capacity = 0;
+	p->spare = NULL;
+	p->sparecapacity = 0;
+
 	p->format = HWC;
 
 	p->isfloat = 0; /* Float representation of the image (stored in `data`) */
@@ -41,9 +52,74 @@ crossbowImageP crossbowImageCreate (int channels, int height, int width) {
 
 	p->output = NULL;
 	p->offset = 0;
+
+	crossbowYarngInit (&(p->rng), 0, 0, 0);
 	return p;
 }
 
+/*
+ * Prepare the image object for the next image: the decompressor and the
+ * buffers are kept, so that reusing an image object allocates nothing.
+ */
+void crossbowImageReset (crossbowImageP p) {
+	nullPointerException(p);
+	/* Return the decompressor to its initial state (a no-op if idle) */
+	jpeg_abort_decompress (p->info);
+
+	p->height = p->width = 0;
+	p->elements = 0;
+	p->inputheight = p->inputwidth = 0;
+
+	p->format = HWC;
+
+	p->isfloat = 0;
+	p->started = 0;
+	p->decoded = 0;
+
+	p->output = NULL;
+	p->offset = 0;
+	return;
+}
+
+/*
+ * Start the random stream used by the image's augmentations, for `example`
+ * in `epoch` (the stream is not reset with the image)
+ */
+void crossbowImageSeed (crossbowImageP p, unsigned long long seed, unsigned epoch, unsigned example) {
+	nullPointerException(p);
+	crossbowYarngInit (&(p->rng), seed, epoch, example);
+	return;
+}
+
+/* Grow geometrically, so that a reused image object soon stops reallocating */
+static inline int crossbowImageGrow (int capacity, int required) {
+	return max(required, 2 * capacity);
+}
+
+/*
+ * Returns a float buffer of at least `elements`, other than `data`. Once
+ * filled, it replaces `data` by a call to crossbowImageSwap.
+ */
+static float *crossbowImageGetBuffer (crossbowImageP p, int elements) {
+	if (p->sparecapacity < elements) {
+		if (p->spare)
+			crossbowFree (p->spare, p->sparecapacity * sizeof(float));
+		p->sparecapacity = crossbowImageGrow (p->sparecapacity, elements);
+		p->spare = (float *) crossbowMalloc (p->sparecapacity * sizeof(float));
+	}
+	return p->spare;
+}
+
+static inline void crossbowImageSwap (crossbowImageP p) {
+	float *t = p->data;
+	int capacity = p->capacity;
+	p->data = p->spare;
+	p->capacity = p->sparecapacity;
+	p->spare = t;
+	p->sparecapacity = capacity;
+	return;
+}
+
 void crossbowImageReadFromMemory (crossbowImageP p, void *data, int length) {
 	nullPointerException(p);
 	jpeg_mem_src (p->info, data, length);
@@ -64,55 +140,117 @@ void crossbowImageStartDecoding (crossbowImageP p) {
 	/* Try integer fast... */
 	p->info->dct_method = JDCT_IFAST;
 	p->info->out_color_space = JCS_RGB;
-	jpeg_start_decompress(p->info);
+	/* Output dimensions are at full scale, unless the image is scaled before decoding */
+	jpeg_calc_output_dimensions (p->info);
 	/* dbg("JPEG image (%d x %d x %d)\n", p->info->output_height, p->info->output_width, p->info->output_components); */
 	/* JPEG images must have 3 channels */
 	if (p->info->output_components != 3) {
 		printf("Hm. Image has %d channels?\n", p->info->output_components);
 	}
 	invalidConditionException (p->info->output_components == p->channels);
+	p->inputheight = p->info->output_height;
+	p->inputwidth  = p->info->output_width;
 	p->started = 1;
 	return;
 }
 
-void crossbowImageDecode (crossbowImageP p) {
+/*
+ * Decode at the smallest DCT scale (M/8) that yields an image of at least
+ * (height x width) pixels. Most of the IDCT work is skipped, and it is much
+ * cheaper than decoding at full scale and resizing.
+ */
+void crossbowImageScale (crossbowImageP p, int height, int width) {
+	unsigned int num;
+	nullPointerException(p);
+	invalidConditionException (p->started);
+	invalidConditionException (! p->decoded);
+	/* If no fraction is large enough, the loop ends at 8/8 (full scale) */
+	for (num = 1; num <= 8; ++num) {
+		p->info->scale_num = num;
+		p->info->scale_denom = 8;
+		jpeg_calc_output_dimensions (p->info);
+		if ((int) p->info->output_height >= height && (int) p->info->output_width >= width)
+			break;
+	}
+	p->inputheight = p->info->output_height;
+	p->inputwidth  = p->info->output_width;
+	return;
+}
+
+void crossbowImageDecodeWindow (crossbowImageP p, int top, int left, int height, int width) {
+	int i;
 	nullPointerException(p);
 	/* Is `p->info` filled? */
 	invalidConditionException (p->started);
 	if (p->decoded)
 		return;
-	p->elements = crossbowImageInputHeight (p) * crossbowImageInputWidth (p) * crossbowImageChannels (p);
-	p->img = (unsigned char *) crossbowMalloc (p->elements);
+
+	int H = crossbowImageInputHeight (p);
+	int W = crossbowImageInputWidth  (p);
+
+	invalidConditionException ((top  >= 0) && (height > 0) && (top  + height <= H));
+	invalidConditionException ((left >= 0) && (width  > 0) && (left + width  <= W));
+
+	/* The image keeps its full (scaled) shape; only the window is valid */
+	p->elements = H * W * crossbowImageChannels (p);
+	if (p->imgcapacity < p->elements) {
+		if (p->img)
+			crossbowFree (p->img, p->imgcapacity);
+		p->imgcapacity = crossbowImageGrow (p->imgcapacity, p->elements);
+		p->img = (unsigned char *) crossbowMalloc (p->imgcapacity);
+	}
 
 	/* Decompress */
+	jpeg_start_decompress(p->info);
+
+	/* Columns are cropped at iMCU boundaries, so `left` may move left and `width` grow */
+	JDIMENSION xoffset = (JDIMENSION) left;
+	JDIMENSION columns = (JDIMENSION) width;
+	if (columns < (JDIMENSION) W)
+		jpeg_crop_scanline (p->info, &xoffset, &columns);
+
+	if (top > 0)
+		jpeg_skip_scanlines (p->info, (JDIMENSION) top);
 
 	/* Compute row stride */
-	int stride = crossbowImageInputWidth (p) * crossbowImageChannels (p);
-	unsigned char *buffer[1];
+	int stride = W * crossbowImageChannels (p);
+	unsigned char *buffer[4];
 
 	/* By default, scanlines will come out in RGBRGBRGB...  order */
-	while (p->info->output_scanline < (unsigned int) crossbowImageInputHeight (p)) {
+	while (p->info->output_scanline < (unsigned int) (top + height)) {
 
-		buffer[0] = p->img + p->info->output_scanline * stride;
+		for (i = 0; i < 4; ++i)
+			buffer[i] = p->img + (p->info->output_scanline + i) * stride + xoffset * crossbowImageChannels (p);
 
-		jpeg_read_scanlines(p->info, buffer, 1);
+		jpeg_read_scanlines(p->info, buffer, min(4, (top + height) - (int) p->info->output_scanline));
 	}
-	jpeg_finish_decompress(p->info);
+	/* Discard the remaining scanlines, if any */
+	if (p->info->output_scanline < p->info->output_height)
+		jpeg_abort_decompress(p->info);
+	else
+		jpeg_finish_decompress(p->info);
 
 	p->decoded = 1;
 	return;
 }
 
+void crossbowImageDecode (crossbowImageP p) {
+	nullPointerException(p);
+	crossbowImageDecodeWindow (p, 0, 0, crossbowImageInputHeight (p), crossbowImageInputWidth (p));
+	return;
+}
+
 void crossbowImageCast (crossbowImageP p) {
 	int i;
 	nullPointerException (p);
-	/* Is the image decoded? */
-	invalidConditionException (p->decoded);
 	if (p->isfloat)
 		return;
-	p->data = (float *) crossbowMalloc (p->elements * sizeof(float));
+	/* Decode the image, if not already decoded */
+	crossbowImageDecode (p);
+	float *data = crossbowImageGetBuffer (p, p->elements);
 	for (i = 0; i < p->elements; i++)
-		p->data[i] = (float) p->img[i];
+		data[i] = (float) p->img[i];
+	crossbowImageSwap (p);
 	p->isfloat = 1;
 	/* Set current height & width */
 	p->height = crossbowImageInputHeight (p);
@@ -126,7 +264,7 @@ void crossbowImageTranspose (crossbowImageP p) {
 	invalidConditionException (p->decoded);
 	invalidConditionException (p->isfloat);
     /* Allocate new buffer */
-    float *transposed = (float *) crossbowMalloc (crossbowImageCurrentElements (p) * sizeof(float));
+    float *transposed = crossbowImageGetBuffer (p, crossbowImageCurrentElements (p));
     int src, dst;
     for (h = 0; h < p->height; ++h) {
         for (w = 0; w < p->width; ++w) {
@@ -138,23 +276,21 @@ void crossbowImageTranspose (crossbowImageP p) {
         }
     }
     
-    /* Free current data pointer */
-    crossbowFree (p->data, crossbowImageCurrentElements (p) * sizeof(float));
     /* Assign new data pointer */
-    p->data = transposed;
+    crossbowImageSwap (p);
     return;
 }
 
 int crossbowImageInputHeight (crossbowImageP p) {
 	nullPointerException(p);
 	invalidConditionException (p->started);
-	return p->info->output_height;
+	return p->inputheight;
 }
 
 int crossbowImageInputWidth (crossbowImageP p) {
 	nullPointerException(p);
 	invalidConditionException (p->started);
-	return p->info->output_width;
+	return p->inputwidth;
 }
 
 int crossbowImageCurrentHeight (crossbowImageP p) {
@@ -208,7 +344,7 @@ void crossbowImageCrop (crossbowImageP p, int height, int width, int top, int le
 	*/
 
 	/* Allocate new buffer */
-	float *cropped = (float *) crossbowMalloc (crossbowImageChannels (p) * height * width * sizeof(float));
+	float *cropped = crossbowImageGetBuffer (p, crossbowImageChannels (p) * height * width);
 
 	/* Compute new row size */
 	int rowsize = width * crossbowImageChannels (p);
@@ -224,10 +360,8 @@ void crossbowImageCrop (crossbowImageP p, int height, int width, int top, int le
 		/* Move output data pointer */
 		offset += rowsize;
 	}
-	/* Free current data pointer */
-	crossbowFree (p->data, crossbowImageCurrentElements (p) * sizeof(float));
 	/* Assign new data pointer */
-	p->data = cropped;
+	crossbowImageSwap (p);
 	/* Set current data, height & width */
 	p->height = height;
 	p->width  =  width;
@@ -248,7 +382,7 @@ void crossbowImageRandomBrightness (crossbowImageP p, float delta) {
 	nullPointerException(p);
 	invalidArgumentException(delta > 0);
 
-	float brightness = crossbowYarngNext (-delta, delta);
+	float brightness = crossbowYarngNext (&(p->rng), -delta, delta);
 	crossbowImageAdjustBrightness (p, brightness);
 
 	return;
@@ -277,7 +411,7 @@ void crossbowImageRandomContrast (crossbowImageP p, float lower, float upper) {
 	invalidArgumentException(lower >= 0);
 	invalidArgumentException(lower <= upper);
 
-	float contrast = crossbowYarngNext (lower, upper);
+	float contrast = crossbowYarngNext (&(p->rng), lower, upper);
 	crossbowImageAdjustContrast (p, contrast);
 	return;
 }
@@ -536,9 +670,11 @@ void crossbowImageFree (crossbowImageP p) {
 	if (! p)
 		return;
 	if (p->img)
-		crossbowFree (p->img, p->elements);
+		crossbowFree (p->img, p->imgcapacity);
 	if (p->data)
-		crossbowFree (p->data, crossbowImageCurrentElements (p) * sizeof(float));
+		crossbowFree (p->data, p->capacity * sizeof(float));
+	if (p->spare)
+		crossbowFree (p->spare, p->sparecapacity * sizeof(float));
 	/* Release JPEG library state */
 	jpeg_destroy_decompress(p->info);
 	crossbowFree (p->info, sizeof(struct jpeg_decompress_struct));
@@ -547,169 +683,300 @@ void crossbowImageFree (crossbowImageP p) {
 	return;
 }
 
-/* Assuming M inputs & N outputs */
-static inline void crossbowComputeInterpolationWeights
-	(crossbowInterpolationWeightP *weights, long N, long M, float scale) {
-
-	float in;
-	long idx;
+/*
+ * Interpolation tables depend only on the (input, output) size pair, and
+ * decoded images tend to come in a few common sizes. Each thread keeps a
+ * small cache of tables, along with the scratch rows used by resampling,
+ * so that resizing an image allocates nothing but its output buffer.
+ *
+ * Cached state lives as long as the thread (decoder threads are long-lived),
+ * and is released by a thread-specific data destructor when the thread exits.
+ */
+#define CROSSBOW_INTERPOLATION_CACHE_SIZE 8
 
-	weights [N]->lower = 0;
-	weights [N]->upper = 0;
+typedef struct crossbow_image_thread_cache {
+	crossbow_interpolation_table_t tables [CROSSBOW_INTERPOLATION_CACHE_SIZE];
+	int next; /* Next table to evict */
+	float *scratch;
+	int capacity; /* Scratch capacity, in floats */
+	unsigned registered;
+} crossbow_image_thread_cache_t;
 
-	for (idx = N - 1; idx >= 0; --idx) {
+static __thread crossbow_image_thread_cache_t cache;
 
-		in = idx * scale;
+static pthread_key_t cachekey;
+static pthread_once_t cachekeyonce = PTHREAD_ONCE_INIT;
 
-		weights [idx]->lower = (long) in;
-		weights [idx]->upper = min(weights[idx]->lower + 1, M - 1);
-		weights [idx]->lerp = in - weights[idx]->lower;
+static void crossbowImageThreadCacheFree (void *args) {
+	int i;
+	crossbow_image_thread_cache_t *c = (crossbow_image_thread_cache_t *) args;
+	for (i = 0; i < CROSSBOW_INTERPOLATION_CACHE_SIZE; ++i) {
+		if (c->tables[i].weights)
+			crossbowFree (c->tables[i].weights, c->tables[i].output * sizeof(crossbow_interpolation_weight_t));
 	}
+	if (c->scratch)
+		crossbowFree (c->scratch, c->capacity * sizeof(float));
+	memset (c, 0, sizeof(crossbow_image_thread_cache_t));
+	return;
 }
 
-static inline float crossbowComputeLerp (float topleft, float topright, float bottomleft, float bottomright, float xlerp, float ylerp) {
-
-	float top = topleft + (topright - topleft) * xlerp;
-	float bottom = bottomleft + (bottomright - bottomleft) * xlerp;
-
-	return (top + (bottom - top) * ylerp);
+static void crossbowImageThreadCacheCreateKey (void) {
+	pthread_key_create (&cachekey, crossbowImageThreadCacheFree);
+	return;
 }
 
-static void crossbowResizeImage (
-	float *input,
-	long C,
-	long H, /* Input dimensions */
-	long W,
-	long H_, /* Output dimensions */
-	long W_,
-	crossbowInterpolationWeightP *X,
-	crossbowInterpolationWeightP *Y,
-	float *output) {
-
-	long x, y;
-
-	float topleft [3], topright [3], bottomleft [3], bottomright [3];
-
-	/* Resize image from (C, H, W) to (C, H_, W_)... */
-
-	long row  = W  * C;
-	long row_ = W_ * C;
-
-	(void) H;
-
-	float *outputP = output;
+/* Called before the first allocation of a thread's cache */
+static void crossbowImageThreadCacheRegister (void) {
+	if (cache.registered)
+		return;
+	pthread_once (&cachekeyonce, crossbowImageThreadCacheCreateKey);
+	pthread_setspecific (cachekey, &cache);
+	cache.registered = 1;
+	return;
+}
 
-	for (y = 0; y < H_; ++y) {
+/* Assuming M inputs & N outputs */
+static inline void crossbowComputeInterpolationWeights
+	(crossbowInterpolationWeightP weights, long N, long M, float scale) {
 
-		float *_y_lower = input + Y [y]->lower * row;
-		float *_y_upper = input + Y [y]->upper * row;
+	float in;
+	long idx;
 
-		float  _y_lerp  = Y[y]->lerp;
+	for (idx = N - 1; idx >= 0; --idx) {
 
-		for (x = 0; x < W_; ++x) {
+		in = idx * scale;
 
-			long  _x_lower = X [x]->lower;
-			long  _x_upper = X [x]->upper;
-			float _x_lerp  = X [x]->lerp;
+		weights [idx].lower = (long) in;
+		weights [idx].upper = min(weights[idx].lower + 1, M - 1);
+		weights [idx].lerp = in - weights[idx].lower;
+	}
+}
 
-			/* Read channel #0 (R) */
-			topleft     [0] = _y_lower [_x_lower + 0];
-			topright    [0] = _y_lower [_x_upper + 0];
-			bottomleft  [0] = _y_upper [_x_lower + 0];
-			bottomright [0] = _y_upper [_x_upper + 0];
+static inline float crossbowCalculateResizeScale (int inputSize, int outputSize) {
+	return (float) inputSize / (float) outputSize;
+}
 
-			/* Read channel #1 (G) */
-			topleft     [1] = _y_lower [_x_lower + 1];
-			topright    [1] = _y_lower [_x_upper + 1];
-			bottomleft  [1] = _y_upper [_x_lower + 1];
-			bottomright [1] = _y_upper [_x_upper + 1];
+/* Returns the table for (input, output); on a miss, it never evicts `inuse` */
+static crossbowInterpolationWeightP crossbowGetInterpolationWeights (int input, int output, crossbowInterpolationWeightP inuse) {
+	int i;
+	crossbowInterpolationTableP t;
+	for (i = 0; i < CROSSBOW_INTERPOLATION_CACHE_SIZE; ++i) {
+		t = &(cache.tables[i]);
+		if (t->weights && t->input == input && t->output == output)
+			return t->weights;
+	}
+	/* Miss: replace the oldest entry */
+	crossbowImageThreadCacheRegister ();
+	t = &(cache.tables[cache.next]);
+	cache.next = (cache.next + 1) % CROSSBOW_INTERPOLATION_CACHE_SIZE;
+	if (t->weights && t->weights == inuse) {
+		t = &(cache.tables[cache.next]);
+		cache.next = (cache.next + 1) % CROSSBOW_INTERPOLATION_CACHE_SIZE;
+	}
+	if (t->weights)
+		crossbowFree (t->weights, t->output * sizeof(crossbow_interpolation_weight_t));
+	t->input = input;
+	t->output = output;
+	t->weights = (crossbowInterpolationWeightP) crossbowMalloc (output * sizeof(crossbow_interpolation_weight_t));
+	crossbowComputeInterpolationWeights (t->weights, output, input, crossbowCalculateResizeScale (input, output));
+	return t->weights;
+}
 
-			/* Read channel #2 (B) */
-			topleft     [2] = _y_lower [_x_lower + 2];
-			topright    [2] = _y_lower [_x_upper + 2];
-			bottomleft  [2] = _y_upper [_x_lower + 2];
-			bottomright [2] = _y_upper [_x_upper + 2];
+static float *crossbowGetScratch (int elements) {
+	if (cache.capacity < elements) {
+		crossbowImageThreadCacheRegister ();
+		if (cache.scratch)
+			crossbowFree (cache.scratch, cache.capacity * sizeof(float));
+		cache.scratch = (float *) crossbowMalloc (elements * sizeof(float));
+		cache.capacity = elements;
+	}
+	return cache.scratch;
+}
 
-			/* Compute output */
-			outputP [x * C + 0] = crossbowComputeLerp (topleft [0], topright [0], bottomleft [0], bottomright [0], _x_lerp, _y_lerp);
-			outputP [x * C + 1] = crossbowComputeLerp (topleft [1], topright [1], bottomleft [1], bottomright [1], _x_lerp, _y_lerp);
-			outputP [x * C + 2] = crossbowComputeLerp (topleft [2], topright [2], bottomleft [2], bottomright [2], _x_lerp, _y_lerp);
+/*
+ * Horizontal pass: interpolate `width` pixels of an input row. The `X`
+ * table is indexed by output column (reversed, if `flip` is set).
+ */
+static inline void crossbowInterpolateRowFromBytes (const unsigned char *input, crossbowInterpolationWeightP X, long offset, int width, int C, unsigned flip, float *output) {
+	int x, c;
+	long lower, upper;
+	float lerp;
+	for (x = 0; x < width; ++x) {
+		crossbowInterpolationWeightP w = &(X[flip ? (width - 1 - x) : x]);
+		lower = (w->lower + offset) * C;
+		upper = (w->upper + offset) * C;
+		lerp  =  w->lerp;
+		for (c = 0; c < C; ++c) {
+			float left = (float) input [lower + c];
+			output [x * C + c] = left + ((float) input [upper + c] - left) * lerp;
 		}
-
-		/* Move output pointer to next row */
-		outputP = outputP + row_;
 	}
 	return;
 }
 
-static inline float crossbowCalculateResizeScale (int inputSize, int outputSize) {
-	return (float) inputSize / (float) outputSize;
+static inline void crossbowInterpolateRowFromFloats (const float *input, crossbowInterpolationWeightP X, long offset, int width, int C, unsigned flip, float *output) {
+	int x, c;
+	long lower, upper;
+	float lerp;
+	for (x = 0; x < width; ++x) {
+		crossbowInterpolationWeightP w = &(X[flip ? (width - 1 - x) : x]);
+		lower = (w->lower + offset) * C;
+		upper = (w->upper + offset) * C;
+		lerp  =  w->lerp;
+		for (c = 0; c < C; ++c) {
+			float left = input [lower + c];
+			output [x * C + c] = left + (input [upper + c] - left) * lerp;
+		}
+	}
+	return;
 }
 
-void crossbowImageResize (crossbowImageP p, int height, int width) {
-	int i;
-	nullPointerException(p);
-
-	/* Allocate interpolation weights on the X and Y dimensions */
+/*
+ * Vertical pass, fused with normalisation:
+ *
+ * output = (top + (bottom - top) x lerp) x scale - shift
+ */
+static inline void crossbowInterpolateColumns (const float *top, const float *bottom, float lerp, int count, float scale, float shift, float *output) {
+	int i = 0;
+	crossbowVector_t l = crossbowVectorSet (lerp);
+	crossbowVector_t s = crossbowVectorSet (scale);
+	crossbowVector_t b = crossbowVectorSet (-shift);
+	for (; i <= count - CROSSBOW_SIMD_WIDTH; i += CROSSBOW_SIMD_WIDTH) {
+		crossbowVector_t t = crossbowVectorLoad (top + i);
+		crossbowVector_t v = crossbowVectorFma (crossbowVectorSub (crossbowVectorLoad (bottom + i), t), l, t);
+		crossbowVectorStore (output + i, crossbowVectorFma (v, s, b));
+	}
+	for (; i < count; ++i)
+		output[i] = (top[i] + (bottom[i] - top[i]) * lerp) * scale - shift;
+	return;
+}
 
-	crossbowInterpolationWeightP *X =
-			(crossbowInterpolationWeightP *) crossbowMalloc ((width  + 1) * sizeof(crossbowInterpolationWeightP));
+static inline int crossbowImageSourceHeight (crossbowImageP p) {
+	return (p->isfloat) ? crossbowImageCurrentHeight (p) : crossbowImageInputHeight (p);
+}
 
-	crossbowInterpolationWeightP *Y =
-			(crossbowInterpolationWeightP *) crossbowMalloc ((height + 1) * sizeof(crossbowInterpolationWeightP));
+static inline int crossbowImageSourceWidth (crossbowImageP p) {
+	return (p->isfloat) ? crossbowImageCurrentWidth (p) : crossbowImageInputWidth (p);
+}
 
-	for (i = 0; i < width + 1; ++i)
-		X[i] = (crossbowInterpolationWeightP) crossbowMalloc (sizeof(crossbow_interpolation_weight_t));
+/*
+ * Bilinear resampling in a single pass over the source image, which is
+ * either the decoded image (bytes) or its float representation.
+ *
+ * The (srcheight x srcwidth) window of the source at (srctop, srcleft) is
+ * resized to (resizeheight x resizewidth); the output is the (height x
+ * width) window of the resized image at (top, left), optionally flipped
+ * left-right, and normalised by `scale` and `shift`.
+ *
+ * Only the output window is ever computed. Source rows are interpolated
+ * horizontally once, and kept in two scratch rows while they are in use.
+ */
+static void crossbowImageResample (crossbowImageP p,
+	int srctop, int srcleft, int srcheight, int srcwidth,
+	int resizeheight, int resizewidth,
+	int top, int left, int height, int width,
+	unsigned flip, float scale, float shift) {
 
-	for (i = 0; i < height + 1; ++i)
-		Y[i] = (crossbowInterpolationWeightP) crossbowMalloc (sizeof(crossbow_interpolation_weight_t));
+	int y;
+	long lower, upper;
 
-	crossbowComputeInterpolationWeights (X,  width, crossbowImageCurrentWidth  (p), crossbowCalculateResizeScale (crossbowImageCurrentWidth  (p),  width));
-	crossbowComputeInterpolationWeights (Y, height, crossbowImageCurrentHeight (p), crossbowCalculateResizeScale (crossbowImageCurrentHeight (p), height));
+	nullPointerException(p);
+	invalidConditionException (p->started);
 
-	for (i = 0; i < width + 1; ++i) {
-		X[i]->lower *= p->channels;
-		X[i]->upper *= p->channels;
+	int C = crossbowImageChannels (p);
+	int H = crossbowImageSourceHeight (p);
+	int W = crossbowImageSourceWidth  (p);
+
+	invalidConditionException ((srctop  >= 0) && (srctop  + srcheight <= H));
+	invalidConditionException ((srcleft >= 0) && (srcleft + srcwidth  <= W));
+	invalidConditionException ((top  >= 0) && (top  + height <= resizeheight));
+	invalidConditionException ((left >= 0) && (left + width  <= resizewidth ));
+
+	crossbowInterpolationWeightP X = crossbowGetInterpolationWeights (srcwidth,  resizewidth,  NULL);
+	crossbowInterpolationWeightP Y = crossbowGetInterpolationWeights (srcheight, resizeheight, X);
+	X += left;
+	Y += top;
+
+	/* If not yet decoded, decode only the source rows and columns that the output needs */
+	if (! p->decoded) {
+		long ymin = srctop  + Y[0].lower, ymax = srctop  + Y[height - 1].upper;
+		long xmin = srcleft + X[0].lower, xmax = srcleft + X[width  - 1].upper;
+		crossbowImageDecodeWindow (p, (int) ymin, (int) xmin, (int) (ymax - ymin + 1), (int) (xmax - xmin + 1));
 	}
 
-	/* Allocate new buffer */
-	float *resized = (float *) crossbowMalloc (crossbowImageChannels (p) * height * width * sizeof(float));
+	int row = width * C;
 
-	crossbowResizeImage (
-		p->data,
-		p->channels,
-		crossbowImageCurrentHeight (p),
-		crossbowImageCurrentWidth  (p),
-		height,
-		width,
-		X,
-		Y,
-		resized
-	);
+	float *rows = crossbowGetScratch (2 * row);
+	float *slot [2] = { rows, rows + row };
+	long index [2] = { -1, -1 };
 
-	/* Free interpolation weights */
+	/* Allocate new buffer */
+	float *output = crossbowImageGetBuffer (p, height * row);
 
-	for (i = 0; i < width + 1; ++i)
-		crossbowFree (X[i], sizeof(crossbow_interpolation_weight_t));
+	for (y = 0; y < height; ++y) {
 
-	for (i = 0; i < height + 1; ++i)
-		crossbowFree (Y[i], sizeof(crossbow_interpolation_weight_t));
+		lower = Y[y].lower + srctop;
+		upper = Y[y].upper + srctop;
+
+		/* Fill-in a scratch row that is not needed by this output row */
+		if (index[0] != lower && index[1] != lower) {
+			int s = (index[1] == upper) ? 0 : 1;
+			if (p->isfloat)
+				crossbowInterpolateRowFromFloats (p->data + lower * W * C, X, srcleft, width, C, flip, slot[s]);
+			else
+				crossbowInterpolateRowFromBytes  (p->img  + lower * W * C, X, srcleft, width, C, flip, slot[s]);
+			index[s] = lower;
+		}
+		if (index[0] != upper && index[1] != upper) {
+			int s = (index[0] == lower) ? 1 : 0;
+			if (p->isfloat)
+				crossbowInterpolateRowFromFloats (p->data + upper * W * C, X, srcleft, width, C, flip, slot[s]);
+			else
+				crossbowInterpolateRowFromBytes  (p->img  + upper * W * C, X, srcleft, width, C, flip, slot[s]);
+			index[s] = upper;
+		}
 
-	crossbowFree (X, ((width  + 1) * sizeof(crossbowInterpolationWeightP)));
-	crossbowFree (Y, ((height + 1) * sizeof(crossbowInterpolationWeightP)));
+		crossbowInterpolateColumns (
+			slot[(index[0] == lower) ? 0 : 1],
+			slot[(index[0] == upper) ? 0 : 1],
+			Y[y].lerp, row, scale, shift, output + y * row);
+	}
 
-	/* Free current data pointer */
-	crossbowFree (p->data, crossbowImageCurrentElements (p) * sizeof(float));
 	/* Assign new data pointer */
-	p->data = resized;
+	crossbowImageSwap (p);
+	p->isfloat = 1;
 	/* Set current data, height & width */
 	p->height = height;
 	p->width  =  width;
+	return;
+}
 
+void crossbowImageResize (crossbowImageP p, int height, int width) {
+	nullPointerException(p);
+	int H = crossbowImageSourceHeight (p);
+	int W = crossbowImageSourceWidth  (p);
+	crossbowImageResample (p, 0, 0, H, W, height, width, 0, 0, height, width, 0, 1, 0);
+	return;
+}
+
+void crossbowImageResizeAndCrop (crossbowImageP p, int resizeheight, int resizewidth, int top, int left, float scale, float shift) {
+	nullPointerException(p);
+	/* No need to decode more pixels than the resized image has */
+	if (! p->decoded)
+		crossbowImageScale (p, resizeheight, resizewidth);
+	int H = crossbowImageSourceHeight (p);
+	int W = crossbowImageSourceWidth  (p);
+	crossbowImageResample (p, 0, 0, H, W, resizeheight, resizewidth, top, left, p->height_, p->width_, 0, scale, shift);
+	return;
+}
+
+void crossbowImageCropAndResize (crossbowImageP p, int height, int width, int top, int left, unsigned flip, float scale, float shift) {
+	nullPointerException(p);
+	crossbowImageResample (p, top, left, height, width, p->height_, p->width_, 0, 0, p->height_, p->width_, flip, scale, shift);
 	return;
 }
 
-static unsigned generateRandomCrop (crossbowRectangleP crop, int originalHeight, int originalWidth, float *area, float aspectRatio) {
+static unsigned generateRandomCrop (crossbowYarngP rng, crossbowRectangleP crop, int originalHeight, int originalWidth, float *area, float aspectRatio) {
 
 	/* If any of height, width, area, aspect ratio is less that 0, return 0; */
 
@@ -734,7 +1001,7 @@ static unsigned generateRandomCrop (crossbowRectangleP crop, int originalHeight,
 
 	if (minHeight < maxHeight)
 		/* Generate a random number of the closed range [0, (maxHeight - minHeight)]*/
-		minHeight += crossbowYarngNext (0, maxHeight - minHeight + 1);
+		minHeight += crossbowYarngNext (rng, 0, maxHeight - minHeight + 1);
 
 	int minWidth = (int) lrintf (minHeight * aspectRatio);
 
@@ -759,12 +1026,12 @@ static unsigned generateRandomCrop (crossbowRectangleP crop, int originalHeight,
 
 	int x = 0;
 	if (minWidth < originalWidth) {
-		x = crossbowYarngNext (0, originalWidth - minWidth);
+		x = crossbowYarngNext (rng, 0, originalWidth - minWidth);
 	}
 
 	int y = 0;
 	if (minHeight < originalHeight) {
-		y = crossbowYarngNext (0, originalHeight - minHeight);
+		y = crossbowYarngNext (rng, 0, originalHeight - minHeight);
 	}
 
 	crop->xmin = x;
@@ -806,10 +1073,10 @@ void crossbowImageSampleDistortedBoundingBox (crossbowImageP p, crossbowArrayLis
 	unsigned generated = 0;
 	int i;
 	for (i = 0; i < attempts; ++i) {
-		float random = 0.1;
+		float random = crossbowYarngNext (&(p->rng), 0, 1);
 		/* Sample aspect ratio (within bounds) */
 		float sample = random * (ratio[1] - ratio[0]) + ratio[0];
-		if (generateRandomCrop (crop, currentHeight, currentWidth, area, sample)) {
+		if (generateRandomCrop (&(p->rng), crop, currentHeight, currentWidth, area, sample)) {
 
 			if (crossbowRectangleCovers(crop, coverage, rectangles)) {
 				generated = 1;
@@ -9,6 +9,8 @@
 
 #include "../arraylist.h"
 
+#include "yarng.h"
+
 typedef struct jpeg_decompress_struct *crossbowJpegDecompressInfoP;
 
 typedef struct jpeg_error_mgr *crossbowJpegErrorP;
@@ -23,9 +25,16 @@ typedef struct crossbow_image {
 	/* Decoded image */
 	unsigned char *img;
 	int elements; /* Decoded image length (as reported in info) */
+	int imgcapacity;
+	/* Decoded image height & width (possibly scaled, see crossbowImageScale) */
+	int inputheight, inputwidth;
 
 	/* Temporary buffer containing the transformed image */
 	float *data;
+	int capacity; /* In floats */
+	/* The next transformation writes here, and then swaps it with `data` */
+	float *spare;
+	int sparecapacity;
 	/* Current image height & width (based on transformations) */
 	int channels, height, width;
 
@@ -43,6 +52,9 @@ typedef struct crossbow_image {
 	void *output;
 	int offset;
 
+	/* Random stream for augmentations (see crossbowImageSeed) */
+	crossbow_yarng_t rng;
+
 } crossbow_image_t;
 
 typedef struct crossbow_interpolation_weight *crossbowInterpolationWeightP;
@@ -54,16 +66,35 @@ typedef struct crossbow_interpolation_weight {
 
 } crossbow_interpolation_weight_t;
 
+/* Interpolation weights for resizing a dimension from `input` to `output` */
+typedef struct crossbow_interpolation_table *crossbowInterpolationTableP;
+typedef struct crossbow_interpolation_table {
+
+	int input;
+	int output;
+	crossbowInterpolationWeightP weights; /* One per output index */
+
+} crossbow_interpolation_table_t;
+
 crossbowImageP crossbowImageCreate (int, int, int);
 
+void crossbowImageReset (crossbowImageP);
+
+void crossbowImageSeed (crossbowImageP, unsigned long long, unsigned, unsigned);
+
 void crossbowImageReadFromMemory (crossbowImageP, void *, int);
 
 void crossbowImageReadFromFile (crossbowImageP, FILE *);
 
 void crossbowImageStartDecoding (crossbowImageP);
 
+void crossbowImageScale (crossbowImageP, int, int);
+
 void crossbowImageDecode (crossbowImageP);
 
+/* Decodes only the given window (top, left, height, width) of the image */
+void crossbowImageDecodeWindow (crossbowImageP, int, int, int, int);
+
 void crossbowImageCrop (crossbowImageP, int, int, int, int);
 
 void crossbowImageCast (crossbowImageP);
@@ -90,6 +121,23 @@ void crossbowImageSampleDistortedBoundingBox (crossbowImageP, crossbowArrayListP
 
 void crossbowImageResize (crossbowImageP, int, int);
 
+/*
+ * Fused transformations, from the decoded image straight to the normalised
+ * float representation of the expected output shape. Each output value is
+ * x * scale - shift, as if followed by crossbowImageMultiply and crossbowImageSubtract.
+ *
+ * ResizeAndCrop resizes the image and then crops it at (top, left);
+ * CropAndResize crops (height x width) at (top, left), optionally flips the
+ * result left-right, and then resizes it.
+ *
+ * If the image is not yet decoded, only the pixels the output depends on
+ * are decoded; ResizeAndCrop also decodes at a reduced DCT scale when the
+ * resized image is small enough.
+ */
+void crossbowImageResizeAndCrop (crossbowImageP, int, int, int, int, float, float);
+
+void crossbowImageCropAndResize (crossbowImageP, int, int, int, int, unsigned, float, float);
+
 void crossbowImageDistortColor (crossbowImageP);
 
 void crossbowImageRandomBrightness (crossbowImageP, float);
@@ -14,10 +14,80 @@ crossbowRecordP crossbowRecordCreate () {
     return p;
 }
 
+static void crossbowRecordFreeBoxes (crossbowRecordP p) {
+    int ndx;
+    crossbowBoundingBoxP box;
+    if (! p->boxes)
+        return;
+    /* Boxes of records parsed in place point into the mapped file */
+    if (! p->inplace) {
+        for (ndx = 0; ndx < crossbowArrayListSize(p->boxes); ++ndx) {
+            box = (crossbowBoundingBoxP) crossbowArrayListGet (p->boxes, ndx);
+            crossbowBoundingBoxFree (box);
+        }
+    }
+    crossbowArrayListFree (p->boxes);
+    p->boxes = NULL;
+    return;
+}
+
+/* Point the (reused) image object to the JPEG and read its header */
+static void crossbowRecordStartDecoding (crossbowRecordP p) {
+    /* Reuse the image object (and its decompressor and buffers), if any */
+    if (p->image)
+        crossbowImageReset (p->image);
+    else
+        p->image = crossbowImageCreate (3, 224, 224);
+    crossbowImageReadFromMemory (p->image, p->jpeg, p->bytes);
+    /* Read JPEG header only */
+    crossbowImageStartDecoding (p->image);
+    return;
+}
+
+/*
+ * Parse a record in place: bounding boxes and the JPEG image point into
+ * `data`, which must outlive the record's contents (e.g. a mapped file).
+ * The layout is the same as in crossbowRecordReadFromFile.
+ */
 void crossbowRecordReadFromMemory (crossbowRecordP p, void *data, int position) {
+
+    int ndx; /* Generic iterator */
+    int N;   /* Number of bounding boxes */
+
+    char *record;
+    char *cursor;
+
 	nullPointerException (p);
-	(void) data;
-    (void) position;
+	nullPointerException (data);
+
+    /* A record object may be reused: drop the previous record's boxes */
+    crossbowRecordFreeBoxes (p);
+
+    record = cursor = (char *) data + position;
+
+    /* Header fields are not necessarily aligned */
+    memcpy (&(p->length), cursor, 4); cursor += 4;
+    memcpy (&(p->label),  cursor, 4); cursor += 4;
+    /* Bounding boxes, if any, are stored as consecutive (xmin, ymin, xmax, ymax) floats */
+    memcpy (&N, cursor, 4); cursor += 4;
+    p->inplace = 1;
+    if (N > 0) {
+        p->boxes = crossbowArrayListCreate (N);
+        for (ndx = 0; ndx < N; ++ndx) {
+            crossbowArrayListSet (p->boxes, ndx, (void *) cursor);
+            cursor += sizeof(crossbow_bbox_t);
+        }
+    }
+    /* Image dimensions */
+    memcpy (&(p->height), cursor, 4); cursor += 4;
+    memcpy (&(p->width),  cursor, 4); cursor += 4;
+    /* JPEG image is the rest of the record */
+    p->jpeg = (unsigned char *) cursor;
+    p->bytes = p->length - (int) (cursor - record);
+    invalidConditionException(p->bytes > 0);
+
+    crossbowRecordStartDecoding (p);
+    return;
 }
 
 void crossbowRecordReadFromFile (crossbowRecordP p, FILE *file, int position) {
@@ -27,6 +97,10 @@ void crossbowRecordReadFromFile (crossbowRecordP p, FILE *file, int position) {
     int N;   /* Number of bounding boxes */
     
 	nullPointerException (p);
+
+    /* A record object may be reused: drop the previous record's boxes */
+    crossbowRecordFreeBoxes (p);
+    p->inplace = 0;
     
 	/* A reminder of how a record is laid out of disk:
      *
@@ -61,12 +135,18 @@ void crossbowRecordReadFromFile (crossbowRecordP p, FILE *file, int position) {
     /* Read image dimensions */
     nr = fread(&(p->height), 4, 1, file); invalidConditionException(nr == 1);
     nr = fread(&(p->width),  4, 1, file); invalidConditionException(nr == 1);
-    /* Read JPEG image */
-    p->image = crossbowImageCreate (3, 224, 224);
-    crossbowImageReadFromFile (p->image, file);
-    crossbowImageStartDecoding (p->image);
-    crossbowImageDecode (p->image);
-    crossbowImageCast (p->image);
+    /* Read JPEG image (the rest of the record) into memory; decoding is deferred */
+    p->bytes = p->length - (int) (ftell(file) - position);
+    invalidConditionException(p->bytes > 0);
+    if (p->capacity < p->bytes) {
+        if (p->buffer)
+            crossbowFree (p->buffer, p->capacity);
+        p->capacity = max(p->bytes, 2 * p->capacity);
+        p->buffer = (unsigned char *) crossbowMalloc (p->capacity);
+    }
+    p->jpeg = p->buffer;
+    nr = fread(p->jpeg, p->bytes, 1, file); invalidConditionException(nr == 1);
+    crossbowRecordStartDecoding (p);
     
 	fseek(file, position,  SEEK_SET); /* Reset file pointer to the beginning of this record */
 	fseek(file, p->length, SEEK_CUR); /* Increment pointer by record length */
@@ -106,19 +186,13 @@ int crossbowRecordLabelCopy (crossbowRecordP p, void *buffer, int offset, int li
 }
 
 void crossbowRecordFree (crossbowRecordP p) {
-    int ndx;
-    crossbowBoundingBoxP box;
     if (! p)
         return;
-    if (p->boxes) {
-        for (ndx = 0; ndx < crossbowArrayListSize(p->boxes); ++ndx) {
-            box = (crossbowBoundingBoxP) crossbowArrayListGet (p->boxes, ndx);
-            crossbowBoundingBoxFree (box);
-        }
-        crossbowArrayListFree (p->boxes);
-    }
+    crossbowRecordFreeBoxes (p);
     /* Free image */
     crossbowImageFree (p->image);
+    if (p->buffer)
+        crossbowFree (p->buffer, p->capacity);
     crossbowFree (p, sizeof(crossbow_record_t));
     return;
 }
@@ -13,11 +13,23 @@ typedef struct crossbow_record {
     crossbowArrayListP boxes;
     int height;
     int width;
+    /* Compressed image, decoded on demand */
+    unsigned char *jpeg;
+    int bytes;
+    /* Owned buffer for images read from a file */
+    unsigned char *buffer;
+    int capacity;
+    /* Boxes and image point into memory the record does not own */
+    unsigned inplace;
     crossbowImageP image;
 } crossbow_record_t;
 
 crossbowRecordP crossbowRecordCreate ();
 
+/*
+ * Reading into an existing record reuses its buffers and image object, so
+ * a long-lived record per thread takes the allocator off the decode path.
+ */
 void crossbowRecordReadFromMemory (crossbowRecordP, void *, int);
 
 void crossbowRecordReadFromFile (crossbowRecordP, FILE *, int);
@@ -23,7 +23,8 @@ void crossbowRecordFileOpen (crossbowRecordFileP p) {
 	if (p->opened)
 		return;
 #ifdef MAP_RECORDS
-	p->fd = open(p->filename, O_RDWR);
+	(void) i;
+	p->fd = open(p->filename, O_RDONLY);
 	if (p->fd < 0) {
 		fprintf(stderr, "error: failed to open %s\n", p->filename);
 		exit (1);
@@ -48,6 +49,10 @@ void crossbowRecordFileOpen (crossbowRecordFileP p) {
 #endif
 	crossbowRecordFileStat (p);
 	p->opened = 1;
+#ifdef MAP_RECORDS
+	/* All workers parse records in place, from a single mapping */
+	crossbowRecordFileMap (p);
+#endif
 }
 
 void crossbowRecordFileStat (crossbowRecordFileP p) {
@@ -71,12 +76,15 @@ void crossbowRecordFileMap (crossbowRecordFileP p) {
 #ifdef MAP_RECORDS
 	if (p->mapped)
 		return;
-	p->data = mmap(0, p->length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_NORESERVE, p->fd, 0);
+	p->data = mmap(0, p->length, PROT_READ, MAP_SHARED, p->fd, 0);
 	if (p->data == MAP_FAILED) {
 		fprintf(stderr, "error: failed to map %s\n", p->filename);
 		exit (1);
 	}
 	p->mapped = 1;
+	/* Access is sequential within a batch, but batches may jump across the file */
+	if (madvise(p->data, p->length, MADV_RANDOM) != 0)
+		err("Call to madvice() failed: %s\n", strerror(errno));
 #endif
 	return;
 }
@@ -92,11 +100,33 @@ void crossbowRecordFileAdviceWillNeed (crossbowRecordFileP p) {
 	return;
 }
 
+void crossbowRecordFileAdviceWillNeedRegion (crossbowRecordFileP p, int offset, int length) {
+	nullPointerException (p);
+#ifdef MAP_RECORDS
+	invalidConditionException(p->mapped);
+	invalidConditionException((offset >= 0) && (offset + length <= p->length));
+	/* Align start address to page boundary */
+	long pagesize = sysconf(_SC_PAGESIZE);
+	int start = offset - (offset % pagesize);
+	void *ptr = (void *) ((char *) (p->data) + start);
+	if (madvise(ptr, length + (offset - start), MADV_WILLNEED) != 0)
+		err("Call to madvice() failed: %s\n", strerror(errno));
+	p->needed = 1;
+#else
+	(void) offset;
+	(void) length;
+#endif
+	return;
+}
+
 int crossbowRecordFileHeader (crossbowRecordFileP p) {
 	int nr;
 	nullPointerException(p);
 #ifdef MAP_RECORDS
-	illegalStateException ();
+	(void) nr;
+	invalidConditionException (p->mapped);
+	invalidConditionException (p->length >= (int) __HEADER_SIZE);
+	memcpy (&(p->records), p->data, __HEADER_SIZE);
 #else
 	nr = fread(&(p->records), __HEADER_SIZE, 1, p->fp);
 	/* Read exactly one integer */
@@ -108,6 +138,113 @@ int crossbowRecordFileHeader (crossbowRecordFileP p) {
 	return p->records;
 }
 
+/*
+ * Load the cached index of the file, if there is one and it is not stale.
+ * Returns 1 on success.
+ */
+static unsigned crossbowRecordFileLoadIndex (crossbowRecordFileP p, const char *filename) {
+	FILE *fp;
+	struct stat sb, ib;
+	int header [2];
+	int nr;
+	if (stat(p->filename, &sb) < 0 || stat(filename, &ib) < 0)
+		return 0;
+	/* Rebuild the index if the record file has been modified since */
+	if (ib.st_mtime < sb.st_mtime)
+		return 0;
+	if (ib.st_size != (off_t) ((p->records + 3) * sizeof(int)))
+		return 0;
+	fp = fopen(filename, "rb");
+	if (! fp)
+		return 0;
+	nr = fread(header, sizeof(int), 2, fp);
+	if (nr != 2 || header[0] != p->records || header[1] != p->length) {
+		fclose(fp);
+		return 0;
+	}
+	nr = fread(p->index, sizeof(int), p->records + 1, fp);
+	fclose(fp);
+	if (nr != (p->records + 1))
+		return 0;
+	return (p->index[0] == __HEADER_SIZE && p->index[p->records] == p->length);
+}
+
+static void crossbowRecordFileStoreIndex (crossbowRecordFileP p, const char *filename) {
+	FILE *fp;
+	int header [2] = { p->records, p->length };
+	int nw = 0;
+	fp = fopen(filename, "wb");
+	if (fp) {
+		nw += fwrite(header, sizeof(int), 2, fp);
+		nw += fwrite(p->index, sizeof(int), p->records + 1, fp);
+		fclose(fp);
+	}
+	/* Not fatal: the index will be rebuilt next time */
+	if (nw != (p->records + 3)) {
+		info("Warning: failed to write index file %s\n", filename);
+		unlink(filename);
+	}
+	return;
+}
+
+void crossbowRecordFileIndex (crossbowRecordFileP p) {
+	int ndx;
+	int position;
+	int length;
+	char *filename;
+	nullPointerException(p);
+	invalidConditionException (p->records > 0);
+	if (p->index)
+		return;
+	p->index = (int *) crossbowMalloc ((p->records + 1) * sizeof(int));
+	filename = crossbowStringConcat ("%s.index", p->filename);
+	if (! crossbowRecordFileLoadIndex (p, filename)) {
+		info("Indexing %d records in %s\n", p->records, p->filename);
+#ifndef MAP_RECORDS
+		long current = ftell (p->fp);
+#endif
+		/* Hop from record to record; the first field of a record is its length */
+		position = __HEADER_SIZE;
+		for (ndx = 0; ndx < p->records; ++ndx) {
+			invalidConditionException (position + 4 <= p->length);
+#ifdef MAP_RECORDS
+			memcpy (&length, (char *) p->data + position, 4);
+#else
+			fseek (p->fp, position, SEEK_SET);
+			if (fread(&length, 4, 1, p->fp) != 1) {
+				fprintf(stderr, "error: failed to index %s\n", p->filename);
+				exit (1);
+			}
+#endif
+			invalidConditionException((length > 0) && (position + length <= p->length));
+			p->index[ndx] = position;
+			position += length;
+		}
+		invalidConditionException (position == p->length);
+		p->index[p->records] = position;
+#ifndef MAP_RECORDS
+		fseek (p->fp, current, SEEK_SET);
+#endif
+		crossbowRecordFileStoreIndex (p, filename);
+	}
+	crossbowStringFree (filename);
+	return;
+}
+
+int crossbowRecordFileRecordPosition (crossbowRecordFileP p, int ndx) {
+	nullPointerException(p);
+	nullPointerException(p->index);
+	invalidArgumentException ((ndx >= 0) && (ndx < p->records));
+	return p->index[ndx];
+}
+
+int crossbowRecordFileRecordLength (crossbowRecordFileP p, int ndx) {
+	nullPointerException(p);
+	nullPointerException(p->index);
+	invalidArgumentException ((ndx >= 0) && (ndx < p->records));
+	return (p->index[ndx + 1] - p->index[ndx]);
+}
+
 int crossbowRecordFilePosition (crossbowRecordFileP p) {
 	nullPointerException(p);
 	invalidConditionException (p->opened);
@@ -139,10 +276,10 @@ void crossbowRecordFileReset (crossbowRecordFileP p, unsigned clear) {
 	if (clear) {
 		/*
 		 * If there are more than 1 files in the dataset,
-		 * "clear" this file from memory.
+		 * "clear" this file from memory. The file stays
+		 * mapped, since decoders may still be reading it.
 		 */
-		crossbowRecordFileAdviceWillNotNeed (p);
-		crossbowRecordFileUnmap (p);
+		crossbowRecordFileAdviceDontNeed (p);
 	}
 #else
 	(void) clear;
@@ -154,11 +291,11 @@ void crossbowRecordFileReset (crossbowRecordFileP p, unsigned clear) {
 void crossbowRecordFileRead (crossbowRecordFileP p, crossbowRecordP record) {
 	nullPointerException (p);
 #ifdef MAP_RECORDS
-	illegalStateException ();
-    if (crossbowRecordFilePosition(p) == 0) /* Skip header */
-        p->offset += __HEADER_SIZE;
-	/* crossbowRecordReadFromMemory (record, p->data, crossbowRecordFilePosition(p)); */
-    /* Explicitly move file pointer */
+	if (crossbowRecordFilePosition(p) == 0) /* Skip header */
+		p->offset += __HEADER_SIZE;
+	crossbowRecordReadFromMemory (record, p->data, crossbowRecordFilePosition(p));
+	/* Explicitly move file pointer */
+	p->offset += record->length;
 #else
 	if (crossbowRecordFilePosition(p) == 0) /* Skip header */
 		fseek (p->fp, __HEADER_SIZE, SEEK_CUR);
@@ -173,8 +310,19 @@ int crossbowRecordFileNextPointer (crossbowRecordFileP p) {
     int length;
     nullPointerException (p);
 #ifdef MAP_RECORDS
-    illegalStateException ();
-    return 0;
+    (void) nr;
+    if (crossbowRecordFilePosition(p) == 0) /* Skip header */
+        p->offset += __HEADER_SIZE;
+
+    position = crossbowRecordFilePosition(p);
+
+    /* Read record length */
+    memcpy (&length, (char *) p->data + position, 4);
+    invalidConditionException((length > 0) && (position + length <= p->length));
+
+    p->offset += length;
+
+    return position;
 #else
     if (crossbowRecordFilePosition(p) == 0) /* Skip header */
         fseek (p->fp, __HEADER_SIZE, SEEK_CUR);
@@ -195,13 +343,18 @@ int crossbowRecordFileNextPointer (crossbowRecordFileP p) {
 void crossbowRecordFileReadSafely (crossbowRecordFileP p, int id, int position, crossbowRecordP record) {
     nullPointerException(p);
 #ifdef MAP_RECORDS
-    illegalStateException ();
+    /* No per-worker state: records are parsed in place */
+    (void) id;
+    invalidConditionException (position < p->length);
+    crossbowRecordReadFromMemory (record, p->data, position);
 #else
-    /* info("Read from %p (worker %d) at position %d\n", p->f[id], id, position); */
-    nullPointerException (p->f[id]);
+    /* With a single worker, there are no per-worker file handles */
+    FILE *fp = (p->f) ? p->f[id] : p->fp;
+    /* info("Read from %p (worker %d) at position %d\n", fp, id, position); */
+    nullPointerException (fp);
     invalidConditionException (position < p->length);
-    fseek (p->f[id], position, SEEK_SET);
-    crossbowRecordReadFromFile (record, p->f[id], position);
+    fseek (fp, position, SEEK_SET);
+    crossbowRecordReadFromFile (record, fp, position);
 #endif
     return;
 }
@@ -235,6 +388,7 @@ void crossbowRecordFileClose (crossbowRecordFileP p) {
 	if (! p->opened)
 		return;
 #ifdef MAP_RECORDS
+	(void) i;
 	close (p->fd);
 #else
 	fclose (p->fp);
@@ -253,6 +407,8 @@ void crossbowRecordFileFree (crossbowRecordFileP p) {
 		return;
 	crossbowRecordFileUnmap (p);
 	crossbowRecordFileClose (p);
+	if (p->index)
+		crossbowFree (p->index, (p->records + 1) * sizeof(int));
 	crossbowStringFree (p->filename);
 	crossbowFree (p, sizeof(crossbow_record_file_t));
 }
@@ -16,6 +16,15 @@
 
 #include <errno.h>
 
+/*
+ * By default, records are parsed in place from a read-only mapping of the
+ * file, which all decoder threads share. Define STDIO_RECORDS to read them
+ * with `fread` instead (one FILE handle per worker).
+ */
+#ifndef STDIO_RECORDS
+#define MAP_RECORDS
+#endif
+
 typedef struct crossbow_record_file *crossbowRecordFileP;
 typedef struct crossbow_record_file {
 	char *filename;
@@ -40,6 +49,11 @@ typedef struct crossbow_record_file {
 	int length;
 	/* The total number of records in the file (stored in file header) */
 	int records;
+	/*
+	 * Offset of every record in the file, plus the file length (i.e.
+	 * `records + 1` entries). Built on demand; see crossbowRecordFileIndex.
+	 */
+	int *index;
 	unsigned opened;
 	int counter;
 } crossbow_record_file_t;
@@ -54,8 +68,24 @@ void crossbowRecordFileMap (crossbowRecordFileP);
 
 void crossbowRecordFileAdviceWillNeed (crossbowRecordFileP);
 
+/* Start reading ahead the given byte range, e.g. the records of an upcoming batch */
+void crossbowRecordFileAdviceWillNeedRegion (crossbowRecordFileP, int, int);
+
 int crossbowRecordFileHeader (crossbowRecordFileP);
 
+/*
+ * Build the record offset index of the file. The index is cached next to
+ * the file, as `<filename>.index`, so that it is only built once: it holds
+ * the number of records, the file length, and the `records + 1` offsets.
+ * Must be called after crossbowRecordFileHeader.
+ */
+void crossbowRecordFileIndex (crossbowRecordFileP);
+
+/* The position and length of the i-th record in the file (requires an index) */
+int crossbowRecordFileRecordPosition (crossbowRecordFileP, int);
+
+int crossbowRecordFileRecordLength (crossbowRecordFileP, int);
+
 int crossbowRecordFilePosition (crossbowRecordFileP);
 
 int crossbowRecordFileRemaining (crossbowRecordFileP);
@@ -5,19 +5,15 @@
 #include "../debug.h"
 #include "../utils.h"
 
-#include "../arraylist.h"
-
 #include "../timer.h"
 
-#include <pthread.h>
+#include <sched.h>
 
 /*
  * Perform the kind of pre-processing for test images
  */
 static void preprocessTestRecord (crossbowRecordP record, unsigned verbose) {
 
-	crossbowImageCast (record->image);
-
 	/* Resize image */
 
 	float h = (float) crossbowImageInputHeight (record->image);
@@ -33,17 +29,13 @@ static void preprocessTestRecord (crossbowRecordP record, unsigned verbose) {
 	if (verbose > 0)
 		printf("Resized image to (%d x %d)\n", resizeheight, resizewidth);
 
-	crossbowImageResize (record->image, resizeheight, resizewidth);
-	
-	if (verbose > 0)
-		printf("Checksum of resized image is %.4f\n", crossbowImageChecksum (record->image));
-
 	/* Crop image */
 
 	int top  = (resizeheight - 224) / 2;
 	int left = (resizewidth  - 224) / 2;
 
-	crossbowImageCrop (record->image, 224, 224, top, left);
+	/* Resize and crop in a single pass over the decoded image */
+	crossbowImageResizeAndCrop (record->image, resizeheight, resizewidth, top, left, 1, 0);
 	
 	if (verbose > 0)
 		printf("Checksum of cropped image is %.4f\n", crossbowImageChecksum (record->image));
@@ -51,48 +43,219 @@ static void preprocessTestRecord (crossbowRecordP record, unsigned verbose) {
 }
 
 /*
- * A worker thread
+ * Decode a single record; called by decoder pool worker `id`
  */
-static void *handle (void *args) {
-    
-    /*
-     * The argument to each thread is an array list of tasks.
-     * Handle it appropriately.
-     */
-    crossbowArrayListP list = (crossbowArrayListP) args;
-    crossbowRecordReaderTaskP task = crossbowArrayListGet (list, 0);
-    
-    /* Pin thread to a particular core based on worker id */
-
-    cpu_set_t set;
-    int core = 2 + task->id;
-    CPU_ZERO (&set);
-    CPU_SET  (core, &set);
-    sched_setaffinity (0, sizeof(set), &set);
-    dbg("Decoder #%02d pinned on core %02d\n", task->id, core);
-    
-    /* Iterate over list of tasks */
-    int idx;
-    for (idx = 0; idx < crossbowArrayListSize (list); ++idx) {
-        task = crossbowArrayListGet (list, idx);
-        /* Create new record */
-        crossbowRecordP record = crossbowRecordCreate ();
-        /* Read record (thread-safe version) */
-        crossbowRecordFileReadSafely (task->file, task->id, task->position, record);
-        /* Pre-process record */
-        preprocessTestRecord (record, 0);
-        /* Copy decoded (augmented) image to buffer */
-        crossbowImageCopy (record->image, task->buffer[0], task->offset[0], 0); /* Ignore limit */
-        /* Copy label */
-        if (task->buffer[1])
-        	crossbowRecordLabelCopy (record, task->buffer[1], task->offset[1], 0); /* Ignore limit */
-        /* Free record */
-        crossbowRecordFree (record);
+static void handle (int id, void *args) {
+
+    crossbowRecordReaderTaskP task = (crossbowRecordReaderTaskP) args;
+    /* The worker id selects the file handle to read from, and the record to read into */
+    task->id = id;
+    crossbowRecordP record = task->reader->arena[id];
+    /* Read record (thread-safe version) */
+    crossbowRecordFileReadSafely (task->file, task->id, task->position, record);
+    /* Augmentations depend only on the example, not on the worker */
+    crossbowImageSeed (record->image, task->reader->seed, task->epoch, task->example);
+    /* Pre-process record */
+    preprocessTestRecord (record, 0);
+    /* Copy decoded (augmented) image to buffer */
+    crossbowImageCopy (record->image, task->buffer[0], task->offset[0], 0); /* Ignore limit */
+    /* Copy label */
+    if (task->buffer[1])
+    	crossbowRecordLabelCopy (record, task->buffer[1], task->offset[1], 0); /* Ignore limit */
+    return;
+}
+
+/*
+ * SplitMix64: a small generator that is cheap to seed, so that the order
+ * of every epoch can be derived from the seed and the epoch number alone.
+ */
+static inline unsigned long long crossbowRecordReaderRandom (unsigned long long *state) {
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/*
+ * Permute all records of the dataset (Fisher-Yates) and keep this reader's
+ * shard of the permutation
+ */
+static void crossbowRecordReaderShuffleEpoch (crossbowRecordReaderP p, int epoch) {
+
+    int i, j, k, t;
+    unsigned long long state = (((unsigned long long) p->seed) << 32) | ((unsigned) epoch);
+
+    for (i = 0; i < p->records; ++i)
+        p->permutation[i] = i;
+
+    for (i = p->records - 1; i > 0; --i) {
+        j = (int) (crossbowRecordReaderRandom (&state) % ((unsigned long long) (i + 1)));
+        t = p->permutation[i];
+        p->permutation[i] = p->permutation[j];
+        p->permutation[j] = t;
+    }
+
+    for (i = p->shard, k = 0; i < p->records; i += p->shards)
+        p->order[k++] = p->permutation[i];
+    invalidConditionException (k == p->size);
+
+    p->cursor = 0;
+    p->ahead = 0;
+    return;
+}
+
+/* Find the file (and the index therein) of a record, given its global id */
+static crossbowRecordFileP crossbowRecordReaderLocate (crossbowRecordReaderP p, int id, int *ndx) {
+    int lo = 0;
+    int hi = crossbowListSize (p->dataset) - 1;
+    int mid;
+    while (lo < hi) {
+        mid = (lo + hi + 1) / 2;
+        if (p->first[mid] <= id)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    *ndx = id - p->first[lo];
+    return p->files[lo];
+}
+
+/*
+ * Advise the OS to read ahead the records of the next `count` positions in
+ * the shuffled order, unless they have been advised already. Records are
+ * scattered across the files, so each one is a separate region.
+ */
+static void crossbowRecordReaderReadAhead (crossbowRecordReaderP p, int count) {
+    int ndx;
+    crossbowRecordFileP file;
+    int end = min (p->cursor + count, p->size);
+    for (; p->ahead < end; p->ahead++) {
+        file = crossbowRecordReaderLocate (p, p->order[p->ahead], &ndx);
+        crossbowRecordFileAdviceWillNeedRegion (file, crossbowRecordFileRecordPosition (file, ndx), crossbowRecordFileRecordLength (file, ndx));
+    }
+    return;
+}
+
+/*
+ * Create a decoding job of `count` tasks. Offsets advance by `size`, plus
+ * `padding` at the end of every batch of `b` items. Must be called by the
+ * thread that owns the reader, since it moves the reader's file pointers.
+ */
+static crossbowRecordReaderRequestP crossbowRecordReaderRequestCreate (crossbowRecordReaderP p,
+    int count,
+    int *size,
+    int b,
+    int *padding,
+    void *images,
+    void *labels,
+    int *limit,
+    crossbowDecoderJobCallback callback,
+    void *args) {
+
+    int ndx;
+    int counter;
+    int offset [2];
+
+    crossbowRecordReaderTaskP task;
+
+    /* The contiguous range of records read so far, to be read ahead */
+    crossbowRecordFileP window = NULL;
+    int start = 0, end = 0;
+
+    crossbowRecordReaderRequestP request = (crossbowRecordReaderRequestP) crossbowMalloc (sizeof(crossbow_record_reader_request_t));
+    request->tasks = (crossbowRecordReaderTaskP) crossbowMalloc (count * sizeof(crossbow_record_reader_task_t));
+    request->count = count;
+    request->job = crossbowDecoderJobCreate (count, callback, args);
+    request->callback = NULL;
+    request->args = NULL;
+    request->timer = NULL;
+
+    /* Write offset for output buffer */
+    offset[0] = offset[1] = 0;
+    counter = 0;
+
+    for (ndx = 0; ndx < count; ++ndx) {
+
+        task = &(request->tasks[ndx]);
+
+        /* Fill-in task */
+        task->id = -1; /* Set by the worker that decodes it */
+        task->jc = p->jc;
+        task->reader = p;
+
+        task->counter = (++counter);
+
+        /* Find next read pointer */
+        task->file = crossbowRecordReaderNextPointer (p, &(task->position));
+
+        task->epoch = p->wraps;
+        task->example = p->counter++;
+
+        if (! p->shuffle) {
+            if (task->file != window || task->position != end) {
+                if (window)
+                    crossbowRecordFileAdviceWillNeedRegion (window, start, end - start);
+                window = task->file;
+                start = task->position;
+            }
+            end = crossbowRecordFilePosition (task->file);
+        }
+
+        task->buffer[0] = images;
+        task->buffer[1] = labels;
+
+        task->offset[0] = offset [0];
+        task->offset[1] = offset [1];
+
+        dbg("Item #%04d: image offset %10d size %6d limit %10d\n", counter, offset[0], size[0], limit[0]);
+
+        invalidConditionException ((offset[0] + size[0]) <= limit[0]);
+        if (labels)
+            invalidConditionException ((offset[1] + size[1]) <= limit[1]);
+
+        request->job->items[ndx] = (void *) task;
+
+        /* Increment offset */
+        offset[0] += size[0] + ((counter % b == 0) ? padding[0] : 0);
+        if (labels)
+            offset[1] += size[1] + ((counter % b == 0) ? padding[1] : 0);
     }
-    return args;
+    /* Ask the OS to start reading the batch's records, before decoders fault them in */
+    if (window)
+        crossbowRecordFileAdviceWillNeedRegion (window, start, end - start);
+    /* In shuffled order, also read ahead the records of the next batch */
+    if (p->shuffle)
+        crossbowRecordReaderReadAhead (p, count);
+    return request;
+}
+
+static void crossbowRecordReaderRequestFree (crossbowRecordReaderRequestP request) {
+    crossbowDecoderJobFree (request->job);
+    crossbowFree (request->tasks, request->count * sizeof(crossbow_record_reader_task_t));
+    if (request->timer)
+        crossbowTimerFree (request->timer);
+    crossbowFree (request, sizeof(crossbow_record_reader_request_t));
+    return;
+}
+
+/*
+ * Completion of an asynchronous read, invoked by the last decoder
+ */
+static void crossbowRecordReaderRequestComplete (void *args) {
+
+    crossbowRecordReaderRequestP request = (crossbowRecordReaderRequestP) args;
+
+    tstamp_t dt = crossbowTimerElapsedTime (request->timer);
+    info("%d images processed in %llu usecs\n", request->count, dt);
+
+    request->callback (request->args);
+
+    crossbowRecordReaderRequestFree (request);
+    return;
 }
 
 crossbowRecordReaderP crossbowRecordReaderCreate (int workers) {
+    int id;
     crossbowRecordReaderP p = NULL;
     p = (crossbowRecordReaderP) crossbowMalloc (sizeof(crossbow_record_reader_t));
     p->dataset = crossbowListCreate ();
@@ -104,6 +267,22 @@ crossbowRecordReaderP crossbowRecordReaderCreate (int workers) {
     p->finalised = 0;
     p->workers = workers;
     p->jc = 0;
+    p->pool = NULL;
+    p->shuffle = 0;
+    p->seed = 0;
+    p->shard = 0;
+    p->shards = 1;
+    p->files = NULL;
+    p->first = NULL;
+    p->permutation = NULL;
+    p->order = NULL;
+    p->size = 0;
+    p->cursor = 0;
+    p->ahead = 0;
+    /* Records are reused across reads, one per worker */
+    p->arena = (crossbowRecordP *) crossbowMalloc (workers * sizeof(crossbowRecordP));
+    for (id = 0; id < workers; ++id)
+        p->arena[id] = crossbowRecordCreate ();
     return p;
 }
 
@@ -123,11 +302,19 @@ void crossbowRecordReaderRegister (crossbowRecordReaderP p, const char *filename
 void crossbowRecordReaderFinalise (crossbowRecordReaderP p) {
 
 	int records;
+	int files, ndx;
 
 	nullPointerException(p);
 	invalidConditionException (! (p->finalised));
 
+	files = crossbowListSize (p->dataset);
+	if (p->shuffle) {
+		p->files = (crossbowRecordFileP *) crossbowMalloc (files * sizeof(crossbowRecordFileP));
+		p->first = (int *) crossbowMalloc (files * sizeof(int));
+	}
+
 	/* Iterate over files in dataset and extract number of records */
+	ndx = 0;
 	crossbowListIteratorReset (p->dataset);
 	while (crossbowListIteratorHasNext(p->dataset)) {
 
@@ -136,14 +323,32 @@ void crossbowRecordReaderFinalise (crossbowRecordReaderP p) {
 		/* Read file header */
 		records = crossbowRecordFileHeader (p->current);
 		invalidConditionException(records > 0);
+		if (p->shuffle) {
+			/* Shuffled iteration jumps to records by offset */
+			crossbowRecordFileIndex (p->current);
+			p->files[ndx] = p->current;
+			p->first[ndx] = p->records;
+			ndx ++;
+		}
 		/* Accumulate number of records */
 		p->records += records;
 	}
 	invalidConditionException(p->records > 0);
-	info("%d records in %d file%s\n", p->records, crossbowListSize(p->dataset), (crossbowListSize(p->dataset) > 1 ? "s" : ""));
+	info("%d records in %d file%s\n", p->records, files, (files > 1 ? "s" : ""));
+	if (p->shuffle) {
+		p->size = (p->records - p->shard + p->shards - 1) / p->shards;
+		invalidConditionException(p->size > 0);
+		p->permutation = (int *) crossbowMalloc (p->records * sizeof(int));
+		p->order = (int *) crossbowMalloc (p->size * sizeof(int));
+		crossbowRecordReaderShuffleEpoch (p, 0);
+		info("Shuffle records with seed %u (shard %d of %d, %d records)\n", p->seed, p->shard, p->shards, p->size);
+	}
 	/* Reset file iterator */
 	crossbowListIteratorReset (p->dataset);
 	p->current = (crossbowRecordFileP) crossbowListIteratorNext (p->dataset);
+	/* Start decoder threads; they live as long as the reader */
+	if (p->workers > 1)
+		p->pool = crossbowDecoderPoolCreate (p->workers, 2 + p->jc, handle);
 	/* Finalise record reader */
 	p->finalised = 1;
 	return;
@@ -156,6 +361,18 @@ void crossbowRecordReaderRepeat (crossbowRecordReaderP p, int limit) {
 	p->limit = limit;
 }
 
+void crossbowRecordReaderShuffle (crossbowRecordReaderP p, unsigned seed, int shard, int shards) {
+	nullPointerException(p);
+	invalidConditionException (! (p->finalised));
+	invalidArgumentException (shards > 0);
+	invalidArgumentException ((shard >= 0) && (shard < shards));
+	p->shuffle = 1;
+	p->seed = seed;
+	p->shard = shard;
+	p->shards = shards;
+	return;
+}
+
 unsigned crossbowRecordReaderHasNext (crossbowRecordReaderP p) {
 	nullPointerException(p);
 	invalidConditionException (p->finalised);
@@ -168,6 +385,10 @@ unsigned crossbowRecordReaderHasNext (crossbowRecordReaderP p) {
 	if ((p->wraps + 1) < p->limit)
 		return 1;
 
+	/* In shuffled order, the last epoch ends with this shard's records */
+	if (p->shuffle)
+		return (p->cursor < p->size);
+
 	/* The iterator is about to hit `p->limit`, so check if `current` is the last file */
 	if (p->current != crossbowListPeekTail (p->dataset))
 		return 1;
@@ -181,9 +402,18 @@ unsigned crossbowRecordReaderHasNext (crossbowRecordReaderP p) {
 }
 
 void crossbowRecordReaderNext (crossbowRecordReaderP p, crossbowRecordP record) {
+	int position;
+	crossbowRecordFileP file;
 	nullPointerException(p);
 	invalidConditionException (p->finalised);
 
+	if (p->shuffle) {
+		file = crossbowRecordReaderNextPointer (p, &position);
+		crossbowRecordFileReadSafely (file, 0, position, record);
+		crossbowImageSeed (record->image, p->seed, p->wraps, p->counter++);
+		return;
+	}
+
 	if (! crossbowRecordFileHasRemaining (p->current)) {
 		/* Reset current file */
 		crossbowRecordFileReset (p->current, (crossbowListSize(p->dataset) != 1));
@@ -196,12 +426,26 @@ void crossbowRecordReaderNext (crossbowRecordReaderP p, crossbowRecordP record)
 	}
 	/* Read a record from `p->current` file */
 	crossbowRecordFileRead (p->current, record);
+	crossbowImageSeed (record->image, p->seed, p->wraps, p->counter++);
     return;
 }
 
 crossbowRecordFileP crossbowRecordReaderNextPointer (crossbowRecordReaderP p, int *position) {
+    int ndx;
+    crossbowRecordFileP file;
     nullPointerException(p);
     invalidConditionException (p->finalised);
+
+    if (p->shuffle) {
+        if (p->cursor == p->size) {
+            /* Start a new epoch, in a new order */
+            p->wraps ++;
+            crossbowRecordReaderShuffleEpoch (p, p->wraps);
+        }
+        file = crossbowRecordReaderLocate (p, p->order[p->cursor++], &ndx);
+        *position = crossbowRecordFileRecordPosition (file, ndx);
+        return file;
+    }
     
     if (! crossbowRecordFileHasRemaining (p->current)) {
         /* Reset current file */
@@ -227,17 +471,8 @@ void crossbowRecordReaderRead (crossbowRecordReaderP p,
     void *buffer,
     int limit) {
     
-    int id;
-    int counter;
     int ndx;
     int offset;
-    int partition;
-    
-    crossbowRecordFileP file;
-    int position;
-    
-    crossbowArrayListP list;
-    crossbowRecordReaderTaskP task;
     
     nullPointerException (p);
     invalidConditionException (p->finalised);
@@ -246,86 +481,27 @@ void crossbowRecordReaderRead (crossbowRecordReaderP p,
         
         /* Multi-threaded version */
         dbg("Decode %d examples with %d workers\n", count, p->workers);
-        
-        /* Create worker pool */
-        pthread_t *pool = (pthread_t *) crossbowMalloc (p->workers * sizeof(pthread_t));
-        
-        /* Split work (number of tasks per worker) */
-        invalidConditionException ((count % p->workers) == 0);
-        partition = count / p->workers;
-        
-        /* Write offset for output buffer */
-        offset  = 0;
-        counter = 0;
-        for (id = 0; id < p->workers; ++id) {
-            
-            /* Create list of tasks for worker */
-            list = crossbowArrayListCreate (partition);
-            
-            /* Populate list */
-            for (ndx = 0; ndx < partition; ++ndx) {
-                /* Find next read pointer */
-                file = crossbowRecordReaderNextPointer (p, &position);
-                /* Create new task */
-                task = crossbowMalloc (sizeof(crossbow_record_reader_task_t));
-                /* Fill-in task */
-                task->id = id;
-                task->jc = p->jc;
-
-                task->counter = (++counter);
-                
-                task->file = file;
-                task->position = position;
-                
-                task->buffer[0] = buffer;
-                task->buffer[1] = NULL;
-
-                task->offset[0] = offset;
-                task->offset[1] = 0;
-
-                invalidConditionException ((offset + size) <= limit);
-                
-                /* Append to list */
-                crossbowArrayListSet (list, ndx, task);
-                
-                /* Increment offset */
-                offset += size;
-            }
-            
-            /* Create worker thread */
-            pthread_create (&(pool[id]), NULL, handle, (void *) list);
-        }
-        
-        for (id = 0; id < p->workers; ++id) {
-            /* Wait worker to finish */
-            pthread_join(pool[id], (void **) &list);
-            /* Free list of tasks for worker */
-            for (ndx = 0; ndx < partition; ++ndx) {
-                task = crossbowArrayListGet (list, ndx);
-                crossbowFree (task, sizeof(crossbow_record_reader_task_t));
-            }
-            crossbowArrayListFree (list);
-        }
-        
-        crossbowFree (pool, (p->workers * sizeof(pthread_t)));
+
+        int  sizes [2] = { size, 0 };
+        int  pads  [2] = { 0, 0 };
+        int limits [2] = { limit, 0 };
+
+        crossbowRecordReaderRequestP request = crossbowRecordReaderRequestCreate (p, count, sizes, 1, pads, buffer, NULL, limits, NULL, NULL);
+        crossbowDecoderPoolSubmitAndWait (p->pool, request->job);
+        crossbowRecordReaderRequestFree (request);
     }
     else {
         /* Single-threaded version */
         
         offset  = 0;
-        counter = 0;
+        crossbowRecordP record = p->arena[0];
         for (ndx = 0; ndx < count; ++ndx) {
-            counter ++;
-            /* Allocate new record */
-            crossbowRecordP record = crossbowRecordCreate ();
             /* Read record and decode image therein */
             crossbowRecordReaderNext (p, record);
             /* Preprocess record */
             preprocessTestRecord (record, 0);
             /* Copy decoded image to buffer */
             offset += crossbowImageCopy (record->image, buffer, offset, limit);
-            /* Free record */
-            crossbowRecordFree (record);
         }
     }
 }
@@ -339,18 +515,7 @@ void crossbowRecordReaderReadProperly (crossbowRecordReaderP p,
 	void *labels,
     int *limit) {
 
-    int id;
-    int counter;
-    int ndx;
-    int offset [2];
-
-    int partition;
-
-    crossbowRecordFileP file;
-    int position;
-
-    crossbowArrayListP list;
-    crossbowRecordReaderTaskP task;
+    crossbowRecordReaderRequestP request;
 
     crossbowTimerP timer = crossbowTimerCreate ();
     crossbowTimerStart (timer);
@@ -360,89 +525,65 @@ void crossbowRecordReaderReadProperly (crossbowRecordReaderP p,
 
     invalidConditionException (p->workers > 1);
 
-	/* Create worker pool */
-	pthread_t *pool = (pthread_t *) crossbowMalloc (p->workers * sizeof(pthread_t));
-
-	/* Split work equally among workers (number of tasks per worker) */
-	invalidConditionException ((count % p->workers) == 0);
-	partition = count / p->workers;
-
-	/* Ensure that each worker write one or more complete batches */
-	invalidConditionException ((partition % b) == 0);
-
-	/* Write offset for output buffer */
-	offset[0] = offset[1] = 0;
-	counter = 0;
-
-	for (id = 0; id < p->workers; ++id) {
-
-		/* Create list of tasks for worker */
-		list = crossbowArrayListCreate (partition);
-
-		/* Populate list */
-		for (ndx = 0; ndx < partition; ++ndx) {
+	request = crossbowRecordReaderRequestCreate (p, count, size, b, padding, images, labels, limit, NULL, NULL);
+	crossbowDecoderPoolSubmitAndWait (p->pool, request->job);
+	crossbowRecordReaderRequestFree (request);
 
-			/* Find next read pointer */
-			file = crossbowRecordReaderNextPointer (p, &position);
-			/* Create new task */
-			task = crossbowMalloc (sizeof(crossbow_record_reader_task_t));
-			/* Fill-in task */
-			task->id = id;
-			task->jc = p->jc;
-
-			task->counter = (++counter);
-
-			task->file = file;
-			task->position = position;
-
-			task->buffer[0] = images;
-			task->buffer[1] = labels;
-
-			task->offset[0] = offset [0];
-			task->offset[1] = offset [1];
-
-			dbg("Item #%04d: image offset %10d size %6d limit %10d\n", counter, offset[0], size[0], limit[0]);
-			dbg("          : label offset %10d size %6d limit %10d\n",          offset[1], size[1], limit[1]);
+	tstamp_t dt = crossbowTimerElapsedTime (timer);
+	info("%d images processed in %llu usecs\n", count, dt);
+	crossbowTimerFree (timer);
 
-			invalidConditionException ((offset[0] + size[0]) <= limit[0]);
-			invalidConditionException ((offset[1] + size[1]) <= limit[1]);
+	return;
+}
 
-			/* Append to list */
-			crossbowArrayListSet (list, ndx, task);
+void crossbowRecordReaderReadProperlyAsync (crossbowRecordReaderP p,
+    int count,
+    int *size,
+	int b,
+	int *padding,
+    void *images,
+	void *labels,
+    int *limit,
+	crossbowDecoderJobCallback callback,
+	void *args) {
 
-			/* Increment offset */
-			offset[0] += size[0] + ((counter % b == 0) ? padding[0] : 0);
-			offset[1] += size[1] + ((counter % b == 0) ? padding[1] : 0);
-		}
+    crossbowRecordReaderRequestP request;
 
-		/* Create worker thread */
-		pthread_create (&(pool[id]), NULL, handle, (void *) list);
-	}
+    nullPointerException (p);
+    nullPointerException (callback);
+    invalidConditionException (p->finalised);
 
-	for (id = 0; id < p->workers; ++id) {
-		/* Wait worker to finish */
-		pthread_join(pool[id], (void **) &list);
-		/* Free list of tasks for worker */
-		for (ndx = 0; ndx < partition; ++ndx) {
-			task = crossbowArrayListGet (list, ndx);
-			crossbowFree (task, sizeof(crossbow_record_reader_task_t));
-		}
-		crossbowArrayListFree (list);
-	}
+    invalidConditionException (p->workers > 1);
 
-	crossbowFree (pool, (p->workers * sizeof(pthread_t)));
+	request = crossbowRecordReaderRequestCreate (p, count, size, b, padding, images, labels, limit, crossbowRecordReaderRequestComplete, NULL);
+	request->job->args = (void *) request;
+	request->callback = callback;
+	request->args = args;
 
-	tstamp_t dt = crossbowTimerElapsedTime (timer);
-	info("%d images processed in %llu usecs\n", count, dt);
-	crossbowTimerFree (timer);
+	request->timer = crossbowTimerCreate ();
+	crossbowTimerStart (request->timer);
 
+	/* From now on, the request belongs to the decoder pool */
+	crossbowDecoderPoolSubmit (p->pool, request->job);
 	return;
-
 }
 
 void crossbowRecordReaderFree (crossbowRecordReaderP p) {
+    int id;
     if (! p)
         return;
+    /* Wait for pending reads, since they use the dataset files */
+    if (p->pool)
+        crossbowDecoderPoolFree (p->pool);
+    for (id = 0; id < p->workers; ++id)
+        crossbowRecordFree (p->arena[id]);
+    crossbowFree (p->arena, p->workers * sizeof(crossbowRecordP));
+    if (p->shuffle && p->finalised) {
+        crossbowFree (p->files, crossbowListSize (p->dataset) * sizeof(crossbowRecordFileP));
+        crossbowFree (p->first, crossbowListSize (p->dataset) * sizeof(int));
+        crossbowFree (p->permutation, p->records * sizeof(int));
+        crossbowFree (p->order, p->size * sizeof(int));
+    }
     if (p->dataset) {
     	while (! crossbowListEmpty(p->dataset)) {
     		crossbowRecordFileP file = crossbowListRemoveFirst (p->dataset); 
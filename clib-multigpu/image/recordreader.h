@@ -5,18 +5,34 @@
 
 #include "record.h"
 #include "recordfile.h"
+#include "decoderpool.h"
+
+#include "../timer.h"
 
 typedef struct crossbow_record_reader *crossbowRecordReaderP;
 typedef struct crossbow_record_reader {
     crossbowListP dataset;
     int records; /* Total number of records in dataset */
-    int counter; /* Current record counter */
+    int counter; /* Records read so far (across epochs) */
     int limit;
     int wraps;
     crossbowRecordFileP current;
     unsigned finalised;
     int workers;
     int jc; /* Pin workers to cores, starting from core `jc` */
+    crossbowDecoderPoolP pool; /* Created on finalise, if workers > 1 */
+    crossbowRecordP *arena; /* One reusable record per worker */
+    /* Shuffled iteration (see crossbowRecordReaderShuffle) */
+    unsigned shuffle;
+    unsigned seed;
+    int shard, shards;
+    crossbowRecordFileP *files; /* Files in dataset order */
+    int *first; /* Global id of the first record of each file */
+    int *permutation; /* All records, in the current epoch's order */
+    int *order; /* The records of this shard, in the current epoch's order */
+    int size; /* Number of records in this shard */
+    int cursor; /* Next record in `order` */
+    int ahead; /* Records in `order` before `ahead` have been read ahead */
 } crossbow_record_reader_t;
 
 typedef struct crossbow_record_reader_task *crossbowRecordReaderTaskP;
@@ -25,6 +41,10 @@ typedef struct crossbow_record_reader_task {
     int id;
     int jc;
     int counter;
+    /* Seeds the example's random stream (see crossbowImageSeed) */
+    unsigned epoch;
+    unsigned example;
+    crossbowRecordReaderP reader;
     /* Read from file at position */
     crossbowRecordFileP file;
     int position;
@@ -33,6 +53,18 @@ typedef struct crossbow_record_reader_task {
     int   offset[2];
 } crossbow_record_reader_task_t;
 
+/* A batch of tasks, submitted to the decoder pool as a single job */
+typedef struct crossbow_record_reader_request *crossbowRecordReaderRequestP;
+typedef struct crossbow_record_reader_request {
+    crossbowRecordReaderTaskP tasks;
+    int count;
+    crossbowDecoderJobP job;
+    /* Completion callback of an asynchronous read */
+    crossbowDecoderJobCallback callback;
+    void *args;
+    crossbowTimerP timer;
+} crossbow_record_reader_request_t;
+
 crossbowRecordReaderP crossbowRecordReaderCreate (int);
 
 void crossbowRecordReaderCoreOffset (crossbowRecordReaderP, int);
@@ -43,6 +75,18 @@ void crossbowRecordReaderFinalise (crossbowRecordReaderP);
 
 void crossbowRecordReaderRepeat (crossbowRecordReaderP, int);
 
+/*
+ * Iterate over the records of all files in a different random order every
+ * epoch, instead of sequentially. The order of epoch `e` is a permutation
+ * seeded by `seed` and `e`, so that it is reproducible; of that, the reader
+ * only visits every `shards`-th record, starting from `shard`. Readers that
+ * use the same seed and different shards thus split each epoch between them.
+ *
+ * Record offsets come from per-file indices (see crossbowRecordFileIndex).
+ * Must be called before crossbowRecordReaderFinalise.
+ */
+void crossbowRecordReaderShuffle (crossbowRecordReaderP, unsigned, int, int);
+
 unsigned crossbowRecordReaderHasNext (crossbowRecordReaderP);
 
 void crossbowRecordReaderNext (crossbowRecordReaderP, crossbowRecordP);
@@ -53,6 +97,13 @@ void crossbowRecordReaderRead (crossbowRecordReaderP, int, int, void *, int);
 
 void crossbowRecordReaderReadProperly (crossbowRecordReaderP, int, int *, int, int *, void *, void *, int *);
 
+/*
+ * Same as above, but returns as soon as the read is scheduled. The callback is
+ * invoked (with the given argument) from a decoder thread once all images and
+ * labels have been written.
+ */
+void crossbowRecordReaderReadProperlyAsync (crossbowRecordReaderP, int, int *, int, int *, void *, void *, int *, crossbowDecoderJobCallback, void *);
+
 void crossbowRecordReaderFree (crossbowRecordReaderP);
 
 #endif /* __CROSSBOW_RECORDREADER_H_ */
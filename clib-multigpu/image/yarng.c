@@ -0,0 +1,26 @@
+#include "yarng.h"
+
+#include "../cpukernels/philox.h"
+
+void crossbowYarngInit (crossbowYarngP p, unsigned long long seed, unsigned epoch, unsigned example) {
+	p->key[0] = (unsigned) seed;
+	p->key[1] = (unsigned) (seed >> 32);
+	p->counter[0] = example;
+	p->counter[1] = epoch;
+	p->counter[2] = 0; /* Incremented for every block drawn */
+	p->counter[3] = 0;
+	p->next = 4;
+	return;
+}
+
+float crossbowYarngNext (crossbowYarngP p, float start, float end) {
+	if (p->next == 4) {
+		p->words[0] = p->counter[0];
+		p->words[1] = p->counter[1];
+		p->words[2] = p->counter[2]++;
+		p->words[3] = p->counter[3];
+		crossbowPhilox (p->words, p->key);
+		p->next = 0;
+	}
+	return start + (end - start) * crossbowPhiloxUniform (p->words[p->next++]);
+}
@@ -1,14 +1,24 @@
 #ifndef __CROSSBOW_YARNG_H_
 #define __CROSSBOW_YARNG_H_
 
-#ifdef __cplusplus
-extern "C"
-#endif
-void crossbowYarngInit (unsigned int);
-
-#ifdef __cplusplus
-extern "C"
-#endif
-float crossbowYarngNext (float, float);
+/*
+ * Yet another random number generator: a Philox stream per example (see
+ * cpukernels/philox.h), so that image augmentation is reproducible for a
+ * given seed, regardless of which decoder handles which example, and needs
+ * no locks or shared state.
+ */
+typedef struct crossbow_yarng *crossbowYarngP;
+typedef struct crossbow_yarng {
+	unsigned key [2];
+	unsigned counter [4];
+	unsigned words [4]; /* The current block */
+	int next; /* Next unused word in `words` */
+} crossbow_yarng_t;
+
+/* Starts the stream of `example` in `epoch` */
+void crossbowYarngInit (crossbowYarngP, unsigned long long seed, unsigned epoch, unsigned example);
+
+/* Returns a uniformly distributed value in [start, end) */
+float crossbowYarngNext (crossbowYarngP, float start, float end);
 
 #endif /* __CROSSBOW_YARNG_H_ */
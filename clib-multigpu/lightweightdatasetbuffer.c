@@ -52,7 +52,7 @@ void crossbowLightWeightDatasetBufferRegister (crossbowLightWeightDatasetBufferP
 	for (i = 0; i < blocks; ++i) {
 		if (mlock (ptr, blocksize) < 0)
 			err ("Call to mlock() failed: %s\n", strerror(errno));
-		checkCudaErrors(cudaHostRegister(ptr, blocksize, cudaHostRegisterMapped | cudaHostRegisterPortable));
+		crossbowHostRegister (ptr, blocksize);
 		ptr = (void *) ((char *) (ptr) + (blocksize));
 	}
 	p->locked = blocks;
@@ -80,7 +80,7 @@ void crossbowLightWeightDatasetBufferUnregister (crossbowLightWeightDatasetBuffe
 	for (i = 0; i < blocks; ++i) {
 		if (munlock (ptr, blocksize) < 0)
 			err("Call to munlock() failed: %s\n", strerror(errno));
-		checkCudaErrors(cudaHostUnregister(ptr));
+		crossbowHostUnregister (ptr);
 		ptr = (void *) ((char *) (ptr) + (blocksize));
 	}
 	/* Reset counter */
@@ -0,0 +1,279 @@
+#include "lockfreequeue.h"
+
+#include "memorymanager.h"
+
+#include "debug.h"
+#include "utils.h"
+
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/* Bounds of the adaptive spin budget, in attempts */
+#define CROSSBOW_LOCKFREE_MIN_SPINS    64
+#define CROSSBOW_LOCKFREE_MAX_SPINS 16384
+
+static inline void crossbowLockFreeQueuePause (void) {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause ();
+#else
+	__asm__ __volatile__ ("" ::: "memory");
+#endif
+}
+
+static void crossbowLockFreeQueueWaitersInit (crossbow_lockfree_queue_waiters_t *w) {
+	w->futex = 0;
+	w->sleepers = 0;
+	w->spins = CROSSBOW_LOCKFREE_MIN_SPINS;
+	return;
+}
+
+/*
+ * Wake up a thread waiting on the other side of the queue, if any. The fence
+ * orders the caller's update of the queue before reading `sleepers`: either
+ * we see the waiter, or the waiter sees the update when it re-checks the
+ * queue after registering itself (see crossbowLockFreeQueueSleep).
+ */
+static inline void crossbowLockFreeQueueWake (crossbow_lockfree_queue_waiters_t *w) {
+	__atomic_thread_fence (__ATOMIC_SEQ_CST);
+	if (__atomic_load_n (&(w->sleepers), __ATOMIC_RELAXED) > 0) {
+		__atomic_fetch_add (&(w->futex), 1, __ATOMIC_SEQ_CST);
+		syscall (SYS_futex, &(w->futex), FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+	}
+	return;
+}
+
+/* Sleep, unless the futex word has changed since `value` was read */
+static inline void crossbowLockFreeQueueSleep (crossbow_lockfree_queue_waiters_t *w, int value) {
+	syscall (SYS_futex, &(w->futex), FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+	return;
+}
+
+static int crossbowLockFreeQueueTryEnqueueSPSC (crossbowLockFreeQueueP q, void *item) {
+	unsigned long tail = q->tail;
+	if (tail - q->headcache >= (unsigned long) q->capacity) {
+		q->headcache = __atomic_load_n (&(q->head), __ATOMIC_ACQUIRE);
+		if (tail - q->headcache >= (unsigned long) q->capacity)
+			return 0;
+	}
+	q->slots[tail & q->mask].item = item;
+	__atomic_store_n (&(q->tail), tail + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+static int crossbowLockFreeQueueTryDequeueSPSC (crossbowLockFreeQueueP q, void **item) {
+	unsigned long head = q->head;
+	if (head == q->tailcache) {
+		q->tailcache = __atomic_load_n (&(q->tail), __ATOMIC_ACQUIRE);
+		if (head == q->tailcache)
+			return 0;
+	}
+	*item = q->slots[head & q->mask].item;
+	__atomic_store_n (&(q->head), head + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+/*
+ * Slot `pos & mask` is free for the producer that claims position `pos`
+ * when its sequence is `pos`, and holds an item for the consumer that
+ * claims position `pos` when its sequence is `pos + 1`.
+ */
+static int crossbowLockFreeQueueTryEnqueueMPMC (crossbowLockFreeQueueP q, void *item) {
+	crossbow_lockfree_queue_slot_t *slot;
+	unsigned long seq;
+	long diff;
+	unsigned long pos = __atomic_load_n (&(q->tail), __ATOMIC_RELAXED);
+	while (1) {
+		slot = &(q->slots[pos & q->mask]);
+		seq = __atomic_load_n (&(slot->sequence), __ATOMIC_ACQUIRE);
+		diff = (long) seq - (long) pos;
+		if (diff == 0) {
+			if (__atomic_compare_exchange_n (&(q->tail), &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		}
+		else if (diff < 0) {
+			/* Full */
+			return 0;
+		}
+		else {
+			pos = __atomic_load_n (&(q->tail), __ATOMIC_RELAXED);
+		}
+	}
+	slot->item = item;
+	__atomic_store_n (&(slot->sequence), pos + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+static int crossbowLockFreeQueueTryDequeueMPMC (crossbowLockFreeQueueP q, void **item) {
+	crossbow_lockfree_queue_slot_t *slot;
+	unsigned long seq;
+	long diff;
+	unsigned long pos = __atomic_load_n (&(q->head), __ATOMIC_RELAXED);
+	while (1) {
+		slot = &(q->slots[pos & q->mask]);
+		seq = __atomic_load_n (&(slot->sequence), __ATOMIC_ACQUIRE);
+		diff = (long) seq - (long) (pos + 1);
+		if (diff == 0) {
+			if (__atomic_compare_exchange_n (&(q->head), &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		}
+		else if (diff < 0) {
+			/* Empty */
+			return 0;
+		}
+		else {
+			pos = __atomic_load_n (&(q->head), __ATOMIC_RELAXED);
+		}
+	}
+	*item = slot->item;
+	/* Free the slot for the producer that wraps around to it */
+	__atomic_store_n (&(slot->sequence), pos + q->mask + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+crossbowLockFreeQueueP crossbowLockFreeQueueCreate (crossbowLockFreeQueueType_t type, int capacity) {
+	int i;
+	crossbowLockFreeQueueP q;
+	invalidArgumentException (capacity > 0);
+	q = (crossbowLockFreeQueueP) crossbowMallocAligned (CROSSBOW_CACHE_LINE_SIZE, sizeof(crossbow_lockfree_queue_t));
+	memset (q, 0, sizeof(crossbow_lockfree_queue_t));
+	q->type = type;
+	q->capacity = 1;
+	while (q->capacity < capacity)
+		q->capacity <<= 1;
+	q->mask = (unsigned long) (q->capacity - 1);
+	q->slots = (crossbow_lockfree_queue_slot_t *) crossbowMalloc (q->capacity * sizeof(crossbow_lockfree_queue_slot_t));
+	for (i = 0; i < q->capacity; ++i) {
+		q->slots[i].sequence = (unsigned long) i;
+		q->slots[i].item = NULL;
+	}
+	q->head = q->tail = 0;
+	q->headcache = q->tailcache = 0;
+	crossbowLockFreeQueueWaitersInit (&(q->notempty));
+	crossbowLockFreeQueueWaitersInit (&(q->notfull));
+	return q;
+}
+
+int crossbowLockFreeQueueCapacity (crossbowLockFreeQueueP q) {
+	return q->capacity;
+}
+
+int crossbowLockFreeQueueTryDequeue (crossbowLockFreeQueueP q, void **item) {
+	int found;
+	if (q->type == SPSC)
+		found = crossbowLockFreeQueueTryDequeueSPSC (q, item);
+	else
+		found = crossbowLockFreeQueueTryDequeueMPMC (q, item);
+	if (found)
+		crossbowLockFreeQueueWake (&(q->notfull));
+	return found;
+}
+
+void *crossbowLockFreeQueueDequeue (crossbowLockFreeQueueP q) {
+	void *item = NULL;
+	if (! crossbowLockFreeQueueTryDequeue (q, &item))
+		return NULL;
+	return item;
+}
+
+void *crossbowLockFreeQueueDequeueOrWait (crossbowLockFreeQueueP q) {
+	void *item = NULL;
+	int spin, value;
+	crossbow_lockfree_queue_waiters_t *w = &(q->notempty);
+	int spins = w->spins;
+	for (spin = 0; spin < spins; ++spin) {
+		if (crossbowLockFreeQueueTryDequeue (q, &item)) {
+			/* An item arrived late in the spin phase: spin longer next time */
+			if (spin > (spins >> 1) && spins < CROSSBOW_LOCKFREE_MAX_SPINS)
+				w->spins = spins << 1;
+			return item;
+		}
+		crossbowLockFreeQueuePause ();
+	}
+	/* Spinning did not pay off */
+	if (spins > CROSSBOW_LOCKFREE_MIN_SPINS)
+		w->spins = spins >> 1;
+	while (1) {
+		__atomic_fetch_add (&(w->sleepers), 1, __ATOMIC_SEQ_CST);
+		value = __atomic_load_n (&(w->futex), __ATOMIC_SEQ_CST);
+		if (crossbowLockFreeQueueTryDequeue (q, &item)) {
+			__atomic_fetch_sub (&(w->sleepers), 1, __ATOMIC_SEQ_CST);
+			break;
+		}
+		crossbowLockFreeQueueSleep (w, value);
+		__atomic_fetch_sub (&(w->sleepers), 1, __ATOMIC_SEQ_CST);
+		if (crossbowLockFreeQueueTryDequeue (q, &item))
+			break;
+	}
+	return item;
+}
+
+int crossbowLockFreeQueueTryEnqueue (crossbowLockFreeQueueP q, void *item) {
+	int done;
+	if (q->type == SPSC)
+		done = crossbowLockFreeQueueTryEnqueueSPSC (q, item);
+	else
+		done = crossbowLockFreeQueueTryEnqueueMPMC (q, item);
+	if (done)
+		crossbowLockFreeQueueWake (&(q->notempty));
+	return done;
+}
+
+void crossbowLockFreeQueueEnqueue (crossbowLockFreeQueueP q, void *item) {
+	if (! crossbowLockFreeQueueTryEnqueue (q, item)) {
+		fprintf(stderr, "error: lock-free queue is full\n");
+		exit (1);
+	}
+	return;
+}
+
+void crossbowLockFreeQueueEnqueueOrWait (crossbowLockFreeQueueP q, void *item) {
+	int spin, value;
+	crossbow_lockfree_queue_waiters_t *w = &(q->notfull);
+	int spins = w->spins;
+	for (spin = 0; spin < spins; ++spin) {
+		if (crossbowLockFreeQueueTryEnqueue (q, item)) {
+			if (spin > (spins >> 1) && spins < CROSSBOW_LOCKFREE_MAX_SPINS)
+				w->spins = spins << 1;
+			return;
+		}
+		crossbowLockFreeQueuePause ();
+	}
+	if (spins > CROSSBOW_LOCKFREE_MIN_SPINS)
+		w->spins = spins >> 1;
+	while (1) {
+		__atomic_fetch_add (&(w->sleepers), 1, __ATOMIC_SEQ_CST);
+		value = __atomic_load_n (&(w->futex), __ATOMIC_SEQ_CST);
+		if (crossbowLockFreeQueueTryEnqueue (q, item)) {
+			__atomic_fetch_sub (&(w->sleepers), 1, __ATOMIC_SEQ_CST);
+			break;
+		}
+		crossbowLockFreeQueueSleep (w, value);
+		__atomic_fetch_sub (&(w->sleepers), 1, __ATOMIC_SEQ_CST);
+		if (crossbowLockFreeQueueTryEnqueue (q, item))
+			break;
+	}
+	return;
+}
+
+int crossbowLockFreeQueueEmpty (crossbowLockFreeQueueP q) {
+	return (crossbowLockFreeQueueSize (q) == 0);
+}
+
+int crossbowLockFreeQueueSize (crossbowLockFreeQueueP q) {
+	unsigned long head = __atomic_load_n (&(q->head), __ATOMIC_ACQUIRE);
+	unsigned long tail = __atomic_load_n (&(q->tail), __ATOMIC_ACQUIRE);
+	/* A concurrent dequeue may move `head` past the `tail` we read */
+	if (tail <= head)
+		return 0;
+	return (int) min (tail - head, (unsigned long) q->capacity);
+}
+
+/* Assumes that there are no concurrent operations */
+void crossbowLockFreeQueueFree (crossbowLockFreeQueueP q) {
+	if (! q)
+		return;
+	crossbowFree (q->slots, q->capacity * sizeof(crossbow_lockfree_queue_slot_t));
+	crossbowFree (q, sizeof(crossbow_lockfree_queue_t));
+	return;
+}
@@ -0,0 +1,86 @@
+#ifndef __CROSSBOW_LOCK_FREE_QUEUE_H_
+#define __CROSSBOW_LOCK_FREE_QUEUE_H_
+
+/*
+ * A bounded, lock-free ring buffer of pointers.
+ *
+ * SPSC queues are safe for one producer and one consumer thread; MPMC
+ * queues (Vyukov's bounded queue, with a sequence number per slot) for
+ * any number of either. Items may be NULL (e.g. to signal a handler to
+ * exit), so non-blocking calls report success separately.
+ *
+ * Threads that must wait, for an item or for a free slot, spin for a
+ * while and then sleep on a futex. The spin budget adapts: it grows when
+ * spinning pays off and shrinks when the thread ends up sleeping anyway.
+ */
+
+#define CROSSBOW_CACHE_LINE_SIZE 64
+
+typedef enum crossbow_lockfree_queue_type {
+	SPSC = 0,
+	MPMC
+} crossbowLockFreeQueueType_t;
+
+typedef struct crossbow_lockfree_queue_slot {
+	volatile unsigned long sequence; /* MPMC only */
+	void *item;
+} crossbow_lockfree_queue_slot_t;
+
+/* Wait/wake-up state for one side of the queue */
+typedef struct crossbow_lockfree_queue_waiters {
+	volatile int futex; /* Bumped on every wake-up */
+	volatile int sleepers;
+	volatile int spins;
+} crossbow_lockfree_queue_waiters_t;
+
+typedef struct crossbow_lockfree_queue *crossbowLockFreeQueueP;
+typedef struct crossbow_lockfree_queue {
+
+	crossbowLockFreeQueueType_t type;
+	int capacity; /* A power of 2 */
+	unsigned long mask;
+	crossbow_lockfree_queue_slot_t *slots;
+
+	/* Consumer side */
+	volatile unsigned long head __attribute__((aligned(CROSSBOW_CACHE_LINE_SIZE)));
+	unsigned long tailcache; /* SPSC: the consumer's last view of `tail` */
+
+	/* Producer side */
+	volatile unsigned long tail __attribute__((aligned(CROSSBOW_CACHE_LINE_SIZE)));
+	unsigned long headcache; /* SPSC: the producer's last view of `head` */
+
+	/* Consumers waiting for an item, producers waiting for a free slot */
+	crossbow_lockfree_queue_waiters_t notempty __attribute__((aligned(CROSSBOW_CACHE_LINE_SIZE)));
+	crossbow_lockfree_queue_waiters_t notfull  __attribute__((aligned(CROSSBOW_CACHE_LINE_SIZE)));
+
+} crossbow_lockfree_queue_t;
+
+/* Capacity is rounded up to the next power of 2 */
+crossbowLockFreeQueueP crossbowLockFreeQueueCreate (crossbowLockFreeQueueType_t, int);
+
+int crossbowLockFreeQueueCapacity (crossbowLockFreeQueueP);
+
+/* Returns 1 if an item was dequeued (into the second argument), 0 if the queue is empty */
+int crossbowLockFreeQueueTryDequeue (crossbowLockFreeQueueP, void **);
+
+/* Returns the next item, or NULL if the queue is empty */
+void *crossbowLockFreeQueueDequeue (crossbowLockFreeQueueP);
+
+void *crossbowLockFreeQueueDequeueOrWait (crossbowLockFreeQueueP);
+
+/* Returns 1 if the item was enqueued, 0 if the queue is full */
+int crossbowLockFreeQueueTryEnqueue (crossbowLockFreeQueueP, void *);
+
+/* Fails if the queue is full */
+void crossbowLockFreeQueueEnqueue (crossbowLockFreeQueueP, void *);
+
+void crossbowLockFreeQueueEnqueueOrWait (crossbowLockFreeQueueP, void *);
+
+/* The following two are only hints, since the queue may change concurrently */
+int crossbowLockFreeQueueEmpty (crossbowLockFreeQueueP);
+
+int crossbowLockFreeQueueSize (crossbowLockFreeQueueP);
+
+void crossbowLockFreeQueueFree (crossbowLockFreeQueueP);
+
+#endif /* __CROSSBOW_LOCK_FREE_QUEUE_H_ */
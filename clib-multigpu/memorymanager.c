@@ -3,7 +3,6 @@
 #include "debug.h"
 #include "utils.h"
 
-#include "waitfreequeue.h"
 #include "timer.h"
 
 #include <sys/mman.h>
@@ -22,6 +21,9 @@
  * a) free
  * b) cudaFreeHost
  * c) cudaFree
+ *
+ * In CPU-only builds (CROSSBOW_CPU_ONLY), there is no device memory and
+ * "pinned" memory is page-aligned host memory.
  */
 
 #ifndef INC_ATOMICALLY
@@ -80,8 +82,15 @@ void *crossbowMallocAligned (int alignment, int size) {
 
 void *crossbowCudaMallocHost (int size) {
 	void *p = NULL;
+#ifndef CROSSBOW_CPU_ONLY
 	checkCudaErrors(cudaMallocHost (&p, size));
 	/* checkCudaErrors(cudaHostAlloc (&p, size, cudaHostAllocPortable)); */
+#else
+	if (posix_memalign (&p, getpagesize(), size) != 0) {
+		fprintf(stderr, "fatal error: out of memory\n");
+		exit(1);
+	}
+#endif
 #ifndef INC_ATOMICALLY
 	cudaMallocHostBytes += size;
 	cudaMallocHostCalls ++;
@@ -94,7 +103,11 @@ void *crossbowCudaMallocHost (int size) {
 
 void *crossbowCudaMalloc (int size) {
 	void *p = NULL;
+#ifndef CROSSBOW_CPU_ONLY
 	checkCudaErrors(cudaMalloc (&p, size));
+#else
+	unsupportedOperationException ();
+#endif
 #ifndef INC_ATOMICALLY
 	cudaMallocBytes += size;
 	cudaMallocCalls ++;
@@ -121,7 +134,11 @@ void *crossbowFree (void *item, int size) {
 
 void *crossbowCudaFreeHost (void *item, int size) {
 	if (item) {
+#ifndef CROSSBOW_CPU_ONLY
 		checkCudaErrors(cudaFreeHost (item));
+#else
+		free (item);
+#endif
 #ifndef INC_ATOMICALLY
 		cudaMallocHostBytes -= size;
 		cudaFreeHostCalls ++;
@@ -135,7 +152,11 @@ void *crossbowCudaFreeHost (void *item, int size) {
 
 void *crossbowCudaFree (void *item, int size) {
 	if (item) {
+#ifndef CROSSBOW_CPU_ONLY
 		checkCudaErrors(cudaFree (item));
+#else
+		unsupportedOperationException ();
+#endif
 #ifndef INC_ATOMICALLY
 		cudaMallocBytes -= size;
 		cudaFreeCalls ++;
@@ -217,7 +238,12 @@ static inline unsigned isRegistered (void *buffer, int start, int end) {
 	(void) start;
 	(void) end;
 	*/
-	
+#ifdef CROSSBOW_CPU_ONLY
+	(void) buffer;
+	(void) start;
+	(void) end;
+	return 1;
+#else
 	struct cudaPointerAttributes attributes;
 
 	void *p = (void *) ((char *) (buffer) + start);
@@ -232,6 +258,7 @@ static inline unsigned isRegistered (void *buffer, int start, int end) {
 	}
 	
 	return 1;
+#endif
 }
 
 void crossbowHostRegisterBuffer (int type, void *buffer, int length, int start, int end, crossbowPhase_t phase) {
@@ -256,9 +283,30 @@ void crossbowHostRegisterBuffer (int type, void *buffer, int length, int start,
 	return;
 }
 
+void crossbowHostRegister (void *ptr, int length) {
+#ifndef CROSSBOW_CPU_ONLY
+	checkCudaErrors(cudaHostRegister(ptr, length, cudaHostRegisterMapped | cudaHostRegisterPortable));
+#else
+	(void) ptr;
+	(void) length;
+#endif
+	return;
+}
+
+void crossbowHostUnregister (void *ptr) {
+#ifndef CROSSBOW_CPU_ONLY
+	checkCudaErrors(cudaHostUnregister(ptr));
+#else
+	(void) ptr;
+#endif
+	return;
+}
+
 void crossbowMemoryManagerDump () {
-	size_t free, total;
+	size_t free = 0, total = 0;
+#ifndef CROSSBOW_CPU_ONLY
 	cudaMemGetInfo(&free, &total);
+#endif
 
 	printf ("=== [Memory manager] ===\n");
 
@@ -11,9 +11,11 @@
 #include <stdint.h> /* uintptr_t */
 #include <unistd.h> /* getpagesize() */
 
+#ifndef CROSSBOW_CPU_ONLY
 #include <cuda.h>
 #include <cuda_runtime.h>
 #include <cuda_runtime_api.h>
+#endif
 
 #include "utils.h"
 
@@ -45,6 +47,11 @@ void crossbowMemoryManagerDestroy ();
 
 void crossbowHostRegisterBuffer (int, void *, int, int, int, crossbowPhase_t);
 
+/* Page-lock host memory for device access (a no-op in CPU-only builds) */
+void crossbowHostRegister (void *, int);
+
+void crossbowHostUnregister (void *);
+
 void crossbowMemoryManagerDump ();
 
 #endif /* __CROSSBOW_MEMORYMANAGER_H_ */
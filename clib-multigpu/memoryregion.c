@@ -81,7 +81,7 @@ void crossbowMemoryRegionRegister (crossbowMemoryRegionP p, int offset, int leng
 	void *ptr = (void *) ((char *) (p->data) + offset);
 	if (mlock (ptr, length) < 0)
 		err ("Call to mlock() failed: %s\n", strerror(errno));
-	checkCudaErrors(cudaHostRegister(ptr, length, cudaHostRegisterMapped | cudaHostRegisterPortable));
+	crossbowHostRegister (ptr, length);
 	/* Atomically increment counter */
 	__sync_add_and_fetch (&(p->locked), 1);
 	return;
@@ -104,7 +104,7 @@ void crossbowMemoryRegionUnregister (crossbowMemoryRegionP p, int offset, int le
 	void *ptr = (void *) ((char *) (p->data) + offset);
 	if (munlock (ptr, length) < 0)
 		err ("Call to munlock() failed: %s\n", strerror(errno));
-	checkCudaErrors(cudaHostUnregister(ptr));
+	crossbowHostUnregister (ptr);
 	/* Atomically increment counter */
 	__sync_sub_and_fetch (&(p->locked), 1);
 	return;
@@ -5,57 +5,19 @@
 #include "debug.h"
 #include "utils.h"
 
-static void *handle (void *args) {
+/*
+ * Invoked by the decoder thread that completes a fill request
+ */
+static void crossbowRecordDatasetFilled (void *args) {
 
-	crossbowRecordDatasetP      self  = NULL;
-	crossbowRecordDatasetEventP event = NULL;
+	crossbowRecordDatasetEventP event = (crossbowRecordDatasetEventP) args;
 
-	self = (crossbowRecordDatasetP) args;
+	dbg("Filled buffer %d\n", event->idx);
 
-	cpu_set_t set;
-	int core = 1;
-	CPU_ZERO (&set);
-	CPU_SET  (core, &set);
-	sched_setaffinity (0, sizeof(set), &set);
-	info("Record dataset handler pinned on core %d\n", core);
+	crossbowDoubleBufferUnlock (event->dataset->buffer, event->idx);
 
-	pthread_mutex_lock(&(self->lock));
-
-	dbg("Record data set worker starts\n");
-
-	while (! self->exit) {
-		/* Block, waiting for an event */
-		while (!self->exit && crossbowListSize(self->events) == 0) {
-			pthread_cond_wait(&(self->cond), &(self->lock));
-		}
-		if (self->exit) {
-			break;
-		}
-
-		/* Get task */
-		event = (crossbowRecordDatasetEventP) crossbowListRemoveFirst (self->events);
-
-		info("New task: fill %d\n", event->idx);
-
-		/* Process event */
-
-		crossbowRecordReaderReadProperly (self->reader,
-				self->count,
-				self->buffer->size,
-				self->buffer->b,
-				self->buffer->padding,
-				self->buffer->theImages[event->idx],
-				self->buffer->theLabels[event->idx],
-				self->buffer->capacity
-		);
-
-		crossbowDoubleBufferUnlock (self->buffer, event->idx);
-
-		/* Return task to free list */
-		crossbowFree (event, sizeof(crossbow_record_dataset_event_t));
-	}
-	self->exited = 1;
-	return self;
+	crossbowFree (event, sizeof(crossbow_record_dataset_event_t));
+	return;
 }
 
 crossbowRecordDatasetP crossbowRecordDatasetCreate (int workers, int *capacity, int NB, int b, int *padding) {
@@ -75,18 +37,6 @@ crossbowRecordDatasetP crossbowRecordDatasetCreate (int workers, int *capacity,
 	/* Number of images and labels to decode/read per read call */
 	p->count = (NB * b);
 
-	/* Set-up worker thread */
-	p->exit = 0;
-	p->exited = 0;
-
-	pthread_mutex_init (&(p->lock), NULL);
-	pthread_cond_init  (&(p->cond), NULL);
-
-	p->events = crossbowListCreate ();
-
-	/* Launch thread */
-	pthread_create (&(p->thread), NULL, handle, (void *) p);
-
 	return p;
 }
 
@@ -152,14 +102,23 @@ void crossbowRecordDatasetSwap (crossbowRecordDatasetP p) {
 	crossbowDoubleBufferLock (p->buffer, prev);
 
 	crossbowRecordDatasetEventP event = crossbowMalloc (sizeof(crossbow_record_dataset_event_t));
+	event->dataset = p;
 	event->idx = prev;
-	/* Schedule task */
-	pthread_mutex_lock (&(p->lock));
-	if (! p->exit) {
-		crossbowListAppend (p->events, event);
-		pthread_cond_signal (&(p->cond));
-	}
-	pthread_mutex_unlock(&(p->lock));
+
+	info("New task: fill %d\n", prev);
+
+	/* Schedule task; the decoder pool unlocks the buffer once it is filled */
+	crossbowRecordReaderReadProperlyAsync (p->reader,
+			p->count,
+			p->buffer->size,
+			p->buffer->b,
+			p->buffer->padding,
+			p->buffer->theImages[prev],
+			p->buffer->theLabels[prev],
+			p->buffer->capacity,
+			crossbowRecordDatasetFilled,
+			(void *) event
+	);
 
 	return;
 }
@@ -168,13 +127,12 @@ void crossbowRecordDatasetFree (crossbowRecordDatasetP p) {
 	if (! p)
 		return;
 
-	if (p->buffer)
-		crossbowDoubleBufferFree (p->buffer);
-
+	/* Free the reader first: it waits for any pending fill request */
 	if (p->reader)
 		crossbowRecordReaderFree (p->reader);
 
-	crossbowListFree (p->events);
+	if (p->buffer)
+		crossbowDoubleBufferFree (p->buffer);
 
 	crossbowFree (p, sizeof(crossbow_record_dataset_t));
 	return;
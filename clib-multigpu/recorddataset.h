@@ -4,8 +4,6 @@
 #include "doublebuffer.h"
 #include "image/recordreader.h"
 
-#include <pthread.h>
-
 typedef struct crossbow_record_dataset *crossbowRecordDatasetP;
 typedef struct crossbow_record_dataset {
 
@@ -18,29 +16,17 @@ typedef struct crossbow_record_dataset {
 	crossbowRecordReaderP reader;
 	crossbowDoubleBufferP buffer;
 
-	/* Create worker thread */
-
-	volatile int exit;
-	int exited;
-
-	pthread_mutex_t lock;
-	pthread_cond_t cond;
-
-	crossbowListP events;
-
-	pthread_t thread;
-
 } crossbow_record_dataset_t;
 
+/* Passed to the reader's completion callback: buffer `idx` has been filled */
 typedef struct crossbow_record_dataset_event *crossbowRecordDatasetEventP;
 typedef struct crossbow_record_dataset_event {
+	crossbowRecordDatasetP dataset;
 	int idx;
 } crossbow_record_dataset_event_t;
 
 crossbowRecordDatasetP crossbowRecordDatasetCreate (int, int *, int, int, int *);
 
-void crossbowRecordDatasetInit (crossbowRecordDatasetP);
-
 void crossbowRecordDatasetInitSafely (crossbowRecordDatasetP);
 
 void crossbowRecordDatasetSwap (crossbowRecordDatasetP);
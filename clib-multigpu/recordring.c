@@ -0,0 +1,190 @@
+#include "recordring.h"
+
+#include "memorymanager.h"
+
+#include "debug.h"
+#include "utils.h"
+
+#include <errno.h>
+
+#include <sys/mman.h> /* mlock, etc. */
+#include <unistd.h>
+
+/*
+ * Invoked by the decoder thread that completes a fill request
+ */
+static void crossbowRecordRingFilled (void *args) {
+
+	crossbowRecordRingEventP event = (crossbowRecordRingEventP) args;
+	crossbowRecordRingP p = event->ring;
+
+	dbg("Filled slot %d\n", event->idx);
+
+	pthread_mutex_lock (&(p->lock));
+	p->state[event->idx] = RECORD_RING_SLOT_FILLED;
+	pthread_cond_broadcast (&(p->filled));
+	pthread_mutex_unlock (&(p->lock));
+
+	crossbowFree (event, sizeof(crossbow_record_ring_event_t));
+	return;
+}
+
+static void crossbowRecordRingFill (crossbowRecordRingP p, int idx) {
+
+	crossbowRecordRingEventP event = crossbowMalloc (sizeof(crossbow_record_ring_event_t));
+	event->ring = p;
+	event->idx = idx;
+
+	p->state[idx] = RECORD_RING_SLOT_FILLING;
+
+	/* Schedule task; the decoder pool marks the slot as filled once it is done */
+	crossbowRecordReaderReadProperlyAsync (p->reader,
+			(p->NB * p->b),
+			p->size,
+			p->b,
+			p->padding,
+			p->images[idx],
+			p->labels[idx],
+			p->limit,
+			crossbowRecordRingFilled,
+			(void *) event
+	);
+	return;
+}
+
+crossbowRecordRingP crossbowRecordRingCreate (int workers, int slots, int NB, int b, int *size, int *padding) {
+
+	int i, j;
+	void **buffer;
+
+	crossbowRecordRingP p = (crossbowRecordRingP) crossbowMalloc (sizeof(crossbow_record_ring_t));
+
+	p->reader = crossbowRecordReaderCreate (workers);
+
+	p->slots = slots;
+
+	p->NB = NB;
+	p->b = b;
+
+	for (i = 0; i < 2; ++i) {
+		p->size   [i] = size   [i];
+		p->padding[i] = padding[i];
+		p->capacity [i] = (size_t) NB * ((size_t) b * (size_t) size[i] + (size_t) padding[i]);
+		if (p->capacity[i] > RECORD_RING_MAX_SLOT_SIZE) {
+			fprintf(stderr, "fatal error: record ring slot of %d batches is %zu bytes (at most %lu bytes)\n",
+				NB, p->capacity[i], RECORD_RING_MAX_SLOT_SIZE);
+			exit(1);
+		}
+		p->limit [i] = (int) p->capacity[i];
+	}
+
+	p->images = (void **) crossbowMalloc (slots * sizeof(void *));
+	p->labels = (void **) crossbowMalloc (slots * sizeof(void *));
+
+	for (i = 0; i < 2; ++i) {
+		buffer = (i == 0) ? p->images : p->labels;
+		for (j = 0; j < slots; ++j) {
+			if (posix_memalign (&(buffer[j]), getpagesize(), p->capacity[i]) != 0) {
+				fprintf(stderr, "fatal error: out of memory\n");
+				exit(1);
+			}
+			/* Slots are written by decoders and read by CPU workers; keep them resident */
+			if (mlock (buffer[j], p->capacity[i]) < 0)
+				err ("Call to mlock() failed: %s\n", strerror(errno));
+		}
+	}
+
+	p->state = (volatile int *) crossbowMalloc (slots * sizeof(int));
+	for (j = 0; j < slots; ++j)
+		p->state[j] = RECORD_RING_SLOT_IN_USE;
+
+	pthread_mutex_init (&(p->lock), NULL);
+	pthread_cond_init (&(p->filled), NULL);
+
+	return p;
+}
+
+void crossbowRecordRingRegister (crossbowRecordRingP p, const char *filename) {
+	nullPointerException (p);
+	crossbowRecordReaderRegister (p->reader, filename);
+	return;
+}
+
+void crossbowRecordRingFinalise (crossbowRecordRingP p) {
+	int j;
+	nullPointerException (p);
+
+	crossbowRecordReaderFinalise (p->reader);
+
+	info("%d slots of %d batches (%zu/%zu bytes per slot)\n", p->slots, p->NB, p->capacity[0], p->capacity[1]);
+
+	/* Fill every slot, in order */
+	pthread_mutex_lock (&(p->lock));
+	for (j = 0; j < p->slots; ++j)
+		crossbowRecordRingFill (p, j);
+	pthread_mutex_unlock (&(p->lock));
+	return;
+}
+
+void *crossbowRecordRingAddress (crossbowRecordRingP p, int type, int idx) {
+	nullPointerException (p);
+	indexOutOfBoundsException (idx, p->slots);
+	return (type == 0) ? p->images[idx] : p->labels[idx];
+}
+
+size_t crossbowRecordRingCapacity (crossbowRecordRingP p, int type) {
+	nullPointerException (p);
+	return p->capacity[type];
+}
+
+void crossbowRecordRingSlideIn (crossbowRecordRingP p, int idx) {
+	nullPointerException (p);
+	indexOutOfBoundsException (idx, p->slots);
+
+	pthread_mutex_lock (&(p->lock));
+	/* A slot must slide out before it slides in again */
+	invalidConditionException (p->state[idx] != RECORD_RING_SLOT_IN_USE);
+	while (p->state[idx] != RECORD_RING_SLOT_FILLED)
+		pthread_cond_wait (&(p->filled), &(p->lock));
+	p->state[idx] = RECORD_RING_SLOT_IN_USE;
+	pthread_mutex_unlock (&(p->lock));
+	return;
+}
+
+void crossbowRecordRingSlideOut (crossbowRecordRingP p, int idx) {
+	nullPointerException (p);
+	indexOutOfBoundsException (idx, p->slots);
+
+	pthread_mutex_lock (&(p->lock));
+	invalidConditionException (p->state[idx] == RECORD_RING_SLOT_IN_USE);
+	crossbowRecordRingFill (p, idx);
+	pthread_mutex_unlock (&(p->lock));
+	return;
+}
+
+void crossbowRecordRingFree (crossbowRecordRingP p) {
+	int j;
+	if (! p)
+		return;
+
+	/* Free the reader first: it waits for any pending fill request */
+	if (p->reader)
+		crossbowRecordReaderFree (p->reader);
+
+	for (j = 0; j < p->slots; ++j) {
+		munlock (p->images[j], p->capacity[0]);
+		munlock (p->labels[j], p->capacity[1]);
+		free (p->images[j]);
+		free (p->labels[j]);
+	}
+	crossbowFree (p->images, p->slots * sizeof(void *));
+	crossbowFree (p->labels, p->slots * sizeof(void *));
+
+	crossbowFree ((void *) p->state, p->slots * sizeof(int));
+
+	pthread_mutex_destroy (&(p->lock));
+	pthread_cond_destroy (&(p->filled));
+
+	crossbowFree (p, sizeof(crossbow_record_ring_t));
+	return;
+}
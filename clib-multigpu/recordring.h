@@ -0,0 +1,76 @@
+#ifndef __CROSSBOW_RECORD_RING_H_
+#define __CROSSBOW_RECORD_RING_H_
+
+#include <pthread.h>
+#include <stddef.h>
+
+#include "image/recordreader.h"
+
+#define RECORD_RING_SLOT_FILLING 0
+#define RECORD_RING_SLOT_FILLED  1
+#define RECORD_RING_SLOT_IN_USE  2
+
+/* A slot is mapped as a single (Java) buffer, and read with int offsets */
+#define RECORD_RING_MAX_SLOT_SIZE 2147483647UL
+
+/*
+ * A ring of page-aligned slots, each holding `NB` batches of decoded images
+ * and their labels, for CPU workers.
+ *
+ * The decoder pool of a record reader fills slots asynchronously, in ring
+ * order. A slot slides in (i.e. the caller waits until it is filled) before
+ * its first batch is read, and slides out (i.e. it is refilled with the next
+ * `NB` batches) once all its batches have been consumed.
+ */
+typedef struct crossbow_record_ring *crossbowRecordRingP;
+typedef struct crossbow_record_ring {
+
+	crossbowRecordReaderP reader;
+
+	int slots;
+
+	/* Number of batches per slot, batch size, and item size and padding per batch (for images and labels) */
+	int NB, b;
+	int size[2];
+	int padding[2];
+
+	/* Slot size (in bytes) */
+	size_t capacity[2];
+
+	/* Same as `capacity`, as passed to the reader */
+	int limit[2];
+
+	void **images;
+	void **labels;
+
+	volatile int *state;
+
+	pthread_mutex_t lock;
+	pthread_cond_t filled;
+
+} crossbow_record_ring_t;
+
+/* Passed to the reader's completion callback: slot `idx` has been filled */
+typedef struct crossbow_record_ring_event *crossbowRecordRingEventP;
+typedef struct crossbow_record_ring_event {
+	crossbowRecordRingP ring;
+	int idx;
+} crossbow_record_ring_event_t;
+
+crossbowRecordRingP crossbowRecordRingCreate (int, int, int, int, int *, int *);
+
+void crossbowRecordRingRegister (crossbowRecordRingP, const char *);
+
+void crossbowRecordRingFinalise (crossbowRecordRingP);
+
+void *crossbowRecordRingAddress (crossbowRecordRingP, int, int);
+
+size_t crossbowRecordRingCapacity (crossbowRecordRingP, int);
+
+void crossbowRecordRingSlideIn (crossbowRecordRingP, int);
+
+void crossbowRecordRingSlideOut (crossbowRecordRingP, int);
+
+void crossbowRecordRingFree (crossbowRecordRingP);
+
+#endif /* __CROSSBOW_RECORD_RING_H_ */
@@ -0,0 +1,135 @@
+#include "uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager.h"
+
+#include "memorymanager.h"
+
+#include "debug.h"
+#include "utils.h"
+
+#include "recordring.h"
+
+#include <stdlib.h>
+
+#define PHASES 2
+#define  TYPES 2
+
+static crossbowRecordRingP ring [PHASES]; /* NULL by default */
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager_init
+	(JNIEnv *env, jobject obj, jint phase, jint workers, jint slots, jint NB, jint b, jintArray size, jintArray padding) {
+
+	(void) obj;
+
+	indexOutOfBoundsException (phase, PHASES);
+	invalidConditionException (ring[phase] == NULL);
+
+	invalidArgumentException ((*env)->GetArrayLength(env, size) == TYPES);
+	invalidArgumentException ((*env)->GetArrayLength(env, padding) == TYPES);
+
+	jint *_size = (*env)->GetIntArrayElements (env, size, 0);
+	jint *_padding = (*env)->GetIntArrayElements (env, padding, 0);
+
+	crossbowMemoryManagerInit ();
+
+	ring[phase] = crossbowRecordRingCreate (workers, slots, NB, b, _size, _padding);
+
+	(*env)->ReleaseIntArrayElements (env, size, _size, JNI_ABORT);
+	(*env)->ReleaseIntArrayElements (env, padding, _padding, JNI_ABORT);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager_register
+	(JNIEnv *env, jobject obj, jint phase, jstring filename) {
+
+	(void) obj;
+
+	indexOutOfBoundsException (phase, PHASES);
+
+	const char *binding = (*env)->GetStringUTFChars (env, filename, NULL);
+
+	crossbowRecordRingRegister (ring[phase], binding);
+
+	(*env)->ReleaseStringUTFChars (env, filename, binding);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager_finalise
+	(JNIEnv *env, jobject obj, jint phase) {
+
+	(void) env;
+	(void) obj;
+
+	indexOutOfBoundsException (phase, PHASES);
+
+	crossbowRecordRingFinalise (ring[phase]);
+
+	return 0;
+}
+
+JNIEXPORT jlong JNICALL Java_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager_address
+	(JNIEnv *env, jobject obj, jint phase, jint type, jint idx) {
+
+	(void) env;
+	(void) obj;
+
+	indexOutOfBoundsException (phase, PHASES);
+	indexOutOfBoundsException (type,   TYPES);
+
+	return (jlong) crossbowRecordRingAddress (ring[phase], type, idx);
+}
+
+JNIEXPORT jlong JNICALL Java_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager_capacity
+	(JNIEnv *env, jobject obj, jint phase, jint type) {
+
+	(void) env;
+	(void) obj;
+
+	indexOutOfBoundsException (phase, PHASES);
+	indexOutOfBoundsException (type,   TYPES);
+
+	return (jlong) crossbowRecordRingCapacity (ring[phase], type);
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager_slideIn
+	(JNIEnv *env, jobject obj, jint phase, jint idx) {
+
+	(void) env;
+	(void) obj;
+
+	indexOutOfBoundsException (phase, PHASES);
+
+	crossbowRecordRingSlideIn (ring[phase], idx);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager_slideOut
+	(JNIEnv *env, jobject obj, jint phase, jint idx) {
+
+	(void) env;
+	(void) obj;
+
+	indexOutOfBoundsException (phase, PHASES);
+
+	crossbowRecordRingSlideOut (ring[phase], idx);
+
+	return 0;
+}
+
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager_free
+	(JNIEnv *env, jobject obj) {
+
+	(void) env;
+	(void) obj;
+
+	int i;
+	for (i = 0; i < PHASES; ++i) {
+		crossbowRecordRingFree (ring[i]);
+		ring[i] = NULL;
+	}
+
+	crossbowMemoryManagerDump ();
+
+	return 0;
+}
@@ -170,8 +170,8 @@ static void *handle (void *args) {
 	pthread_barrier_wait (&(self->barrier));
 
 	while (! self->exit) {
-		/* Busy-wait for a task */
-		s = (crossbowStreamP) crossbowWaitFreeQueueDequeueOrWait (self->tasks);
+		/* Spin, then sleep, waiting for a task */
+		s = (crossbowStreamP) crossbowLockFreeQueueDequeueOrWait (self->tasks);
 		if (! s)
 			break;
 		crossbowStreamExecute (self, s);
@@ -188,7 +188,7 @@ crossbowTaskHandlerP crossbowTaskHandlerCreate (crossbowArrayListP callbackhandl
 	p->id = autoincrement++;
 	/* Create a barrier between the main thread and a task handler */
 	pthread_barrier_init(&(p->barrier), NULL, 2);
-	p->tasks = crossbowWaitFreeQueueCreate(10);
+	p->tasks = crossbowLockFreeQueueCreate (MPMC, 16);
 	p->callbackhandlers = callbackhandlers;
 	p->socket = socket;
 	p->core = core;
@@ -201,19 +201,19 @@ crossbowTaskHandlerP crossbowTaskHandlerCreate (crossbowArrayListP callbackhandl
 
 void crossbowTaskHandlerPublish (crossbowTaskHandlerP p, crossbowStreamP args) {
 	/* Should we wait for a slot to be freed? */
-	crossbowWaitFreeQueueEnqueueOrWait(p->tasks, args);
+	crossbowLockFreeQueueEnqueueOrWait (p->tasks, args);
 }
 
 void crossbowTaskHandlerFree (crossbowTaskHandlerP p) {
 	if (! p->exited) {
 		p->exit = 1;
-		/* Unblock thread */
-		crossbowWaitFreeQueueEnqueue(p->tasks, NULL);
+		/* Unblock thread (if the queue is full, it will see `exit` after its next item) */
+		crossbowLockFreeQueueTryEnqueue (p->tasks, NULL);
 	}
 	/* Wait until thread has exited */
 	pthread_join(p->thread, NULL);
 	/* Queue of events should be empty */
-	crossbowWaitFreeQueueFree (p->tasks);
+	crossbowLockFreeQueueFree (p->tasks);
 	pthread_barrier_destroy (&(p->barrier));
 	/* Task queue should be empty */
 	crossbowFree (p, sizeof(crossbow_taskhandler_t));
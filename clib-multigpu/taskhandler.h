@@ -2,7 +2,7 @@
 #define __CROSSBOW_TASKHANDLER_H_
 
 #include "list.h"
-#include "waitfreequeue.h"
+#include "lockfreequeue.h"
 #include "stream.h"
 
 #include <pthread.h>
@@ -16,7 +16,7 @@ typedef struct crossbow_taskhandler {
 
 	pthread_barrier_t barrier;
 
-	crossbowWaitFreeQueueP tasks;
+	crossbowLockFreeQueueP tasks;
 
 	crossbowArrayListP callbackhandlers;
 
@@ -37,9 +37,10 @@ static crossbowListNodeP getNode (crossbowThreadSafeQueueP queue) {
 	/* If `freeList` is NULL, all nodes are in use. */
 	if (! (p = queue->freeList)) {
 		/* Create a new pool of nodes and append them to the `freeList`.
-		 * By default the new pool size is 1.
+		 * The new pool is as large as the queue, so that expanding
+		 * the queue one item at a time allocates geometrically.
 		 */
-		p = crossbowThreadSafeQueueCreatePool (queue, 1);
+		p = crossbowThreadSafeQueueCreatePool (queue, max(1, queue->capacity));
 	}
 	queue->freeList = p->next;
 	return p;
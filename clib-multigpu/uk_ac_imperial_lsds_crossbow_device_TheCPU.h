@@ -39,6 +39,14 @@ JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_TheCPU_unbind
 JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_TheCPU_getCpuId
   (JNIEnv *, jobject);
 
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_TheCPU
+ * Method:    getNumaNode
+ * Signature: (I)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_TheCPU_getNumaNode
+  (JNIEnv *, jobject, jint);
+
 #ifdef __cplusplus
 }
 #endif
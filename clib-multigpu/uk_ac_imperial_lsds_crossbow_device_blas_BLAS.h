@@ -7,6 +7,12 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
+#undef uk_ac_imperial_lsds_crossbow_device_blas_BLAS_NO_TRANS
+#define uk_ac_imperial_lsds_crossbow_device_blas_BLAS_NO_TRANS 111L
+#undef uk_ac_imperial_lsds_crossbow_device_blas_BLAS_TRANS
+#define uk_ac_imperial_lsds_crossbow_device_blas_BLAS_TRANS 112L
+#undef uk_ac_imperial_lsds_crossbow_device_blas_BLAS_MIN_MULTIPLY_ADDS_PER_PART
+#define uk_ac_imperial_lsds_crossbow_device_blas_BLAS_MIN_MULTIPLY_ADDS_PER_PART 4194304LL
 /*
  * Class:     uk_ac_imperial_lsds_crossbow_device_blas_BLAS
  * Method:    init
@@ -26,50 +32,74 @@ JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_destro
 /*
  * Class:     uk_ac_imperial_lsds_crossbow_device_blas_BLAS
  * Method:    csgemm
- * Signature: (Ljava/lang/String;Ljava/lang/String;IIIFIIIIFII)I
+ * Signature: (IIIIIFIIIIFII)I
  */
-JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemm__Ljava_lang_String_2Ljava_lang_String_2IIIFIIIIFII
-  (JNIEnv *, jobject, jstring, jstring, jint, jint, jint, jfloat, jint, jint, jint, jint, jfloat, jint, jint);
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemm
+  (JNIEnv *, jobject, jint, jint, jint, jint, jint, jfloat, jint, jint, jint, jint, jfloat, jint, jint);
 
 /*
  * Class:     uk_ac_imperial_lsds_crossbow_device_blas_BLAS
- * Method:    csgemm
- * Signature: (Ljava/lang/String;Ljava/lang/String;IIIFLuk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIIFLuk/ac/imperial/lsds/crossbow/data/IDataBuffer;III)I
+ * Method:    csgemv
+ * Signature: (IIIFIIIIFII)I
  */
-JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemm__Ljava_lang_String_2Ljava_lang_String_2IIIFLuk_ac_imperial_lsds_crossbow_data_IDataBuffer_2IIILuk_ac_imperial_lsds_crossbow_data_IDataBuffer_2IIIFLuk_ac_imperial_lsds_crossbow_data_IDataBuffer_2III
-  (JNIEnv *, jobject, jstring, jstring, jint, jint, jint, jfloat, jobject, jint, jint, jint, jobject, jint, jint, jint, jfloat, jobject, jint, jint, jint);
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemv
+  (JNIEnv *, jobject, jint, jint, jint, jfloat, jint, jint, jint, jint, jfloat, jint, jint);
 
 /*
  * Class:     uk_ac_imperial_lsds_crossbow_device_blas_BLAS
- * Method:    csgemv
- * Signature: (Ljava/lang/String;IIFIIIIFII)I
+ * Method:    csaxpby
+ * Signature: (IFIIFII)I
  */
-JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemv__Ljava_lang_String_2IIFIIIIFII
-  (JNIEnv *, jobject, jstring, jint, jint, jfloat, jint, jint, jint, jint, jfloat, jint, jint);
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csaxpby
+  (JNIEnv *, jobject, jint, jfloat, jint, jint, jfloat, jint, jint);
 
 /*
  * Class:     uk_ac_imperial_lsds_crossbow_device_blas_BLAS
- * Method:    csgemv
- * Signature: (Ljava/lang/String;IIFLuk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;IFLuk/ac/imperial/lsds/crossbow/data/IDataBuffer;I)I
+ * Method:    csomatcopy
+ * Signature: (IIIFIIII)I
  */
-JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemv__Ljava_lang_String_2IIFLuk_ac_imperial_lsds_crossbow_data_IDataBuffer_2IIILuk_ac_imperial_lsds_crossbow_data_IDataBuffer_2IFLuk_ac_imperial_lsds_crossbow_data_IDataBuffer_2I
-  (JNIEnv *, jobject, jstring, jint, jint, jfloat, jobject, jint, jint, jint, jobject, jint, jfloat, jobject, jint);
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csomatcopy
+  (JNIEnv *, jobject, jint, jint, jint, jfloat, jint, jint, jint, jint);
 
 /*
  * Class:     uk_ac_imperial_lsds_crossbow_device_blas_BLAS
- * Method:    csaxpby
- * Signature: (IFIIFII)I
+ * Method:    csgemmDirect
+ * Signature: (IIIIIFJIJIFJI)I
  */
-JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csaxpby__IFIIFII
-  (JNIEnv *, jobject, jint, jfloat, jint, jint, jfloat, jint, jint);
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemmDirect
+  (JNIEnv *, jclass, jint, jint, jint, jint, jint, jfloat, jlong, jint, jlong, jint, jfloat, jlong, jint);
 
 /*
  * Class:     uk_ac_imperial_lsds_crossbow_device_blas_BLAS
- * Method:    csaxpby
- * Signature: (IFLuk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIIFLuk/ac/imperial/lsds/crossbow/data/IDataBuffer;I)I
+ * Method:    csgemmBatch
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemmBatch
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_blas_BLAS
+ * Method:    csgemvDirect
+ * Signature: (IIIFJIJIFJI)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csgemvDirect
+  (JNIEnv *, jclass, jint, jint, jint, jfloat, jlong, jint, jlong, jint, jfloat, jlong, jint);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_blas_BLAS
+ * Method:    csaxpbyDirect
+ * Signature: (IFJIFJI)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csaxpbyDirect
+  (JNIEnv *, jclass, jint, jfloat, jlong, jint, jfloat, jlong, jint);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_blas_BLAS
+ * Method:    csomatcopyDirect
+ * Signature: (IIIFJIJI)I
  */
-JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csaxpby__IFLuk_ac_imperial_lsds_crossbow_data_IDataBuffer_2IIIFLuk_ac_imperial_lsds_crossbow_data_IDataBuffer_2I
-  (JNIEnv *, jobject, jint, jfloat, jobject, jint, jint, jint, jfloat, jobject, jint);
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_blas_BLAS_csomatcopyDirect
+  (JNIEnv *, jclass, jint, jint, jint, jfloat, jlong, jint, jlong, jint);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,77 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager */
+
+#ifndef _Included_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager
+#define _Included_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager
+ * Method:    init
+ * Signature: (IIIII[I[I)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager_init
+  (JNIEnv *, jobject, jint, jint, jint, jint, jint, jintArray, jintArray);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager
+ * Method:    register
+ * Signature: (ILjava/lang/String;)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager_register
+  (JNIEnv *, jobject, jint, jstring);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager
+ * Method:    finalise
+ * Signature: (I)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager_finalise
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager
+ * Method:    free
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager_free
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager
+ * Method:    address
+ * Signature: (III)J
+ */
+JNIEXPORT jlong JNICALL Java_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager_address
+  (JNIEnv *, jobject, jint, jint, jint);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager
+ * Method:    capacity
+ * Signature: (II)J
+ */
+JNIEXPORT jlong JNICALL Java_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager_capacity
+  (JNIEnv *, jobject, jint, jint);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager
+ * Method:    slideOut
+ * Signature: (II)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager_slideOut
+  (JNIEnv *, jobject, jint, jint);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager
+ * Method:    slideIn
+ * Signature: (II)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_dataset_RecordDatasetMemoryManager_slideIn
+  (JNIEnv *, jobject, jint, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,197 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels */
+
+#ifndef _Included_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+#define _Included_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    init
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_init
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    destroy
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_destroy
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    relu
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIF)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_relu
+  (JNIEnv *, jobject, jobject, jint, jobject, jint, jint, jfloat);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    reluGradient
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIF)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_reluGradient
+  (JNIEnv *, jobject, jobject, jint, jobject, jint, jobject, jint, jint, jfloat);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    maxPool
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIIIIIIIIIII)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_maxPool
+  (JNIEnv *, jobject, jobject, jint, jobject, jint, jobject, jint, jint, jint, jint, jint, jint, jint, jint, jint, jint, jint, jint);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    averagePool
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIIIIIIIIIII)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_averagePool
+  (JNIEnv *, jobject, jobject, jint, jobject, jint, jint, jint, jint, jint, jint, jint, jint, jint, jint, jint, jint);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    maxPoolGradient
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;IILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_maxPoolGradient
+  (JNIEnv *, jobject, jobject, jint, jobject, jint, jint, jobject, jint, jint);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    averagePoolGradient
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIIIIIIIIIII)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_averagePoolGradient
+  (JNIEnv *, jobject, jobject, jint, jobject, jint, jint, jint, jint, jint, jint, jint, jint, jint, jint, jint, jint);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    softmax
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;III)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_softmax
+  (JNIEnv *, jobject, jobject, jint, jobject, jint, jint, jint);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    copy
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_copy
+  (JNIEnv *, jobject, jobject, jint, jobject, jint, jint);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    batchNorm
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIIIIZZFF)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_batchNorm
+  (JNIEnv *, jobject, jobject, jint, jobject, jint, jobject, jobject, jobject, jobject, jobject, jobject, jobject, jobject, jint, jint, jint, jint, jint, jboolean, jboolean, jfloat, jfloat);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    batchNormGradient
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIIII)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_batchNormGradient
+  (JNIEnv *, jobject, jobject, jint, jobject, jobject, jobject, jobject, jint, jobject, jobject, jint, jint, jint, jint, jint);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    lrn
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIIIFFF)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_lrn
+  (JNIEnv *, jobject, jobject, jint, jobject, jint, jobject, jint, jint, jint, jint, jfloat, jfloat, jfloat);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    lrnGradient
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIIIIFFF)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_lrnGradient
+  (JNIEnv *, jobject, jobject, jint, jobject, jint, jobject, jobject, jint, jint, jint, jint, jint, jfloat, jfloat, jfloat);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    matFact
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIFFZ)F
+ */
+JNIEXPORT jfloat JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_matFact
+  (JNIEnv *, jobject, jobject, jint, jobject, jint, jobject, jobject, jint, jint, jfloat, jfloat, jboolean);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    sgdUpdate
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;IFFFF)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_sgdUpdate
+  (JNIEnv *, jobject, jobject, jobject, jobject, jint, jfloat, jfloat, jfloat, jfloat);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    sumOfSquares
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;I)F
+ */
+JNIEXPORT jfloat JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_sumOfSquares
+  (JNIEnv *, jobject, jobject, jint);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    modelAverage
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;[Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;III)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_modelAverage
+  (JNIEnv *, jobject, jobject, jobjectArray, jint, jint, jint);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    elasticAverage
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;[Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIIF)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_elasticAverage
+  (JNIEnv *, jobject, jobject, jobjectArray, jint, jint, jint, jfloat);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    dataTransform
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;IILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;I[IIIIIIIILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;ZFFF)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_dataTransform
+  (JNIEnv *, jobject, jobject, jint, jint, jobject, jint, jintArray, jint, jint, jint, jint, jint, jint, jint, jobject, jboolean, jfloat, jfloat, jfloat);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    dropout
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIFIIIJ)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_dropout
+  (JNIEnv *, jobject, jobject, jint, jobject, jint, jobject, jint, jint, jfloat, jint, jint, jint, jlong);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    dropoutGradient
+ * Signature: (Luk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;ILuk/ac/imperial/lsds/crossbow/data/IDataBuffer;IIF)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_dropoutGradient
+  (JNIEnv *, jobject, jobject, jint, jobject, jint, jobject, jint, jint, jfloat);
+
+/*
+ * Class:     uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels
+ * Method:    philox
+ * Signature: ([IIIIIJ)I
+ */
+JNIEXPORT jint JNICALL Java_uk_ac_imperial_lsds_crossbow_device_kernel_CPUKernels_philox
+  (JNIEnv *, jobject, jintArray, jint, jint, jint, jint, jlong);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
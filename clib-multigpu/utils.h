@@ -68,9 +68,6 @@
 /* #define USE_NCCL */
 #undef USE_NCCL
 
-/* #define MAP_RECORDS */
-#undef MAP_RECORDS
-
 #define max(a,b) ((a) > (b) ? (a) : (b))
 #define min(a,b) ((a) < (b) ? (a) : (b))
 
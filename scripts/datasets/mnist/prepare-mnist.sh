@@ -6,6 +6,6 @@ if [ -z $CROSSBOW_HOME ]; then
 fi
 
 $CROSSBOW_HOME/scripts/datasets/mnist/download-mnist.sh
-$CROSSBOW_HOME/scripts/datasets/mnist/preprocess-mnist.sh $1
+$CROSSBOW_HOME/scripts/datasets/mnist/preprocess-mnist.sh $1 $2
 
 exit 0
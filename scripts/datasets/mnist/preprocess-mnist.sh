@@ -34,26 +34,29 @@ if [ -z $CROSSBOW_HOME ]; then
 fi
 
 CROSSBOW="${CROSSBOW_HOME}/target/crossbow-0.0.1-SNAPSHOT.jar"
-TESTS="${CROSSBOW_HOME}/target/test-classes"
 
 crossbowFileExists ${CROSSBOW}
-crossbowDirExists ${TESTS}
 
 # Set classpath
 JCP="."
-JCP="${JCP}:${CROSSBOW}:${LOG4JAPI}:${LOG4JCORE}:${TESTS}"
+JCP="${JCP}:${CROSSBOW}:${LOG4JAPI}:${LOG4JCORE}"
 
 # OPTS="-Xloggc:test-gc.out"
 OPTS="-server -XX:+UseConcMarkSweepGC -XX:NewRatio=2 -XX:SurvivorRatio=16 -Xms48g -Xmx48g"
 
 CLASS="uk.ac.imperial.lsds.crossbow.preprocess.mnist.MNIST"
-CLASSFILE="${TESTS}/`echo ${CLASS} | tr '.' '/'`.class"
 
 batchsize=$1
 if [ -z "$batchsize" ]; then
     batchsize=1
 fi
 
+# Number of encoder threads
+workers=$2
+if [ -z "$workers" ]; then
+    workers=`nproc`
+fi
+
 inputdirectory="$CROSSBOW_HOME/data/mnist/original"
 outputdirectory=`printf "$CROSSBOW_HOME/data/mnist/b-%03d" $batchsize`
 
@@ -63,7 +66,7 @@ if [ -d "$outputdirectory" ]; then
 fi
 mkdir -p $outputdirectory
 
-java $OPTS -cp $JCP $CLASS -i $inputdirectory -o $outputdirectory -b $batchsize
+java $OPTS -cp $JCP $CLASS -i $inputdirectory -o $outputdirectory -b $batchsize -w $workers
 
 echo "Done"
 
@@ -8,17 +8,20 @@ public class CoreMapper {
 	
 	private int [] offset;
 	
+	private int intraOpOffset;
+	
 	private boolean planned;
 	
 	public CoreMapper () {
 		offset = new int [3];
 		Arrays.fill(offset, -1);
+		intraOpOffset = -1;
 		planned = false;
 	}
 	
 	public CoreMapper plan () {
 		
-		int pivot;
+		int pivot = SystemConf.getInstance().numberOfWorkerThreads() + 1;
 		
 		if (SystemConf.getInstance().getGPU()) {
 			
@@ -46,8 +49,12 @@ public class CoreMapper {
 			
 			/* Configure offset for dataset handlers */
 			offset[1] = pivot;
+			pivot += SystemConf.getInstance().numberOfGPUCallbackHandlers();
 		}
 		
+		/* Intra-op threads are bound to the cores that follow all other threads */
+		intraOpOffset = pivot;
+		
 		return this;
 	}
 	
@@ -63,6 +70,14 @@ public class CoreMapper {
 	public int getCallbackHandlerOffset () { return getOffset (HandlerType.CALLBACK ); }
 	public int  getDatasetHandlerOffset () { return getOffset (HandlerType.DATASET  ); }
 	
+	public int getIntraOpThreadOffset () {
+		if (! planned) {
+			plan ();
+			planned = true;
+		}
+		return intraOpOffset;
+	}
+	
 	public void dump () {
 		
 		return;
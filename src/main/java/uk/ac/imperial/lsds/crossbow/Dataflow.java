@@ -141,7 +141,13 @@ public class Dataflow {
 		switch (ModelConf.getInstance().getDataset(phase).getType()) {
 		case  BASIC: dispatcher = new            TaskDispatcher (this); break;
 		case  LIGHT: dispatcher = new LightWeightTaskDispatcher (this); break;
-		case RECORD: dispatcher = new    ResNet50TaskDispatcher (this); break;
+		case RECORD:
+			/* On the CPU, decoded records are dispatched like a basic dataset */
+			if (SystemConf.getInstance().getGPU())
+				dispatcher = new ResNet50TaskDispatcher (this);
+			else
+				dispatcher = new         TaskDispatcher (this);
+			break;
 		}
 		
 		handler = handler.setup();
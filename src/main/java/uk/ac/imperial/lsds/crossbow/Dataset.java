@@ -12,7 +12,7 @@ import uk.ac.imperial.lsds.crossbow.types.DatasetType;
 import uk.ac.imperial.lsds.crossbow.types.Phase;
 import uk.ac.imperial.lsds.crossbow.utils.SlottedObjectPool;
 
-public class Dataset implements IDataset {
+public class Dataset implements IMappedDataset {
 
 	private DatasetMetadata meta;
 	
@@ -114,11 +114,7 @@ public class Dataset implements IDataset {
 		DatasetMemoryManager.getInstance().finalise(phase.getId());
 		
 		/* Register the first file */
-		DatasetMemoryManager.getInstance().slideIn(phase.getId(), 0);
-		
-		/* (Re-) Assign address for the first file containing examples and labels, respectively */
-		examples.elementAt(0).setAddress (DatasetMemoryManager.getInstance().address (phase.getId(), DatasetFileType.EXAMPLES.getId(), 0));
-		labels.  elementAt(0).setAddress (DatasetMemoryManager.getInstance().address (phase.getId(),   DatasetFileType.LABELS.getId(), 0));
+		slideIn (0);
 		
 		initialised = true;
 		
@@ -173,6 +169,20 @@ public class Dataset implements IDataset {
 		return labels.elementAt (idx);
 	}
 
+	public void slideIn (int idx) {
+		
+		DatasetMemoryManager.getInstance().slideIn (phase.getId(), idx);
+		
+		/* (Re-) Assign address for the file containing examples and labels, respectively */
+		examples.elementAt(idx).setAddress (DatasetMemoryManager.getInstance().address (phase.getId(), DatasetFileType.EXAMPLES.getId(), idx));
+		labels.  elementAt(idx).setAddress (DatasetMemoryManager.getInstance().address (phase.getId(),   DatasetFileType.LABELS.getId(), idx));
+	}
+	
+	public void slideOut (int idx) {
+		
+		DatasetMemoryManager.getInstance().slideOut (phase.getId(), idx);
+	}
+	
 	@Override
 	public boolean isInitialised () {
 		return initialised;
@@ -36,6 +36,12 @@ public class DatasetMetadata {
 	
 	private DataType [] type;
 	
+	/* 
+	 * Examples stored in a compact type (e.g. uint8) are widened to floats
+	 * as `scale x value + shift`
+	 */
+	private float scale, shift;
+	
 	/* Data files are page-alligned so that, when mapped to memory, 
 	 * they can be registered with CUDA memory. 
 	 */
@@ -62,6 +68,9 @@ public class DatasetMetadata {
 			pad    [i] = 0;
 		}
 		
+		scale = 1F;
+		shift = 0F;
+		
 		fill = -1;
 		loaded = false;
 	}
@@ -196,6 +205,22 @@ public class DatasetMetadata {
 		return getType (1);
 	}
 	
+	public void setExampleScale (float scale, float shift) {
+		
+		this.scale = scale;
+		this.shift = shift;
+	}
+	
+	public float getExampleScale () {
+		
+		return scale;
+	}
+	
+	public float getExampleShift () {
+		
+		return shift;
+	}
+	
 	public void setPrefix (int ndx, String prefix) {
 		
 		this.prefix [ndx] = prefix;
@@ -328,6 +353,14 @@ public class DatasetMetadata {
 					
 				type [1] = DataType.fromString (value);
 			
+			} else if (key.equalsIgnoreCase("example scale")) {
+				
+				scale = Float.parseFloat(value);
+			
+			} else if (key.equalsIgnoreCase("example shift")) {
+				
+				shift = Float.parseFloat(value);
+			
 			} else if (key.equalsIgnoreCase("fill")) {
 				
 				fill = Integer.parseInt(value);
@@ -363,6 +396,11 @@ public class DatasetMetadata {
 		meta.append(String.format("example pad  : %d\n",    pad [0]));
 		meta.append(String.format("label pad    : %d\n",    pad [1]));
 		
+		if (type [0].isCompact ()) {
+			meta.append(String.format("example scale: %s\n", Float.toString(scale)));
+			meta.append(String.format("example shift: %s\n", Float.toString(shift)));
+		}
+		
 		if (isFillSet ())
 			meta.append(String.format("fill         : %d\n", fill));
 		
@@ -383,6 +421,8 @@ public class DatasetMetadata {
 		s.append(String.format("Labels   at \"%s.*\"", prefix [1])).append("\n");
 		s.append(String.format("%d x %s %ss per example batch", batchSize, shape [0], type [0])).append("\n");
 		s.append(String.format("%d x %s %ss per label batch", batchSize, shape [1], type [1])).append("\n");
+		if (type [0].isCompact ())
+			s.append(String.format("Examples widened to floats as %s x value + %s", Float.toString(scale), Float.toString(shift))).append("\n");
 		s.append(String.format("Example batches padded by %d bytes", pad [0])).append("\n");
 		s.append(String.format("Label batches padded by %d bytes", pad [1])).append("\n");
 		if (isFillSet ())
@@ -14,6 +14,8 @@ import uk.ac.imperial.lsds.crossbow.device.TheGPU;
 import uk.ac.imperial.lsds.crossbow.device.blas.BLAS;
 import uk.ac.imperial.lsds.crossbow.device.dataset.DatasetMemoryManager;
 import uk.ac.imperial.lsds.crossbow.device.dataset.LightWeightDatasetMemoryManager;
+import uk.ac.imperial.lsds.crossbow.device.dataset.RecordDatasetMemoryManager;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
 import uk.ac.imperial.lsds.crossbow.device.random.RandomGenerator;
 import uk.ac.imperial.lsds.crossbow.model.Model;
 import uk.ac.imperial.lsds.crossbow.model.ModelManager;
@@ -97,8 +99,12 @@ public class ExecutionContext {
 		TheCPU.getInstance().bind(0);
 		
 		/* Initialise the (Open)BLAS library only if CPU mode is enabled */
-		if (SystemConf.getInstance().getCPU())
+		if (SystemConf.getInstance().getCPU()) {
 			BLAS.getInstance().init();
+			/* Load native CPU kernels (pooling, ReLU, softmax, etc.) */
+			CPUKernels.getInstance().load();
+			CPUKernels.getInstance().init();
+		}
 		
 		TheGPU.getInstance().init();
 		
@@ -606,14 +612,23 @@ public class ExecutionContext {
 		monitor.stop ();
 		workerPool.stop();
 		
+		modelManager.destroy ();
+		
 		if(BLAS.getInstance().isLoaded())
 			BLAS.getInstance().destroy ();
 		
+		if (CPUKernels.getInstance().isLoaded())
+			CPUKernels.getInstance().destroy ();
+		
 		/* Free dataset file handlers */
 		switch (ModelConf.getInstance().getDatasetType()) {
 		
 		case  BASIC:            DatasetMemoryManager.getInstance().free(); break;
 		case  LIGHT: LightWeightDatasetMemoryManager.getInstance().free(); break;
+		case RECORD:
+			if (RecordDatasetMemoryManager.getInstance().isLoaded())
+				RecordDatasetMemoryManager.getInstance().free();
+			break;
 		default:
 			break;
 		}
@@ -0,0 +1,31 @@
+package uk.ac.imperial.lsds.crossbow;
+
+import uk.ac.imperial.lsds.crossbow.data.MappedDataBuffer;
+import uk.ac.imperial.lsds.crossbow.utils.SlottedObjectPool;
+
+/*
+ * A dataset whose examples and labels are memory-mapped in partitions that
+ * the task dispatcher slides in and out as it moves through the dataset.
+ */
+public interface IMappedDataset extends IDataset {
+	
+	public int numberOfPartitions ();
+	
+	public long getExamplesCapacity ();
+	
+	public long getLabelsCapacity ();
+	
+	public SlottedObjectPool<MappedDataBuffer> getExamples ();
+	
+	public MappedDataBuffer getExamples (int idx);
+	
+	public SlottedObjectPool<MappedDataBuffer> getLabels ();
+	
+	public MappedDataBuffer getLabels (int idx);
+	
+	/* Waits until partition `idx` is available and (re-)assigns its address */
+	public void slideIn (int idx);
+	
+	/* Releases partition `idx`, once all tasks over it have completed */
+	public void slideOut (int idx);
+}
@@ -9,6 +9,7 @@ import uk.ac.imperial.lsds.crossbow.cli.Option;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
 import uk.ac.imperial.lsds.crossbow.device.dataset.DatasetMemoryManager;
 import uk.ac.imperial.lsds.crossbow.device.dataset.LightWeightDatasetMemoryManager;
+import uk.ac.imperial.lsds.crossbow.device.dataset.RecordDatasetMemoryManager;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.SolverConf;
 import uk.ac.imperial.lsds.crossbow.model.Shape;
 import uk.ac.imperial.lsds.crossbow.types.Phase;
@@ -45,6 +46,8 @@ public class ModelConf {
 	
 	private SolverConf solverConf;
 	
+	private float sparseGradientThreshold;
+	
 	public ModelConf () {
 		
 		/* Fill command-line arguments */
@@ -58,6 +61,7 @@ public class ModelConf {
 		opts.add (new Option ("--splits"            ).setType (Integer.class));
 		opts.add (new Option ("--test-interval"     ).setType (Integer.class));
 		opts.add (new Option ("--update-model"      ).setType ( String.class));
+		opts.add (new Option ("--sparse-gradient-threshold").setType (Float.class));
 		
 		/* Add solver command-line arguments */
 		opts.addAll(SolverConf.getOptions ());
@@ -81,6 +85,8 @@ public class ModelConf {
 		updateModel = UpdateModel.DEFAULT;
 		
 		solverConf = new SolverConf (this);
+		
+		sparseGradientThreshold = 0.25F;
 	}
 	
 	public ModelConf setWpcUnit (TrainingUnit wpcUnit) {
@@ -200,6 +206,19 @@ public class ModelConf {
 		return solverConf;
 	}
 	
+	/*
+	 * Row-sparse gradients fall back to dense ones once they touch more than
+	 * this fraction of the rows of a variable. If 0, they are always dense.
+	 */
+	public ModelConf setSparseGradientThreshold (float sparseGradientThreshold) {
+		this.sparseGradientThreshold = sparseGradientThreshold;
+		return this;
+	}
+	
+	public float getSparseGradientThreshold () {
+		return sparseGradientThreshold;
+	}
+	
 	public Shape getInputShape (Phase phase) {
 		
 		Shape exampleshape = getDataset(phase).getMetadata().getExampleShape();
@@ -302,6 +321,10 @@ public class ModelConf {
 				System.exit(1);
 			}
 		}
+		else if (arg.equals("--sparse-gradient-threshold")) {
+			
+			setSparseGradientThreshold (opt.getFloatValue ());
+		}
 		else if (arg.equals("--learning-rate-decay-policy")) {
 			
 			try {
@@ -476,6 +499,8 @@ public class ModelConf {
 			}
 			break;
 		case RECORD:
+			if (! SystemConf.getInstance().getGPU())
+				RecordDatasetMemoryManager.getInstance().init ();
 			for (int i = 0; i < datasets.length; ++i) {
 				if (datasets[i] != null) {
 					log.info(String.format("[DBG] Initialise dataset #%d", i));
@@ -509,6 +534,7 @@ public class ModelConf {
 		s.append (String.format("%d split%s\n", splits, ((splits > 1) ? "s" : "")));
 		s.append (String.format("Test every %d tasks\n", getTestInterval ()));
 		s.append (String.format("Synchronise with %s\n", getUpdateModel ()));
+		s.append (String.format("Row-sparse gradients fall back to dense above %.2f%% of rows\n", sparseGradientThreshold * 100));
 		s.append (String.format("Using %s datasets\n", getDatasetType().toString()));
 		
 		/* Append solver configuration */
@@ -2,16 +2,35 @@ package uk.ac.imperial.lsds.crossbow;
 
 import java.io.IOException;
 import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 
 import org.apache.logging.log4j.LogManager;
 import org.apache.logging.log4j.Logger;
 
+import uk.ac.imperial.lsds.crossbow.data.MappedDataBuffer;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
+import uk.ac.imperial.lsds.crossbow.device.dataset.RecordDatasetMemoryManager;
+import uk.ac.imperial.lsds.crossbow.types.DataType;
+import uk.ac.imperial.lsds.crossbow.types.DatasetFileType;
 import uk.ac.imperial.lsds.crossbow.types.DatasetType;
 import uk.ac.imperial.lsds.crossbow.types.HandlerType;
 import uk.ac.imperial.lsds.crossbow.types.Phase;
+import uk.ac.imperial.lsds.crossbow.utils.SlottedObjectPool;
 
-public class RecordDataset implements IDataset {
+/*
+ * A dataset of JPEG records, decoded by a pool of native workers.
+ *
+ * On the GPU, decoded batches are double-buffered and dispatched by the
+ * `ResNet50TaskDispatcher`. Otherwise, they are decoded into a ring of
+ * `SLOTS` slots (each holding as many batches as the task queue) that the
+ * `TaskDispatcher` slides in and out like the partitions of a `Dataset`.
+ */
+public class RecordDataset implements IMappedDataset {
+	
+	private static final int SLOTS = 3;
+	
+	/* A slot is mapped as a single buffer, so it cannot exceed 2GB */
+	private static final long MAX_SLOT_SIZE = Integer.MAX_VALUE;
 	
 	@SuppressWarnings("unused")
 	private final static Logger log = LogManager.getLogger (RecordDataset.class);
@@ -24,7 +43,11 @@ public class RecordDataset implements IDataset {
 	
 	private boolean initialised;
 	
-	private int [] capacity;
+	/* The size of a slot, in bytes; on the CPU, after `init()`, the size of the ring */
+	private long [] capacity;
+	
+	private SlottedObjectPool<MappedDataBuffer> examples;
+	private SlottedObjectPool<MappedDataBuffer>   labels;
 	
 	public RecordDataset (String metadatafile) throws IOException {
 		
@@ -38,7 +61,9 @@ public class RecordDataset implements IDataset {
 		
 		initialised = false;
 		
-		capacity = new int [2];
+		capacity = new long [2];
+		
+		examples = labels = null;
 	}
 	
 	public void setPhase (Phase phase) {
@@ -54,7 +79,8 @@ public class RecordDataset implements IDataset {
 	}
 	
 	public int numberOfPartitions () {
-		return parts;
+		/* On the CPU, the dispatcher slides slots in and out */
+		return (examples == null) ? parts : SLOTS;
 	}
 	
 	public void init () {
@@ -68,14 +94,27 @@ public class RecordDataset implements IDataset {
 		meta.realign ();
 		meta.refill  ();
 		
-		capacity [0] = SystemConf.getInstance().getTaskQueueSizeLimit() * (meta.getExampleSize () * meta.getBatchSize () + meta.getExamplesFilePad ());
-		capacity [1] = SystemConf.getInstance().getTaskQueueSizeLimit() * (meta.getLabelSize   () * meta.getBatchSize () + meta.getLabelsFilePad   ());
+		long batches = SystemConf.getInstance().getTaskQueueSizeLimit();
+		
+		capacity [0] = batches * ((long) meta.getExampleSize () * (long) meta.getBatchSize () + meta.getExamplesFilePad ());
+		capacity [1] = batches * ((long) meta.getLabelSize   () * (long) meta.getBatchSize () + meta.getLabelsFilePad   ());
+		
+		for (int i = 0; i < 2; ++i) {
+			if (capacity [i] > MAX_SLOT_SIZE)
+				throw new IllegalArgumentException (String.format("error: record dataset slot of %d %s batches is %d bytes (at most %d bytes); reduce the batch size or the task queue size limit", 
+						batches, ((i == 0) ? "example" : "label"), capacity [i], MAX_SLOT_SIZE));
+		}
+		
+		if (! SystemConf.getInstance().getGPU()) {
+			initRing ();
+			return;
+		}
 		
 		log.info(">>>>>>>>> Initialise dataset... " + SystemConf.getInstance().getCoreMapper().getOffset(HandlerType.DATASET));
 		TheGPU.getInstance().recordDatasetInit (
 				phase.getId(), 
 				SystemConf.getInstance().numberOfFileHandlers(),
-				capacity,
+				new int [] { (int) capacity [0], (int) capacity [1] },
 				SystemConf.getInstance().getTaskQueueSizeLimit(),
 				ModelConf.getInstance().getBatchSize(),
 				meta.getPad()
@@ -98,6 +137,82 @@ public class RecordDataset implements IDataset {
 		return;
 	}
 	
+	private void initRing () {
+		
+		int batches = SystemConf.getInstance().getTaskQueueSizeLimit();
+		
+		RecordDatasetMemoryManager.getInstance().init (
+				phase.getId(),
+				Math.max(2, SystemConf.getInstance().numberOfFileHandlers()),
+				SLOTS,
+				batches,
+				ModelConf.getInstance().getBatchSize(),
+				new int [] { meta.getExampleSize (), meta.getLabelSize () },
+				meta.getPad()
+		);
+		
+		for (int id = 0; id < parts; ++id)
+			RecordDatasetMemoryManager.getInstance().register (phase.getId(), String.format("%s.%d", meta.getExamplesFilePrefix (), (id + 1)));
+		
+		/* Start decoding into every slot */
+		RecordDatasetMemoryManager.getInstance().finalise (phase.getId());
+		
+		examples = new SlottedObjectPool<MappedDataBuffer> (SLOTS);
+		labels   = new SlottedObjectPool<MappedDataBuffer> (SLOTS);
+		
+		for (int id = 0; id < SLOTS; ++id) {
+			
+			examples.setElementAt(id, newBuffer (DatasetFileType.EXAMPLES, id, meta.getExampleType()));
+			labels.  setElementAt(id, newBuffer (DatasetFileType.LABELS,   id, meta.getLabelType()));
+		}
+		
+		capacity [0] *= SLOTS;
+		capacity [1] *= SLOTS;
+		
+		slideIn (0);
+		
+		initialised = true;
+	}
+	
+	private MappedDataBuffer newBuffer (DatasetFileType type, int id, DataType dataType) {
+		
+		long address = RecordDatasetMemoryManager.getInstance().address  (phase.getId(), type.getId(), id);
+		long size    = RecordDatasetMemoryManager.getInstance().capacity (phase.getId(), type.getId());
+		
+		if (size != capacity [type.getId()])
+			throw new IllegalStateException (String.format("error: invalid record dataset slot size (found %d, expected %d)", size, capacity [type.getId()]));
+		
+		MappedDataBuffer buffer = new MappedDataBuffer (phase, type, id, address, (int) size, dataType);
+		buffer.order(ByteOrder.LITTLE_ENDIAN);
+		return buffer;
+	}
+	
+	public SlottedObjectPool<MappedDataBuffer> getExamples () {
+		return examples;
+	}
+	
+	public MappedDataBuffer getExamples (int idx) {
+		return examples.elementAt (idx);
+	}
+	
+	public SlottedObjectPool<MappedDataBuffer> getLabels () {
+		return labels;
+	}
+	
+	public MappedDataBuffer getLabels (int idx) {
+		return labels.elementAt (idx);
+	}
+	
+	/* Waits until slot `idx` has been decoded */
+	public void slideIn (int idx) {
+		RecordDatasetMemoryManager.getInstance().slideIn (phase.getId(), idx);
+	}
+	
+	/* Decodes the next batches into slot `idx` */
+	public void slideOut (int idx) {
+		RecordDatasetMemoryManager.getInstance().slideOut (phase.getId(), idx);
+	}
+	
 	@Override
 	public boolean isInitialised () {
 		return initialised;
@@ -119,10 +234,10 @@ public class RecordDataset implements IDataset {
 	}
 
 	public long getExamplesCapacity () {
-		return (long) capacity[0];
+		return capacity[0];
 	}
 
 	public long getLabelsCapacity() {
-		return (long) capacity[1];
+		return capacity[1];
 	}
 }
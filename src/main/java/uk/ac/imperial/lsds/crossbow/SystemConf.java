@@ -62,6 +62,9 @@ public class SystemConf {
 	private int workers;
 	private int [] replicas;
 	
+	/* Threads that only run parts of CPU workers' tasks (e.g. ranges of examples) */
+	private int intraOpThreads;
+	
 	private int slots;
 	
 	private SchedulingPolicy schedulingPolicy;
@@ -91,6 +94,12 @@ public class SystemConf {
 	private int checkpointInterval;
 	private TrainingUnit checkpointIntervalUnit;
 	
+	/* 
+	 * CPU model checkpoints between two full checkpoints store only the 
+	 * blocks that changed since the previous checkpoint
+	 */
+	private int fullCheckpointInterval;
+	
 	private boolean queue;
 	
 	private boolean tee;
@@ -137,6 +146,7 @@ public class SystemConf {
 		opts.add (new Option ("--checkpoint-directory"       ).setType ( String.class));
 		opts.add (new Option ("--model-directory"            ).setType ( String.class));
 		opts.add (new Option ("--number-of-workers"          ).setType (Integer.class));
+		opts.add (new Option ("--number-of-intra-op-threads" ).setType (Integer.class));
 		opts.add (new Option ("--number-of-cpu-models"       ).setType (Integer.class));
 		opts.add (new Option ("--number-of-gpu-models"       ).setType (Integer.class));
 		opts.add (new Option ("--number-of-result-slots"     ).setType (Integer.class));
@@ -156,6 +166,7 @@ public class SystemConf {
 		opts.add (new Option ("--display-accumulated-loss"   ).setType (Boolean.class));
 		opts.add (new Option ("--checkpoint-interval"        ).setType (Integer.class));
 		opts.add (new Option ("--checkpoint-interval-unit"   ).setType ( String.class));
+		opts.add (new Option ("--full-checkpoint-interval"   ).setType (Integer.class));
 		opts.add (new Option ("--queue-measurements"         ).setType (Boolean.class));
 		opts.add (new Option ("--file-partition-size"        ).setType (   Long.class));
 		opts.add (new Option ("--task-queue-size"            ).setType (Integer.class));
@@ -179,6 +190,7 @@ public class SystemConf {
 		checkpointDirectory = modelDirectory = null;
 		
 		workers = 1;
+		intraOpThreads = 0;
 		replicas = new int [2];
 		replicas[0] = replicas[1] = 1;
 		
@@ -208,6 +220,7 @@ public class SystemConf {
 		
 		checkpointInterval = 0;
 		checkpointIntervalUnit = TrainingUnit.TASKS;
+		fullCheckpointInterval = 1;
 		
 		queue = false;
 		
@@ -296,6 +309,15 @@ public class SystemConf {
 		return workers;
 	}
 	
+	public SystemConf setNumberOfIntraOpThreads (int intraOpThreads) {
+		this.intraOpThreads = intraOpThreads;
+		return this;
+	}
+	
+	public int numberOfIntraOpThreads () {
+		return intraOpThreads;
+	}
+	
 	public SystemConf setNumberOfCPUModelReplicas (int replicas) {
 		this.replicas[0] = replicas;
 		return this;
@@ -467,6 +489,16 @@ public class SystemConf {
 		return checkpointIntervalUnit;
 	}
 	
+	public SystemConf setFullCheckpointInterval (int fullCheckpointInterval) {
+		this.fullCheckpointInterval = fullCheckpointInterval;
+		return this;
+	}
+	
+	/* Every n-th CPU model checkpoint is a full one; the rest are incremental */
+	public int getFullCheckpointInterval () {
+		return fullCheckpointInterval;
+	}
+	
 	public SystemConf queueMeasurements (boolean queue) {
 		this.queue = queue;
 		return this;
@@ -636,6 +668,10 @@ public class SystemConf {
 			
 			setNumberOfWorkerThreads (opt.getIntValue ());
 		} 
+		else if (arg.equals("--number-of-intra-op-threads")) {
+			
+			setNumberOfIntraOpThreads (opt.getIntValue ());
+		}
 		else if (arg.equals("--number-of-cpu-models")) {
 			
 			setNumberOfCPUModelReplicas (opt.getIntValue ());
@@ -738,6 +774,10 @@ public class SystemConf {
 				System.exit(1);
 			}
 		}
+		else if (arg.equals("--full-checkpoint-interval")) {
+			
+			setFullCheckpointInterval (opt.getIntValue ());
+		}
 		else if (arg.equals("--queue-measurements")) {
 			
 			queueMeasurements (opt.getBooleanValue ());
@@ -793,6 +833,7 @@ public class SystemConf {
 		s.append(String.format("Checkpoint directory is %s\n", checkpointDirectory));
 		s.append(String.format("%s execution mode\n", (isHybrid() ? "Hybrid" : (getGPU() ? "GPU-only" : "CPU-only"))));
 		s.append(String.format("%d worker threads\n", workers));
+		s.append(String.format("%d intra-op threads\n", intraOpThreads));
 		s.append(String.format("%d CPU model replicas\n", replicas[0]));
 		s.append(String.format("%d reader%s per CPU model replica\n", readersPerModel, (readersPerModel > 1 ? "s" : "")));
 		s.append(String.format("%d GPU model replicas\n", replicas[1]));
@@ -813,6 +854,9 @@ public class SystemConf {
 		s.append(String.format("%s measurements\n", (tee ? "Tee" : "Don't tee")));
 		s.append(String.format("%d bytes per input data partition [max]\n", filePartitionSize));
 		s.append(String.format("%d tasks queued [max]\n", taskQueueSizeLimit));
+		if (checkpointInterval > 0)
+			s.append(String.format("Checkpoint model(s) every %d %s (every %d CPU model checkpoint(s) is full)\n", 
+					checkpointInterval, checkpointIntervalUnit.toString(checkpointInterval > 1), fullCheckpointInterval));
 		s.append(String.format("Random seed is %d\n", seed));
 		s.append(String.format("Performance monitor interval is %d\n", performanceMonitorInterval));
 		s.append(String.format("%s number of model replicas per GPU\n", (autotune ? "Auto-tune" : "Don't auto-tune")));
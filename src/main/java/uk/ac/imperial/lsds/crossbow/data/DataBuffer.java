@@ -5,6 +5,7 @@ import java.nio.ByteOrder;
 
 import uk.ac.imperial.lsds.crossbow.SystemConf;
 import uk.ac.imperial.lsds.crossbow.types.DataType;
+import uk.ac.imperial.lsds.crossbow.utils.Bits;
 import uk.ac.imperial.lsds.crossbow.utils.IObjectPool;
 import uk.ac.imperial.lsds.crossbow.utils.Pooled;
 
@@ -18,6 +19,9 @@ public class DataBuffer implements IDataBuffer, Pooled<DataBuffer> {
 
 	private boolean direct;
 	
+	/* Resolved once, so that native calls need not look it up */
+	private long address;
+	
 	/* 
 	 * Data buffers have fixed size but they are not necessarily always full. 
 	 * When a buffer is finalised, it can no longer be modified: the current
@@ -48,8 +52,10 @@ public class DataBuffer implements IDataBuffer, Pooled<DataBuffer> {
 		
 		if (! direct) {
 			buffer = ByteBuffer.allocate (this.capacity).order (ByteOrder.LITTLE_ENDIAN);
+			address = 0L;
 		} else {
 			buffer = ByteBuffer.allocateDirect (this.capacity).order (ByteOrder.LITTLE_ENDIAN);
+			address = Bits.address (buffer);
 		}
 		
 		finalised = false;
@@ -199,7 +205,14 @@ public class DataBuffer implements IDataBuffer, Pooled<DataBuffer> {
 	public boolean isDirect () {
 		return direct;
 	}
-	
+
+	@Override
+	public long address () {
+		if (! direct)
+			throw new UnsupportedOperationException ("error: buffer is not direct");
+		return address;
+	}
+
 	@Override
 	public void finalise (int offset) {
 	
@@ -30,6 +30,9 @@ public interface IDataBuffer {
 	
 	public boolean isDirect ();
 	
+	/* The native address of a direct buffer */
+	public long address ();
+	
 	public void finalise (int index);
 	public boolean isFinalised ();
 	
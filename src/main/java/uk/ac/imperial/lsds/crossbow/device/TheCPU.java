@@ -37,4 +37,7 @@ public class TheCPU {
 	public native int bind (int cpu);
 	public native int unbind ();
 	public native int getCpuId ();
+	
+	/* NUMA node of a core (0 if unknown) */
+	public native int getNumaNode (int cpu);
 }
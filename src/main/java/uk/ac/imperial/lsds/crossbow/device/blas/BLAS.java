@@ -5,6 +5,7 @@ import org.apache.logging.log4j.Logger;
 
 import uk.ac.imperial.lsds.crossbow.SystemConf;
 import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
+import uk.ac.imperial.lsds.crossbow.processor.IdleWorkerQueue;
 import uk.ac.imperial.lsds.crossbow.types.DataType;
 
 public class BLAS {
@@ -13,6 +14,13 @@ public class BLAS {
 	
 	private static final BLAS blasInstance = new BLAS ();
 	
+	/* Transpose codes (the values of CBLAS_TRANSPOSE) */
+	public static final int NO_TRANS = 111;
+	public static final int    TRANS = 112;
+	
+	/* Large GEMM calls are split by rows of C, with at least that many multiply-adds per part */
+	private static final long MIN_MULTIPLY_ADDS_PER_PART = 1L << 22;
+	
 	public static BLAS getInstance () { return blasInstance; }
 	
 	private HeapMemoryManager manager;
@@ -49,12 +57,12 @@ public class BLAS {
 		init (numberOfBuffers, bufferSize);
 	}
 	
-	private int arraySize (int rows, int columns, DataType type) {
+	static int arraySize (int rows, int columns, DataType type) {
 		
 		return (rows * columns * type.sizeOf());
 	}
 	
-	private void checkArrayBounds (String array, String method, int expected, int m, int n) {
+	static void checkArrayBounds (String array, String method, int expected, int m, int n) {
 		
 		int size = arraySize (m, n, DataType.FLOAT);
 		if (size != expected)
@@ -62,6 +70,24 @@ public class BLAS {
 				(String.format("error: incorrect size of array %s in %s (found %d, expected %d)", array, method, size, expected));
 	}
 	
+	public static int transpose (String Trans) {
+		
+		switch (Trans.charAt(0)) {
+		case 'N':
+		case 'n': return NO_TRANS;
+		case 'T':
+		case 't': return TRANS;
+		default:
+			throw new IllegalArgumentException (String.format("error: invalid transpose code: %s", Trans));
+		}
+	}
+	
+	static void checkTranspose (int Trans) {
+		
+		if (Trans != NO_TRANS && Trans != TRANS)
+			throw new IllegalArgumentException (String.format("error: invalid transpose code: %d", Trans));
+	}
+	
 	public void inputDataMovementCallback (int ndx, long address, int size) {
 		
 		manager.inputDataMovementCallback(ndx, address, size);
@@ -83,8 +109,8 @@ public class BLAS {
 	 */
 	
 	public int sgemm (
-			String TransA, 
-			String TransB, 
+			int TransA, 
+			int TransB, 
 			int M, 
 			int N, 
 			int K, 
@@ -98,8 +124,8 @@ public class BLAS {
 	}
 	
 	public int sgemm (
-			String TransA, 
-			String TransB, 
+			int TransA, 
+			int TransB, 
 			int M, 
 			int N, 
 			int K, 
@@ -113,7 +139,10 @@ public class BLAS {
 		
 		if (! isLoaded())
 			throw new IllegalStateException ("error: BLAS library is not loaded");
-
+		
+		checkTranspose (TransA);
+		checkTranspose (TransB);
+		
 		/* Check bounds */
 		checkArrayBounds ("A", "sgemm", endA - startA, M, K);
 		checkArrayBounds ("B", "sgemm", endB - startB, K, N);
@@ -142,20 +171,65 @@ public class BLAS {
 			manager.free (z);
 		
 		} else
-			result = csgemm (
+			result = sgemmDirect (
 					TransA, 
 					TransB, 
 					M, 
 					N, 
 					K, 
 					alpha, 
-					A, startA, endA, lda, 
-					B, startB, endB, ldb, 
+					A.address() + startA, lda, 
+					B.address() + startB, ldb, 
 					beta, 
-					C, startC, endC, ldc);
+					C.address() + startC, ldc);
 
 		return result;
 	}
+	
+	/*
+	 * Splits C (and op(A)) into ranges of rows that are multiplied in parallel,
+	 * if other workers are idle. OpenBLAS itself is single-threaded.
+	 */
+	private int sgemmDirect (
+			final int TransA, 
+			final int TransB, 
+			int M, 
+			final int N, 
+			final int K, 
+			final float alpha, 
+			final long A, final int lda, 
+			final long B, final int ldb, 
+			final float beta, 
+			final long C, final int ldc) {
+		
+		int grain = (int) Math.min(M, Math.max(1L, MIN_MULTIPLY_ADDS_PER_PART / Math.max(1L, (long) N * K)));
+		
+		IdleWorkerQueue.getInstance().parallelFor (M, grain, new IdleWorkerQueue.Range () {
+			public void run (int from, int to) {
+				/* Row `from` of op(A) starts at row `from` of A, or at column `from` of A if transposed */
+				long rowA = (TransA == NO_TRANS) ? ((long) from * lda * 4L) : ((long) from * 4L);
+				csgemmDirect (TransA, TransB, to - from, N, K, alpha, A + rowA, lda, B, ldb, beta, C + ((long) from * ldc * 4L), ldc);
+			}
+		});
+		
+		return 0;
+	}
+	
+	/* Runs the GEMM calls of a batch, in order, with a single native call */
+	public int sgemm (GemmBatch batch) {
+		
+		int result = 0;
+		
+		if (! isLoaded())
+			throw new IllegalStateException ("error: BLAS library is not loaded");
+		
+		if (batch.size() > 0)
+			result = csgemmBatch (batch.address(), batch.size());
+		
+		batch.clear();
+		
+		return result;
+	}
 
 	/* Perform matrix-vector operation Y = alpha (A X) + beta Y
 	 *
@@ -166,7 +240,7 @@ public class BLAS {
 	 * Y is a M vector if TransA == 'N' or a N vector otherwise
 	 */
 	public int sgemv (
-			String TransA,  
+			int TransA,  
 			int M, 
 			int N,  
 			float alpha, 
@@ -180,10 +254,12 @@ public class BLAS {
 		if (! isLoaded())
 			throw new IllegalStateException ("error: BLAS library is not loaded");
 		
+		checkTranspose (TransA);
+		
 		/* Check bounds */
 		checkArrayBounds ("A", "sgemv", end - start, M, N);
-		checkArrayBounds ("X", "sgemv", X.limit(), 1, TransA.equals("N") ? N : M);
-		checkArrayBounds ("Y", "sgemv", Y.limit(), 1, TransA.equals("N") ? M : N);
+		checkArrayBounds ("X", "sgemv", X.limit(), 1, (TransA == NO_TRANS) ? N : M);
+		checkArrayBounds ("Y", "sgemv", Y.limit(), 1, (TransA == NO_TRANS) ? M : N);
 		
 		if (! SystemConf.getInstance().useDirectBuffers()) {
 			
@@ -207,15 +283,15 @@ public class BLAS {
 			manager.free (y);
 		
 		} else
-			result = csgemv (
+			result = csgemvDirect (
 					TransA, 
 					M, 
 					N, 
 					alpha, 
-					A, start, end, lda, 
-					X, incX, 
+					A.address() + start, lda, 
+					X.address(), incX, 
 					beta, 
-					Y, incY);
+					Y.address(), incY);
 		
 		return result;
 	}
@@ -255,12 +331,64 @@ public class BLAS {
 			manager.free (y);
 		
 		} else
-			csaxpby (
+			result = csaxpbyDirect (
 					N, 
 					alpha, 
-					X, start, end, incX, 
+					X.address() + start, incX, 
 					beta, 
-					Y, incY);
+					Y.address(), incY);
+		
+		return result;
+	}
+	
+	/* 
+	 * Compute B = alpha op(A), where op(A) is either A or its transpose.
+	 * 
+	 * A is a rows x cols matrix with leading dimension lda, and B 
+	 * is a rows x cols (or cols x rows, if transposed) matrix with 
+	 * leading dimension ldb.
+	 * 
+	 * Used to scatter (or gather) strided sub-matrices in one pass.
+	 */
+	public int somatcopy (
+			int Trans, 
+			int rows, 
+			int cols, 
+			float alpha, 
+			IDataBuffer A, int startA, int endA, int lda, 
+			IDataBuffer B, int startB, int endB, int ldb) {
+		
+		int result = 0;
+		
+		if (! isLoaded())
+			throw new IllegalStateException ("error: BLAS library is not loaded");
+		
+		checkTranspose (Trans);
+		
+		if (! SystemConf.getInstance().useDirectBuffers()) {
+			
+			Integer x = manager.setAndGet (A, startA, endA);
+			Integer y = manager.setAndGet (B, startB, endB);
+			
+			result = csomatcopy (
+					Trans, 
+					rows, 
+					cols, 
+					alpha, 
+					x.intValue(), lda, 
+					y.intValue(), ldb);
+			
+			manager.free (x);
+			manager.free (y);
+		
+		} else
+			result = csomatcopyDirect (
+					Trans, 
+					rows, 
+					cols, 
+					alpha, 
+					A.address() + startA, lda, 
+					B.address() + startB, ldb);
 		
 		return result;
 	}
@@ -270,9 +398,11 @@ public class BLAS {
 	private native int init (int size, int bufferSize);
 	public native int destroy ();
 	
+	/* Operands are buffer pool slots */
+	
 	private native int csgemm (
-			String TransA, 
-			String TransB, 
+			int TransA, 
+			int TransB, 
 			int M, 
 			int N, 
 			int K, 
@@ -282,20 +412,8 @@ public class BLAS {
 			float beta, 
 			int C, int ldc);
 	
-	private native int csgemm (
-			String TransA, 
-			String TransB, 
-			int M, 
-			int N, 
-			int K, 
-			float alpha, 
-			IDataBuffer A, int startA, int endA, int lda, 
-			IDataBuffer B, int startB, int endB, int ldb, 
-			float beta, 
-			IDataBuffer C, int startC, int endC, int ldc);
-	
 	private native int csgemv (
-			String TransA,  
+			int TransA,  
 			int M, 
 			int N, 
 			float alpha, 
@@ -304,16 +422,6 @@ public class BLAS {
 			float beta, 
 			int Y, int incY);
 	
-	private native int csgemv (
-			String TransA,  
-			int M, 
-			int N,  
-			float alpha, 
-			IDataBuffer A, int start, int end, int lda, 
-			IDataBuffer X, int incX, 
-			float beta, 
-			IDataBuffer Y, int incY);
-	
 	private native int csaxpby ( 
 			int N,  
 			float alpha, 
@@ -323,10 +431,52 @@ public class BLAS {
 			int Y, 
 			int incY);
 	
-	private native int csaxpby ( 
+	private native int csomatcopy (
+			int Trans, 
+			int rows, 
+			int cols, 
+			float alpha, 
+			int A, int lda, 
+			int B, int ldb);
+	
+	/* Operands are native addresses */
+	
+	private static native int csgemmDirect (
+			int TransA, 
+			int TransB, 
+			int M, 
+			int N, 
+			int K, 
+			float alpha, 
+			long A, int lda, 
+			long B, int ldb, 
+			float beta, 
+			long C, int ldc);
+	
+	private static native int csgemmBatch (long descriptors, int count);
+	
+	private static native int csgemvDirect (
+			int TransA,  
+			int M, 
+			int N, 
+			float alpha, 
+			long A, int lda, 
+			long X, int incX, 
+			float beta, 
+			long Y, int incY);
+	
+	private static native int csaxpbyDirect ( 
 			int N,  
 			float alpha, 
-			IDataBuffer X, int start, int end, int incX,
+			long X, int incX,
 			float beta,
-			IDataBuffer Y, int incY);
+			long Y, int incY);
+	
+	private static native int csomatcopyDirect (
+			int Trans, 
+			int rows, 
+			int cols, 
+			float alpha, 
+			long A, int lda, 
+			long B, int ldb);
 }
@@ -0,0 +1,114 @@
+package uk.ac.imperial.lsds.crossbow.device.blas;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+import uk.ac.imperial.lsds.crossbow.SystemConf;
+import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
+import uk.ac.imperial.lsds.crossbow.utils.Bits;
+
+/*
+ * A sequence of GEMM calls that `BLAS.sgemm(GemmBatch)` runs, in order,
+ * with a single native call.
+ *
+ * Calls are stored as 64-byte descriptors in a direct byte buffer, with
+ * the layout of `crossbow_sgemm_descriptor_t` (see `clib-multigpu/BLAS.h`).
+ * Batching requires direct buffers: otherwise, `add` runs the call at once.
+ *
+ * A batch is not thread-safe.
+ */
+public class GemmBatch {
+	
+	private static final int DESCRIPTOR_SIZE = 64;
+	
+	private ByteBuffer descriptors;
+	private long address;
+	
+	private int count;
+	
+	public GemmBatch (int capacity) {
+		
+		allocate (Math.max(1, capacity));
+		count = 0;
+	}
+	
+	private void allocate (int capacity) {
+		
+		ByteBuffer buffer = ByteBuffer.allocateDirect (capacity * DESCRIPTOR_SIZE).order (ByteOrder.nativeOrder());
+		
+		if (descriptors != null) {
+			descriptors.clear();
+			descriptors.limit(count * DESCRIPTOR_SIZE);
+			buffer.put(descriptors);
+			buffer.clear();
+		}
+		
+		descriptors = buffer;
+		address = Bits.address (descriptors);
+	}
+	
+	public int size () {
+		return count;
+	}
+	
+	public int capacity () {
+		return (descriptors.capacity() / DESCRIPTOR_SIZE);
+	}
+	
+	long address () {
+		return address;
+	}
+	
+	public void clear () {
+		count = 0;
+	}
+	
+	/* Same arguments as `BLAS.sgemm` */
+	public void add (
+			int TransA, 
+			int TransB, 
+			int M, 
+			int N, 
+			int K, 
+			float alpha, 
+			IDataBuffer A, int startA, int endA, int lda, 
+			IDataBuffer B, int startB, int endB, int ldb, 
+			float beta, 
+			IDataBuffer C, int startC, int endC, int ldc) {
+		
+		if (! SystemConf.getInstance().useDirectBuffers()) {
+			
+			BLAS.getInstance().sgemm (TransA, TransB, M, N, K, alpha, A, startA, endA, lda, B, startB, endB, ldb, beta, C, startC, endC, ldc);
+			return;
+		}
+		
+		BLAS.checkTranspose (TransA);
+		BLAS.checkTranspose (TransB);
+		
+		/* Check bounds */
+		BLAS.checkArrayBounds ("A", "sgemm", endA - startA, M, K);
+		BLAS.checkArrayBounds ("B", "sgemm", endB - startB, K, N);
+		BLAS.checkArrayBounds ("C", "sgemm", endC - startC, M, N);
+		
+		if (count == capacity ())
+			allocate (2 * count);
+		
+		int offset = count * DESCRIPTOR_SIZE;
+		
+		descriptors.putInt   (offset     , TransA);
+		descriptors.putInt   (offset +  4, TransB);
+		descriptors.putInt   (offset +  8, M);
+		descriptors.putInt   (offset + 12, N);
+		descriptors.putInt   (offset + 16, K);
+		descriptors.putInt   (offset + 20, lda);
+		descriptors.putInt   (offset + 24, ldb);
+		descriptors.putInt   (offset + 28, ldc);
+		descriptors.putFloat (offset + 32, alpha);
+		descriptors.putFloat (offset + 36, beta);
+		descriptors.putLong  (offset + 40, A.address() + startA);
+		descriptors.putLong  (offset + 48, B.address() + startB);
+		descriptors.putLong  (offset + 56, C.address() + startC);
+		
+		count ++;
+	}
+}
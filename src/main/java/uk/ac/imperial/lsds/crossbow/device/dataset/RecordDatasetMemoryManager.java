@@ -0,0 +1,51 @@
+package uk.ac.imperial.lsds.crossbow.device.dataset;
+
+import uk.ac.imperial.lsds.crossbow.SystemConf;
+
+/*
+ * Decodes record datasets for CPU workers into a ring of slots, each holding
+ * a fixed number of batches (see `clib-multigpu/recordring.h`).
+ */
+public class RecordDatasetMemoryManager {
+
+	private static final RecordDatasetMemoryManager instance = new RecordDatasetMemoryManager ();
+	
+	public static RecordDatasetMemoryManager getInstance () { return instance; }
+	
+	private boolean loaded;
+	
+	public RecordDatasetMemoryManager () {
+		loaded = false;
+	}
+	
+	public boolean isLoaded () {
+		return loaded;
+	}
+	
+	public void init () {
+		if (! loaded) {
+			String library = String.format("%s/clib-multigpu/librecords.so", SystemConf.getInstance().getHomeDirectory());
+			try {
+				System.load (library);
+			} catch (final UnsatisfiedLinkError e) {
+				System.err.println(e.getMessage());
+				System.exit(1);
+			}
+			loaded = true;
+		}
+	}
+	
+	public native int init (int phase, int workers, int slots, int batches, int batchsize, int [] size, int [] padding);
+	
+	public native int register (int phase, String filename);
+	
+	public native int finalise (int phase);
+	
+	public native int free ();
+	
+	public native long address (int phase, int type, int id);
+	public native long capacity (int phase, int type);
+	
+	public native int slideOut (int phase, int id);
+	public native int slideIn  (int phase, int id);
+}
@@ -0,0 +1,240 @@
+package uk.ac.imperial.lsds.crossbow.device.kernel;
+
+import uk.ac.imperial.lsds.crossbow.SystemConf;
+import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
+
+/*
+ * Native (SIMD) implementations of the element-wise and reduction kernels
+ * that are not expressed in terms of BLAS calls: pooling, ReLU, softmax,
+ * batch normalisation and local response normalisation, and their gradients;
+ * sparse (in-place) matrix factorisation updates; fused model updates; CPU
+ * model replica synchronisation; data transformations; and random number
+ * generation.
+ *
+ * All buffers must be direct (i.e. `DataBuffer` backed by a direct byte buffer,
+ * or `MappedDataBuffer`). Offsets are in bytes, as elsewhere in Crossbow.
+ */
+public class CPUKernels {
+
+	private static final CPUKernels kernelsInstance = new CPUKernels ();
+
+	public static CPUKernels getInstance () { return kernelsInstance; }
+
+	private boolean loaded;
+
+	public CPUKernels () {
+		loaded = false;
+	}
+
+	public boolean isLoaded () {
+		return loaded;
+	}
+
+	public void load () {
+
+		if (! isLoaded()) {
+			try {
+				String library = String.format("%s/clib-multigpu/libCPUKernels.so", SystemConf.getInstance().getHomeDirectory());
+				System.load (library);
+			} catch (final UnsatisfiedLinkError e) {
+				System.err.println(e.getMessage());
+				System.exit(1);
+			}
+			loaded = true;
+		}
+	}
+
+	/*
+	 * Native kernels are used only when the library is loaded and
+	 * all variable buffers are direct.
+	 */
+	public boolean isEnabled () {
+
+		return (isLoaded() && SystemConf.getInstance().useDirectBuffers());
+	}
+
+	public native int init ();
+
+	public native int destroy ();
+
+	/* Y = max(X, 0) + slope x min(X, 0) */
+	public native int relu (IDataBuffer X, int startX, IDataBuffer Y, int startY, int count, float slope);
+
+	/* dX = (X > 0) ? dY : slope x dY */
+	public native int reluGradient (IDataBuffer dY, int startdY, IDataBuffer X, int startX, IDataBuffer dX, int startdX, int count, float slope);
+
+	/*
+	 * Pooling over `planes` (examples x channels) 2-D planes. Max pooling
+	 * stores the byte offset (relative to the start of buffer X) of every
+	 * selected input element in `indices`.
+	 */
+	public native int maxPool (
+		IDataBuffer X, int startX,
+		IDataBuffer Y, int startY,
+		IDataBuffer indices, int startIndices,
+		int planes,
+		int height, int width,
+		int pooledHeight, int pooledWidth,
+		int kernelHeight, int kernelWidth,
+		int strideHeight, int strideWidth,
+		int paddingHeight, int paddingWidth);
+
+	public native int averagePool (
+		IDataBuffer X, int startX,
+		IDataBuffer Y, int startY,
+		int planes,
+		int height, int width,
+		int pooledHeight, int pooledWidth,
+		int kernelHeight, int kernelWidth,
+		int strideHeight, int strideWidth,
+		int paddingHeight, int paddingWidth);
+
+	/*
+	 * Accumulates `count` elements of dY into dX (of `elements` elements) at the
+	 * positions stored in `indices`; `offset` is the start of the peer's input.
+	 */
+	public native int maxPoolGradient (IDataBuffer dY, int startdY, IDataBuffer indices, int count, int offset, IDataBuffer dX, int startdX, int elements);
+
+	public native int averagePoolGradient (
+		IDataBuffer dY, int startdY,
+		IDataBuffer dX, int startdX,
+		int planes,
+		int height, int width,
+		int pooledHeight, int pooledWidth,
+		int kernelHeight, int kernelWidth,
+		int strideHeight, int strideWidth,
+		int paddingHeight, int paddingWidth);
+
+	public native int softmax (IDataBuffer X, int startX, IDataBuffer Y, int startY, int examples, int classes);
+
+	/* Copies `count` bytes from X to Y */
+	public native int copy (IDataBuffer X, int startX, IDataBuffer Y, int startY, int count);
+
+	/*
+	 * Fused batch normalisation (statistics, moving averages, normalisation,
+	 * scale and shift) of channels [fromChannel, toChannel). `bias` may be null.
+	 */
+	public native int batchNorm (
+		IDataBuffer X, int startX,
+		IDataBuffer Y, int startY,
+		IDataBuffer weights, IDataBuffer bias,
+		IDataBuffer mean, IDataBuffer variance,
+		IDataBuffer averageMean, IDataBuffer averageVariance,
+		IDataBuffer invVar, IDataBuffer xnorm,
+		int batchsize, int channels, int spatial,
+		int fromChannel, int toChannel,
+		boolean training, boolean first,
+		float fraction, float epsilon);
+
+	/* `biasGradient` may be null */
+	public native int batchNormGradient (
+		IDataBuffer dY, int startdY,
+		IDataBuffer xnorm, IDataBuffer weights, IDataBuffer invVar,
+		IDataBuffer dX, int startdX,
+		IDataBuffer weightGradient, IDataBuffer biasGradient,
+		int batchsize, int channels, int spatial,
+		int fromChannel, int toChannel);
+
+	/*
+	 * Cross-channel local response normalisation. The forward kernel stores
+	 * the scale that the backward kernel reads back.
+	 */
+	public native int lrn (
+		IDataBuffer X, int startX,
+		IDataBuffer Y, int startY,
+		IDataBuffer scale,
+		int batchsize, int channels, int spatial,
+		int size, float alpha, float beta, float kappa);
+
+	public native int lrnGradient (
+		IDataBuffer dY, int startdY,
+		IDataBuffer X, int startX,
+		IDataBuffer scale,
+		IDataBuffer dX, int startdX,
+		int batchsize, int channels, int spatial,
+		int size, float alpha, float beta, float kappa);
+
+	/*
+	 * Sparse matrix factorisation: updates the user and item rows of every
+	 * (user, item) example in place, without locking the model (or holding
+	 * per-row stripe locks, if `locking` is set). Returns the batch loss.
+	 */
+	public native float matFact (
+		IDataBuffer X, int startX,
+		IDataBuffer labels, int startLabels,
+		IDataBuffer users, IDataBuffer items,
+		int examples, int latents,
+		float lambda, float rate,
+		boolean locking);
+
+	/*
+	 * Fused gradient descent update of a model variable (see GradientDescentOptimiser):
+	 *
+	 * G = rate x (scale x G + decay x W) + momentum x last; W = W - G
+	 *
+	 * `last` may be null.
+	 */
+	public native int sgdUpdate (
+		IDataBuffer weights, IDataBuffer gradient, IDataBuffer last,
+		int count,
+		float scale, float decay, float rate, float momentum);
+
+	public native float sumOfSquares (IDataBuffer X, int count);
+
+	/*
+	 * Synchronisation of the first `n` model replicas with their base model, over
+	 * `count` elements starting at byte `offset` of every buffer.
+	 *
+	 * Model averaging sets the base model and all replicas to the replicas' mean;
+	 * elastic averaging moves each replica towards the base model, and the base
+	 * model towards the replicas, by `alpha` times their difference.
+	 */
+	public native int modelAverage (IDataBuffer base, IDataBuffer [] replicas, int n, int offset, int count);
+
+	public native int elasticAverage (IDataBuffer base, IDataBuffer [] replicas, int n, int offset, int count, float alpha);
+
+	/*
+	 * Fused data transformation (crop, mirror, mean subtraction and scaling) of
+	 * `examples` images, starting at the `first`-th triplet of `offsets` (crop
+	 * height and width offsets, and mirror flag, per image):
+	 *
+	 * Y = factor x ((scale x X + shift) - means)
+	 *
+	 * X holds elements of the given type (a `DataType` id); `scale` and `shift`
+	 * widen compact types to floats. `means` may be null, hold one value per
+	 * channel or, if `meanImage` is set, a mean image.
+	 */
+	public native int dataTransform (
+		IDataBuffer X, int startX, int type,
+		IDataBuffer Y, int startY,
+		int [] offsets, int first,
+		int examples, int channels, int height, int width, int croppedHeight, int croppedWidth,
+		IDataBuffer means, boolean meanImage,
+		float scale, float shift, float factor);
+
+	/*
+	 * Inverted dropout of `count` elements: Y = X / (1 - ratio) for kept elements,
+	 * and 0 otherwise. The bit-packed keep mask is drawn from Philox stream (task,
+	 * stream) under key `seed`; `first` is the index of the first mask word (see
+	 * cpukernels/dropout.h).
+	 */
+	public native int dropout (
+		IDataBuffer X, int startX,
+		IDataBuffer Y, int startY,
+		IDataBuffer mask, int startMask,
+		int count, float ratio,
+		int first, int task, int stream, long seed);
+
+	/* dX = dY / (1 - ratio) for the elements kept by `dropout`, and 0 otherwise */
+	public native int dropoutGradient (
+		IDataBuffer dY, int startdY,
+		IDataBuffer mask, int startMask,
+		IDataBuffer dX, int startdX,
+		int count, float ratio);
+
+	/*
+	 * Fills `Y` with `blocks` Philox-4x32-10 blocks (4 words each), for counters
+	 * (first + i, epoch, stream, 0) under key `seed` (see `utils.Philox`).
+	 */
+	public native int philox (int [] Y, int blocks, int first, int epoch, int stream, long seed);
+}
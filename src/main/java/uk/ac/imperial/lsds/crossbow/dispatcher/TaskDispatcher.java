@@ -6,19 +6,18 @@ import org.apache.logging.log4j.Logger;
 import uk.ac.imperial.lsds.crossbow.Batch;
 import uk.ac.imperial.lsds.crossbow.BatchFactory;
 import uk.ac.imperial.lsds.crossbow.Dataflow;
-import uk.ac.imperial.lsds.crossbow.Dataset;
+import uk.ac.imperial.lsds.crossbow.IDataset;
+import uk.ac.imperial.lsds.crossbow.IMappedDataset;
 import uk.ac.imperial.lsds.crossbow.ModelConf;
 import uk.ac.imperial.lsds.crossbow.SubGraph;
 import uk.ac.imperial.lsds.crossbow.SystemConf;
 import uk.ac.imperial.lsds.crossbow.data.MappedDataBuffer;
 import uk.ac.imperial.lsds.crossbow.data.VirtualCircularDataBuffer;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
-import uk.ac.imperial.lsds.crossbow.device.dataset.DatasetMemoryManager;
 import uk.ac.imperial.lsds.crossbow.result.IResultHandler;
 import uk.ac.imperial.lsds.crossbow.task.Task;
 import uk.ac.imperial.lsds.crossbow.task.TaskFactory;
 import uk.ac.imperial.lsds.crossbow.task.TaskQueue;
-import uk.ac.imperial.lsds.crossbow.types.DatasetFileType;
 import uk.ac.imperial.lsds.crossbow.types.DatasetType;
 import uk.ac.imperial.lsds.crossbow.types.Phase;
 
@@ -38,7 +37,7 @@ public class TaskDispatcher implements ITaskDispatcher {
 	
 	/* Model configuration */
 	
-	private Dataset dataset;
+	private IMappedDataset dataset;
 	
 	private VirtualCircularDataBuffer [] circularBuffer;
 	
@@ -79,10 +78,13 @@ public class TaskDispatcher implements ITaskDispatcher {
 		phase = dataflow.getPhase();
 		test = dataflow.isTest();
 		
-		if (ModelConf.getInstance ().getDataset (phase).getType () != DatasetType.BASIC)
+		IDataset d = ModelConf.getInstance ().getDataset (phase);
+		
+		/* Record datasets are dispatched here only when decoded for CPU workers */
+		if (! (d.getType () == DatasetType.BASIC || (d.getType () == DatasetType.RECORD && ! SystemConf.getInstance().getGPU())))
 			throw new IllegalStateException ("Invalid dataset in task dispatcher");
 		
-		dataset = (Dataset) ModelConf.getInstance ().getDataset (phase);
+		dataset = (IMappedDataset) d;
 		
 		circularBuffer = new VirtualCircularDataBuffer [2];
 		
@@ -245,7 +247,7 @@ public class TaskDispatcher implements ITaskDispatcher {
 			while (start > circularBuffer[0].getAddressTranslator().getEndPointer (w0)) {
 				/* Slide-out old dataset file */
 				/* log.info(String.format("Slide-out file id %2d", w0)); */
-				DatasetMemoryManager.getInstance().slideOut (phase.getId(), w0);
+				dataset.slideOut (w0);
 				/* Increment file pointer */
 				w0 = (w0 + 1) % dataset.numberOfPartitions();
 			}
@@ -257,7 +259,7 @@ public class TaskDispatcher implements ITaskDispatcher {
 				
 				/* Slide-out old dataset file */
 				/* log.info(String.format("Slide-out file id %2d", w0)); */
-				DatasetMemoryManager.getInstance().slideOut (phase.getId(), w0);
+				dataset.slideOut (w0);
 				
 				/* Increment file pointer */
 				w0 = (w0 + 1);
@@ -278,7 +280,7 @@ public class TaskDispatcher implements ITaskDispatcher {
 				
 				/* Slide-out old dataset file */
 				/* log.info(String.format("Slide-out file id %2d", w0)); */
-				DatasetMemoryManager.getInstance().slideOut (phase.getId(), w0);
+				dataset.slideOut (w0);
 				/* Increment file pointer */
 				w0 = (w0 + 1) % dataset.numberOfPartitions();
 			}
@@ -290,14 +292,12 @@ public class TaskDispatcher implements ITaskDispatcher {
 			
 			/* Slide-in dataset file */
 			log.info(String.format("Slide-in file id %2d", w1));
-			DatasetMemoryManager.getInstance().slideIn (phase.getId(), w1);
 			
 			/* Update (11/12/2017)
 			 * 
-			 * Assign new addresses to buffers (since they may be mapped again in memory...) 
+			 * Also assigns new addresses to buffers (since they may be mapped again in memory...) 
 			 */
-			dataset.getExamples(w1).setAddress (DatasetMemoryManager.getInstance().address (phase.getId(), DatasetFileType.EXAMPLES.getId(), w1));
-			dataset.getLabels  (w1).setAddress (DatasetMemoryManager.getInstance().address (phase.getId(), DatasetFileType.LABELS.getId(),   w1));
+			dataset.slideIn (w1);
 		}
 		
 		/* Track previous start pointer */
@@ -9,12 +9,14 @@ import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
 import uk.ac.imperial.lsds.crossbow.data.IDataBufferIterator;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
 import uk.ac.imperial.lsds.crossbow.device.blas.BLAS;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.BatchNormConf;
 import uk.ac.imperial.lsds.crossbow.model.InitialiserConf;
 import uk.ac.imperial.lsds.crossbow.model.LocalVariable;
 import uk.ac.imperial.lsds.crossbow.model.Model;
 import uk.ac.imperial.lsds.crossbow.model.Shape;
 import uk.ac.imperial.lsds.crossbow.model.Variable;
+import uk.ac.imperial.lsds.crossbow.processor.IdleWorkerQueue;
 import uk.ac.imperial.lsds.crossbow.task.ITask;
 import uk.ac.imperial.lsds.crossbow.types.BatchNormEstimatedMeanAndVarianceType;
 import uk.ac.imperial.lsds.crossbow.types.CudnnKernelType;
@@ -23,6 +25,9 @@ import uk.ac.imperial.lsds.crossbow.types.ModelAccess;
 public class BatchNorm extends Kernel {
 
 	private final static Logger log = LogManager.getLogger (BatchNorm.class);
+	
+	/* Channels are normalised in parallel in ranges of at least that many elements */
+	final static int MIN_ELEMENTS_PER_PART = 65536;
 
 	private BatchNormConf conf;
 
@@ -245,6 +250,52 @@ public class BatchNorm extends Kernel {
 
 		// Find out whether this is TRAINING or TESTING phase
         boolean isTestingPhase = api.isValidationTask();
+        
+        if (CPUKernels.getInstance().isEnabled()) {
+        	
+        	/* Fused statistics, moving average update, normalisation, scale and shift */
+        	final boolean first = (! isTestingPhase) && isFirstMeanVariance.get();
+        	final boolean training = (! isTestingPhase);
+        	
+        	final int n = batchsize, c = channels, s = spatial_dim;
+        	
+        	/* Resolve thread-local buffers here, since ranges may run on other threads */
+        	final IDataBuffer __X = inputDataBuffer, __Y = outputDataBuffer;
+        	final int __startX = inputStartP;
+        	final IDataBuffer __mean = newMean.get()[0].getDataBuffer(), __var = newVar.get()[0].getDataBuffer();
+        	final IDataBuffer __averageMean = averageMean.get()[0].getDataBuffer(), __averageVar = averageVar.get()[0].getDataBuffer();
+        	final IDataBuffer __invVar = invVar.get()[0].getDataBuffer(), __xnorm = x_norm.get()[0].getDataBuffer();
+        	
+        	model.readLock();
+        	
+        	final IDataBuffer __weights = model.getVariable (operator.getId(), 1).getDataBuffer();
+        	final IDataBuffer __bias = conf.hasBias() ? model.getVariable (operator.getId(), 2).getDataBuffer() : null;
+        	
+        	/* Normalise ranges of channels in parallel, if other workers are idle */
+        	IdleWorkerQueue.getInstance().parallelFor (c, Math.max(1, MIN_ELEMENTS_PER_PART / (n * s)), new IdleWorkerQueue.Range () {
+        		public void run (int from, int to) {
+        			CPUKernels.getInstance().batchNorm (
+        				__X, __startX,
+        				__Y, 0,
+        				__weights, __bias,
+        				__mean, __var,
+        				__averageMean, __averageVar,
+        				__invVar, __xnorm,
+        				n, c, s,
+        				from, to,
+        				training, first,
+        				(float) conf.getMovingAverageFraction(), (float) conf.getEpsilon());
+        		}
+        	});
+        	
+        	model.readUnlock();
+        	
+        	if (first)
+        		isFirstMeanVariance.set(false);
+        	
+        	batch.setOutput (operator.getId(), outputDataBuffer);
+        	return;
+        }
 
 		if (isTestingPhase) {
 			// Use global mean/variance
@@ -441,7 +492,7 @@ public class BatchNorm extends Kernel {
         X = spatial_sum_multiplier.get()[0].getDataBuffer();
         Y = num_by_chans.get()[0].getDataBuffer();
 
-        BLAS.getInstance().sgemv ("N",
+        BLAS.getInstance().sgemv (BLAS.NO_TRANS,
                 M, N,
                 alpha,
                 A, startA, endA, lda,
@@ -458,7 +509,7 @@ public class BatchNorm extends Kernel {
         X = batch_sum_multiplier.get()[0].getDataBuffer();
         Y = _Y;
 
-        BLAS.getInstance().sgemv ("T",
+        BLAS.getInstance().sgemv (BLAS.TRANS,
                 M, N,
                 alpha,
                 A, 0, A.limit(), lda,
@@ -491,7 +542,7 @@ public class BatchNorm extends Kernel {
         startB = startX;
         endB = endX;
 
-        BLAS.getInstance().sgemm("N", "N",
+        BLAS.getInstance().sgemm(BLAS.NO_TRANS, BLAS.NO_TRANS,
                 M, N, K,
                 alpha,
                 A, startA, endA, lda,
@@ -515,7 +566,7 @@ public class BatchNorm extends Kernel {
         startB = 0;
         endB = B.limit();
 
-        BLAS.getInstance().sgemm("N", "N",
+        BLAS.getInstance().sgemm(BLAS.NO_TRANS, BLAS.NO_TRANS,
                 M, N, K,
                 alpha,
                 A, startA, endA, lda,
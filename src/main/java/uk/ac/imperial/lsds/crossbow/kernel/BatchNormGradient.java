@@ -9,6 +9,7 @@ import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
 import uk.ac.imperial.lsds.crossbow.data.IDataBufferIterator;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
 import uk.ac.imperial.lsds.crossbow.device.blas.BLAS;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.BatchNormConf;
 import uk.ac.imperial.lsds.crossbow.model.InitialiserConf;
 import uk.ac.imperial.lsds.crossbow.model.LocalVariable;
@@ -17,6 +18,7 @@ import uk.ac.imperial.lsds.crossbow.model.ModelGradient;
 import uk.ac.imperial.lsds.crossbow.model.Shape;
 import uk.ac.imperial.lsds.crossbow.model.Variable;
 import uk.ac.imperial.lsds.crossbow.model.VariableGradient;
+import uk.ac.imperial.lsds.crossbow.processor.IdleWorkerQueue;
 import uk.ac.imperial.lsds.crossbow.task.ITask;
 import uk.ac.imperial.lsds.crossbow.types.ModelAccess;
 
@@ -192,6 +194,43 @@ public class BatchNormGradient extends Kernel {
         /* Get 'x_norm' variable from the peer */
         x_norm = ((BatchNorm) operator.getPeer().getKernel()).getXNorm();
         xnormBuffer     = x_norm.get()      [0].getDataBuffer();
+        
+        if (CPUKernels.getInstance().isEnabled()) {
+        	
+        	/* The native kernel overwrites (rather than accumulates) both gradients */
+        	biasGradientBuffer = conf.hasBias() ? gradient.getVariableGradient (operator.getPeer().getId(), 2).getDataBuffer() : null;
+        	
+        	final int n = batchsize, c = channels, s = spatial_dim;
+        	
+        	/* Resolve thread-local buffers here, since ranges may run on other threads */
+        	final IDataBuffer __dY = inputDataBuffer, __dX = outputDataBuffer, __xnorm = xnormBuffer;
+        	final int __startdY = inputStartP;
+        	final IDataBuffer __invVar = ((BatchNorm) operator.getPeer().getKernel()).getInvVar().get()[0].getDataBuffer();
+        	final IDataBuffer __weightGradient = weightGradientBuffer, __biasGradient = biasGradientBuffer;
+        	
+        	model.readLock();
+        	
+        	final IDataBuffer __weights = model.getVariable(operator.getPeer().getId(), 1).getDataBuffer();
+        	
+        	/* Compute gradients of ranges of channels in parallel, if other workers are idle */
+        	IdleWorkerQueue.getInstance().parallelFor (c, Math.max(1, BatchNorm.MIN_ELEMENTS_PER_PART / (n * s)), new IdleWorkerQueue.Range () {
+        		public void run (int from, int to) {
+        			CPUKernels.getInstance().batchNormGradient (
+        				__dY, __startdY,
+        				__xnorm, __weights, __invVar,
+        				__dX, 0,
+        				__weightGradient, __biasGradient,
+        				n, c, s,
+        				from, to);
+        		}
+        	});
+        	
+        	model.readUnlock();
+        	
+        	batch.setOutput(operator.getId(), outputDataBuffer);
+        	return;
+        }
+        
         xnormDiffBuffer = x_norm_diff.get() [0].getDataBuffer();
 
         /* Stage 1: Compute dE/d(scale) and dE/d(shift) */
@@ -321,7 +360,7 @@ public class BatchNormGradient extends Kernel {
         X = spatial_sum_multiplier.get()[0].getDataBuffer();
         Y = num_by_chans.get()[0].getDataBuffer();
 
-        BLAS.getInstance().sgemv ("N",
+        BLAS.getInstance().sgemv (BLAS.NO_TRANS,
                 M, N,
                 alpha,
                 A, startA, endA, lda,
@@ -338,7 +377,7 @@ public class BatchNormGradient extends Kernel {
         X = batch_sum_multiplier.get()[0].getDataBuffer();
         Y = _Y;
 
-        BLAS.getInstance().sgemv ("T",
+        BLAS.getInstance().sgemv (BLAS.TRANS,
                 M, N,
                 alpha,
                 A, 0, A.limit(), lda,
@@ -371,7 +410,7 @@ public class BatchNormGradient extends Kernel {
         startB = startX;
         endB = endX;
 
-        BLAS.getInstance().sgemm("N", "N",
+        BLAS.getInstance().sgemm(BLAS.NO_TRANS, BLAS.NO_TRANS,
                 M, N, K,
                 alpha,
                 A, startA, endA, lda,
@@ -395,7 +434,7 @@ public class BatchNormGradient extends Kernel {
         startB = 0;
         endB = B.limit();
 
-        BLAS.getInstance().sgemm("N", "N",
+        BLAS.getInstance().sgemm(BLAS.NO_TRANS, BLAS.NO_TRANS,
                 M, N, K,
                 alpha,
                 A, startA, endA, lda,
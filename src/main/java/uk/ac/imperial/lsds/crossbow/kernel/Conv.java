@@ -5,15 +5,18 @@ import org.apache.logging.log4j.Logger;
 
 import uk.ac.imperial.lsds.crossbow.Batch;
 import uk.ac.imperial.lsds.crossbow.Operator;
+import uk.ac.imperial.lsds.crossbow.SystemConf;
 import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
 import uk.ac.imperial.lsds.crossbow.device.blas.BLAS;
+import uk.ac.imperial.lsds.crossbow.device.blas.GemmBatch;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.ConvConf;
 import uk.ac.imperial.lsds.crossbow.model.InitialiserConf;
 import uk.ac.imperial.lsds.crossbow.model.LocalVariable;
 import uk.ac.imperial.lsds.crossbow.model.Model;
 import uk.ac.imperial.lsds.crossbow.model.Shape;
 import uk.ac.imperial.lsds.crossbow.model.Variable;
+import uk.ac.imperial.lsds.crossbow.processor.IdleWorkerQueue;
 import uk.ac.imperial.lsds.crossbow.task.ITask;
 import uk.ac.imperial.lsds.crossbow.types.CudnnKernelType;
 import uk.ac.imperial.lsds.crossbow.types.DataType;
@@ -42,6 +45,22 @@ public class Conv extends Kernel {
 	
 	LocalVariable _column, _biasmultiplier;
 	
+	/* 
+	 * When more than one example is lowered at a time, the column matrix of 
+	 * `columnBatchSize` examples is multiplied by the weights in one go. The 
+	 * result is stored in `_outputs` and then scattered to the output buffer.
+	 */
+	int columnBatchSize;
+	
+	LocalVariable _columns, _outputs, _biasmultipliers;
+	
+	/* The GEMM calls of a (sub-)batch are issued with a single native call */
+	private ThreadLocal<GemmBatch> _gemms = new ThreadLocal<GemmBatch> () {
+		protected GemmBatch initialValue () {
+			return new GemmBatch (16);
+		}
+	};
+	
 	public Conv (ConvConf conf) {
 		
 		this.conf = conf;
@@ -205,6 +224,41 @@ public class Conv extends Kernel {
 			log.debug(String.format("Local variable %s", biasmultiplier.getName()));
 		}
 		
+		/* Configure batched lowering */
+		
+		int batchsize = inputShape[0].countElements(0, axis);
+		
+		columnBatchSize = conf.getColumnBatchSize();
+		if ((columnBatchSize == 0) || (columnBatchSize > batchsize))
+			columnBatchSize = batchsize;
+		
+		log.debug(String.format("Lower %d example%s at a time", columnBatchSize, (columnBatchSize > 1) ? "s" : ""));
+		
+		Variable columns = null, outputs_ = null, biasmultipliers = null;
+		
+		if (columnBatchSize > 1) {
+			
+			int elements = columnBatchSize * outputShape.countElements(axis + 1);
+			
+			columns = new Variable ("columns", new Shape (new int [] { kernelSpatialDimensions * groups, elements }), false);
+			columns.initialise (new InitialiserConf().setValue(0));
+			
+			_columns = new LocalVariable (columns);
+			
+			outputs_ = new Variable ("outputs", new Shape (new int [] { outputs, elements }), false);
+			outputs_.initialise (new InitialiserConf().setValue(0));
+			
+			_outputs = new LocalVariable (outputs_);
+			
+			if (conf.hasBias()) {
+				
+				biasmultipliers = new Variable ("bias-multipliers", new Shape (new int [] { elements }), false);
+				biasmultipliers.initialise (new InitialiserConf().setValue(1));
+				
+				_biasmultipliers = new LocalVariable (biasmultipliers);
+			}
+		}
+		
 		/* 
 		 * Set memory requirements 
 		 */
@@ -222,6 +276,16 @@ public class Conv extends Kernel {
 		if (conf.hasBias())
 			memoryRequirements.incLocalCPUMemoryRequirements (biasmultiplier.capacity());
 		
+		/* Batched lowering adds `columns`, `outputs` and `biasmultipliers` */
+		long rangeBytes = column.capacity() + (conf.hasBias() ? biasmultiplier.capacity() : 0);
+		if (columnBatchSize > 1) {
+			rangeBytes = columns.capacity() + outputs_.capacity() + (conf.hasBias() ? biasmultipliers.capacity() : 0);
+			memoryRequirements.incLocalCPUMemoryRequirements (rangeBytes);
+		}
+		
+		/* Ranges of examples also run on intra-op threads, each with its own copy of these buffers */
+		memoryRequirements.incLocalCPUMemoryRequirements ((long) SystemConf.getInstance().numberOfIntraOpThreads() * rangeBytes);
+		
 		/* Are there any GPU-specific local variables? Yes, but they cannot be defined at the moment */
 		memoryRequirements.setLocalGPUMemoryRequirements (0);
 		
@@ -307,7 +371,7 @@ public class Conv extends Kernel {
 		return;
 	}
 	
-	private void imageToColumn2D (IDataBuffer image, int offset, IDataBuffer column, int channels,
+	private void imageToColumn2D (IDataBuffer image, int offset, IDataBuffer column, int columnoffset, int ldc, int channels,
 		
 		int   imageHeight, int   imageWidth, 
 		int  kernelHeight, int  kernelWidth,
@@ -335,7 +399,7 @@ public class Conv extends Kernel {
 					int h_ = h * strideHeight - paddingHeight + heightOffset;
 					int w_ = w * strideWidth  - paddingWidth  +  widthOffset;
 					
-					int index = ((columnelement * output_h + h) * output_w + w) * DataType.FLOAT.sizeOf();
+					int index = (columnelement * ldc + columnoffset + h * output_w + w) * DataType.FLOAT.sizeOf();
 					float value = 0F;
 					if (h_ >= 0 && w_ >= 0 && h_ < imageHeight && w_ < imageWidth) {
 						value = image.getFloat(offset + (((c_ * imageHeight + h_) * imageWidth + w_) * DataType.FLOAT.sizeOf()));
@@ -347,12 +411,16 @@ public class Conv extends Kernel {
 		}
 	}
 	
-	private void imageToColumn (IDataBuffer inputbuffer, int offset, IDataBuffer columnbuffer, int channels) {
+	/*
+	 * Lower an image into the columns [columnoffset, columnoffset + N) of a 
+	 * column matrix whose rows are `ldc` elements long.
+	 */
+	private void imageToColumn (IDataBuffer inputbuffer, int offset, IDataBuffer columnbuffer, int columnoffset, int ldc, int channels) {
 		
 		if (spatialDimensions != 2)
 			throw new UnsupportedOperationException("error: multi-dimensional convolution is not yet supported");
 		
-		imageToColumn2D (inputbuffer, offset, columnbuffer, channels,
+		imageToColumn2D (inputbuffer, offset, columnbuffer, columnoffset, ldc, channels,
 				
 			  image.get(1),   image.get(2), /* Image  height & width */
 			 kernel.get(0),  kernel.get(1), /* Kernel height & width */ 
@@ -387,8 +455,8 @@ public class Conv extends Kernel {
 		IDataBuffer outputDataBuffer = getCurrentOutput (batch, api);
 		output[0].wrap(outputDataBuffer);
 		
-		int  inputoffset,  inputvectorsize;
-		int outputoffset, outputvectorsize;
+		int  inputvectorsize;
+		int outputvectorsize;
 		/*
 		 * An image has one of more color channels `c` (typically, c = 1 for grayscale and c = 3 for RGB images),
 		 * a height `h` and a width `w`. 
@@ -401,28 +469,81 @@ public class Conv extends Kernel {
 		
 		int batchsize = input[0].getShape().countElements(0, axis);
 		
-		Variable [] column = _column.get();
-		IDataBuffer columnBuffer = column[0].getDataBuffer(); //For matmul operation
-		
 		model.readLock();
 		
 		Variable weights = model.getVariable(operator.getId(), 1);
 		log.debug("Weight checksum is " + weights.computeChecksum());
 		IDataBuffer weightsBuffer = weights.getDataBuffer();
 		
-		IDataBuffer biasBuffer = null, biasmultiplierBuffer = null;
+		IDataBuffer biasBuffer = null;
 		
 		if (conf.hasBias()) {
 			Variable biasVar = model.getVariable(operator.getId(), 2);
 			log.debug("Bias checksum is " + biasVar.computeChecksum());
 			biasBuffer = model.getVariable(operator.getId(), 2).getDataBuffer();
-			biasmultiplierBuffer = _biasmultiplier.get()[0].getDataBuffer();
 		}
 		
 		/* GEMM helper variables */
-		int M = outputs / groups;
-		int N = output[0].getShape().countElements(axis + 1);
-		int K = weights.getShape().countElements(1);
+		final int M = outputs / groups;
+		final int N = output[0].getShape().countElements(axis + 1);
+		final int K = weights.getShape().countElements(1);
+		
+		final IDataBuffer __input = inputDataBuffer, __output = outputDataBuffer;
+		final IDataBuffer __weights = weightsBuffer, __bias = biasBuffer;
+		final int __inputStartP = inputStartP, __inputvectorsize = inputvectorsize, __outputvectorsize = outputvectorsize;
+		final int __batchsize = batchsize, __channels = channels, __groups = groups;
+		
+		if (columnBatchSize > 1) {
+			
+			int subbatches = (batchsize + columnBatchSize - 1) / columnBatchSize;
+			
+			/* Compute sub-batches in parallel, if other workers are idle */
+			IdleWorkerQueue.getInstance().parallelFor (subbatches, 1, new IdleWorkerQueue.Range () {
+				public void run (int from, int to) {
+					computeBatched (__input, __inputStartP, __inputvectorsize, __output, __outputvectorsize, 
+						from * columnBatchSize, Math.min(__batchsize, to * columnBatchSize), __channels, __groups, M, N, K, __weights, __bias);
+				}
+			});
+		}
+		else {
+			
+			/* Compute examples in parallel, if other workers are idle */
+			IdleWorkerQueue.getInstance().parallelFor (batchsize, 1, new IdleWorkerQueue.Range () {
+				public void run (int from, int to) {
+					computeExamples (__input, __inputStartP, __inputvectorsize, __output, __outputvectorsize, 
+						from, to, __channels, __groups, M, N, K, __weights, __bias);
+				}
+			});
+		}
+		
+		model.readUnlock();
+		
+		/* Store output in batch for downstream operators */
+		batch.setOutput(operator.getId(), outputDataBuffer);
+	}
+	
+	/*
+	 * Computes examples [first, last) one at a time. Thread-local buffers are
+	 * resolved here, since ranges of examples may run on other threads.
+	 */
+	private void computeExamples (
+		
+		IDataBuffer inputDataBuffer, int inputStartP, int inputvectorsize, 
+		IDataBuffer outputDataBuffer, int outputvectorsize, 
+		int first, int last, int channels, int groups, 
+		int M, int N, int K, 
+		IDataBuffer weightsBuffer, IDataBuffer biasBuffer
+		
+		) {
+		
+		int  inputoffset;
+		int outputoffset;
+		
+		int sizeOf = DataType.FLOAT.sizeOf();
+		
+		IDataBuffer columnBuffer = _column.get()[0].getDataBuffer(); //For matmul operation
+		
+		IDataBuffer biasmultiplierBuffer = conf.hasBias() ? _biasmultiplier.get()[0].getDataBuffer() : null;
 		
 		/*
 		int lda = (TransA == CblasNoTrans) ? K : M;
@@ -437,13 +558,13 @@ public class Conv extends Kernel {
 		int Blimit = K * N * 4;
 		int Climit = M * N * 4;
 		
-		int weightsoffset = M * K * weights.getType().sizeOf();
-		int columnoffset  = N * K *  column[0].getType().sizeOf();
+		int weightsoffset = M * K * sizeOf;
+		int columnoffset  = N * K * sizeOf;
 		
-		int output_group_offset = M * N;
+		int output_group_offset = M * N * sizeOf;
 		
-		int M2 = outputs;
-		int N2 = output[0].getShape().countElements(axis + 1);
+		int M2 = M * groups;
+		int N2 = N;
 		int K2 = 1;
 		int lda2 = K2;
 		int ldb2 = N2;
@@ -451,7 +572,9 @@ public class Conv extends Kernel {
 		
 		int Climit2 = M2 * N2 * 4;
 		
-		for (int n = 0; n < batchsize; ++n) { //For each training example
+		GemmBatch gemms = _gemms.get();
+		
+		for (int n = first; n < last; ++n) { //For each training example
 			
 			 inputoffset = n *  inputvectorsize;
 			outputoffset = n * outputvectorsize;
@@ -460,11 +583,11 @@ public class Conv extends Kernel {
 			
 			if (! scalar) { /* Not a (1 x 1) convolution */
 				
-				imageToColumn (inputDataBuffer, (inputStartP + inputoffset), columnBuffer, channels);
+				imageToColumn (inputDataBuffer, (inputStartP + inputoffset), columnBuffer, 0, N, channels);
 				
 				for (int g = 0; g < groups; ++g) {
 					
-					BLAS.getInstance().sgemm ("N", "N", 
+					gemms.add (BLAS.NO_TRANS, BLAS.NO_TRANS, 
 						M, N, K,
 						1F, 
 						weightsBuffer, g * weightsoffset, g * weightsoffset + Alimit, lda, /* A */
@@ -477,21 +600,21 @@ public class Conv extends Kernel {
 				
 				for (int g = 0; g < groups; ++g) {
 					
-					BLAS.getInstance().sgemm ("N", "N", 
+					gemms.add (BLAS.NO_TRANS, BLAS.NO_TRANS, 
 						M, N, K,
 						1F, 
 						weightsBuffer, g *  weightsoffset                        ,   g * weightsoffset + Alimit, lda,
 						inputDataBuffer  , g *  columnoffset + (inputStartP + inputoffset),   g *  columnoffset + (inputStartP + inputoffset) + Blimit, ldb,
 						0F, 
-						outputDataBuffer , g *  outputoffset                         ,   g *  outputoffset + Climit, ldc);
+						outputDataBuffer , (outputoffset + g * output_group_offset), (outputoffset + g *  output_group_offset) + Climit, ldc);
 				}
 			}
 			
 			if (conf.hasBias()) {
 				
 				/* forward_cpu_bias (output + n * top_dim_, bias) */
-				BLAS.getInstance().sgemm (
-					"N", "N",
+				gemms.add (
+					BLAS.NO_TRANS, BLAS.NO_TRANS,
 					M2,N2,K2,
 					1F, 
 					biasBuffer,           0, biasBuffer.limit(), lda2,
@@ -499,12 +622,111 @@ public class Conv extends Kernel {
 					1F, 
 					outputDataBuffer, outputoffset, outputoffset + Climit2, ldc2);
 			}
+			
+			/* The column buffer is reused by the next example; otherwise, batch all examples of the range */
+			if (! scalar || (n == last - 1))
+				BLAS.getInstance().sgemm (gemms);
 		}
+	}
+	
+	private void computeBatched (
 		
-		model.readUnlock();
+		IDataBuffer inputDataBuffer, int inputStartP, int inputvectorsize, 
+		IDataBuffer outputDataBuffer, int outputvectorsize, 
+		int first, int last, int channels, int groups, 
+		int M, int N, int K, 
+		IDataBuffer weightsBuffer, IDataBuffer biasBuffer
 		
-		/* Store output in batch for downstream operators */
-		batch.setOutput(operator.getId(), outputDataBuffer);
+		) {
+		
+		int outputs = M * groups;
+		int rows = K * groups;
+		
+		int sizeOf = DataType.FLOAT.sizeOf();
+		
+		IDataBuffer columnsBuffer = _columns.get()[0].getDataBuffer();
+		IDataBuffer outputsBuffer = _outputs.get()[0].getDataBuffer();
+		
+		IDataBuffer biasmultipliersBuffer = conf.hasBias() ? _biasmultipliers.get()[0].getDataBuffer() : null;
+		
+		for (int n = first; n < last; n += columnBatchSize) {
+			
+			/* The last sub-batch may be smaller */
+			int examples = Math.min(columnBatchSize, last - n);
+			
+			/* Leading dimension of both the column and the output matrix */
+			int ld = examples * N;
+			
+			/* Lower examples into a (K x ld) column matrix, one column block per example */
+			for (int s = 0; s < examples; ++s) {
+				
+				int inputoffset = inputStartP + (n + s) * inputvectorsize;
+				
+				if (! scalar) {
+					
+					imageToColumn (inputDataBuffer, inputoffset, columnsBuffer, s * N, ld, channels);
+				}
+				else {
+					
+					int columnoffset = s * N * sizeOf;
+					
+					BLAS.getInstance().somatcopy (BLAS.NO_TRANS, 
+						rows, N, 
+						1F, 
+						inputDataBuffer, inputoffset, inputoffset + (rows * N * sizeOf), N, 
+						columnsBuffer, columnoffset, columnoffset + ((rows - 1) * ld + N) * sizeOf, ld);
+				}
+			}
+			
+			GemmBatch gemms = _gemms.get();
+			
+			float beta = 0F;
+			
+			if (conf.hasBias()) {
+				
+				/* Broadcast bias to all examples with a single rank-1 update */
+				gemms.add (
+					BLAS.NO_TRANS, BLAS.NO_TRANS,
+					outputs, ld, 1,
+					1F, 
+					biasBuffer,            0, outputs * sizeOf, 1,
+					biasmultipliersBuffer, 0,      ld * sizeOf, ld,
+					0F, 
+					outputsBuffer,         0, outputs * ld * sizeOf, ld);
+				
+				beta = 1F;
+			}
+			
+			for (int g = 0; g < groups; ++g) {
+				
+				int weightsoffset = g * M * K  * sizeOf;
+				int columnsoffset = g * K * ld * sizeOf;
+				int outputsoffset = g * M * ld * sizeOf;
+				
+				gemms.add (BLAS.NO_TRANS, BLAS.NO_TRANS, 
+					M, ld, K,
+					1F, 
+					weightsBuffer, weightsoffset, weightsoffset + (M * K  * sizeOf), K,  /* A */
+					columnsBuffer, columnsoffset, columnsoffset + (K * ld * sizeOf), ld, /* B */
+					beta, 
+					outputsBuffer, outputsoffset, outputsoffset + (M * ld * sizeOf), ld); /* C */
+			}
+			
+			BLAS.getInstance().sgemm (gemms);
+			
+			/* Scatter (outputs x ld) result to the output buffer, one (outputs x N) matrix per example */
+			for (int s = 0; s < examples; ++s) {
+				
+				int offset = s * N * sizeOf;
+				int outputoffset = (n + s) * outputvectorsize;
+				
+				BLAS.getInstance().somatcopy (BLAS.NO_TRANS, 
+					outputs, N, 
+					1F, 
+					outputsBuffer, offset, offset + ((outputs - 1) * ld + N) * sizeOf, ld, 
+					outputDataBuffer, outputoffset, outputoffset + (outputs * N * sizeOf), N);
+			}
+		}
 	}
 	
 	public LocalVariable getLocalVariableColumn (){
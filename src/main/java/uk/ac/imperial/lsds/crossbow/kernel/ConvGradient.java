@@ -290,7 +290,7 @@ public class ConvGradient extends Kernel {
 
             /* Use bottom directly */
 
-            BLAS.getInstance().sgemm("N", "T",
+            BLAS.getInstance().sgemm(BLAS.NO_TRANS, BLAS.TRANS,
                     M, K, N,
                     1F,
                     topdiff, topdiff_offset, Alimit + topdiff_offset, lda,
@@ -310,7 +310,7 @@ public class ConvGradient extends Kernel {
             /* We need to derive column buffer from bottom first */
             imageToColumn(bottom, bottom_offset, columnbuffer, channels);
 
-            BLAS.getInstance().sgemm("N", "T",
+            BLAS.getInstance().sgemm(BLAS.NO_TRANS, BLAS.TRANS,
                     M, K, N,
                     1F,
                     topdiff,      topdiff_offset, Alimit + topdiff_offset, lda,
@@ -336,7 +336,7 @@ public class ConvGradient extends Kernel {
 
         if( ((Conv) operator.getPeer().getKernel()).getScalar() ){ /* 1x1 case */
 
-            BLAS.getInstance().sgemm ("T", "N",
+            BLAS.getInstance().sgemm (BLAS.TRANS, BLAS.NO_TRANS,
                     K, N, M,
                     1F,
                     weightbuffer  ,                    0, Alimit,                     lda,
@@ -346,7 +346,7 @@ public class ConvGradient extends Kernel {
 
         }else{
 
-            BLAS.getInstance().sgemm ("T", "N",
+            BLAS.getInstance().sgemm (BLAS.TRANS, BLAS.NO_TRANS,
                     K, N, M,
                     1F,
                     weightbuffer  ,               0, Alimit,                  lda,
@@ -380,7 +380,7 @@ public class ConvGradient extends Kernel {
         int Climit = M * K * 4; /* bias_diff */
 
         /* TODO Check correctness */
-        BLAS.getInstance().sgemm ("N", "N",
+        BLAS.getInstance().sgemm (BLAS.NO_TRANS, BLAS.NO_TRANS,
                 M, K, N,
                 1F,
                 topdiff ,        topdiff_offset, Alimit + topdiff_offset, lda,
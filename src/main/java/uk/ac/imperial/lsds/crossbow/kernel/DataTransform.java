@@ -4,33 +4,46 @@ import org.apache.logging.log4j.LogManager;
 import org.apache.logging.log4j.Logger;
 
 import uk.ac.imperial.lsds.crossbow.Batch;
+import uk.ac.imperial.lsds.crossbow.DatasetMetadata;
+import uk.ac.imperial.lsds.crossbow.ModelConf;
 import uk.ac.imperial.lsds.crossbow.Operator;
+import uk.ac.imperial.lsds.crossbow.SystemConf;
 import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
 import uk.ac.imperial.lsds.crossbow.data.IDataBufferIterator;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.DataTransformConf;
 import uk.ac.imperial.lsds.crossbow.model.LocalVariable;
 import uk.ac.imperial.lsds.crossbow.model.Model;
 import uk.ac.imperial.lsds.crossbow.model.Shape;
 import uk.ac.imperial.lsds.crossbow.model.Variable;
+import uk.ac.imperial.lsds.crossbow.processor.IdleWorkerQueue;
 import uk.ac.imperial.lsds.crossbow.task.ITask;
+import uk.ac.imperial.lsds.crossbow.types.DataType;
 import uk.ac.imperial.lsds.crossbow.types.ModelAccess;
+import uk.ac.imperial.lsds.crossbow.utils.HalfPrecision;
+import uk.ac.imperial.lsds.crossbow.utils.Philox;
 
 import java.io.File;
 import java.io.RandomAccessFile;
 import java.nio.ByteOrder;
 import java.nio.MappedByteBuffer;
 import java.nio.channels.FileChannel;
-import java.util.concurrent.ThreadLocalRandom;
 
 public class DataTransform extends Kernel {
 	
 	private final static Logger log = LogManager.getLogger(DataTransform.class);
+	
+	/* Smallest range of examples transformed by an idle worker */
+	private final static int MIN_EXAMPLES_PER_PART = 8;
 
 	private DataTransformConf conf;
 	
 	private LocalVariable _meanvalues = null;
 	
+	/* Per-thread random numbers (4 per example) and crop offsets & mirror flags (3 per example) */
+	private ThreadLocal<int []> _randoms = null, _offsets = null;
+	
 	public DataTransform (DataTransformConf conf) {
 		this.conf = conf;
 	}
@@ -95,8 +108,8 @@ public class DataTransform extends Kernel {
 				float [] pixels = conf.getMeanPixelValues ();
 			
 				var.getDataBuffer().putFloat(0, pixels [0]);
-				var.getDataBuffer().putFloat(0, pixels [1]);
-				var.getDataBuffer().putFloat(0, pixels [2]);
+				var.getDataBuffer().putFloat(4, pixels [1]);
+				var.getDataBuffer().putFloat(8, pixels [2]);
 			
 				_meanvalues = new LocalVariable (var);
 			}
@@ -104,6 +117,20 @@ public class DataTransform extends Kernel {
 			log.debug(String.format("Local variable %s", var.getName ()));
 		}
 		
+		final int examples = inputShape [0].numberOfExamples();
+		
+		_randoms = new ThreadLocal<int []> () {
+			protected int [] initialValue () {
+				return new int [4 * examples];
+			}
+		};
+		
+		_offsets = new ThreadLocal<int []> () {
+			protected int [] initialValue () {
+				return new int [3 * examples];
+			}
+		};
+		
 		/* 
 		 * Set memory requirements 
 		 */
@@ -118,6 +145,9 @@ public class DataTransform extends Kernel {
 		if (conf.subtractMean())
 			memoryRequirements.setLocalCPUMemoryRequirements (var.capacity());
 		
+		/* And `randoms` and `offsets`, per worker */
+		memoryRequirements.incLocalCPUMemoryRequirements (28 * examples);
+		
 		/* Are there any GPU-specific local variables? Yes, `means` and `randoms` */
 		if (conf.subtractMean())
 			memoryRequirements.incLocalGPUMemoryRequirements (var.capacity());
@@ -132,6 +162,10 @@ public class DataTransform extends Kernel {
 	public void GPURegister () {
 
 		log.debug(String.format ("Register kernel with GPU for operator %s", operator.getName()));
+		
+		/* Compact dataset examples are only widened on the CPU */
+		if (ModelConf.getInstance().getTrainingDataset().getMetadata().getExampleType().isCompact())
+			throw new IllegalStateException (String.format("error: operator %s requires float examples on the GPU", operator.getName()));
 
 		int id = operator.getId();
 		String name = this.getClass().getSimpleName();
@@ -203,9 +237,6 @@ public class DataTransform extends Kernel {
 		int inputImageHeight = input[0].getShape().height ();
 		int inputImageWidth  = input[0].getShape().width ();
 		
-		/* Input image n starts at `n x imageOffset` */
-		int inputImageOffset = channels * inputImageHeight * inputImageWidth * input[0].getType().sizeOf();
-		
 		int outputImageHeight = output[0].getShape().height ();
 		int outputImageWidth  = output[0].getShape().width ();
 		
@@ -216,6 +247,22 @@ public class DataTransform extends Kernel {
 		IDataBuffer inputDataBuffer = getCurrentInput (batch, api);
 		int inputStartP = getStartPointer ();
 		
+		/* 
+		 * Examples may be stored in a compact type (e.g. uint8), in which case
+		 * pixels are widened to floats as `inputScale x pixel + inputShift`
+		 */
+		DataType inputType = inputDataBuffer.getType ();
+		boolean widen = inputType.isCompact ();
+		float inputScale = 1F, inputShift = 0F;
+		if (widen) {
+			DatasetMetadata meta = ModelConf.getInstance().getDataset(api.getPhase()).getMetadata();
+			inputScale = meta.getExampleScale ();
+			inputShift = meta.getExampleShift ();
+		}
+		
+		/* Input image n starts at `n x imageOffset` */
+		int inputImageOffset = channels * inputImageHeight * inputImageWidth * inputType.sizeOf();
+		
 		/* Get output buffer */
 		IDataBuffer outputDataBuffer = getCurrentOutput (batch, api);
 		output[0].wrap (outputDataBuffer);
@@ -233,26 +280,74 @@ public class DataTransform extends Kernel {
 			means = meanimage[0].getDataBuffer();
 		}
 		
-		boolean mirror = conf.getMirror () && (ThreadLocalRandom.current().nextInt(2) == 1);
 		boolean training = (! api.isValidationTask());
 		
+		/* 
+		 * Crop offsets and mirror flag, per image, drawn from the image's random
+		 * stream: a Philox block keyed by the random seed, for the example index
+		 * in the current epoch (so that runs with the same seed are repeatable)
+		 */
+		int tasks = (training) ? ModelConf.getInstance().numberOfTasksPerEpoch() : ModelConf.getInstance().numberOfTestTasks();
+		int epoch = batch.getId() / tasks;
+		int first = (batch.getId() % tasks) * examples;
+		
+		int [] randoms = _randoms.get();
+		Philox.fill (randoms, examples, first, epoch, operator.getId(), SystemConf.getInstance().getRandomSeed());
+		
+		int [] offsets = _offsets.get();
+		
 		for (int n = 0; n < examples; ++n) {
 			
-			/* Find current position in input/output buffers */
-			int  inputImagePos = (n *  inputImageOffset) + inputStartP;
-			int outputImagePos = (n * outputImageOffset);
-			
 			int heightOffset = 0, widthOffset = 0;
 			
 			if (cropSize > 0) {
 				if (training) {
-					heightOffset = ThreadLocalRandom.current().nextInt (inputImageHeight - cropSize + 1);
-					 widthOffset = ThreadLocalRandom.current().nextInt (inputImageWidth  - cropSize + 1);
+					heightOffset = Philox.bounded (randoms [4 * n    ], inputImageHeight - cropSize + 1);
+					 widthOffset = Philox.bounded (randoms [4 * n + 1], inputImageWidth  - cropSize + 1);
 				} else {
 					heightOffset = (inputImageHeight - cropSize) / 2;
 					 widthOffset = (inputImageWidth  - cropSize) / 2;
 				}
 			}
+			offsets [3 * n    ] = heightOffset;
+			offsets [3 * n + 1] =  widthOffset;
+			offsets [3 * n + 2] = (conf.getMirror ()) ? (randoms [4 * n + 2] & 1) : 0;
+		}
+		
+		if (CPUKernels.getInstance().isEnabled()) {
+			
+			/* 
+			 * Transform ranges of examples in parallel, if other workers are idle
+			 * (with at least `MIN_EXAMPLES_PER_PART` examples per range)
+			 */
+			IdleWorkerQueue.getInstance().parallelFor (examples, MIN_EXAMPLES_PER_PART,
+				new DataTransformRange (
+					inputDataBuffer, inputStartP, inputImageOffset, inputType,
+					outputDataBuffer, outputImageOffset,
+					offsets,
+					channels, inputImageHeight, inputImageWidth, outputImageHeight, outputImageWidth,
+					means, inputScale, inputShift, scaleFactor));
+			
+			batch.setOutput(operator.getId(), outputDataBuffer);
+			return;
+		}
+		
+		boolean subtractMean = conf.subtractMean ();
+		boolean hasMeanImage = conf.hasMeanImage ();
+		
+		int  inputPixelSize = inputType.sizeOf ();
+		int outputPixelSize = output[0].getType().sizeOf ();
+		int   meanPixelSize = (subtractMean) ? meanimage[0].getType().sizeOf() : 0;
+		
+		for (int n = 0; n < examples; ++n) {
+			
+			/* Find current position in input/output buffers */
+			int  inputImagePos = (n *  inputImageOffset) + inputStartP;
+			int outputImagePos = (n * outputImageOffset);
+			
+			int heightOffset = offsets [3 * n    ];
+			int  widthOffset = offsets [3 * n + 1];
+			boolean   mirror = (offsets [3 * n + 2] > 0);
 			
 			for (int c = 0 ; c < channels; ++c) {
 				for (int h = 0 ; h < outputImageHeight; ++h) {
@@ -261,18 +356,22 @@ public class DataTransform extends Kernel {
 						int  inputIndex = (c * inputImageHeight  + heightOffset + h) * inputImageWidth + widthOffset + w;
 						int outputIndex = (c * outputImageHeight + h) * outputImageWidth + ((mirror) ? (outputImageWidth - 1 - w) : w);
 						
-						int  inputPixelPos =  inputImagePos + ( inputIndex *  input[0].getType().sizeOf ());
-						int outputPixelPos = outputImagePos + (outputIndex * output[0].getType().sizeOf ());
+						int  inputPixelPos =  inputImagePos + ( inputIndex *  inputPixelSize);
+						int outputPixelPos = outputImagePos + (outputIndex * outputPixelSize);
 						
-						float pixel = inputDataBuffer.getFloat(inputPixelPos);
+						float pixel;
+						if (widen)
+							pixel = inputScale * getPixel (inputDataBuffer, inputPixelPos, inputType) + inputShift;
+						else
+							pixel = inputDataBuffer.getFloat(inputPixelPos);
 						
 						/* Subtract mean */
-						if (conf.subtractMean ()) {
+						if (subtractMean) {
 							
-							if (conf.hasMeanImage ())
-								pixel -= means.getFloat(meanimage[0].getType().sizeOf() * inputIndex);
+							if (hasMeanImage)
+								pixel -= means.getFloat(meanPixelSize * inputIndex);
 							else
-								pixel -= means.getFloat(meanimage[0].getType().sizeOf() * c);
+								pixel -= means.getFloat(meanPixelSize * c);
 						}
 						
 						/* Scale */
@@ -290,6 +389,65 @@ public class DataTransform extends Kernel {
 		batch.setOutput(operator.getId(), outputDataBuffer);
 	}
 	
+	/* Reads a compact (little-endian) pixel value */
+	private static float getPixel (IDataBuffer buffer, int offset, DataType type) {
+		
+		switch (type) {
+		case UINT8: return (float) (buffer.get(offset) & 0xFF);
+		case  INT8: return (float)  buffer.get(offset);
+		case  FP16: return HalfPrecision.toFloat ((short) ((buffer.get(offset) & 0xFF) | (buffer.get(offset + 1) << 8)));
+		default:
+			return buffer.getFloat(offset);
+		}
+	}
+	
+	/* Transforms examples [first, last) of a batch with the native kernel */
+	private class DataTransformRange implements IdleWorkerQueue.Range {
+		
+		IDataBuffer input, output, means;
+		int inputStartP, inputImageOffset, outputImageOffset;
+		DataType inputType;
+		int [] offsets;
+		int channels, height, width, croppedHeight, croppedWidth;
+		float scale, shift, factor;
+		
+		public DataTransformRange (
+			IDataBuffer input, int inputStartP, int inputImageOffset, DataType inputType,
+			IDataBuffer output, int outputImageOffset,
+			int [] offsets,
+			int channels, int height, int width, int croppedHeight, int croppedWidth,
+			IDataBuffer means, float scale, float shift, float factor) {
+			
+			this.input = input;
+			this.inputStartP = inputStartP;
+			this.inputImageOffset = inputImageOffset;
+			this.inputType = inputType;
+			this.output = output;
+			this.outputImageOffset = outputImageOffset;
+			this.offsets = offsets;
+			this.channels = channels;
+			this.height = height;
+			this.width = width;
+			this.croppedHeight = croppedHeight;
+			this.croppedWidth = croppedWidth;
+			this.means = means;
+			this.scale = scale;
+			this.shift = shift;
+			this.factor = factor;
+		}
+		
+		public void run (int first, int last) {
+			
+			CPUKernels.getInstance().dataTransform (
+				input, inputStartP + first * inputImageOffset, inputType.getId(),
+				output, first * outputImageOffset,
+				offsets, first,
+				last - first, channels, height, width, croppedHeight, croppedWidth,
+				means, conf.hasMeanImage(),
+				scale, shift, factor);
+		}
+	}
+	
 	@SuppressWarnings("resource")
 	private void loadFile (String filename, IDataBuffer image) {
 		File file = new File(filename);
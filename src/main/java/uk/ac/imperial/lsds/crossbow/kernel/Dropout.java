@@ -1,26 +1,53 @@
 package uk.ac.imperial.lsds.crossbow.kernel;
 
+import java.nio.BufferOverflowException;
+
 import org.apache.logging.log4j.LogManager;
 import org.apache.logging.log4j.Logger;
 
 import uk.ac.imperial.lsds.crossbow.Batch;
 import uk.ac.imperial.lsds.crossbow.Operator;
 import uk.ac.imperial.lsds.crossbow.SystemConf;
+import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.DropoutConf;
+import uk.ac.imperial.lsds.crossbow.model.InitialiserConf;
 import uk.ac.imperial.lsds.crossbow.model.LocalVariable;
 import uk.ac.imperial.lsds.crossbow.model.Model;
 import uk.ac.imperial.lsds.crossbow.model.Shape;
 import uk.ac.imperial.lsds.crossbow.model.Variable;
+import uk.ac.imperial.lsds.crossbow.processor.IdleWorkerQueue;
 import uk.ac.imperial.lsds.crossbow.task.ITask;
 import uk.ac.imperial.lsds.crossbow.types.CudnnKernelType;
+import uk.ac.imperial.lsds.crossbow.types.DataType;
 import uk.ac.imperial.lsds.crossbow.types.ModelAccess;
+import uk.ac.imperial.lsds.crossbow.utils.Philox;
 
+/*
+ * Inverted dropout: during training, every element is kept with probability
+ * (1 - ratio) and scaled by 1 / (1 - ratio); otherwise, it is dropped (0).
+ * At test time, dropout is the identity.
+ *
+ * On CPU, the keep mask is bit-packed (one bit per element, in `mask`) and
+ * drawn from a Philox stream keyed by the random seed, for the task and the
+ * operator: mask word w is derived from blocks 4w, ..., 4w + 3 (one 16-bit
+ * random value per element), so that ranges of words can be generated in
+ * parallel. The peer DropoutGradient operator reads the mask back.
+ */
 public class Dropout extends Kernel {
 	
 	private final static Logger log = LogManager.getLogger (Dropout.class);
 	
+	/* Elements are processed in parallel in ranges of at least that many mask words */
+	final static int MIN_WORDS_PER_PART = 2048;
+	
+	/* Mask words generated at a time, if native kernels are disabled */
+	private final static int WORDS = 16;
+	
 	DropoutConf conf;
+	
+	LocalVariable _mask;
 
 	public Dropout (DropoutConf conf) {
 		this.conf = conf;
@@ -57,8 +84,16 @@ public class Dropout extends Kernel {
 		/* Are there any model variables? No */
 		memoryRequirements.setModelMemoryRequirements (0);
 		
-		/* Are there any CPU-specific local variables? No */
-		memoryRequirements.setLocalCPUMemoryRequirements (0);
+		/* Are there any CPU-specific local variables? Yes, `mask` (one bit per element) */
+		int words = (input.getShape().countAllElements() + 31) / 32;
+		
+		Variable mask = new Variable ("mask", new Shape (new int [] { words }), false, DataType.INT);
+		mask.initialise (new InitialiserConf().setValue(0));
+		_mask = new LocalVariable (mask);
+		
+		log.debug(String.format("Local variable %s", mask.getName()));
+		
+		memoryRequirements.setLocalCPUMemoryRequirements (mask.capacity());
 		
 		/* Are there any GPU-specific local variables? Yes, but they cannot be defined at the moment */
 		memoryRequirements.setLocalGPUMemoryRequirements (0);
@@ -111,6 +146,120 @@ public class Dropout extends Kernel {
 	}
 	
 	public void compute (Operator [] previous, Batch batch, Model model, ITask api) {
+		
+		log.debug(String.format("Compute kernel for operator %s", operator.getName()));
+		
+		if (previous != null && previous.length > 1)
+			throw new IllegalArgumentException (String.format("error: invalid number of inputs for operator %s", operator.getName()));
+		
+		/* Get thread-local variables */
+		Variable [] input  =  theInput.get();
+		Variable [] output = theOutput.get();
+		
+		/* Get input buffer */
+		final IDataBuffer inputDataBuffer = getCurrentInput (batch, api);
+		final int inputStartP = getStartPointer ();
+		int inputEndP = getEndPointer ();
+		
+		/* Get an output buffer */
+		final IDataBuffer outputDataBuffer = getCurrentOutput (batch, api);
+		output[0].wrap(outputDataBuffer);
+		
+		final int elements = input[0].getShape().countAllElements();
+		
+		if ((inputStartP + elements * input[0].getType().sizeOf()) > inputEndP)
+			throw new BufferOverflowException();
+		
+		if (api.isValidationTask()) {
+			
+			/* Dropout is the identity at test time */
+			if (CPUKernels.getInstance().isEnabled()) {
+				CPUKernels.getInstance().copy (inputDataBuffer, inputStartP, outputDataBuffer, 0, elements * 4);
+			} else {
+				for (int ndx = 0; ndx < elements; ++ndx)
+					outputDataBuffer.putFloat(ndx * 4, inputDataBuffer.getFloat(inputStartP + ndx * 4));
+			}
+			batch.setOutput(operator.getId(), outputDataBuffer);
+			return;
+		}
+		
+		/* Get configuration variable(s) */
+		final float ratio = conf.getRatio();
+		
+		final int task = batch.getId();
+		final int stream = operator.getId();
+		final long seed = SystemConf.getInstance().getRandomSeed();
+		
+		final IDataBuffer maskBuffer = _mask.get()[0].getDataBuffer();
+		
+		int words = (elements + 31) / 32;
+		
+		if (CPUKernels.getInstance().isEnabled()) {
+			
+			/* Generate and apply ranges of mask words in parallel, if other workers are idle */
+			IdleWorkerQueue.getInstance().parallelFor (words, MIN_WORDS_PER_PART, new IdleWorkerQueue.Range () {
+				public void run (int from, int to) {
+					int first = from * 32;
+					int count = Math.min(elements, to * 32) - first;
+					CPUKernels.getInstance().dropout (
+						inputDataBuffer, inputStartP + first * 4,
+						outputDataBuffer, first * 4,
+						maskBuffer, from * 4,
+						count, ratio,
+						from, task, stream, seed);
+				}
+			});
+		}
+		else {
+			
+			/* Same mask as the native kernel */
+			int threshold = getThreshold (ratio);
+			float scale = getScale (ratio);
+			
+			int [] randoms = new int [16 * WORDS];
+			
+			for (int w = 0; w < words; w += WORDS) {
+				
+				int n = Math.min(WORDS, words - w);
+				
+				Philox.fill (randoms, 4 * n, 4 * w, task, stream, seed);
+				
+				for (int j = 0; j < n; ++j) {
+					int bits = 0;
+					for (int b = 0; b < 16; ++b) {
+						int r = randoms [16 * j + b];
+						if ((r & 0xFFFF) >= threshold) bits |= 1 << (2 * b);
+						if ((r >>>    16) >= threshold) bits |= 1 << (2 * b + 1);
+					}
+					maskBuffer.putInt((w + j) * 4, bits);
+				}
+			}
+			
+			for (int ndx = 0; ndx < elements; ++ndx) {
+				boolean keep = ((maskBuffer.getInt((ndx >> 5) * 4) >>> (ndx & 31)) & 1) != 0;
+				outputDataBuffer.putFloat(ndx * 4, keep ? inputDataBuffer.getFloat(inputStartP + ndx * 4) * scale : 0);
+			}
+		}
+		
+		batch.setOutput(operator.getId(), outputDataBuffer);
+	}
+	
+	/* Kept elements are scaled by 1 / (1 - ratio) */
+	static float getScale (float ratio) {
+		return (ratio < 1F) ? (1F / (1F - ratio)) : 0F;
+	}
+	
+	/* An element is kept if its 16-bit random value is at least the threshold */
+	static int getThreshold (float ratio) {
+		if (ratio <= 0F)
+			return 0;
+		if (ratio >= 1F)
+			return 65536;
+		return (int) (ratio * 65536F);
+	}
+	
+	public LocalVariable getMask () {
+		return _mask;
 	}
 	
 	public ModelAccess getModelAccessType () {
@@ -1,16 +1,21 @@
 package uk.ac.imperial.lsds.crossbow.kernel;
 
+import java.nio.BufferOverflowException;
+
 import org.apache.logging.log4j.LogManager;
 import org.apache.logging.log4j.Logger;
 
 import uk.ac.imperial.lsds.crossbow.Batch;
 import uk.ac.imperial.lsds.crossbow.Operator;
+import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.DropoutConf;
 import uk.ac.imperial.lsds.crossbow.model.LocalVariable;
 import uk.ac.imperial.lsds.crossbow.model.Model;
 import uk.ac.imperial.lsds.crossbow.model.Shape;
 import uk.ac.imperial.lsds.crossbow.model.Variable;
+import uk.ac.imperial.lsds.crossbow.processor.IdleWorkerQueue;
 import uk.ac.imperial.lsds.crossbow.task.ITask;
 import uk.ac.imperial.lsds.crossbow.types.ModelAccess;
 
@@ -96,6 +101,62 @@ public class DropoutGradient extends Kernel {
 	}
 	
 	public void compute (Operator [] previous, Batch batch, Model model, ITask api) {
+		
+		log.debug(String.format("Compute kernel for operator %s", operator.getName()));
+		
+		if (previous != null && previous.length > 1)
+			throw new IllegalArgumentException (String.format("error: invalid number of inputs for operator %s", operator.getName()));
+		
+		/* Get thread-local variables */
+		Variable [] input  =  theInput.get();
+		Variable [] output = theOutput.get();
+		
+		/* Get input buffer */
+		final IDataBuffer inputDataBuffer = getCurrentInput (batch, api);
+		final int inputStartP = getStartPointer ();
+		int inputEndP = getEndPointer ();
+		
+		/* Get an output buffer */
+		final IDataBuffer outputDataBuffer = getCurrentOutput (batch, api);
+		output[0].wrap(outputDataBuffer);
+		
+		final int elements = input[0].getShape().countAllElements();
+		
+		if ((inputStartP + elements * input[0].getType().sizeOf()) > inputEndP)
+			throw new BufferOverflowException();
+		
+		final float ratio = conf.getRatio();
+		
+		/* The mask generated by the forward peer for this task */
+		final IDataBuffer maskBuffer = ((Dropout) operator.getPeer().getKernel()).getMask().get()[0].getDataBuffer();
+		
+		int words = (elements + 31) / 32;
+		
+		if (CPUKernels.getInstance().isEnabled()) {
+			
+			IdleWorkerQueue.getInstance().parallelFor (words, Dropout.MIN_WORDS_PER_PART, new IdleWorkerQueue.Range () {
+				public void run (int from, int to) {
+					int first = from * 32;
+					int count = Math.min(elements, to * 32) - first;
+					CPUKernels.getInstance().dropoutGradient (
+						inputDataBuffer, inputStartP + first * 4,
+						maskBuffer, from * 4,
+						outputDataBuffer, first * 4,
+						count, ratio);
+				}
+			});
+		}
+		else {
+			
+			float scale = Dropout.getScale (ratio);
+			
+			for (int ndx = 0; ndx < elements; ++ndx) {
+				boolean keep = ((maskBuffer.getInt((ndx >> 5) * 4) >>> (ndx & 31)) & 1) != 0;
+				outputDataBuffer.putFloat(ndx * 4, keep ? inputDataBuffer.getFloat(inputStartP + ndx * 4) * scale : 0);
+			}
+		}
+		
+		batch.setOutput(operator.getId(), outputDataBuffer);
 	}
 	
 	public ModelAccess getModelAccessType () {
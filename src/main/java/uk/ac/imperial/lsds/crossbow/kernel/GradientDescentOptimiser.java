@@ -7,9 +7,8 @@ import uk.ac.imperial.lsds.crossbow.Batch;
 import uk.ac.imperial.lsds.crossbow.ModelConf;
 import uk.ac.imperial.lsds.crossbow.Operator;
 import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
-import uk.ac.imperial.lsds.crossbow.data.IDataBufferIterator;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
-import uk.ac.imperial.lsds.crossbow.device.blas.BLAS;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.SolverConf;
 import uk.ac.imperial.lsds.crossbow.model.LocalVariable;
 import uk.ac.imperial.lsds.crossbow.model.Model;
@@ -19,7 +18,6 @@ import uk.ac.imperial.lsds.crossbow.model.Shape;
 import uk.ac.imperial.lsds.crossbow.model.Variable;
 import uk.ac.imperial.lsds.crossbow.model.VariableGradient;
 import uk.ac.imperial.lsds.crossbow.task.ITask;
-import uk.ac.imperial.lsds.crossbow.types.DataType;
 import uk.ac.imperial.lsds.crossbow.types.LearningRateDecayPolicy;
 import uk.ac.imperial.lsds.crossbow.types.ModelAccess;
 import uk.ac.imperial.lsds.crossbow.types.Regularisation;
@@ -106,13 +104,8 @@ public class GradientDescentOptimiser extends Kernel {
 		
 			model.writeLock();
 			
-			clipGradient        (       gradient);
-			applyWeightDecay 	(model, gradient); /* This method requires access to model variables */
-			applyLearningRate   (rate,  gradient);
-			applyMomentum       (model, gradient); /* This requires access to the last gradient that was applied to the model */
-			
-			/* Apply gradient to local model */
-			model.apply(gradient);
+			/* Update local model */
+			update (model, gradient, rate);
 			
 			/* Unlock the model */
 			model.writeUnlock();
@@ -131,13 +124,8 @@ public class GradientDescentOptimiser extends Kernel {
 			
 			model.writeLock();
 			
-			clipGradient        (       gradient);
-			applyWeightDecay 	(model, gradient); /* This method requires access to model variables */
-			applyLearningRate   (rate,  gradient);
-			applyMomentum       (model, gradient); /* This requires access to the last gradient that was applied to the model */
-			
-			/* Apply gradient to local model */
-			model.apply(gradient);
+			/* Update local model */
+			update (model, gradient, rate);
 			
 			/* Unlock the model */
 			model.writeUnlock();
@@ -152,6 +140,103 @@ public class GradientDescentOptimiser extends Kernel {
 		return;
 	}
 	
+	/*
+	 * Clips the gradient, applies weight decay, the learning rate and momentum,
+	 * and then applies the gradient to the model.
+	 *
+	 * With native kernels, every dense variable is updated in one fused pass
+	 * that reads the gradient, the variable and the last gradient once (rather
+	 * than once per step).
+	 */
+	private void update (Model model, ModelGradient gradient, float rate) {
+		
+		if ((! CPUKernels.getInstance().isEnabled()) || (conf.getWeightDecay() > 0F && conf.getRegularisationType() != Regularisation.L2)) {
+			
+			clipGradient        (       gradient);
+			applyWeightDecay 	(model, gradient); /* This method requires access to model variables */
+			applyLearningRate   (rate,  gradient);
+			applyMomentum       (model, gradient); /* This requires access to the last gradient that was applied to the model */
+			
+			model.apply(gradient);
+			return;
+		}
+		
+		float scale = getClipFactor (gradient);
+		float decay = Math.max(conf.getWeightDecay(), 0F);
+		float momentum = conf.getMomentum();
+		
+		ModelGradient last = (momentum == 0F) ? null : model.getLastGradient();
+		
+		ModelIterator<Variable> m = model.iterator();
+		ModelIterator<VariableGradient> g = gradient.iterator();
+		ModelIterator<VariableGradient> l = (last == null) ? null : last.iterator();
+		
+		IDataBuffer W;
+		VariableGradient G, L;
+		float r;
+		
+		while (m.hasNext() && g.hasNext()) {
+			
+			W = m.next().getDataBuffer();
+			G = g.next();
+			L = (l != null && l.hasNext()) ? l.next() : null;
+			
+			r = G.getLearningRateMultiplier() * rate;
+			
+			if (G.isSparse() || (L != null && L.isSparse())) {
+				
+				/* Row-sparse gradients take the unfused steps, over the rows they touch */
+				if (scale != 1F)
+					G.scale(scale);
+				if (decay > 0F)
+					G.add(decay, W);
+				G.scale(r);
+				if (L != null) {
+					G.densify();
+					L.axpy(momentum, G.getDataBuffer());
+				}
+				G.axpy(-1F, W);
+			}
+			else {
+				
+				CPUKernels.getInstance().sgdUpdate (
+					W, G.getDataBuffer(), (L == null) ? null : L.getDataBuffer(),
+					W.limit() / W.getType().sizeOf(),
+					scale, decay, r, momentum);
+			}
+		}
+		
+		model.incUpdates();
+	}
+	
+	/* Returns the factor that scales the gradient's L2 norm down to the clipping threshold (or 1) */
+	private float getClipFactor (ModelGradient gradient) {
+		
+		float threshold = conf.getClipGradientThreshold();
+		
+		if (threshold < 0) {
+			return 1F;
+		}
+		
+		float L2, sumsquared = 0F;
+		
+		ModelIterator<VariableGradient> i = gradient.iterator();
+		VariableGradient G;
+		
+		while (i.hasNext()) {
+			
+			G = i.next();
+			if (G.isSparse())
+				sumsquared += G.sumOfSquares();
+			else
+				sumsquared += CPUKernels.getInstance().sumOfSquares(G.getDataBuffer(), G.getDataBuffer().limit() / 4);
+		}
+		
+		L2 = (float) Math.sqrt(sumsquared);
+		
+		return (L2 > threshold) ? (threshold / L2) : 1F;
+	}
+	
 	private float getLearningRate (int batchid) {
 		
 		float rate;
@@ -217,22 +302,10 @@ public class GradientDescentOptimiser extends Kernel {
 		float L2, sumsquared = 0F;
 		
 		ModelIterator<VariableGradient> i = gradient.iterator();
-		IDataBuffer buffer;
-		
-		IDataBufferIterator j;
-		int offset;
 		
-		while (i.hasNext()) {
-			
-			buffer = i.next().getDataBuffer();
-			j = buffer.getIterator();
-			
-			while (j.hasNext()) {
-				
-				offset = j.next();
-				sumsquared += (float) Math.pow (buffer.getFloat(offset), 2);
-			}
-		}
+		/* Row-sparse gradients only visit the rows they touch */
+		while (i.hasNext())
+			sumsquared += i.next().sumOfSquares();
 		
 		L2 = (float) Math.sqrt(sumsquared);
 		
@@ -241,17 +314,8 @@ public class GradientDescentOptimiser extends Kernel {
 			float factor = threshold / L2;
 			i.reset();
 			
-			while (i.hasNext()) {
-				
-				buffer = i.next().getDataBuffer();
-				j = buffer.getIterator();
-				
-				while (j.hasNext()) {
-					
-					offset = j.next();
-					buffer.putFloat (offset, factor * buffer.getFloat(offset));
-				}
-			}
+			while (i.hasNext())
+				i.next().scale(factor);
 		}
 		
 		return;
@@ -267,20 +331,16 @@ public class GradientDescentOptimiser extends Kernel {
 		ModelIterator<Variable> m = model.iterator();
 		ModelIterator<VariableGradient> g = gradient.iterator();
 		
-		IDataBuffer X, Y;
-		int N;
+		IDataBuffer X;
 		
 		Regularisation t = conf.getRegularisationType();
 		switch (t) {
 		
 		case L2:
+			/* Row-sparse gradients decay only the rows they touch (lazy regularisation) */
 			while (m.hasNext() && g.hasNext()) {
 				X = m.next().getDataBuffer();
-				Y = g.next().getDataBuffer();
-				
-				N = X.limit() / DataType.FLOAT.sizeOf();
-				
-				BLAS.getInstance().saxpby(N, decay, X, 0, X.limit(), /* incX */ 1, 1F, Y, /* incY */ 1);
+				g.next().add(decay, X);
 			}
 			break;
 			
@@ -298,21 +358,11 @@ public class GradientDescentOptimiser extends Kernel {
 		
 		ModelIterator<VariableGradient> g = gradient.iterator();
 		VariableGradient var;
-		IDataBuffer buffer;
-		IDataBufferIterator b;
-		int offset;
 		
 		while (g.hasNext()) {
 			
 			var = g.next();
-			buffer = var.getDataBuffer();
-			b = buffer.getIterator();
-			
-			while (b.hasNext()) {
-				
-				offset = b.next();
-				buffer.putFloat(offset, var.getLearningRateMultiplier() * rate * buffer.getFloat(offset));
-			}
+			var.scale(var.getLearningRateMultiplier() * rate);
 		}
 	}
 	
@@ -337,17 +387,16 @@ public class GradientDescentOptimiser extends Kernel {
 		ModelIterator<VariableGradient> g = gradient.iterator();
 		ModelIterator<VariableGradient> l =     last.iterator();
 		
-		IDataBuffer X, Y;
-		int N;
+		VariableGradient X, Y;
 		
 		while (l.hasNext() && g.hasNext()) {
 			
-			X = l.next().getDataBuffer();
-			Y = g.next().getDataBuffer();
-			
-			N = X.limit() / DataType.FLOAT.sizeOf();
+			X = l.next();
+			Y = g.next();
 			
-			BLAS.getInstance().saxpby(N, momentum, X, 0, X.limit(), /* incX */ 1, 1F, Y, /* incY */ 1);
+			/* Momentum carries over every row of the last gradient */
+			Y.densify();
+			X.axpy(momentum, Y.getDataBuffer());
 		}	
 	}
 
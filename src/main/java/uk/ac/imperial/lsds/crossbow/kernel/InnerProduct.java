@@ -209,7 +209,7 @@ public class InnerProduct extends Kernel {
 		ldb = K; /* if "N", N, else K */
 		ldc = N;
 		
-		BLAS.getInstance().sgemm("N", "T", 
+		BLAS.getInstance().sgemm(BLAS.NO_TRANS, BLAS.TRANS, 
 				M, N, K,
 				alpha,
 				inputDataBuffer, inputStartP, inputEndP, lda,
@@ -236,7 +236,7 @@ public class InnerProduct extends Kernel {
 			weightStartP = 0;
 			weightEndP = weightsBuffer.limit();
 			  
-			BLAS.getInstance().sgemm("N", "N", 
+			BLAS.getInstance().sgemm(BLAS.NO_TRANS, BLAS.NO_TRANS, 
 					M, N, K,
 					alpha,
 					inputDataBuffer, inputStartP, inputEndP, lda,
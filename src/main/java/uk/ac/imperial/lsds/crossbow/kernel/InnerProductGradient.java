@@ -181,7 +181,7 @@ public class InnerProductGradient extends Kernel {
 		weightGradientBuffer.bzero();
 
 		/* Compute weight gradient */
-		BLAS.getInstance().sgemm ("T", "N", 
+		BLAS.getInstance().sgemm (BLAS.TRANS, BLAS.NO_TRANS, 
 				N, K, M,
 				alpha,
 				inputDataBuffer, inputStartP, inputEndP, lda,
@@ -202,7 +202,7 @@ public class InnerProductGradient extends Kernel {
 			local = _biasmultiplier.get();
 			multiplier = local[0].getDataBuffer();
 
-			BLAS.getInstance().sgemv ("T", 
+			BLAS.getInstance().sgemv (BLAS.TRANS, 
 					M, N,
 					alpha,
 					inputDataBuffer, inputStartP, inputEndP, lda,
@@ -232,7 +232,7 @@ public class InnerProductGradient extends Kernel {
 			outputDataBuffer = getCurrentOutput (batch, api);
 			output[0].wrap(outputDataBuffer);
 
-			BLAS.getInstance().sgemm ("N", "N",
+			BLAS.getInstance().sgemm (BLAS.NO_TRANS, BLAS.NO_TRANS,
 					M, K, N,
 					alpha,
 					inputDataBuffer, inputStartP, inputEndP, lda,
@@ -1,44 +1,224 @@
 package uk.ac.imperial.lsds.crossbow.kernel;
 
+import java.nio.BufferOverflowException;
+
 import org.apache.logging.log4j.LogManager;
 import org.apache.logging.log4j.Logger;
 
 import uk.ac.imperial.lsds.crossbow.Batch;
 import uk.ac.imperial.lsds.crossbow.Operator;
+import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
+import uk.ac.imperial.lsds.crossbow.device.TheGPU;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.LRNConf;
+import uk.ac.imperial.lsds.crossbow.model.LocalVariable;
 import uk.ac.imperial.lsds.crossbow.model.Model;
 import uk.ac.imperial.lsds.crossbow.model.Shape;
+import uk.ac.imperial.lsds.crossbow.model.Variable;
 import uk.ac.imperial.lsds.crossbow.task.ITask;
 import uk.ac.imperial.lsds.crossbow.types.ModelAccess;
+import uk.ac.imperial.lsds.crossbow.types.NormalisationRegion;
 
 /*
- * The Local Response Normalisation (LRN) operator 
+ * The Local Response Normalisation (LRN) operator
+ *
+ * For input X of shape N x C x H x W, LRN (across channels) computes:
+ *
+ * scale[n,c,h,w] = kappa + (alpha / size) * sum (X[n,c',h,w]^2), for c' in [c - pre, c + post]
+ *
+ * Y[n,c,h,w] = X[n,c,h,w] * scale[n,c,h,w]^(-beta)
+ *
+ * where pre = (size - 1) / 2 and post = size - pre - 1. The scale is kept
+ * in a thread-local variable for the backward pass.
  */
 public class LRN extends Kernel {
 
-	@SuppressWarnings("unused")
 	private final static Logger log = LogManager.getLogger (LRN.class);
 
 	LRNConf conf;
 
+	int examples, channels, spatial;
+
+	LocalVariable scale;
+
 	public LRN (LRNConf conf) {
 		this.conf = conf;
 	}
 
 	public LRN setup (Shape [] inputShape, Model model) {
+
+		log.debug(String.format("Setup kernel for operator %s", operator.getName()));
+
+		if (inputShape.length > 1)
+			throw new IllegalArgumentException (String.format("error: invalid number of inputs for operator %s", operator.getName()));
+
+		if (conf.getNormalisationRegion() != NormalisationRegion.ACROSS_CHANNELS) {
+			System.err.println(String.format("error: unsupported normalisation region: %s", conf.getNormalisationRegion()));
+			System.exit(1);
+		}
+
+		if (conf.getSize() < 1) {
+			System.err.println("error: LRN size must be positive");
+			System.exit(1);
+		}
+
+		Variable input = new Variable ("input", inputShape[0], true);
+		theInput = new LocalVariable (input);
+
+		log.debug(String.format("Input variable %s", input.getName()));
+
+		/*
+		 * Number of examples, number of channels, and number of
+		 * elements per channel (height x width)
+		 */
+		examples = inputShape[0].numberOfExamples();
+		channels = inputShape[0].numberOfChannels();
+		spatial  = inputShape[0].countElements(2);
+
+		/* Configure local variables */
+
+		Variable var = new Variable ("scale", inputShape[0], false);
+		scale = new LocalVariable (var);
+
+		/* Configure the output shape */
+
+		outputShape = inputShape[0].copy();
+
+		Variable output = new Variable ("output", outputShape, true);
+		theOutput = new LocalVariable (output);
+
+		log.debug(String.format("Output variable %s", output.getName()));
+
+		/*
+		 * Set memory requirements
+		 */
+
+		/* Set output, by default */
+		memoryRequirements.setOutputMemoryRequirements(output.capacity());
+
+		/* Are there any model variables? No */
+		memoryRequirements.setModelMemoryRequirements (0);
+
+		/* Are there any CPU-specific local variables? Yes, `scale` */
+		memoryRequirements.setLocalCPUMemoryRequirements (var.capacity());
+
+		/* Are there any GPU-specific local variables? Yes, `scale` */
+		memoryRequirements.setLocalGPUMemoryRequirements (var.capacity());
+
 		return this;
 	}
 
 	public void GPURegister () {
+
+		log.debug(String.format("Register kernel with GPU for operator %s", operator.getName()));
+
+		int id = operator.getId();
+		String name = this.getClass().getSimpleName();
+
+		/* 1 input, 1 local variable, 1 output */
+		TheGPU.getInstance().setKernel (id, name, 1, 1, 1, (isLossKernel() || isAccuracyKernel()));
+
+		Variable []  input =  theInput.getInitialValue();
+		Variable [] output = theOutput.getInitialValue();
+		Variable []  local =     scale.getInitialValue();
+
+		/* Set input */
+		TheGPU.getInstance().setKernelInput  (id, 0,  input[0].getShape().array(),  input[0].capacity());
+
+		/* Set output */
+		TheGPU.getInstance().setKernelOutput (id,    output[0].getShape().array(), output[0].capacity());
+
+		/* Set local variables */
+		TheGPU.getInstance().setKernelLocalVariable (id, 0, "scale", local[0].getShape().array(), local[0].capacity(), false);
+
+		/* Set kernel configuration parameters */
+		TheGPU.getInstance().setKernelConfigurationParameters (id, 4);
+
+		TheGPU.getInstance().setKernelConfigurationParameterAsInt   (id, 0, "size",  conf.getSize());
+		TheGPU.getInstance().setKernelConfigurationParameterAsFloat (id, 1, "alpha", conf.getAlpha());
+		TheGPU.getInstance().setKernelConfigurationParameterAsFloat (id, 2, "beta",  conf.getBeta());
+		TheGPU.getInstance().setKernelConfigurationParameterAsFloat (id, 3, "kappa", conf.getKappa());
 	}
 
 	public void compute (Operator [] previous, Batch batch, Model model, ITask api) {
+
+		log.debug(String.format("Compute kernel for operator %s", operator.getName()));
+
+		if (previous != null && previous.length > 1)
+			throw new IllegalArgumentException (String.format("error: invalid number of inputs for operator %s", operator.getName()));
+
+		/* Get thread-local variables */
+		Variable []  input =  theInput.get();
+		Variable [] output = theOutput.get();
+
+		/* Get input buffer */
+		IDataBuffer inputDataBuffer = getCurrentInput (batch, api);
+		int inputStartP = getStartPointer ();
+		int inputEndP = getEndPointer ();
+
+		if ((inputStartP + input[0].capacity()) > inputEndP)
+			throw new BufferOverflowException();
+
+		/* Get an output buffer */
+		IDataBuffer outputDataBuffer = getCurrentOutput (batch, api);
+		output[0].wrap(outputDataBuffer);
+
+		/* Get local variable buffer */
+		IDataBuffer scaleDataBuffer = scale.get()[0].getDataBuffer();
+
+		if (CPUKernels.getInstance().isEnabled()) {
+
+			CPUKernels.getInstance().lrn (
+				inputDataBuffer, inputStartP,
+				outputDataBuffer, 0,
+				scaleDataBuffer,
+				examples, channels, spatial,
+				conf.getSize(), conf.getAlpha(), conf.getBeta(), conf.getKappa());
+		}
+		else {
+
+			int pre  = (conf.getSize() - 1) / 2;
+			int post = conf.getSize() - pre - 1;
+
+			float factor = conf.getAlpha() / conf.getSize();
+
+			int offset, position;
+			float sum, value;
+
+			for (int n = 0; n < examples; ++n) {
+				for (int c = 0; c < channels; ++c) {
+					for (int s = 0; s < spatial; ++s) {
+
+						sum = 0;
+						for (int k = Math.max (c - pre, 0); k <= Math.min (c + post, channels - 1); ++k) {
+							value = inputDataBuffer.getFloat(inputStartP + (((n * channels + k) * spatial + s) << 2));
+							sum += value * value;
+						}
+
+						offset = ((n * channels + c) * spatial + s) << 2;
+						position = inputStartP + offset;
+
+						value = conf.getKappa() + factor * sum;
+						scaleDataBuffer.putFloat(offset, value);
+
+						outputDataBuffer.putFloat(offset, inputDataBuffer.getFloat(position) * (float) Math.pow(value, -conf.getBeta()));
+					}
+				}
+			}
+		}
+
+		/* Store output in batch for downstream operators */
+		batch.setOutput(operator.getId(), outputDataBuffer);
+	}
+
+	public LocalVariable getScale () {
+		return scale;
 	}
 
 	public ModelAccess getModelAccessType () {
 		return ModelAccess.NA;
 	}
-	
+
 	public boolean isLossKernel () {
 		return false;
 	}
@@ -50,11 +230,11 @@ public class LRN extends Kernel {
 	public boolean isDataTransformationKernel () {
 		return false;
 	}
-	
+
 	public boolean allowsOutputOverwrite () {
 		return false;
 	}
-	
+
 	public boolean allowsInputOverwrite () {
 		return false;
 	}
@@ -1,41 +1,203 @@
 package uk.ac.imperial.lsds.crossbow.kernel;
 
+import java.nio.BufferOverflowException;
+
 import org.apache.logging.log4j.LogManager;
 import org.apache.logging.log4j.Logger;
 
 import uk.ac.imperial.lsds.crossbow.Batch;
 import uk.ac.imperial.lsds.crossbow.Operator;
+import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
+import uk.ac.imperial.lsds.crossbow.device.TheGPU;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.LRNConf;
+import uk.ac.imperial.lsds.crossbow.model.LocalVariable;
 import uk.ac.imperial.lsds.crossbow.model.Model;
 import uk.ac.imperial.lsds.crossbow.model.Shape;
+import uk.ac.imperial.lsds.crossbow.model.Variable;
 import uk.ac.imperial.lsds.crossbow.task.ITask;
 import uk.ac.imperial.lsds.crossbow.types.ModelAccess;
 
+/*
+ * For input dE/dY, and peer input X, LRNGradient computes:
+ *
+ * dE/dX[n,c] = dE/dY[n,c] * scale[n,c]^(-beta) -
+ *     (2 * alpha * beta / size) * X[n,c] * sum (dE/dY[n,c'] * Y[n,c'] / scale[n,c'])
+ *
+ * over the same window of channels c' as the forward pass. The scale
+ * is read from the peer operator; Y is recomputed from X and the scale.
+ */
 public class LRNGradient extends Kernel {
 
-	@SuppressWarnings("unused")
 	private final static Logger log = LogManager.getLogger (LRNGradient.class);
 
 	LRNConf conf;
 
+	int examples, channels, spatial;
+
 	public LRNGradient (LRNConf conf) {
 		this.conf = conf;
 	}
 
 	public LRNGradient setup (Shape [] inputShape, Model model) {
+
+		log.debug(String.format("Setup kernel for operator %s", operator.getName()));
+
+		if (inputShape.length > 1)
+			throw new IllegalArgumentException (String.format("error: invalid number of inputs for operator %s", operator.getName()));
+
+		Variable input = new Variable ("input", inputShape[0], true);
+		theInput = new LocalVariable (input);
+
+		log.debug(String.format("Input variable %s", input.getName()));
+
+		/* The output of this operator has the same shape as the input of its forward peer */
+		Operator peer = operator.getPeer();
+		Shape [] p = peer.getInputShape();
+		if (p.length > 1)
+			throw new IllegalStateException(String.format("error: peer operator %s has more than one inputs", peer.getName()));
+
+		outputShape = p[0].copy();
+
+		Variable output = new Variable ("output", outputShape, true);
+		theOutput = new LocalVariable (output);
+
+		log.debug(String.format("Output variable %s", output.getName()));
+
+		examples = outputShape.numberOfExamples();
+		channels = outputShape.numberOfChannels();
+		spatial  = outputShape.countElements(2);
+
+		/*
+		 * Set memory requirements
+		 */
+
+		/* Set output, by default */
+		memoryRequirements.setOutputMemoryRequirements(output.capacity());
+
+		/* Are there any model variables? No */
+		memoryRequirements.setModelMemoryRequirements (0);
+
+		/* Are there any CPU-specific local variables? No (`scale` belongs to the peer) */
+		memoryRequirements.setLocalCPUMemoryRequirements (0);
+
+		/* Are there any GPU-specific local variables? No */
+		memoryRequirements.setLocalGPUMemoryRequirements (0);
+
 		return this;
 	}
 
 	public void GPURegister () {
+
+		log.debug(String.format("Register kernel with GPU for operator %s", operator.getName()));
+
+		int id = operator.getId();
+		String name = this.getClass().getSimpleName();
+
+		/* 1 input, 0 local variables, 1 output */
+		TheGPU.getInstance().setKernel (id, name, 1, 0, 1, (isLossKernel() || isAccuracyKernel()));
+
+		Variable []  input =  theInput.getInitialValue();
+		Variable [] output = theOutput.getInitialValue();
+
+		/* Set input */
+		TheGPU.getInstance().setKernelInput  (id, 0,  input[0].getShape().array(),  input[0].capacity());
+
+		/* Set output */
+		TheGPU.getInstance().setKernelOutput (id,    output[0].getShape().array(), output[0].capacity());
+
+		/* Set kernel configuration parameters */
+		TheGPU.getInstance().setKernelConfigurationParameters (id, 4);
+
+		TheGPU.getInstance().setKernelConfigurationParameterAsInt   (id, 0, "size",  conf.getSize());
+		TheGPU.getInstance().setKernelConfigurationParameterAsFloat (id, 1, "alpha", conf.getAlpha());
+		TheGPU.getInstance().setKernelConfigurationParameterAsFloat (id, 2, "beta",  conf.getBeta());
+		TheGPU.getInstance().setKernelConfigurationParameterAsFloat (id, 3, "kappa", conf.getKappa());
 	}
 
 	public void compute (Operator [] previous, Batch batch, Model model, ITask api) {
+
+		log.debug(String.format("Compute kernel for operator %s", operator.getName()));
+
+		if (previous != null && previous.length > 1)
+			throw new IllegalArgumentException (String.format("error: invalid number of inputs for operator %s", operator.getName()));
+
+		/* Get thread-local variables */
+		Variable []  input =  theInput.get();
+		Variable [] output = theOutput.get();
+
+		/* Get input buffer */
+		IDataBuffer inputDataBuffer = getCurrentInput (batch, api);
+		int inputStartP = getStartPointer ();
+		int inputEndP = getEndPointer ();
+
+		if ((inputStartP + input[0].capacity()) > inputEndP)
+			throw new BufferOverflowException();
+
+		/* Get an output buffer */
+		IDataBuffer outputDataBuffer = getCurrentOutput (batch, api);
+		output[0].wrap(outputDataBuffer);
+
+		/* Get peer input */
+		IDataBuffer peerInputDataBuffer = getPeerInput (batch, api);
+		int peerInputStartP = getStartPointer ();
+
+		/* Get `scale` variable from the peer */
+		IDataBuffer scaleDataBuffer = ((LRN) operator.getPeer().getKernel()).getScale().get()[0].getDataBuffer();
+
+		if (CPUKernels.getInstance().isEnabled()) {
+
+			CPUKernels.getInstance().lrnGradient (
+				inputDataBuffer, inputStartP,
+				peerInputDataBuffer, peerInputStartP,
+				scaleDataBuffer,
+				outputDataBuffer, 0,
+				examples, channels, spatial,
+				conf.getSize(), conf.getAlpha(), conf.getBeta(), conf.getKappa());
+		}
+		else {
+
+			int pre  = (conf.getSize() - 1) / 2;
+			int post = conf.getSize() - pre - 1;
+
+			float coefficient = 2F * conf.getAlpha() * conf.getBeta() / conf.getSize();
+
+			int offset, index;
+			float sum, s, x;
+
+			for (int n = 0; n < examples; ++n) {
+				for (int c = 0; c < channels; ++c) {
+					for (int j = 0; j < spatial; ++j) {
+
+						/* sum (dE/dY * Y / scale) = sum (dE/dY * X * scale^(-beta - 1)) */
+						sum = 0;
+						for (int k = Math.max (c - post, 0); k <= Math.min (c + pre, channels - 1); ++k) {
+							index = ((n * channels + k) * spatial + j) << 2;
+							s = scaleDataBuffer.getFloat(index);
+							sum += inputDataBuffer.getFloat(inputStartP + index) *
+									peerInputDataBuffer.getFloat(peerInputStartP + index) * (float) Math.pow(s, -conf.getBeta() - 1F);
+						}
+
+						offset = ((n * channels + c) * spatial + j) << 2;
+
+						s = scaleDataBuffer.getFloat(offset);
+						x = peerInputDataBuffer.getFloat(peerInputStartP + offset);
+
+						outputDataBuffer.putFloat(offset,
+								inputDataBuffer.getFloat(inputStartP + offset) * (float) Math.pow(s, -conf.getBeta()) - coefficient * x * sum);
+					}
+				}
+			}
+		}
+
+		/* Store output in batch for downstream operators */
+		batch.setOutput(operator.getId(), outputDataBuffer);
 	}
 
 	public ModelAccess getModelAccessType () {
 		return ModelAccess.NA;
 	}
-	
+
 	public boolean isLossKernel () {
 		return false;
 	}
@@ -47,11 +209,11 @@ public class LRNGradient extends Kernel {
 	public boolean isDataTransformationKernel () {
 		return false;
 	}
-	
+
 	public boolean allowsOutputOverwrite () {
 		return false;
 	}
-	
+
 	public boolean allowsInputOverwrite () {
 		return false;
 	}
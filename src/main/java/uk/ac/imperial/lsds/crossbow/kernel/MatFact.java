@@ -7,6 +7,7 @@ import uk.ac.imperial.lsds.crossbow.Batch;
 import uk.ac.imperial.lsds.crossbow.Operator;
 import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.MatFactConf;
 import uk.ac.imperial.lsds.crossbow.model.*;
 import uk.ac.imperial.lsds.crossbow.task.ITask;
@@ -19,9 +20,15 @@ public class MatFact extends Kernel {
 	private MatFactConf conf;
 
 	private LocalVariable theLabels;
+	
+	/* Striped row locks for sparse updates in Java (the native kernel has its own) */
+	private static final int STRIPES = 1024;
+	
+	private Object [] userLocks, itemLocks;
 
 	public MatFact (MatFactConf conf) {
 		this.conf = conf;
+		userLocks = itemLocks = null;
 	}
 
 	public IKernel setup (Shape [] inputShape, Model model) {
@@ -51,7 +58,10 @@ public class MatFact extends Kernel {
 		
 		log.debug(String.format("Output variable %s", output.getName()));
 
-		/* Register model variables */
+		/*
+		 * Register model variables. A batch touches only a few of their rows,
+		 * so their gradients are row-sparse.
+		 */
 		
 		int numberOfLatentVariables = conf.numberOfLatentVariables ();
 		int numberOfUsers = conf.numberOfRows ();
@@ -59,10 +69,12 @@ public class MatFact extends Kernel {
 		
 		Variable users = new Variable ("user", new Shape (new int [] { numberOfUsers, numberOfLatentVariables } ), false);
 		users.initialise (conf.getModelVariableInitialiser().setValue(1f));
+		users.setSparseGradient (true);
 		model.register (operator.getId(), users);
 		
 		Variable items = new Variable ("item", new Shape (new int [] { numberOfItems, numberOfLatentVariables } ), false);
 		items.initialise (conf.getModelVariableInitialiser().setValue(1f));
+		items.setSparseGradient (true);
 		model.register (operator.getId(), items);
 		
 		/* Set memory requirements */
@@ -73,6 +85,15 @@ public class MatFact extends Kernel {
 		memoryRequirements.incModelMemoryRequirements(items.capacity());
 		
 		memoryRequirements.setLocalGPUMemoryRequirements(labels.capacity());
+		
+		if (conf.useSparseUpdates() && conf.useStripedLocks()) {
+			userLocks = new Object [STRIPES];
+			itemLocks = new Object [STRIPES];
+			for (int i = 0; i < STRIPES; ++i) {
+				userLocks[i] = new Object ();
+				itemLocks[i] = new Object ();
+			}
+		}
 
 		return this;
 	}
@@ -118,6 +139,11 @@ public class MatFact extends Kernel {
 		if (previous != null && previous.length > 1)
 			throw new IllegalArgumentException (String.format("error: invalid number of inputs for operator %s", operator.getName()));
 		
+		if (conf.useSparseUpdates()) {
+			computeSparse (batch, model, api);
+			return;
+		}
+		
 		/* Get two variables from model and their gradients */
 
 		Variable users = model.getVariable(operator.getId(), 1);
@@ -134,9 +160,9 @@ public class MatFact extends Kernel {
 		IDataBuffer usersGradientDataBuffer = usersGradient.getDataBuffer();
 		IDataBuffer itemsGradientDataBuffer = itemsGradient.getDataBuffer();
 		
-		/* Reset gradients */
-		usersGradientDataBuffer.bzero();
-		itemsGradientDataBuffer.bzero();
+		/* Reset gradients (only the rows touched below are zeroed) */
+		usersGradient.reset();
+		itemsGradient.reset();
 		
 		/* Configure inputs (examples and labels) */
 		Variable [] input = theInput.get();
@@ -184,6 +210,10 @@ public class MatFact extends Kernel {
 			int rowOffset = userId * usersRowSize;
 			int colOffset = itemId * itemsRowSize;
 			
+			/* Zero the gradient rows the first time they are touched (model and gradient rows are at the same offsets) */
+			usersGradient.touch (userId);
+			itemsGradient.touch (itemId);
+			
 			/* Compute dot product */
 			float product = 0;
 			for (int k = 0; k < K; ++k) {
@@ -227,6 +257,102 @@ public class MatFact extends Kernel {
 		log.debug(String.format("Batch %d loss %.5f", batch.getId(), batchLoss));
 	}
 
+	/*
+	 * Hogwild-style training: every example updates the user and item rows
+	 * that it touches directly in the (shared) model replica. There is no
+	 * model gradient, so neither a dense buffer to reset nor a write lock
+	 * to hold for the entire batch.
+	 */
+	private void computeSparse (Batch batch, Model model, ITask api) {
+		
+		Variable users = model.getVariable(operator.getId(), 1);
+		Variable items = model.getVariable(operator.getId(), 2);
+		
+		IDataBuffer usersDataBuffer = users.getDataBuffer();
+		IDataBuffer itemsDataBuffer = items.getDataBuffer();
+		
+		Variable [] input = theInput.get();
+
+		IDataBuffer inputDataBuffer = getCurrentInput (batch, api);
+		int inputStartP = getStartPointer ();
+		
+		IDataBuffer labelsDataBuffer = batch.getInputBuffer (1);
+		int labelsStartP = batch.getBufferStartPointer (1);
+		
+		int examples = input[0].getShape().numberOfExamples ();
+		
+		int K = conf.numberOfLatentVariables ();
+		
+		float rate = conf.getLearningRateEta0 ();
+		float lambda = conf.getLambda ();
+		
+		float batchLoss = 0;
+		
+		if (CPUKernels.getInstance().isEnabled()) {
+			
+			batchLoss = CPUKernels.getInstance().matFact (
+				inputDataBuffer, inputStartP,
+				labelsDataBuffer, labelsStartP,
+				usersDataBuffer, itemsDataBuffer,
+				examples, K,
+				lambda, rate,
+				conf.useStripedLocks());
+		}
+		else {
+			
+			int usersRowSize = users.getShape().get(1) * users.getType().sizeOf();
+			int itemsRowSize = items.getShape().get(1) * items.getType().sizeOf();
+			
+			for (int idx = 0; idx < examples; ++idx) {
+				
+				int offset = inputStartP + (idx * 8);
+				
+				int userId = inputDataBuffer.getInt (offset);
+				int itemId = inputDataBuffer.getInt (offset + 4);
+				
+				float rating = labelsDataBuffer.getFloat(labelsStartP + (idx * 4));
+				
+				int rowOffset = userId * usersRowSize;
+				int colOffset = itemId * itemsRowSize;
+				
+				if (conf.useStripedLocks()) {
+					synchronized (userLocks[userId & (STRIPES - 1)]) {
+						synchronized (itemLocks[itemId & (STRIPES - 1)]) {
+							batchLoss += update (usersDataBuffer, rowOffset, itemsDataBuffer, colOffset, K, rating, rate, lambda);
+						}
+					}
+				} else {
+					batchLoss += update (usersDataBuffer, rowOffset, itemsDataBuffer, colOffset, K, rating, rate, lambda);
+				}
+			}
+		}
+		
+		batch.setLoss(batchLoss);
+		log.debug(String.format("Batch %d loss %.5f", batch.getId(), batchLoss));
+	}
+	
+	/* Updates a user and an item row in place; returns the squared error */
+	private static float update (IDataBuffer users, int rowOffset, IDataBuffer items, int colOffset, int K, float rating, float rate, float lambda) {
+		
+		float product = 0;
+		for (int k = 0; k < K; ++k) {
+			product += (users.getFloat(rowOffset + k * 4) * items.getFloat(colOffset + k * 4));
+		}
+		
+		float error = rating - product;
+		
+		for (int k = 0; k < K; k++) {
+			
+			float userModelValue = users.getFloat (rowOffset + k * 4);
+			float itemModelValue = items.getFloat (colOffset + k * 4);
+			
+			users.putFloat (rowOffset + k * 4, userModelValue + rate * (2 * error * itemModelValue - 2 * lambda * userModelValue));
+			items.putFloat (colOffset + k * 4, itemModelValue + rate * (2 * error * userModelValue - 2 * lambda * itemModelValue));
+		}
+		
+		return (error * error);
+	}
+
 	public ModelAccess getModelAccessType() {
 		return ModelAccess.RW;
 	}
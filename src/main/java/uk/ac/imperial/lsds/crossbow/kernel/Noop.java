@@ -139,7 +139,7 @@ public class Noop extends Kernel {
 		float beta = 0F;
 		int ldc = N;
 		
-		BLAS.getInstance().sgemm("N", "N", 
+		BLAS.getInstance().sgemm(BLAS.NO_TRANS, BLAS.NO_TRANS, 
 				M, N, K, 
 				alpha, 
 				inputDataBuffer, inputStartP, inputEndP, lda, 
@@ -10,12 +10,14 @@ import uk.ac.imperial.lsds.crossbow.Operator;
 import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
 import uk.ac.imperial.lsds.crossbow.data.IDataBufferIterator;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.PoolConf;
 import uk.ac.imperial.lsds.crossbow.model.InitialiserConf;
 import uk.ac.imperial.lsds.crossbow.model.LocalVariable;
 import uk.ac.imperial.lsds.crossbow.model.Model;
 import uk.ac.imperial.lsds.crossbow.model.Shape;
 import uk.ac.imperial.lsds.crossbow.model.Variable;
+import uk.ac.imperial.lsds.crossbow.processor.IdleWorkerQueue;
 import uk.ac.imperial.lsds.crossbow.task.ITask;
 import uk.ac.imperial.lsds.crossbow.types.CudnnKernelType;
 import uk.ac.imperial.lsds.crossbow.types.DataType;
@@ -26,6 +28,9 @@ public class Pool extends Kernel {
 	
 	private final static Logger log = LogManager.getLogger (Pool.class);
 	
+	/* Planes are pooled in parallel in ranges of at least that many planes */
+	private final static int MIN_PLANES_PER_PART = 32;
+	
 	PoolConf conf;
 	
 	LocalVariable _local;
@@ -304,6 +309,13 @@ public class Pool extends Kernel {
 		outputDataBuffer = getCurrentOutput (batch, api);
 		output[0].wrap(outputDataBuffer);
 		
+		if (CPUKernels.getInstance().isEnabled()) {
+			
+			computeNative (inputDataBuffer, inputStartP, inputEndP, outputDataBuffer);
+			
+			batch.setOutput(operator.getId(), outputDataBuffer);
+			return;
+		}
 		
 		IDataBufferIterator iterator;
 		int offset;
@@ -488,6 +500,64 @@ public class Pool extends Kernel {
 		batch.setOutput(operator.getId(), outputDataBuffer);
 	}
 
+	private void computeNative (final IDataBuffer inputDataBuffer, final int inputStartP, int inputEndP, final IDataBuffer outputDataBuffer) {
+		
+		if ((inputStartP + theInput.get()[0].capacity()) > inputEndP)
+			throw new BufferOverflowException();
+		
+		int planes = examples * channels;
+		
+		final int  inputPlane = height * width * 4;
+		final int outputPlane = __pooledHeight * __pooledWidth * 4;
+		
+		switch (conf.getMethod()) {
+		
+		case MAX:
+			
+			final IDataBuffer indices = _local.get()[0].getDataBuffer();
+			
+			/* Pool ranges of planes in parallel, if other workers are idle */
+			IdleWorkerQueue.getInstance().parallelFor (planes, MIN_PLANES_PER_PART, new IdleWorkerQueue.Range () {
+				public void run (int from, int to) {
+					CPUKernels.getInstance().maxPool (
+						inputDataBuffer, inputStartP + from * inputPlane,
+						outputDataBuffer, from * outputPlane,
+						indices, from * outputPlane,
+						to - from,
+						height, width,
+						__pooledHeight, __pooledWidth,
+						kernelHeight, kernelWidth,
+						strideHeight, strideWidth,
+						paddingHeight, paddingWidth);
+				}
+			});
+			break;
+		
+		case AVERAGE:
+			
+			IdleWorkerQueue.getInstance().parallelFor (planes, MIN_PLANES_PER_PART, new IdleWorkerQueue.Range () {
+				public void run (int from, int to) {
+					CPUKernels.getInstance().averagePool (
+						inputDataBuffer, inputStartP + from * inputPlane,
+						outputDataBuffer, from * outputPlane,
+						to - from,
+						height, width,
+						__pooledHeight, __pooledWidth,
+						kernelHeight, kernelWidth,
+						strideHeight, strideWidth,
+						paddingHeight, paddingWidth);
+				}
+			});
+			break;
+		
+		case STOCHASTIC:
+			throw new UnsupportedOperationException("error: stochastic pooling method is not yet implemented");
+		
+		default:
+			throw new IllegalArgumentException("error: invalid pooling method");
+		}
+	}
+	
 	public LocalVariable getLocalVariable () {
         return _local;
     }
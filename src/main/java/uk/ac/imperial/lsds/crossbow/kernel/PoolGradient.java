@@ -8,6 +8,7 @@ import uk.ac.imperial.lsds.crossbow.Operator;
 import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
 import uk.ac.imperial.lsds.crossbow.data.IDataBufferIterator;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.PoolConf;
 import uk.ac.imperial.lsds.crossbow.model.LocalVariable;
 import uk.ac.imperial.lsds.crossbow.model.Model;
@@ -267,11 +268,21 @@ public class PoolGradient extends Kernel {
         /* Get output buffer from pool */
 		outputDataBuffer = getCurrentOutput (batch, api);
 		output[0].wrap(outputDataBuffer);
-        outputDataBuffer.bzero();
 
         /* Get the start of the input of pooling operator i.e. bottom */
         peerInputBuffer = getPeerInput (batch, api);
 		peerInputStartP = getStartPointer ();
+		
+		if (CPUKernels.getInstance().isEnabled()) {
+			
+			/* Native kernels clear the output buffer themselves */
+			computeNative (inputDataBuffer, inputStartP, peerInputStartP, outputDataBuffer);
+			
+			batch.setOutput(operator.getId(), outputDataBuffer);
+			return;
+		}
+		
+        outputDataBuffer.bzero();
 
         /*
          * TODO
@@ -386,6 +397,45 @@ public class PoolGradient extends Kernel {
 
 	}
 
+	private void computeNative (IDataBuffer inputDataBuffer, int inputStartP, int peerInputStartP, IDataBuffer outputDataBuffer) {
+		
+		Variable [] input  =  theInput.get();
+		Variable [] output = theOutput.get();
+		
+		switch (conf.getMethod()) {
+		
+		case MAX:
+			
+			/* Indices are stored by the peer Pool operator */
+			IDataBuffer poolIndexBuffer = ((Pool) operator.getPeer().getKernel()).getLocalVariable().get()[0].getDataBuffer();
+			
+			CPUKernels.getInstance().maxPoolGradient (
+				inputDataBuffer, inputStartP,
+				poolIndexBuffer, input[0].getShape().countAllElements(), peerInputStartP,
+				outputDataBuffer, 0, output[0].getShape().countAllElements());
+			break;
+		
+		case AVERAGE:
+			
+			CPUKernels.getInstance().averagePoolGradient (
+				inputDataBuffer, inputStartP,
+				outputDataBuffer, 0,
+				examples * channels,
+				height, width,
+				__pooledHeight, __pooledWidth,
+				kernelHeight, kernelWidth,
+				strideHeight, strideWidth,
+				paddingHeight, paddingWidth);
+			break;
+		
+		case STOCHASTIC:
+			throw new UnsupportedOperationException("error: stochastic pooling method is not yet implemented");
+		
+		default:
+			throw new IllegalArgumentException("error: invalid pooling method");
+		}
+	}
+	
 	public ModelAccess getModelAccessType () {
 		return ModelAccess.NA;
 	}
@@ -9,6 +9,7 @@ import uk.ac.imperial.lsds.crossbow.Batch;
 import uk.ac.imperial.lsds.crossbow.Operator;
 import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.ReLUConf;
 import uk.ac.imperial.lsds.crossbow.model.LocalVariable;
 import uk.ac.imperial.lsds.crossbow.model.Model;
@@ -141,21 +142,32 @@ public class ReLU extends Kernel {
 		float slope = conf.getNegativeSlope();
 		
 		int elements = input[0].getShape().countAllElements();
-		int offset, inputOffset, outputOffset;
-		float value;
 		
-		for (int ndx = 0; ndx < elements; ++ndx) {
+		if (CPUKernels.getInstance().isEnabled()) {
 			
-			offset = ndx * input[0].getType().sizeOf();
+			if ((inputStartP + elements * input[0].getType().sizeOf()) > inputEndP)
+				throw new BufferOverflowException();
 			
-			 inputOffset = offset + inputStartP;
-			outputOffset = offset;
+			CPUKernels.getInstance().relu(inputDataBuffer, inputStartP, outputDataBuffer, 0, elements, slope);
+		}
+		else {
 			
-			if (inputOffset >= inputEndP)
-				throw new BufferOverflowException();
+			int offset, inputOffset, outputOffset;
+			float value;
 			
-			value = inputDataBuffer.getFloat(inputOffset);
-			outputDataBuffer.putFloat(outputOffset, Math.max(value, 0) + slope * Math.min(value, 0));
+			for (int ndx = 0; ndx < elements; ++ndx) {
+				
+				offset = ndx * input[0].getType().sizeOf();
+				
+				 inputOffset = offset + inputStartP;
+				outputOffset = offset;
+				
+				if (inputOffset >= inputEndP)
+					throw new BufferOverflowException();
+				
+				value = inputDataBuffer.getFloat(inputOffset);
+				outputDataBuffer.putFloat(outputOffset, Math.max(value, 0) + slope * Math.min(value, 0));
+			}
 		}
 		
 		/* Store output in batch for downstream operators */
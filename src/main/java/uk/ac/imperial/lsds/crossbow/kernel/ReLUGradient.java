@@ -9,6 +9,7 @@ import uk.ac.imperial.lsds.crossbow.Batch;
 import uk.ac.imperial.lsds.crossbow.Operator;
 import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.ReLUConf;
 import uk.ac.imperial.lsds.crossbow.model.LocalVariable;
 import uk.ac.imperial.lsds.crossbow.model.Model;
@@ -129,6 +130,18 @@ public class ReLUGradient extends Kernel {
 		
 		int elements = input[0].getShape().countAllElements();
 		
+		if (CPUKernels.getInstance().isEnabled()) {
+			
+			if ((inputStartP + elements * input[0].getType().sizeOf()) > inputEndP)
+				throw new BufferOverflowException();
+			
+			/* As below, the peer input is assumed to start at offset 0 */
+			CPUKernels.getInstance().reluGradient(inputDataBuffer, inputStartP, peerInputDataBuffer, 0, outputDataBuffer, 0, elements, slope);
+			
+			batch.setOutput(operator.getId(), outputDataBuffer);
+			return;
+		}
+		
 		int offset, outputOffset, inputOffset;
 		float inputValue, peerInputValue;
 		
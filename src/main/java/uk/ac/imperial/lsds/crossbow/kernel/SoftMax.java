@@ -8,6 +8,7 @@ import uk.ac.imperial.lsds.crossbow.Operator;
 import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
 import uk.ac.imperial.lsds.crossbow.data.IDataBufferIterator;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.SoftMaxConf;
 import uk.ac.imperial.lsds.crossbow.model.LocalVariable;
 import uk.ac.imperial.lsds.crossbow.model.Model;
@@ -155,6 +156,14 @@ public class SoftMax extends Kernel {
 		
 		log.debug(String.format("Output data buffer length is %d", outputDataBuffer.limit()));
 		
+		if (CPUKernels.getInstance().isEnabled()) {
+			
+			CPUKernels.getInstance().softmax(inputDataBuffer, inputStartP, outputDataBuffer, 0, examples, classes);
+			
+			batch.setOutput(operator.getId(), outputDataBuffer);
+			return;
+		}
+		
 		/* Get local variable buffer */
 		IDataBuffer exampleDataBuffer = local[0].getDataBuffer();
 
@@ -7,6 +7,7 @@ import uk.ac.imperial.lsds.crossbow.Batch;
 import uk.ac.imperial.lsds.crossbow.Operator;
 import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
 import uk.ac.imperial.lsds.crossbow.kernel.conf.SoftMaxConf;
 import uk.ac.imperial.lsds.crossbow.model.LocalVariable;
 import uk.ac.imperial.lsds.crossbow.model.Model;
@@ -125,7 +126,10 @@ public class SoftMaxGradient extends Kernel {
 		output[0].wrap(outputDataBuffer);
 		
 		/* Copy input to output */
-		outputDataBuffer.put(inputDataBuffer, inputStartP, inputEndP - inputStartP, true);
+		if (CPUKernels.getInstance().isEnabled())
+			CPUKernels.getInstance().copy(inputDataBuffer, inputStartP, outputDataBuffer, 0, inputEndP - inputStartP);
+		else
+			outputDataBuffer.put(inputDataBuffer, inputStartP, inputEndP - inputStartP, true);
 		
 		batch.setOutput(operator.getId(), outputDataBuffer);
 	}
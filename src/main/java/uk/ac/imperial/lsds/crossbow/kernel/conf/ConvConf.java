@@ -25,6 +25,14 @@ public class ConvConf implements IConf {
 	
 	private int groups;
 	
+	/* 
+	 * Number of examples lowered into a single column matrix on the CPU. 
+	 * 
+	 * The default value (1) lowers one example at a time; 0 lowers the 
+	 * entire batch.
+	 */
+	private int columnBatchSize;
+	
 	private float weightsLearningRateMultiplier, biasLearningRateMultiplier;
 	
 	public ConvConf () {
@@ -49,6 +57,8 @@ public class ConvConf implements IConf {
 		
 		groups = 1;
 		
+		columnBatchSize = 1;
+		
 		weightsLearningRateMultiplier = biasLearningRateMultiplier = 1;
 	}
 	
@@ -220,6 +230,17 @@ public class ConvConf implements IConf {
 		return groups;
 	}
 	
+	public ConvConf setColumnBatchSize (int columnBatchSize) {
+		if (columnBatchSize < 0)
+			throw new IllegalArgumentException ("error: column batch size must be non-negative");
+		this.columnBatchSize = columnBatchSize;
+		return this;
+	}
+	
+	public int getColumnBatchSize () {
+		return columnBatchSize;
+	}
+	
 	public ConvConf setWeightsLearningRateMultiplier (float weightsLearningRateMultiplier) {
 		this.weightsLearningRateMultiplier = weightsLearningRateMultiplier;
 		return this;
@@ -14,6 +14,10 @@ public class MatFactConf implements IConf {
 
     private float learningRateEta0;
 
+    private boolean sparse;
+
+    private boolean stripedLocks;
+
     private InitialiserConf modelVariableInitialiserConf;
 
     public MatFactConf () {
@@ -27,6 +31,9 @@ public class MatFactConf implements IConf {
 
         lambda = 0.1f;
         learningRateEta0 = 0.001f;
+
+        sparse = false;
+        stripedLocks = false;
     }
 
     public InitialiserConf getModelVariableInitialiser () {
@@ -80,4 +87,27 @@ public class MatFactConf implements IConf {
         this.learningRateEta0 = learningRateEta0;
         return this;
     }
+
+    /*
+     * In sparse mode, each example updates its user and item rows in place,
+     * without a dense model gradient and without write-locking the model.
+     */
+    public boolean useSparseUpdates () {
+        return sparse;
+    }
+
+    public MatFactConf setSparseUpdates (boolean sparse) {
+        this.sparse = sparse;
+        return this;
+    }
+
+    /* Sparse updates are lock-free (Hogwild), unless striped row locks are used */
+    public boolean useStripedLocks () {
+        return stripedLocks;
+    }
+
+    public MatFactConf setStripedLocks (boolean stripedLocks) {
+        this.stripedLocks = stripedLocks;
+        return this;
+    }
 }
@@ -248,17 +248,16 @@ public class Model implements Iterable <Variable> {
 		ModelIterator<Variable>         m =     this.iterator();
 		ModelIterator<VariableGradient> g = gradient.iterator();
 		
-		IDataBuffer X, Y;
-		int count;
+		IDataBuffer Y;
+		VariableGradient X;
 		
 		while (m.hasNext() && g.hasNext()) {
 			
 			Y = m.next().getDataBuffer();
-			X = g.next().getDataBuffer();
-			
-			count = Y.limit() / Y.getType().sizeOf();
+			X = g.next();
 			
-			BLAS.getInstance().saxpby(count, -1, X, 0, X.limit(), /* incX */ 1, 1F, Y, /* incY */ 1);
+			/* Sparse gradients only update the rows they touch */
+			X.axpy(-1F, Y);
 		}
 		
 		incUpdates();
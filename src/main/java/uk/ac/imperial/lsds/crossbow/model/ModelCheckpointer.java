@@ -0,0 +1,394 @@
+package uk.ac.imperial.lsds.crossbow.model;
+
+import java.io.BufferedOutputStream;
+import java.io.DataOutputStream;
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.RandomAccessFile;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.file.Files;
+import java.nio.file.StandardCopyOption;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.TimeUnit;
+
+import org.apache.logging.log4j.LogManager;
+import org.apache.logging.log4j.Logger;
+
+import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
+import uk.ac.imperial.lsds.crossbow.types.DataType;
+
+/*
+ * Checkpoints the CPU base model in the background.
+ *
+ * A checkpoint copies every model variable into a snapshot (which takes as
+ * long as a memory copy of the model) and then writes the snapshot to disk
+ * on a separate thread, so that no model lock is held during I/O. There are
+ * two snapshots: the one being written, and the previous one. If the latter
+ * is still being written when the next checkpoint is due, that checkpoint
+ * is skipped.
+ *
+ * Checkpoint files (`model-<clock>.ckpt`) have the following format:
+ *
+ * int magic, version, clock, base clock (or -1), number of variables
+ *
+ * and, for each variable:
+ *
+ * int type, bytes, float checksum (as in `Variable.computeChecksum`),
+ * int number of blocks (or -1), [int block index, block]*
+ *
+ * A full checkpoint stores every variable as a single block (-1). Otherwise,
+ * it stores only the `BLOCK_SIZE`-byte blocks that changed since the base
+ * checkpoint (the previous one), on which it depends. Every n-th checkpoint
+ * is full (see `SystemConf.getFullCheckpointInterval`).
+ *
+ * Checkpoints are numbered from `first` onwards (i.e., file `model-<first +
+ * clock>.ckpt`), so that a restored run does not overwrite the checkpoints it
+ * was restored from. Once a full checkpoint has been written, all earlier
+ * checkpoints in the directory are superseded and deleted.
+ */
+public class ModelCheckpointer {
+
+	private final static Logger log = LogManager.getLogger (ModelCheckpointer.class);
+
+	private static final int MAGIC = 0x43424B50; /* "CBKP" */
+	private static final int VERSION = 1;
+
+	private static final int BLOCK_SIZE = 4096;
+
+	private static final String PREFIX = "model-";
+	private static final String SUFFIX = ".ckpt";
+
+	private Model theModel;
+
+	private File directory;
+
+	private int fullCheckpointInterval;
+
+	/* Number of the checkpoint at clock 0 */
+	private int first;
+
+	/* Per variable: the snapshot to write next, and the last one written */
+	private byte [][] current, previous;
+
+	private int previousClock;
+
+	private int checkpoints;
+
+	private ExecutorService writer;
+	private Future<?> pending;
+
+	public ModelCheckpointer (Model theModel, String directory, int fullCheckpointInterval, int first) {
+
+		this.theModel = theModel;
+		this.directory = new File (directory);
+		this.fullCheckpointInterval = Math.max(1, fullCheckpointInterval);
+		this.first = first;
+
+		if (! this.directory.isDirectory() && ! this.directory.mkdirs())
+			throw new IllegalArgumentException (String.format("error: invalid checkpoint directory: %s", directory));
+
+		int n = theModel.getVariables().length;
+		current  = new byte [n][];
+		previous = new byte [n][];
+
+		ModelIterator<Variable> m = theModel.iterator();
+		for (int i = 0; m.hasNext(); ++i) {
+			int bytes = m.next().getDataBuffer().limit();
+			current  [i] = new byte [bytes];
+			previous [i] = new byte [bytes];
+		}
+
+		previousClock = -1;
+		checkpoints = 0;
+
+		writer = Executors.newSingleThreadExecutor(new ThreadFactory () {
+			public Thread newThread (Runnable r) {
+				Thread t = new Thread (r, "ModelCheckpointer");
+				t.setDaemon(true);
+				return t;
+			}
+		});
+		pending = null;
+	}
+
+	/*
+	 * Snapshots the base model at `clock` and writes it in the background.
+	 *
+	 * Must be called when the base model is not being modified (i.e., by the
+	 * thread that merges model replicas). Returns false if the checkpoint was
+	 * skipped because the previous one is still being written.
+	 */
+	public boolean checkpoint (int step) {
+
+		final int clock = first + step;
+
+		if (pending != null && ! pending.isDone()) {
+			log.warn(String.format("Skip checkpoint at clock %d (previous checkpoint is still being written)", clock));
+			return false;
+		}
+
+		final boolean full = (previousClock < 0) || (checkpoints % fullCheckpointInterval == 0);
+		final int base = previousClock;
+
+		ModelIterator<Variable> m = theModel.iterator();
+		for (int i = 0; m.hasNext(); ++i) {
+			ByteBuffer src = m.next().getDataBuffer().getByteBuffer().duplicate();
+			src.clear();
+			src.get(current [i], 0, current [i].length);
+		}
+
+		pending = writer.submit(new Runnable () {
+			public void run () {
+				try {
+					write (clock, full ? -1 : base);
+				} catch (IOException e) {
+					log.error(String.format("Failed to checkpoint model at clock %d: %s", clock, e.getMessage()));
+					return;
+				}
+				/* The snapshot just written becomes the base of the next checkpoint */
+				byte [][] t = previous;
+				previous = current;
+				current = t;
+				previousClock = clock;
+			}
+		});
+
+		checkpoints ++;
+		return true;
+	}
+
+	/* Waits for the last checkpoint to be written */
+	public void flush () {
+
+		if (pending == null)
+			return;
+		try {
+			pending.get();
+		} catch (Exception e) {
+			log.error("Failed to flush model checkpoint: " + e.getMessage());
+		}
+	}
+
+	/* Waits for the last checkpoint to be written and stops the writer thread */
+	public void close () {
+
+		flush ();
+		writer.shutdown();
+		try {
+			writer.awaitTermination(Long.MAX_VALUE, TimeUnit.NANOSECONDS);
+		} catch (InterruptedException e) {
+			Thread.currentThread().interrupt();
+		}
+	}
+
+	private void write (int clock, int base) throws IOException {
+
+		File file = getFile (directory, clock);
+		File temp = new File (directory, file.getName() + ".tmp");
+
+		DataOutputStream out = new DataOutputStream (new BufferedOutputStream (new FileOutputStream (temp), 1 << 20));
+		try {
+			out.writeInt (MAGIC);
+			out.writeInt (VERSION);
+			out.writeInt (clock);
+			out.writeInt (base);
+			out.writeInt (current.length);
+
+			ModelIterator<Variable> m = theModel.iterator();
+			for (int i = 0; m.hasNext(); ++i) {
+
+				DataType type = m.next().getType();
+				byte [] data = current [i];
+
+				out.writeInt (type.getId());
+				out.writeInt (data.length);
+				out.writeFloat (computeChecksum (data, type));
+
+				if (base < 0) {
+					out.writeInt (-1);
+					out.write (data);
+					continue;
+				}
+
+				byte [] last = previous [i];
+				int blocks = (data.length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+				int changed = 0;
+				for (int b = 0; b < blocks; ++b)
+					if (! equals (data, last, b))
+						changed ++;
+
+				out.writeInt (changed);
+				for (int b = 0; b < blocks; ++b) {
+					if (! equals (data, last, b)) {
+						int offset = b * BLOCK_SIZE;
+						out.writeInt (b);
+						out.write (data, offset, Math.min(BLOCK_SIZE, data.length - offset));
+					}
+				}
+			}
+		} finally {
+			out.close();
+		}
+		Files.move(temp.toPath(), file.toPath(), StandardCopyOption.REPLACE_EXISTING, StandardCopyOption.ATOMIC_MOVE);
+
+		log.info(String.format("Checkpoint model at clock %d to %s (%s)", clock, file, ((base < 0) ? "full" : ("since clock " + base))));
+
+		if (base < 0)
+			prune (clock);
+	}
+
+	/* Deletes all checkpoints before `clock`, a full checkpoint that supersedes them */
+	private void prune (int clock) {
+
+		File [] files = directory.listFiles();
+		if (files == null)
+			return;
+
+		for (File f: files) {
+			int c = getClock (f);
+			if (c < 0 || c >= clock)
+				continue;
+			if (! f.delete())
+				log.warn(String.format("Failed to delete superseded checkpoint %s", f));
+		}
+	}
+
+	private static boolean equals (byte [] x, byte [] y, int block) {
+
+		int offset = block * BLOCK_SIZE;
+		int length = Math.min(BLOCK_SIZE, x.length - offset);
+		return ByteBuffer.wrap(x, offset, length).equals(ByteBuffer.wrap(y, offset, length));
+	}
+
+	/* Same as `DataBuffer.computeChecksum`, over a snapshot */
+	private static float computeChecksum (byte [] data, DataType type) {
+
+		ByteBuffer buffer = ByteBuffer.wrap(data).order(ByteOrder.LITTLE_ENDIAN);
+		float checksum = 0;
+		for (int offset = 0; offset < data.length; offset += type.sizeOf()) {
+			if (type == DataType.FLOAT) checksum += buffer.getFloat(offset);
+			else
+				checksum += (float) (buffer.getInt(offset));
+		}
+		return checksum;
+	}
+
+	private static File getFile (File directory, int clock) {
+
+		return new File (directory, String.format("%s%d%s", PREFIX, clock, SUFFIX));
+	}
+
+	/* Returns the clock of checkpoint `file`, or -1 if it is not a checkpoint */
+	private static int getClock (File file) {
+
+		String name = file.getName();
+		if (! name.startsWith(PREFIX) || ! name.endsWith(SUFFIX))
+			return -1;
+		try {
+			return Integer.parseInt(name.substring(PREFIX.length(), name.length() - SUFFIX.length()));
+		} catch (NumberFormatException e) {
+			return -1;
+		}
+	}
+
+	/* Returns the latest checkpoint in `directory`, or null if there is none */
+	public static File latest (String directory) {
+
+		File [] files = new File (directory).listFiles();
+		if (files == null)
+			return null;
+
+		File latest = null;
+		int max = -1;
+		for (File f: files) {
+			int clock = getClock (f);
+			if (clock > max) {
+				max = clock;
+				latest = f;
+			}
+		}
+		return latest;
+	}
+
+	/*
+	 * Restores `model` from checkpoint `file` (and, if it is incremental, from
+	 * the checkpoints it depends on), reading checkpoints through memory maps.
+	 * Returns the checkpoint's clock.
+	 */
+	public static int restore (Model model, File file) throws IOException {
+
+		RandomAccessFile f = new RandomAccessFile (file, "r");
+		try {
+			FileChannel channel = f.getChannel();
+			MappedByteBuffer buffer = channel.map(FileChannel.MapMode.READ_ONLY, 0, channel.size());
+
+			if (buffer.getInt() != MAGIC)
+				throw new IOException (String.format("error: %s is not a model checkpoint", file));
+
+			int version = buffer.getInt();
+			if (version != VERSION)
+				throw new IOException (String.format("error: unsupported checkpoint version %d in %s", version, file));
+
+			int clock = buffer.getInt();
+			int base  = buffer.getInt();
+			int count = buffer.getInt();
+
+			if (count != model.getVariables().length)
+				throw new IOException (String.format("error: checkpoint %s has %d variables (expected %d)", file, count, model.getVariables().length));
+
+			if (base >= 0)
+				restore (model, getFile (file.getParentFile(), base));
+
+			ModelIterator<Variable> m = model.iterator();
+			while (m.hasNext()) {
+
+				Variable var = m.next();
+				IDataBuffer data = var.getDataBuffer();
+
+				int type = buffer.getInt();
+				int bytes = buffer.getInt();
+				float checksum = buffer.getFloat();
+
+				if (type != var.getType().getId() || bytes != data.limit())
+					throw new IOException (String.format("error: checkpoint %s does not match model variable %s", file, var.getName()));
+
+				ByteBuffer dst = data.getByteBuffer().duplicate();
+				dst.clear();
+
+				int blocks = buffer.getInt();
+				if (blocks < 0) {
+					copy (buffer, dst, 0, bytes);
+				} else {
+					for (int b = 0; b < blocks; ++b) {
+						int offset = buffer.getInt() * BLOCK_SIZE;
+						copy (buffer, dst, offset, Math.min(BLOCK_SIZE, bytes - offset));
+					}
+				}
+
+				if (var.computeChecksum() != checksum)
+					throw new IOException (String.format("error: checksum mismatch for model variable %s in %s", var.getName(), file));
+			}
+			return clock;
+
+		} finally {
+			f.close();
+		}
+	}
+
+	private static void copy (ByteBuffer src, ByteBuffer dst, int offset, int length) {
+
+		ByteBuffer s = src.duplicate();
+		s.limit(s.position() + length);
+		dst.position(offset);
+		dst.put(s);
+		src.position(src.position() + length);
+	}
+}
@@ -1,6 +1,10 @@
 package uk.ac.imperial.lsds.crossbow.model;
 
+import java.io.File;
+import java.io.IOException;
+import java.util.ArrayList;
 import java.util.Arrays;
+import java.util.List;
 import java.util.concurrent.ConcurrentLinkedQueue;
 
 import org.apache.logging.log4j.LogManager;
@@ -10,13 +14,18 @@ import uk.ac.imperial.lsds.crossbow.ModelConf;
 import uk.ac.imperial.lsds.crossbow.PerformanceMonitor;
 import uk.ac.imperial.lsds.crossbow.SystemConf;
 import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
-import uk.ac.imperial.lsds.crossbow.data.IDataBufferIterator;
 import uk.ac.imperial.lsds.crossbow.device.TheGPU;
-import uk.ac.imperial.lsds.crossbow.device.blas.BLAS;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
+import uk.ac.imperial.lsds.crossbow.processor.IdleWorkerQueue;
+import uk.ac.imperial.lsds.crossbow.types.SynchronisationModel;
+import uk.ac.imperial.lsds.crossbow.types.UpdateModel;
 
 public class ModelManager {
 
 	private final static Logger log = LogManager.getLogger (ModelManager.class);
+	
+	/* Number of elements (per variable) merged by a single task */
+	private static final int MERGE_CHUNK_SIZE = 65536;
 
 	private Model [] replicas;
 	
@@ -33,6 +42,12 @@ public class ModelManager {
 	
 	private int checkpointStep;
 	
+	/* Writes CPU base model checkpoints in the background */
+	private ModelCheckpointer checkpointer;
+	
+	/* Clock of the checkpoint the CPU base model was restored from (or -1) */
+	private int restoredClock;
+	
 	private PerformanceMonitor monitor;
 	
 	private boolean autotuning;
@@ -44,6 +59,13 @@ public class ModelManager {
 	public ModelManager (Model theModel) {
 		
 		this.theModel = theModel;
+		
+		restoredClock = -1;
+		
+		/* Restore the CPU base model from the latest checkpoint in the model directory, if any */
+		if (SystemConf.getInstance().getCPU() && SystemConf.getInstance().getModelDirectory() != null)
+			restore (SystemConf.getInstance().getModelDirectory());
+		
 		replicas = new Model [SystemConf.getInstance().numberOfCPUModelReplicas()];
 		
 		for (int i = 0; i < replicas.length; ++i) {
@@ -79,6 +101,13 @@ public class ModelManager {
 		checkpointStep /= ModelConf.getInstance().getWpc();
 		log.info(String.format("Checkpoint model(s) every %d cycles", checkpointStep));
 		
+		checkpointer = null;
+		if (SystemConf.getInstance().getCPU() && checkpointStep > 0) {
+			if (SystemConf.getInstance().getCheckpointDirectory() == null)
+				throw new IllegalStateException ("error: checkpoint directory is not set");
+			checkpointer = new ModelCheckpointer (theModel, SystemConf.getInstance().getCheckpointDirectory(), SystemConf.getInstance().getFullCheckpointInterval(), restoredClock + 1);
+		}
+		
 		monitor = null;
 		
 		if (SystemConf.getInstance().autotuneModels())
@@ -101,29 +130,15 @@ public class ModelManager {
 		
 		log.debug ("Accumulate gradient from batch " + computedGradient.getMicroBatchId());
 		
-		IDataBuffer X, Y;
-		
 		ModelIterator<VariableGradient> g =    computedGradient.iterator();
 		ModelIterator<VariableGradient> m = accumulatedGradient.iterator();
-		int count;
 		
-		float beta;
-		if (clear) {
-			beta = 0F;
-			clear = false;
-		} else {
-			beta = 1F;
-		}
+		boolean reset = clear;
+		clear = false;
 		
-		while (m.hasNext() && g.hasNext()) {
-			
-			Y = m.next().getDataBuffer();
-			X = g.next().getDataBuffer();
-			
-			count = Y.limit() / Y.getType().sizeOf();
-			
-			BLAS.getInstance().saxpby(count, 1, X, 0, X.limit(), /* incX */ 1, beta, Y, /* incY */ 1);
-		}
+		/* The accumulated gradient stays row-sparse as long as all computed gradients are */
+		while (m.hasNext() && g.hasNext())
+			m.next().accumulate(g.next(), reset);
 	}
 	
 	public Integer acquireAccess (int [] clock) {
@@ -195,29 +210,91 @@ public class ModelManager {
 		return true;
 	}
 
-	@SuppressWarnings("unused")
-	private int merge (int clock) {
+	/*
+	 * Lock the CPU model replicas that take part in the next merge:
+	 * 
+	 * BSP: all replicas (waiting for workers to finish their update);
+	 * SSP: all replicas that have fallen more than `slack` clocks behind, and
+	 *      any other replica that is not in use;
+	 * ASP: any replica that is not in use.
+	 */
+	private int lock (int clock) {
 		
+		SynchronisationModel type = SystemConf.getInstance().getSynchronisationModel();
+		int bound = clock - ModelConf.getInstance().getSlack();
+		
+		Arrays.fill(locked, false);
+		count = 0;
 		for (int i = 0; i < replicas.length; ++i) {
 			
+			boolean wait = (type == SynchronisationModel.BSP) || (type == SynchronisationModel.SSP && replicas[i].getModelClock() < bound);
+			
+			if (wait) {
+				replicas[i].writeLock();
+				locked[i] = true;
+			}
+			else if (replicas[i].tryWriteLock()) {
+				locked[i] = true;
+			}
+			if (locked[i])
+				++count;
+		}
+		return count;
+	}
+	
+	/*
+	 * Merges the locked CPU model replicas with the CPU base model.
+	 * 
+	 * With elastic averaging (EAMSGD), each replica moves towards the base model
+	 * by `alpha` times their difference and the base model moves by the sum of
+	 * these differences. Otherwise, the base model becomes the average of the
+	 * replicas, which is then copied back to them.
+	 * 
+	 * Every variable is split into chunks that are merged in parallel, across
+	 * all replicas at once (so that the base model is read and written once).
+	 */
+	private int merge (int clock) {
+		
+		if (count == 0)
+			return 0;
+		
+		UpdateModel type = ModelConf.getInstance().getUpdateModel();
+		boolean elastic = (type == UpdateModel.EAMSGD || type == UpdateModel.SYNCHRONOUSEAMSGD);
+		float alpha = ModelConf.getInstance().getSolverConf().getAlpha();
+		
+		List<ModelIterator<Variable>> r = new ArrayList<ModelIterator<Variable>>(count);
+		for (int i = 0; i < replicas.length; ++i)
+			if (locked[i])
+				r.add(replicas[i].iterator());
+		
+		final List<MergeTask> tasks = new ArrayList<MergeTask>();
+		
+		ModelIterator<Variable> m = theModel.iterator();
+		while (m.hasNext()) {
+			
+			IDataBuffer base = m.next().getDataBuffer();
+			IDataBuffer [] buffers = new IDataBuffer [count];
+			for (int k = 0; k < count; ++k)
+				buffers[k] = r.get(k).next().getDataBuffer();
+			
+			int elements = base.limit() / base.getType().sizeOf();
+			for (int start = 0; start < elements; start += MERGE_CHUNK_SIZE) {
+				int length = Math.min(MERGE_CHUNK_SIZE, elements - start);
+				tasks.add(new MergeTask (base, buffers, start * base.getType().sizeOf(), length, elastic, alpha));
+			}
+		}
+		
+		/* Merge chunks on the intra-op threads and idle workers, rather than on threads of our own */
+		IdleWorkerQueue.getInstance().parallelFor (tasks.size(), 1, new IdleWorkerQueue.Range () {
+			public void run (int from, int to) {
+				for (int i = from; i < to; ++i)
+					tasks.get(i).run();
+			}
+		});
+		
+		theModel.setModelClock (clock);
+		for (int i = 0; i < replicas.length; ++i) {
 			if (locked[i]) {
-				
-				/* Copy CPU base model to model replica */
-				ModelIterator<Variable> m =  theModel.iterator();
-				ModelIterator<Variable> r = replicas[i].iterator();
-				
-				while (m.hasNext() && r.hasNext()) {
-					
-					IDataBuffer Y = m.next().getDataBuffer();
-					IDataBuffer X = r.next().getDataBuffer();
-					
-					IDataBufferIterator b = Y.getIterator();
-					while (b.hasNext()) {
-						int offset = b.next();
-						X.putFloat(offset, Y.getFloat(offset));
-					}
-				}
-				
 				replicas[i].setModelClock (clock);
 				replicas[i].resetUpdates ();
 			}
@@ -225,6 +302,58 @@ public class ModelManager {
 		return 0;
 	}
 	
+	private static class MergeTask implements Runnable {
+		
+		private IDataBuffer base;
+		private IDataBuffer [] replicas;
+		private int offset, count; /* Offset is in bytes */
+		private boolean elastic;
+		private float alpha;
+		
+		public MergeTask (IDataBuffer base, IDataBuffer [] replicas, int offset, int count, boolean elastic, float alpha) {
+			this.base = base;
+			this.replicas = replicas;
+			this.offset = offset;
+			this.count = count;
+			this.elastic = elastic;
+			this.alpha = alpha;
+		}
+		
+		public void run () {
+			
+			if (CPUKernels.getInstance().isEnabled()) {
+				if (elastic)
+					CPUKernels.getInstance().elasticAverage (base, replicas, replicas.length, offset, count, alpha);
+				else
+					CPUKernels.getInstance().modelAverage (base, replicas, replicas.length, offset, count);
+				return;
+			}
+			
+			int end = offset + count * 4;
+			float scale = 1F / replicas.length;
+			for (int k = offset; k < end; k += 4) {
+				float value = base.getFloat(k);
+				float sum = 0F;
+				if (elastic) {
+					for (int i = 0; i < replicas.length; ++i) {
+						float delta = alpha * (replicas[i].getFloat(k) - value);
+						replicas[i].putFloat(k, replicas[i].getFloat(k) - delta);
+						sum += delta;
+					}
+					base.putFloat(k, value + sum);
+				}
+				else {
+					for (int i = 0; i < replicas.length; ++i)
+						sum += replicas[i].getFloat(k);
+					sum *= scale;
+					base.putFloat(k, sum);
+					for (int i = 0; i < replicas.length; ++i)
+						replicas[i].putFloat(k, sum);
+				}
+			}
+		}
+	}
+	
 	/*
 	 * Apply accumulated CPU gradient to GPU model, and vice versa 
 	 * 
@@ -285,28 +414,41 @@ public class ModelManager {
 		}
 	}
 	
+	private void restore (String directory) {
+		File file = ModelCheckpointer.latest (directory);
+		if (file == null)
+			return;
+		try {
+			/*
+			 * Only model variables are restored; training starts again from clock 0,
+			 * but checkpoints are numbered after the restored one (see ModelCheckpointer).
+			 */
+			restoredClock = ModelCheckpointer.restore (theModel, file);
+			log.info(String.format("Restored model from %s (checkpointed at clock %d)", file, restoredClock));
+		} catch (IOException e) {
+			throw new IllegalStateException (String.format("error: failed to restore model from %s", file), e);
+		}
+	}
+	
 	/*
-	 * NOTE to self:
+	 * Synchronise CPU and/or GPU model replicas at the end of a clock.
 	 * 
-	 * Function has been modified for GPU-only execution; model check-pointing is disabled.
+	 * GPU model check-pointing is disabled. The CPU base model is checkpointed
+	 * after the replicas are unlocked, since workers do not modify it.
 	 */
 	public boolean trySynchronise (int clock) {
 		
-		/* Apply accumulated gradient to the CPU base model and synchronise CPU model replicas */
 		/*
+		 * Synchronise CPU model replicas
+		 * 
+		 * Replicas apply their gradients locally, so the accumulated gradient
+		 * is not applied to the CPU base model; the replicas are merged instead.
+		 */
 		if (SystemConf.getInstance().getCPU()) {
 			
-			this.theModel.apply(accumulatedGradient);
-			
-			if (SystemConf.getInstance().getSynchronisationModel() == SynchronisationModel.BSP) {
-				if (! lockAll())
-					throw new IllegalStateException("error: failed to lock all CPU model replicas at synchronisation barrier");
-			} else {
-				lockAny();
-			}
+			lock (clock);
 			merge (clock);
 		}
-		*/
 		
 		/* 
 		 * Synchronise GPU models
@@ -315,19 +457,11 @@ public class ModelManager {
 		 * For example, if the synchronisation model is BSP, the engine will attempt
 		 * to lock all GPU model replicas (otherwise an exception will be thrown).
 		 */
-		
-		/*
-		if (SystemConf.getInstance().getGPU ()) {
+		if (SystemConf.getInstance().getGPU()) {
 			
 			TheGPU.getInstance().lockAny();
-			
-			TheGPU.getInstance().merge (SystemConf.getInstance().isHybrid());
 			TheGPU.getInstance().synchronise(0, clock, autotune(), false);
 		}
-		*/
-		
-		TheGPU.getInstance().lockAny();
-		TheGPU.getInstance().synchronise(0, clock, autotune(), false);
 		
 		/* Synchronise models across CPU and GPU boundary */
 		/* if (SystemConf.getInstance().isHybrid()) mergeAcrossDevices (); */
@@ -339,15 +473,14 @@ public class ModelManager {
 		clear = true;
 		
 		/* Unlock models */
-		/*
 		if (SystemConf.getInstance().getGPU())
 			TheGPU.getInstance().unlockAny();
 		
-		if (SystemConf.getInstance().getCPU()) {
+		if (SystemConf.getInstance().getCPU())
 			unlockAny();
-		}
-		*/
-		TheGPU.getInstance().unlockAny();
+		
+		if (checkpointer != null && (clock % checkpointStep) == 0)
+			checkpointer.checkpoint (clock);
 		
 		return true;
 	}
@@ -371,7 +504,16 @@ public class ModelManager {
 	 * The idea is to synchronise them one last time.
 	 */
 	public void synchroniseAll() {
+		/* Wait for the last CPU model checkpoint to be written */
+		if (checkpointer != null)
+			checkpointer.flush ();
 		return;
 	}
+	
+	public void destroy () {
+		/* Write the pending CPU model checkpoint, if any, before the process exits */
+		if (checkpointer != null)
+			checkpointer.close ();
+	}
 
 }
@@ -39,6 +39,12 @@ public class Variable implements Linked<Variable>{
 	
 	private float multiplier;
 	
+	/*
+	 * If true, gradients of this variable may be row-sparse (a kernel that
+	 * computes them touches only a few rows, as in an embedding table).
+	 */
+	private boolean sparseGradient;
+	
 	/* We connect variables together to create a model list
 	 * per operator. Accessing this list is not thread-safe
 	 */ 
@@ -77,6 +83,8 @@ public class Variable implements Linked<Variable>{
 		
 		multiplier = 1;
 		
+		sparseGradient = false;
+		
 		if (! isPhantom ()) {
 			
 			if (capacity <= 0)
@@ -138,6 +146,7 @@ public class Variable implements Linked<Variable>{
 		v.setOrder(order);
 		
 		v.setLearningRateMultiplier (multiplier);
+		v.setSparseGradient (sparseGradient);
 		
 		if (! isPhantom()) {
 			
@@ -202,6 +211,17 @@ public class Variable implements Linked<Variable>{
 		return multiplier;
 	}
 
+	public Variable setSparseGradient (boolean sparseGradient) {
+		
+		this.sparseGradient = sparseGradient;
+		return this;
+	}
+	
+	public boolean hasSparseGradient () {
+		
+		return sparseGradient;
+	}
+
 	@Override
 	public Variable getNext() {
 		return next;
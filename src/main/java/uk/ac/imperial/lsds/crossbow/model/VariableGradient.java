@@ -1,21 +1,75 @@
 package uk.ac.imperial.lsds.crossbow.model;
 
+import java.util.Arrays;
+
+import uk.ac.imperial.lsds.crossbow.ModelConf;
 import uk.ac.imperial.lsds.crossbow.data.DataBuffer;
 import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
+import uk.ac.imperial.lsds.crossbow.device.blas.BLAS;
 import uk.ac.imperial.lsds.crossbow.utils.Linked;
 
+/*
+ * The gradient of a model variable.
+ *
+ * Gradients of variables with `hasSparseGradient()` set can be row-sparse:
+ * an (indices, values) pair, where the values of row `i` are stored at its
+ * dense offset in `buffer`. Rows that are not indexed are implicitly zero
+ * (their bytes are stale), so resetting the gradient is O(1) and consumers
+ * only visit the indexed rows. Once a gradient touches more rows than the
+ * threshold set in `ModelConf`, it zeroes the rest and falls back to dense
+ * until it is reset again.
+ *
+ * Kernels that compute row-sparse gradients must call `reset()` instead of
+ * zeroing the buffer, and `touch (row)` before they accumulate into a row.
+ */
 public class VariableGradient implements Linked<VariableGradient> {
 	
 	public IDataBuffer buffer;
 	public VariableGradient next = null;
 	private float multiplier;
 	
+	private boolean sparse;
+	
+	private int rows, rowSize; /* Row size is in bytes */
+	private int threshold;
+	
+	/* Indexed rows; and, for each row, the stamp of the last reset that saw it indexed */
+	private int [] indices;
+	private int [] stamps;
+	private int stamp;
+	private int count;
+	
+	private boolean dense;
+	
 	public VariableGradient (Variable v) {
 		
 		buffer = new DataBuffer (0, v.capacity(), v.getType());
 		buffer.finalise(v.capacity());
 		multiplier = v.getLearningRateMultiplier();
 		next = null;
+		
+		float fraction = ModelConf.getInstance().getSparseGradientThreshold();
+		
+		/* Rows are set for dense gradients too: `touch (row)` returns their offset */
+		if (v.getShape().dimensions() > 1) {
+			rows = v.getShape().get(0);
+			rowSize = v.capacity() / rows;
+		} else {
+			rows = 1;
+			rowSize = v.capacity();
+		}
+		
+		sparse = (v.hasSparseGradient() && fraction > 0F && v.getShape().dimensions() > 1);
+		if (sparse) {
+			threshold = Math.max(1, (int) (fraction * rows));
+			indices = new int [threshold];
+			stamps = new int [rows];
+			stamp = 1;
+			count = 0;
+			dense = false;
+		} else {
+			dense = true;
+		}
 	}
 
 	@Override
@@ -30,4 +84,189 @@ public class VariableGradient implements Linked<VariableGradient> {
 	public float getLearningRateMultiplier() {
 		return multiplier;
 	}
+
+	/* True if the gradient is currently row-sparse */
+	public boolean isSparse () {
+		return (! dense);
+	}
+
+	public int numberOfRows () {
+		return count;
+	}
+
+	public int getRow (int ndx) {
+		return indices[ndx];
+	}
+
+	public int getRowSize () {
+		return rowSize;
+	}
+
+	/* Zero the gradient */
+	public void reset () {
+		
+		if (! sparse) {
+			buffer.bzero();
+			return;
+		}
+		if (stamp == Integer.MAX_VALUE) {
+			Arrays.fill(stamps, 0);
+			stamp = 0;
+		}
+		stamp ++;
+		count = 0;
+		dense = false;
+	}
+
+	/*
+	 * Returns the offset of `row` in the buffer; the first time a row is touched
+	 * since the last reset, its values are zeroed.
+	 */
+	public int touch (int row) {
+		
+		int offset = row * rowSize;
+		
+		if (dense || stamps[row] == stamp)
+			return offset;
+		
+		if (count == threshold) {
+			densify ();
+			return offset;
+		}
+		
+		stamps[row] = stamp;
+		indices[count++] = row;
+		buffer.bzero(offset, rowSize);
+		
+		return offset;
+	}
+
+	/* Zero the rows that are not indexed, so that the buffer holds the dense gradient */
+	public void densify () {
+		
+		if (dense)
+			return;
+		
+		int start = 0;
+		for (int row = 0; row < rows; ++row) {
+			if (stamps[row] == stamp) {
+				if (row > start)
+					buffer.bzero(start * rowSize, (row - start) * rowSize);
+				start = row + 1;
+			}
+		}
+		if (rows > start)
+			buffer.bzero(start * rowSize, (rows - start) * rowSize);
+		
+		dense = true;
+	}
+
+	/* Y = alpha x this + Y, visiting only the indexed rows if the gradient is sparse */
+	public void axpy (float alpha, IDataBuffer Y) {
+		
+		if (dense) {
+			
+			int N = Y.limit() / Y.getType().sizeOf();
+			BLAS.getInstance().saxpby(N, alpha, buffer, 0, buffer.limit(), /* incX */ 1, 1F, Y, /* incY */ 1);
+			return;
+		}
+		
+		for (int ndx = 0; ndx < count; ++ndx) {
+			
+			int offset = indices[ndx] * rowSize;
+			for (int k = offset; k < offset + rowSize; k += 4)
+				Y.putFloat(k, Y.getFloat(k) + alpha * buffer.getFloat(k));
+		}
+	}
+
+	/* this = factor x this */
+	public void scale (float factor) {
+		
+		if (dense) {
+			
+			for (int k = 0; k < buffer.limit(); k += 4)
+				buffer.putFloat(k, factor * buffer.getFloat(k));
+			return;
+		}
+		
+		for (int ndx = 0; ndx < count; ++ndx) {
+			
+			int offset = indices[ndx] * rowSize;
+			for (int k = offset; k < offset + rowSize; k += 4)
+				buffer.putFloat(k, factor * buffer.getFloat(k));
+		}
+	}
+
+	public float sumOfSquares () {
+		
+		float result = 0F, value;
+		
+		if (dense) {
+			
+			for (int k = 0; k < buffer.limit(); k += 4) {
+				value = buffer.getFloat(k);
+				result += value * value;
+			}
+			return result;
+		}
+		
+		for (int ndx = 0; ndx < count; ++ndx) {
+			
+			int offset = indices[ndx] * rowSize;
+			for (int k = offset; k < offset + rowSize; k += 4) {
+				value = buffer.getFloat(k);
+				result += value * value;
+			}
+		}
+		return result;
+	}
+
+	/* this = alpha x X + this, for the indexed rows only if the gradient is sparse */
+	public void add (float alpha, IDataBuffer X) {
+		
+		if (dense) {
+			
+			int N = buffer.limit() / buffer.getType().sizeOf();
+			BLAS.getInstance().saxpby(N, alpha, X, 0, X.limit(), /* incX */ 1, 1F, buffer, /* incY */ 1);
+			return;
+		}
+		
+		for (int ndx = 0; ndx < count; ++ndx) {
+			
+			int offset = indices[ndx] * rowSize;
+			for (int k = offset; k < offset + rowSize; k += 4)
+				buffer.putFloat(k, buffer.getFloat(k) + alpha * X.getFloat(k));
+		}
+	}
+
+	/* this = X + (clear ? 0 : this) */
+	public void accumulate (VariableGradient X, boolean clear) {
+		
+		IDataBuffer x = X.getDataBuffer();
+		
+		if (! X.isSparse()) {
+			
+			if (clear && sparse) {
+				/* The entire buffer is overwritten */
+				count = 0;
+				dense = true;
+			}
+			else {
+				densify ();
+			}
+			int N = buffer.limit() / buffer.getType().sizeOf();
+			BLAS.getInstance().saxpby(N, 1F, x, 0, x.limit(), /* incX */ 1, (clear ? 0F : 1F), buffer, /* incY */ 1);
+			return;
+		}
+		
+		if (clear)
+			reset ();
+		
+		for (int ndx = 0; ndx < X.numberOfRows(); ++ndx) {
+			
+			int offset = touch (X.getRow(ndx));
+			for (int k = offset; k < offset + rowSize; k += 4)
+				buffer.putFloat(k, buffer.getFloat(k) + x.getFloat(k));
+		}
+	}
 }
\ No newline at end of file
@@ -1,8 +1,19 @@
 package uk.ac.imperial.lsds.crossbow.preprocess;
 
+import java.io.File;
 import java.io.IOException;
+import java.io.RandomAccessFile;
 import java.nio.ByteBuffer;
+import java.nio.channels.FileChannel;
+import java.util.ArrayList;
 import java.util.Iterator;
+import java.util.List;
+import java.util.concurrent.Callable;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.concurrent.atomic.AtomicInteger;
 
 import org.apache.logging.log4j.LogManager;
 import org.apache.logging.log4j.Logger;
@@ -50,6 +61,9 @@ public abstract class Encoder implements IEncoder {
 	
 	private final static Logger log = LogManager.getLogger (Encoder.class);
 	
+	/* Maximum size of a write by `encode (int)` */
+	private static final int CHUNK_SIZE = 64 * 1048576;
+	
 	protected EncoderConf conf;
 	
 	protected DatasetMetadata meta = null;
@@ -257,10 +271,398 @@ public abstract class Encoder implements IEncoder {
 		meta.setExampleType (conf.getDataTuplePair ().getExample ().getDataType ());
 		meta.setLabelType   (conf.getDataTuplePair ().getLabel   ().getDataType ());
 		
+		meta.setExampleScale (conf.getExampleScale (), conf.getExampleShift ());
+		
 		meta.setExamplesFilePad (conf.getBatchInfo ().getExampleBatchDescriptor ().getPad ());
 		meta.setLabelsFilePad   (conf.getBatchInfo ().getLabelBatchDescriptor   ().getPad ());
 		
 		meta.setFill (missing);
+		
+		merge (iterator);
+	}
+	
+	/*
+	 * Input files of fixed-size tuples (or examples, or labels), indexed by
+	 * tuple. Tuples are located with the encoder's own header parser: in
+	 * each file, the first tuple after the header determines the size of
+	 * every other.
+	 */
+	private static class InputIndex {
+		
+		static final int TUPLES = 0, EXAMPLES = 1, LABELS = 2;
+		
+		DatasetFile [] files;
+		
+		int [] start, size, first;
+		
+		int count;
+		
+		public InputIndex (DatasetFileReader reader, DataTupleIterator iterator, int kind, DataTuple example, DataTuple label) throws IOException {
+			
+			int N = reader.getCount ();
+			
+			files = new DatasetFile [N];
+			start = new int [N];
+			size  = new int [N];
+			first = new int [N];
+			
+			count = 0;
+			
+			for (int i = 0; i < N; ++i) {
+				
+				files [i] = reader.getDatasetFile (i);
+				
+				/* Input files are big-endian, as is a duplicate of their buffer */
+				ByteBuffer input = files [i].getByteBuffer ().duplicate ();
+				
+				if (kind == LABELS)
+					iterator.parseLabelsFileHeader (input);
+				else
+					iterator.parseExamplesFileHeader (input);
+				
+				start [i] = input.position ();
+				first [i] = count;
+				
+				if (! input.hasRemaining ())
+					continue;
+				
+				switch (kind) {
+				case TUPLES:   size [i] = iterator.__nextTuple   (input, example, label); break;
+				case EXAMPLES: size [i] = iterator.__nextExample (input, example); break;
+				default:
+					size [i] = iterator.__nextLabel (input, label);
+					break;
+				}
+				example.getBuffer ().clear ();
+				label.getBuffer ().clear ();
+				
+				int bytes = input.limit () - start [i];
+				
+				if (size [i] < 1 || (bytes % size [i]) != 0)
+					throw new IOException (String.format("error: %s does not contain fixed-size tuples", files [i].getFilename ()));
+				
+				count += bytes / size [i];
+			}
+		}
+		
+		/* Returns a (big-endian) view of every input file, private to the caller */
+		public ByteBuffer [] views () throws IOException {
+			
+			ByteBuffer [] views = new ByteBuffer [files.length];
+			for (int i = 0; i < files.length; ++i)
+				views [i] = files [i].getByteBuffer ().duplicate ();
+			return views;
+		}
+		
+		/* Positions the view of the file that contains `tuple` at that tuple, and returns it */
+		public ByteBuffer seek (ByteBuffer [] views, int tuple) {
+			
+			int i = files.length - 1;
+			while (first [i] > tuple)
+				--i;
+			
+			views [i].position (start [i] + (tuple - first [i]) * size [i]);
+			return views [i];
+		}
+		
+		public void close () throws IOException {
+			
+			for (DatasetFile file: files)
+				file.close ();
+		}
+	}
+	
+	/*
+	 * Returns true if iterators of this encoder can run concurrently, i.e. if 
+	 * they only write to the data tuples they are given (or to their own state,
+	 * see `merge`) and input tuples are of fixed size. See `encode (int)`.
+	 */
+	public boolean supportsParallelEncoding () {
+		
+		return false;
+	}
+	
+	/*
+	 * Called at the end of `encode ()` or `encode (int)` for every iterator
+	 * that parsed input tuples; every input tuple is parsed by exactly one of
+	 * them. Encoders whose iterators accumulate statistics (e.g. a mean image)
+	 * reduce them here.
+	 */
+	protected void merge (DataTupleIterator iterator) {
+		
+		return;
+	}
+	
+	/*
+	 * Encodes the dataset with `workers` threads. The output (files and 
+	 * metadata) is the same as that of `encode ()`.
+	 * 
+	 * Output batches are split into chunks of at most `CHUNK_SIZE` bytes that
+	 * do not cross file partitions. Each worker takes the next chunk, parses
+	 * and encodes its tuples (with its own iterator and data tuples) into a 
+	 * direct buffer, and writes the buffer at the chunk's offset in its file
+	 * partition. So partitions are written concurrently, in large, page-aligned
+	 * writes rather than through memory-mapped files. Worker iterators are
+	 * merged once all chunks have been written.
+	 * 
+	 * If the encoder does not support parallel encoding, this is `encode ()`.
+	 */
+	public void encode (int workers) throws IOException {
+		
+		if (workers < 2 || ! supportsParallelEncoding ()) {
+			
+			if (workers > 1)
+				log.warn(String.format("%s does not support parallel encoding; encode with 1 worker", getClass().getSimpleName()));
+			
+			encode ();
+			return;
+		}
+		
+		long startTime = System.nanoTime ();
+		
+		final DatasetInfo dataset = conf.getDataset ();
+		
+		final DatasetDescriptor X = dataset.getExamplesDescriptor ();
+		final DatasetDescriptor Y = dataset.getLabelsDescriptor ();
+		
+		final DataTuplePair pair = conf.getDataTuplePair ();
+		
+		final BatchDescriptor [] batch = new BatchDescriptor [] {
+			
+			conf.getBatchInfo ().getExampleBatchDescriptor (),
+			conf.getBatchInfo ().getLabelBatchDescriptor   ()
+		};
+		
+		final int B = conf.getBatchInfo ().elements ();
+		
+		/* Number of batches per file partition (as in `conf.configure ()`) */
+		final int M = (int) conf.getBatchInfo ().numberOfBatchesPerFile (SystemConf.getInstance().getFilePartitionSize());
+		
+		/* Index input tuples */
+		
+		final boolean shared = X.sharesInputWith (Y);
+		
+		DataTupleIterator iterator = iterator ();
+		
+		DataTuple example = new DataTuple (pair.getExample ().getShape (), pair.getExample ().getDataType ());
+		DataTuple label   = new DataTuple (pair.getLabel   ().getShape (), pair.getLabel   ().getDataType ());
+		
+		final InputIndex [] index;
+		
+		if (shared) {
+			
+			index = new InputIndex [] { new InputIndex (X.getDatasetFileReader (), iterator, InputIndex.TUPLES, example, label) };
+		}
+		else {
+			
+			index = new InputIndex [] {
+				
+				new InputIndex (X.getDatasetFileReader (), iterator, InputIndex.EXAMPLES, example, label),
+				new InputIndex (Y.getDatasetFileReader (), iterator, InputIndex.LABELS,   example, label)
+			};
+			
+			if (index[0].count != index[1].count) {
+				
+				System.err.println (String.format("error: inconsistent number of examples and labels (%d examples, %d labels)", index[0].count, index[1].count));
+				System.exit (1);
+			}
+		}
+		
+		final int count = index[0].count;
+		
+		/* As in `encode ()`, the last batch is filled with the first `missing` tuples */
+		final int batches = (count + B - 1) / B;
+		final int missing = batches * B - count;
+		
+		final int partitions = (batches + M - 1) / M;
+		
+		/* Create output files (partitions) */
+		
+		final FileChannel [][] output = new FileChannel [2][partitions];
+		RandomAccessFile [][] files = new RandomAccessFile [2][partitions];
+		
+		String [] prefix = new String [] { X.getDestination (), Y.getDestination () };
+		
+		for (int k = 0; k < 2; ++k) {
+			for (int p = 0; p < partitions; ++p) {
+				
+				File file = new File (String.format("%s.%d", prefix [k], p + 1));
+				if (file.exists ())
+					file.delete ();
+				
+				int n = Math.min(M, batches - p * M);
+				
+				files  [k][p] = new RandomAccessFile (file, "rw");
+				files  [k][p].setLength ((long) n * (long) batch [k].getBatchSize ());
+				output [k][p] = files [k][p].getChannel ();
+			}
+		}
+		
+		/* Split batches into chunks, none of which crosses a file partition */
+		
+		final int K = Math.max(1, Math.min(M, CHUNK_SIZE / Math.max(batch[0].getBatchSize (), batch[1].getBatchSize ())));
+		final int chunksPerPartition = (M + K - 1) / K;
+		final int chunks = partitions * chunksPerPartition;
+		
+		final AtomicInteger next = new AtomicInteger (0);
+		
+		log.info(String.format("Encode %d tuples (%d batches, %d partitions) with %d workers", count, batches, partitions, workers));
+		
+		ExecutorService executor = Executors.newFixedThreadPool (workers);
+		List<Future<Void>> results = new ArrayList<Future<Void>>();
+		
+		/* Per worker iterator, merged at the end */
+		final DataTupleIterator [] iterators = new DataTupleIterator [workers];
+		
+		for (int w = 0; w < workers; ++w) {
+			
+			final int id = w;
+			
+			results.add (executor.submit (new Callable<Void>() {
+				
+				public Void call () throws IOException {
+					
+					DataTupleIterator iterator = iterators [id] = iterator ();
+					
+					/* Re-parses the tuples that fill the last batch, so they are merged only once */
+					DataTupleIterator filler = null;
+					
+					DataTuple example = new DataTuple (pair.getExample ().getShape (), pair.getExample ().getDataType ());
+					DataTuple label   = new DataTuple (pair.getLabel   ().getShape (), pair.getLabel   ().getDataType ());
+					
+					DataTuple [] tuple = new DataTuple [] { example, label };
+					
+					ByteBuffer [][] views = new ByteBuffer [index.length][];
+					for (int k = 0; k < index.length; ++k)
+						views [k] = index[k].views ();
+					
+					ByteBuffer [] buffer = new ByteBuffer [] {
+						
+						ByteBuffer.allocateDirect (K * batch[0].getBatchSize ()),
+						ByteBuffer.allocateDirect (K * batch[1].getBatchSize ())
+					};
+					
+					byte [][] pad = new byte [][] { new byte [batch[0].getPad ()], new byte [batch[1].getPad ()] };
+					
+					int c;
+					while ((c = next.getAndIncrement ()) < chunks) {
+						
+						int p = c / chunksPerPartition;
+						int offset = (c % chunksPerPartition) * K;
+						
+						int first = p * M + offset;
+						int n = Math.min(Math.min(K, M - offset), batches - first);
+						if (n <= 0)
+							continue;
+						
+						buffer [0].clear ();
+						buffer [1].clear ();
+						
+						for (int b = first; b < first + n; ++b) {
+							
+							for (int t = b * B; t < (b + 1) * B; ++t) {
+								
+								int ndx = t;
+								DataTupleIterator it = iterator;
+								
+								if (t >= count) {
+									
+									ndx = t - count;
+									if (filler == null)
+										filler = iterator ();
+									it = filler;
+								}
+								
+								if (shared) {
+									
+									it.__nextTuple (index[0].seek (views [0], ndx), example, label);
+								}
+								else {
+									
+									it.__nextExample (index[0].seek (views [0], ndx), example);
+									it.__nextLabel   (index[1].seek (views [1], ndx), label);
+								}
+								
+								for (int k = 0; k < 2; ++k) {
+									
+									ByteBuffer encoded = tuple [k].getBuffer ();
+									encoded.flip ();
+									buffer [k].put (encoded);
+									encoded.clear ();
+								}
+							}
+							
+							/* Batch complete: align it to page size */
+							buffer [0].put (pad [0]);
+							buffer [1].put (pad [1]);
+						}
+						
+						for (int k = 0; k < 2; ++k) {
+							
+							buffer [k].flip ();
+							
+							long position = (long) offset * (long) batch [k].getBatchSize ();
+							while (buffer [k].hasRemaining ())
+								position += output [k][p].write (buffer [k], position);
+						}
+					}
+					return null;
+				}
+			}));
+		}
+		
+		try {
+			for (Future<Void> result: results)
+				result.get ();
+		} catch (InterruptedException e) {
+			throw new IOException (e);
+		} catch (ExecutionException e) {
+			throw new IOException (e.getCause ());
+		} finally {
+			executor.shutdown ();
+		}
+		
+		for (int k = 0; k < 2; ++k) {
+			for (int p = 0; p < partitions; ++p) {
+				
+				output [k][p].force (true);
+				files  [k][p].close ();
+			}
+		}
+		
+		for (InputIndex i: index)
+			i.close ();
+		
+		for (DataTupleIterator i: iterators)
+			merge (i);
+		
+		/* Create metadata */
+		
+		meta = new DatasetMetadata (conf.getMetadata());
+		
+		meta.setExamplesFilePrefix (X.getDestination ());
+		meta.setLabelsFilePrefix   (Y.getDestination ());
+		
+		meta.setNumberOfPartitions (partitions);
+		
+		meta.setNumberOfExamples (batches * B);
+		
+		meta.setBatchSize (B);
+		
+		meta.setExampleShape (pair.getExample ().getShape ());
+		meta.setLabelShape   (pair.getLabel   ().getShape ());
+		
+		meta.setExampleType (pair.getExample ().getDataType ());
+		meta.setLabelType   (pair.getLabel   ().getDataType ());
+		
+		meta.setExampleScale (conf.getExampleScale (), conf.getExampleShift ());
+		
+		meta.setExamplesFilePad (batch [0].getPad ());
+		meta.setLabelsFilePad   (batch [1].getPad ());
+		
+		meta.setFill (missing);
+		
+		log.info(String.format("Encoded %d tuples in %.2f secs", count, (double) (System.nanoTime () - startTime) / 1000000000D));
 	}
 	
 	/*
@@ -501,6 +903,9 @@ public abstract class Encoder implements IEncoder {
 		meta.setExampleType (conf.getDataTuplePair ().getExample ().getDataType ());
 		meta.setLabelType   (conf.getDataTuplePair ().getLabel   ().getDataType ());
 		
+		/* Examples are copied as they are */
+		meta.setExampleScale (_meta.getExampleScale (), _meta.getExampleShift ());
+		
 		meta.setExamplesFilePad (conf.getBatchInfo ().getExampleBatchDescriptor ().getPad ());
 		meta.setLabelsFilePad   (conf.getBatchInfo ().getLabelBatchDescriptor   ().getPad ());
 		
@@ -582,6 +987,8 @@ public abstract class Encoder implements IEncoder {
 		meta.setExampleType (conf.getDataTuplePair ().getExample ().getDataType ());
 		meta.setLabelType   (conf.getDataTuplePair ().getLabel   ().getDataType ());
 		
+		meta.setExampleScale (conf.getExampleScale (), conf.getExampleShift ());
+		
 		meta.setExamplesFilePad (conf.getBatchInfo ().getExampleBatchDescriptor ().getPad ());
 		meta.setLabelsFilePad   (conf.getBatchInfo ().getLabelBatchDescriptor   ().getPad ());
 		
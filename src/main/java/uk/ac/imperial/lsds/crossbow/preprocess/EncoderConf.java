@@ -12,6 +12,9 @@ public class EncoderConf {
 	
 	private float scalefactor;
 	
+	/* How examples stored in a compact type are widened to floats */
+	private float examplescale, exampleshift;
+	
 	/* Reshuffle options */
 	private boolean copy;
 	private String temp;
@@ -28,6 +31,9 @@ public class EncoderConf {
 		
 		scalefactor = 1F;
 		
+		examplescale = 1F;
+		exampleshift = 0F;
+		
 		copy = false;
 		temp = null;
 		
@@ -122,6 +128,24 @@ public class EncoderConf {
 		return scalefactor;
 	}
 	
+	public EncoderConf setExampleScale (float examplescale, float exampleshift) {
+		
+		this.examplescale = examplescale;
+		this.exampleshift = exampleshift;
+		
+		return this;
+	}
+	
+	public float getExampleScale () {
+		
+		return examplescale;
+	}
+	
+	public float getExampleShift () {
+		
+		return exampleshift;
+	}
+	
 	public EncoderConf setCopyBeforeReshuffle (boolean copy) {
 		
 		this.copy = copy;
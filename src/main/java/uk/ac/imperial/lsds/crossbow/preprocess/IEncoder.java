@@ -10,5 +10,7 @@ public interface IEncoder {
 	
 	public void encode () throws IOException;
 	
+	public void encode (int workers) throws IOException;
+	
 	public abstract DataTupleIterator iterator ();
 }
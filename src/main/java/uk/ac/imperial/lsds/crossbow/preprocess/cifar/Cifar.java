@@ -34,10 +34,15 @@ public class Cifar {
 		options.addOption ("-o", "Output data directory", File.class,    String.format("/mnt/nfs/users/piwatcha/16-crossbow/data/cifar-10/pre-processed-and-normalised/b-%03d", batchSize));
 		options.addOption ("-b", "Micro-batch size",      Integer.class, Integer.toString(batchSize));
 		options.addOption ("-p", "Padding",               Integer.class, Integer.toString(padding));
+		options.addOption ("-w", "Encoder threads",       Integer.class, Integer.toString(Runtime.getRuntime().availableProcessors()));
+		options.addOption ("-t", "Example data type",     String.class,  "float");
 		
 		CommandLine commandLine = new CommandLine (options);
 		commandLine.parse (args);
 		
+		/* Compact types (uint8, int8 or fp16) are widened to floats during training */
+		DataType type = DataType.fromString (options.getOption("-t").getStringValue());
+		
 		/* Encode training data */
 		
 		System.out.println("Encode training data");
@@ -78,7 +83,7 @@ public class Cifar {
 		.setDataset         (dataset1)
 		.setBatchInfo       (options.getOption("-b").getIntValue())
 		.setDataTuplePair   (
-							new DataTuple (new Shape (new int [] { 3, 32 + padding + padding, 32 + padding + padding }), DataType.FLOAT),
+							new DataTuple (new Shape (new int [] { 3, 32 + padding + padding, 32 + padding + padding }), type),
 							new DataTuple (new Shape (new int [] { 1 }), DataType.INT)
 							)
 		.setMetadata        (options.getOption("-o").getStringValue(), "cifar-train.metadata");
@@ -91,7 +96,7 @@ public class Cifar {
 		encoder1.setExpectedCount(50000);
 		encoder1.setPadding (padding);
 			
-		encoder1.encode ();
+		encoder1.encode (options.getOption("-w").getIntValue());
 		encoder1.computeAndStoreMeanImage ();
 		encoder1.getMetadata ().store ();
 		
@@ -122,7 +127,7 @@ public class Cifar {
 		.setDataset         (dataset2)
 		.setBatchInfo       (options.getOption("-b").getIntValue())
 		.setDataTuplePair   (
-							new DataTuple (new Shape (new int [] { 3, 32 + padding + padding, 32 + padding + padding }), DataType.FLOAT),
+							new DataTuple (new Shape (new int [] { 3, 32 + padding + padding, 32 + padding + padding }), type),
 							new DataTuple (new Shape (new int [] { 1 }), DataType.INT)
 							)
 		.setMetadata        (options.getOption("-o").getStringValue(), "cifar-test.metadata");
@@ -135,7 +140,7 @@ public class Cifar {
 		encoder2.setExpectedCount(10000);
 		encoder2.setPadding (padding);
 		
-		encoder2.encode ();
+		encoder2.encode (options.getOption("-w").getIntValue());
 		encoder2.computeAndStoreMeanImage ();
 		encoder2.getMetadata ().store ();
 		
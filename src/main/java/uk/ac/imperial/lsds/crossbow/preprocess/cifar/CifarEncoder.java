@@ -0,0 +1,281 @@
+package uk.ac.imperial.lsds.crossbow.preprocess.cifar;
+
+import java.io.File;
+import java.io.RandomAccessFile;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.util.Arrays;
+
+import uk.ac.imperial.lsds.crossbow.preprocess.DataTuple;
+import uk.ac.imperial.lsds.crossbow.preprocess.DataTupleIterator;
+import uk.ac.imperial.lsds.crossbow.preprocess.Encoder;
+import uk.ac.imperial.lsds.crossbow.preprocess.EncoderConf;
+import uk.ac.imperial.lsds.crossbow.types.DataType;
+import uk.ac.imperial.lsds.crossbow.utils.HalfPrecision;
+
+public class CifarEncoder extends Encoder {
+	
+	private boolean computeMeanImage;
+	
+	private String meanImageFilename = null;
+	
+	private int padding = 0;
+	
+	private int tupleCount, expectedTupleCount;
+	
+	private int percent_ = 0, _percent = 0;
+	long _t, t_;
+	long bytes;
+	double mbps;
+	
+	private ByteBuffer meanImage;
+	
+	/* Number of tuples summed into the mean image */
+	private int meanImageCount = 0;
+
+	public CifarEncoder (EncoderConf conf) {
+		
+		super(conf);
+		
+		/* 
+		 * Compact examples store the original pixel (offset by -128, if signed);
+		 * the transformation below is applied when they are widened to floats.
+		 */
+		float scale = conf.getScaleFactor () / 127.5F;
+		switch (conf.getDataTuplePair ().getExample ().getDataType ()) {
+		case UINT8: conf.setExampleScale (scale, -1F); break;
+		case  INT8: conf.setExampleScale (scale, 128F * scale - 1F); break;
+		default:
+			break;
+		}
+	}
+	
+	public CifarEncoder setComputeMeanImage (boolean computeMeanImage) { 
+		this.computeMeanImage = computeMeanImage;
+		return this;
+	}
+	
+	public CifarEncoder setExpectedCount (int expectedTupleCount) { 
+		this.expectedTupleCount = expectedTupleCount;
+		return this;
+	}
+	
+	public CifarEncoder setMeanImageFilename (String meanImageFilename) {
+		this.meanImageFilename = meanImageFilename;
+		return this;
+	}
+	
+	public CifarEncoder setPadding (int padding) {
+		this.padding = padding;
+		return this;
+	}
+	
+	/*
+	 * Each iterator sums the pixels of the tuples it parses into an image of its
+	 * own, so that iterators can run concurrently (see `Encoder.encode (int)`).
+	 * Partial sums are reduced into the mean image by `merge`.
+	 */
+	private class CifarTupleIterator extends DataTupleIterator {
+		
+		private float [] sum = null;
+		
+		private int count = 0;
+		
+		@Override
+		public void parseExamplesFileHeader (ByteBuffer input) {
+			
+			return;
+		}
+		
+		@Override
+		public void nextExample (ByteBuffer input, DataTuple example) {
+			
+			return;
+		}
+		
+		@Override
+		public void parseLabelsFileHeader (ByteBuffer input) {
+			
+			return;
+		}
+		
+		@Override
+		public void nextLabel (ByteBuffer input, DataTuple label) {
+			
+			return;
+		}
+		
+		@Override
+		public void nextTuple (ByteBuffer input, DataTuple example, DataTuple label) {
+			
+			if (computeMeanImage) {
+				
+				if (sum == null)
+					sum = new float [example.getShape().countAllElements()];
+			}
+			
+			int _label = input.get () & 0xFF;
+			// System.out.println("Label is " + _label);
+			label.getBuffer ().putInt (_label);
+			
+			/*
+			 * Parsing the Cifar-10 dataset without padding
+			 *
+			 * int pixels = example.getShape ().countAllElements ();
+			 *
+			 * for (int i = 0; i < pixels; ++i) {
+			 * 	float pixel = (float) (input.get () & 0xFF);
+			 * 	example.getBuffer ().putFloat (pixel * conf.getScaleFactor ());
+			 * 	if (computeMeanImage)
+			 * 		sum [i] += pixel;
+			 * }
+			 */
+			
+			/* Reset output buffer */
+			Arrays.fill (example.getBuffer().array(), (byte) 0);
+			
+			DataType type = example.getDataType();
+			
+			int width  = example.getShape().get(1);
+			int height = example.getShape().get(2);
+			
+			for (int c = 0; c < 3; c ++) {
+				for (int y = 0; y < 32; y ++) {
+					for (int x = 0; x < 32; x ++) {
+						float pixel = (float) (input.get () & 0xFF);
+						
+						/* Transform pixel */
+						float transformed = pixel * conf.getScaleFactor ();
+						/* Transform pixel (custom):
+						 *
+						 * a) Assert that pixel is in the range [0, 255].
+						 * b) Rescale to [ 0, 2].
+						 * c) Rescale to [-1, 1].
+						 */
+						if ((transformed < 0) || (transformed > 255)) {
+							System.err.println("error: pixel value is not in [0, 255]");
+							System.exit(1);
+						}
+						transformed = (transformed / 127.5F) - 1;
+						
+						int x_ = x + padding;
+						int y_ = y + padding;
+						int index = c * (height * width) + y_ * width + x_;
+						int offset = index * type.sizeOf();
+						switch (type) {
+						case UINT8: example.getBuffer ().put (offset, (byte) pixel); break;
+						case  INT8: example.getBuffer ().put (offset, (byte) (pixel - 128)); break;
+						case  FP16: example.getBuffer ().putShort (offset, HalfPrecision.fromFloat (transformed)); break;
+						default:
+							example.getBuffer ().putFloat (offset, transformed);
+							break;
+						}
+						if (computeMeanImage)
+							sum [index] += pixel;
+					}
+				}
+			}
+			/* Set output buffer position (it will be rewinded afterwards) */
+			example.getBuffer().position (example.size());
+			
+			count ++;
+			
+			progress (example.size());
+		}
+	}
+	
+	public DataTupleIterator iterator () {
+		
+		return new CifarTupleIterator ();
+	}
+	
+	/* Input files hold fixed-size tuples, and iterators only update their own sums */
+	@Override
+	public boolean supportsParallelEncoding () {
+		
+		return true;
+	}
+	
+	@Override
+	protected void merge (DataTupleIterator iterator) {
+		
+		CifarTupleIterator it = (CifarTupleIterator) iterator;
+		
+		if (! computeMeanImage || it.sum == null)
+			return;
+		
+		if (meanImage == null)
+			meanImage = ByteBuffer.allocate(it.sum.length * 4).order(ByteOrder.LITTLE_ENDIAN);
+		
+		for (int i = 0; i < it.sum.length; ++i)
+			meanImage.putFloat (i * 4, meanImage.getFloat(i * 4) + it.sum [i]);
+		
+		meanImageCount += it.count;
+	}
+	
+	/* Prints statistics; called by every iterator */
+	private synchronized void progress (int size) {
+		
+		if (tupleCount < 0)
+			_t = System.nanoTime();
+		
+		/* Inc. tuples processed */
+		tupleCount ++;
+		
+		/* Inc. bytes processed */
+		bytes += (long) size;
+		
+		if (expectedTupleCount > 0) {
+			percent_ = (tupleCount * 100) / expectedTupleCount;
+			if (percent_ == (_percent + 1)) {
+				
+				t_ = System.nanoTime();
+				
+				mbps = (bytes / 1048576.) / ((double) (t_ - _t) / 1000000000.);
+				
+				System.out.print(String.format("Pre-processing Cifar-10...%3d%% (%6.2f MB/s)\r", percent_, mbps));
+				
+				_percent = percent_;
+				_t = t_;
+				
+				/* Reset byte counter */
+				bytes = 0;
+			}
+		}
+	}
+	
+	public void computeAndStoreMeanImage () {
+		
+		if (! computeMeanImage)
+			return;
+		
+		for (int index = 0; index < meanImage.capacity(); index += 4) {
+			meanImage.putFloat (index, (meanImage.getFloat(index) / meanImageCount));
+		}
+		
+		/* Reset meanImage pointers (position) */
+		meanImage.clear();
+		
+		File file = new File (meanImageFilename);
+		
+		try {
+			
+			@SuppressWarnings("resource")
+			FileChannel channel = new RandomAccessFile (file, "rws").getChannel();
+			
+			MappedByteBuffer output = channel.map(FileChannel.MapMode.READ_WRITE, 0, meanImage.capacity());
+			output.order(ByteOrder.LITTLE_ENDIAN);
+			
+			output.put(meanImage);
+			
+			channel.close();
+
+		} catch (Exception e) {
+			
+			System.err.println("error: failed to write mean image file: " + e.getMessage());
+			System.exit(1);
+		}
+	}
+}
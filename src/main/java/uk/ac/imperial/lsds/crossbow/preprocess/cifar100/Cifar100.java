@@ -34,6 +34,7 @@ public class Cifar100 {
 		options.addOption ("-o", "Output data directory", File.class,    "/mnt/nfs/users/piwatcha/16-crossbow/data/cifar-100/pre-processed");
 		options.addOption ("-b", "Micro-batch size",      Integer.class, Integer.toString(batchSize));
 		options.addOption ("-p", "Padding",               Integer.class, Integer.toString(padding));
+		options.addOption ("-w", "Encoder threads",       Integer.class, Integer.toString(Runtime.getRuntime().availableProcessors()));
 		
 		CommandLine commandLine = new CommandLine (options);
 		commandLine.parse (args);
@@ -86,7 +87,7 @@ public class Cifar100 {
 		encoder1.setExpectedCount(50000);
 		encoder1.setPadding (padding);
 			
-		encoder1.encode ();
+		encoder1.encode (options.getOption("-w").getIntValue());
 		encoder1.computeAndStoreMeanImage ();
 		encoder1.getMetadata ().store ();
 		
@@ -130,7 +131,7 @@ public class Cifar100 {
 		encoder2.setExpectedCount(10000);
 		encoder2.setPadding (padding);
 		
-		encoder2.encode ();
+		encoder2.encode (options.getOption("-w").getIntValue());
 		encoder2.computeAndStoreMeanImage ();
 		encoder2.getMetadata ().store ();
 		
@@ -24,6 +24,7 @@ public class MNIST {
 		options.addOption ("-o", "Output data directory", File.class,    "/data/crossbow/mnist/b-" + String.format("%03d", batchSize));
 		options.addOption ("-b", "Micro-batch size",      Integer.class, Integer.toString(batchSize));
 		options.addOption ("-s", "Scale factor",          Float.class,   "0.00390625F");
+		options.addOption ("-w", "Encoder threads",       Integer.class, Integer.toString(Runtime.getRuntime().availableProcessors()));
 		
 		/* SystemConf.getInstance().setFilePartitionLimit (1048576); */
 		
@@ -58,7 +59,7 @@ public class MNIST {
 		
 		MNISTEncoder encoder1 = new MNISTEncoder (conf1);
 		
-		encoder1.encode();
+		encoder1.encode(options.getOption("-w").getIntValue());
 		encoder1.getMetadata().store();
 		
 		/* Encode test data */
@@ -89,7 +90,7 @@ public class MNIST {
 		
 		MNISTEncoder encoder2 = new MNISTEncoder (conf2);
 		
-		encoder2.encode();
+		encoder2.encode(options.getOption("-w").getIntValue());
 		encoder2.getMetadata().store();
 		
 		System.out.println("Bye.");
@@ -19,6 +19,13 @@ public class MNISTEncoder extends Encoder {
 		super(conf);
 	}
 	
+	/* IDX files hold fixed-size examples and labels, and the iterator is stateless */
+	@Override
+	public boolean supportsParallelEncoding () {
+		
+		return true;
+	}
+	
 	public DataTupleIterator iterator () {
 		
 		DataTupleIterator it = new DataTupleIterator () {
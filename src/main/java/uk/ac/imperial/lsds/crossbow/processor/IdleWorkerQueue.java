@@ -0,0 +1,295 @@
+package uk.ac.imperial.lsds.crossbow.processor;
+
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicReference;
+import java.util.concurrent.locks.LockSupport;
+
+import org.apache.logging.log4j.LogManager;
+import org.apache.logging.log4j.Logger;
+
+import uk.ac.imperial.lsds.crossbow.device.TheCPU;
+
+/*
+ * Independent parts of a task (e.g. ranges of examples or channels) that
+ * CPU workers run while they wait for a task of their own, together with
+ * dedicated intra-op threads (see `SystemConf.numberOfIntraOpThreads`).
+ *
+ * A worker that splits its task submits all but one part, runs that part,
+ * and then helps to run the remaining parts (its own, or those of other
+ * workers) until its parts have completed. It never blocks waiting for
+ * an idle worker, so splitting a task is always safe; it only pays off
+ * when other workers are idle (see `numberOfIdleWorkers`). Intra-op
+ * threads count as idle workers that never run tasks of their own.
+ *
+ * There is one queue per NUMA node. Parts are submitted to the queue of
+ * the submitting thread's node, and threads poll the queue of their own
+ * node before they steal parts from other nodes.
+ *
+ * Parts do not split further: a part (or a worker waiting for its parts)
+ * that calls `run` or `parallelFor` runs all sub-parts itself.
+ */
+public class IdleWorkerQueue {
+	
+	private final static Logger log = LogManager.getLogger (IdleWorkerQueue.class);
+	
+	private static final IdleWorkerQueue instance = new IdleWorkerQueue ();
+	
+	public static IdleWorkerQueue getInstance () { return instance; }
+	
+	/* A range of iterations, [from, to), of a parallel loop */
+	public interface Range {
+		
+		public void run (int from, int to);
+	}
+	
+	/* Per-thread state */
+	private static class Context {
+		
+		int node = 0;
+		boolean nested = false;
+	}
+	
+	private static final ThreadLocal<Context> context = new ThreadLocal<Context> () {
+		protected Context initialValue () {
+			return new Context ();
+		}
+	};
+	
+	private static class Part implements Runnable {
+		
+		Runnable body;
+		AtomicInteger pending;
+		AtomicReference<Throwable> error;
+		
+		public Part (Runnable body, AtomicInteger pending, AtomicReference<Throwable> error) {
+			this.body = body;
+			this.pending = pending;
+			this.error = error;
+		}
+		
+		public void run () {
+			Context c = context.get();
+			boolean nested = c.nested;
+			c.nested = true;
+			try {
+				body.run();
+			} catch (Throwable e) {
+				/* Errors too: they must not kill an intra-op thread, and the caller rethrows them */
+				error.compareAndSet(null, e);
+			} finally {
+				c.nested = nested;
+				pending.decrementAndGet();
+			}
+		}
+	}
+	
+	private static class RangePart implements Runnable {
+		
+		Range body;
+		int from, to;
+		
+		public RangePart (Range body, int from, int to) {
+			this.body = body;
+			this.from = from;
+			this.to = to;
+		}
+		
+		public void run () {
+			body.run(from, to);
+		}
+	}
+	
+	private class IntraOpThread extends Thread {
+		
+		int core;
+		volatile boolean parked;
+		
+		public IntraOpThread (int id, int core) {
+			super (String.format("Intra-op thread %d", id));
+			setDaemon(true);
+			this.core = core;
+			this.parked = false;
+		}
+		
+		public void run () {
+			
+			TheCPU.getInstance().bind(core);
+			register (core);
+			
+			while (! stop) {
+				if (runOne ())
+					continue;
+				parked = true;
+				/* Re-check after setting `parked`, since submitters only unpark parked threads */
+				if (! runOne () && ! stop)
+					LockSupport.park(this);
+				parked = false;
+			}
+		}
+	}
+	
+	private volatile ConcurrentLinkedQueue<Runnable> [] queues;
+	
+	private AtomicInteger idle;
+	
+	private IntraOpThread [] threads;
+	private volatile boolean stop;
+	
+	public IdleWorkerQueue () {
+		queues = createQueues (1);
+		idle = new AtomicInteger (0);
+		threads = new IntraOpThread [0];
+		stop = false;
+	}
+	
+	@SuppressWarnings("unchecked")
+	private static ConcurrentLinkedQueue<Runnable> [] createQueues (int nodes) {
+		ConcurrentLinkedQueue<Runnable> [] q = new ConcurrentLinkedQueue [nodes];
+		for (int i = 0; i < nodes; ++i)
+			q[i] = new ConcurrentLinkedQueue<Runnable>();
+		return q;
+	}
+	
+	/*
+	 * Creates one queue per NUMA node and starts `count` intra-op threads, bound
+	 * to the cores that follow `offset`. It must be called before any worker runs.
+	 */
+	public void start (int count, int offset) {
+		
+		TheCPU cpu = TheCPU.getInstance();
+		
+		int cores = Math.max(1, cpu.getNumCores());
+		int nodes = 1;
+		for (int core = 0; core < cores; ++core)
+			nodes = Math.max(nodes, cpu.getNumaNode(core) + 1);
+		
+		queues = createQueues (nodes);
+		
+		stop = false;
+		threads = new IntraOpThread [count];
+		for (int i = 0; i < count; ++i)
+			threads[i] = new IntraOpThread (i, (offset + i) % cores);
+		
+		idle.addAndGet(count);
+		for (int i = 0; i < count; ++i)
+			threads[i].start();
+		
+		log.info(String.format("%d intra-op thread%s over %d NUMA node%s", count, (count == 1 ? "" : "s"), nodes, (nodes == 1 ? "" : "s")));
+	}
+	
+	public void stop () {
+		stop = true;
+		for (int i = 0; i < threads.length; ++i)
+			LockSupport.unpark(threads[i]);
+		idle.addAndGet(-threads.length);
+		threads = new IntraOpThread [0];
+	}
+	
+	/* Called by a thread after it is bound to `core` */
+	public void register (int core) {
+		context.get().node = TheCPU.getInstance().getNumaNode(core) % queues.length;
+	}
+	
+	/* Called by workers when they fail to find a task, and when they find one */
+	public void idle () {
+		idle.incrementAndGet();
+	}
+	
+	public void busy () {
+		idle.decrementAndGet();
+	}
+	
+	public int numberOfIdleWorkers () {
+		return Math.max(0, idle.get());
+	}
+	
+	/* Runs one pending part, if any (from this thread's node first) */
+	public boolean runOne () {
+		ConcurrentLinkedQueue<Runnable> [] q = queues;
+		int node = context.get().node;
+		for (int i = 0; i < q.length; ++i) {
+			Runnable part = q[(node + i) % q.length].poll();
+			if (part != null) {
+				part.run();
+				return true;
+			}
+		}
+		return false;
+	}
+	
+	/* Runs all parts and returns when they have completed */
+	public void run (Runnable [] parts) {
+		
+		Context c = context.get();
+		
+		if (parts.length == 1 || c.nested) {
+			for (int i = 0; i < parts.length; ++i)
+				parts[i].run();
+			return;
+		}
+		
+		AtomicInteger pending = new AtomicInteger (parts.length);
+		AtomicReference<Throwable> error = new AtomicReference<Throwable>(null);
+		
+		ConcurrentLinkedQueue<Runnable> queue = queues[c.node];
+		for (int i = 1; i < parts.length; ++i)
+			queue.offer(new Part (parts[i], pending, error));
+		
+		wakeup (parts.length - 1);
+		
+		c.nested = true;
+		try {
+			new Part (parts[0], pending, error).run();
+			
+			while (pending.get() > 0) {
+				if (! runOne ())
+					Thread.yield();
+			}
+		} finally {
+			c.nested = false;
+		}
+		
+		Throwable e = error.get();
+		if (e instanceof RuntimeException)
+			throw (RuntimeException) e;
+		if (e instanceof Error)
+			throw (Error) e;
+		if (e != null)
+			throw new RuntimeException (e);
+	}
+	
+	/*
+	 * Runs `body` over [0, count), split into at most one range per idle worker
+	 * (plus the caller) with at least `grain` iterations per range.
+	 */
+	public void parallelFor (int count, int grain, Range body) {
+		
+		int parts = 1;
+		if (! context.get().nested)
+			parts = Math.max(1, Math.min(1 + numberOfIdleWorkers(), count / Math.max(1, grain)));
+		
+		if (parts == 1) {
+			if (count > 0)
+				body.run(0, count);
+			return;
+		}
+		
+		Runnable [] ranges = new Runnable [parts];
+		for (int i = 0; i < parts; ++i)
+			ranges [i] = new RangePart (body, (i * count) / parts, ((i + 1) * count) / parts);
+		
+		run (ranges);
+	}
+	
+	/* Unparks up to `count` parked intra-op threads */
+	private void wakeup (int count) {
+		IntraOpThread [] t = threads;
+		for (int i = 0; i < t.length && count > 0; ++i) {
+			if (t[i].parked) {
+				LockSupport.unpark(t[i]);
+				count --;
+			}
+		}
+	}
+}
@@ -40,6 +40,10 @@ public class TaskProcessor implements Runnable {
 	
 	private int tid; /* Thread id */
 	
+	/* Idle CPU workers run parts of other workers' tasks */
+	private IdleWorkerQueue helpers;
+	private boolean idle;
+	
 	public TaskProcessor (int pid, TaskQueue queue, int [][] matrix, ModelManager modelmanager, boolean GPU) {
 		
 		this.pid = pid;
@@ -59,6 +63,9 @@ public class TaskProcessor implements Runnable {
 		
 		for (int i = 0; i < N; i++)
 			this.tasksProcessed[i] = new AtomicLong (0L);
+		
+		helpers = IdleWorkerQueue.getInstance();
+		idle = false;
 	}
 	
 	public void run() {
@@ -82,6 +89,7 @@ public class TaskProcessor implements Runnable {
 			
 		} else {
 			TheCPU.getInstance().bind(pid + 1);
+			helpers.register(pid + 1);
 		}
 		
 		tid = ThreadMap.getInstance().register(Thread.currentThread().getId());
@@ -103,6 +111,14 @@ public class TaskProcessor implements Runnable {
 					replicaId = modelmanager.acquireAccess (clock);
 				
 				while ((task = queue.poll(matrix, deviceId, replicaId, clock[0])) == null) {
+					if (! GPU) {
+						if (! idle) {
+							idle = true;
+							helpers.idle();
+						}
+						if (helpers.runOne())
+							continue;
+					}
 					LockSupport.parkNanos(1L);
 					if (stop)
 						continue retry;
@@ -118,6 +134,10 @@ public class TaskProcessor implements Runnable {
 					} else
 						replicaId = modelmanager.upgradeAccess(replicaId, clock);
 				}
+				if (idle) {
+					idle = false;
+					helpers.busy();
+				}
 				/*
 				 * Early release
 				 *
@@ -65,6 +65,9 @@ public class TaskProcessorPool {
 	}
 	
 	public TaskQueue start (Executor executor) {
+		/* Start intra-op threads (CPU workers run parts of their tasks on them) */
+		if (SystemConf.getInstance().getCPU())
+			IdleWorkerQueue.getInstance().start(SystemConf.getInstance().numberOfIntraOpThreads(), SystemConf.getInstance().getCoreMapper().getIntraOpThreadOffset());
 		for (int i = 0; i < workers; i++)
 			executor.execute(processor[i]);
 		return queue;
@@ -84,6 +87,9 @@ public class TaskProcessorPool {
 		for (int i = 0; i < workers; i++)
 			processor[i].shutdown(signal);
 		signal.await();
+		
+		if (SystemConf.getInstance().getCPU())
+			IdleWorkerQueue.getInstance().stop();
 		return;
 	}
 }
@@ -1,59 +1,164 @@
 package uk.ac.imperial.lsds.crossbow.task;
 
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicLong;
+
 import uk.ac.imperial.lsds.crossbow.SystemConf;
 import uk.ac.imperial.lsds.crossbow.types.SchedulingPolicy;
 
 /*
  * Based on the non-blocking queue of M. Herlihy and N. Shavit
  * from "The Art of Multiprocessor programming".
+ *
+ * Workers still take the first task (in FIFO order) that they can run, but
+ * the queue keeps a small index so that neither side walks the whole list
+ * when it does not have to:
+ *
+ * - `last` points to the most recently added task, so that `add()` does not
+ *   search for the tail;
+ *
+ * - `unbound` counts queued tasks that a worker can run regardless of its
+ *   model replica, and `bounds` holds a lower bound on the clock that the
+ *   other tasks require. A worker without a replica, or whose replica is
+ *   too old, thus fails a `poll()` without a scan.
  */
 public class TaskQueue {
 	
 	private SchedulingPolicy policy;
 	
-	private AbstractTask head;
+	private AbstractTask head, tail;
+	
+	/*
+	 * The last task added. Producers append after it, unless a worker has
+	 * removed it in the meantime (its `next` is marked, or is no longer the
+	 * tail), in which case they fall back to searching for the tail.
+	 */
+	private AbstractTask last;
+	private final Object producers = new Object ();
+	
+	private AtomicInteger count;
+	private AtomicInteger unbound;
+	
+	/*
+	 * The upper 32 bits count `add()` calls; the lower 32 bits are at most the
+	 * smallest lower bound of the queued tasks that require a replica. Adding
+	 * a task can only lower the bound; a worker that scans the queue without
+	 * finding a task raises it to the smallest bound it saw, provided that no
+	 * task was added during the scan.
+	 *
+	 * A task that requires a replica lowers the bound twice: before it is
+	 * linked, so that `skip()` never hides it, and again after, so that a
+	 * scan that started before the task was linked (and did not see it)
+	 * can no longer raise the bound above it.
+	 */
+	private AtomicLong bounds;
 	
 	public TaskQueue () {
 		policy = SystemConf.getInstance().getSchedulingPolicy();
 		head = new Task ();
-		AbstractTask tail = new Task (Integer.MAX_VALUE, null, null, null, null);
+		tail = new Task (Integer.MAX_VALUE, null, null, null, null);
 		while (! head.next.compareAndSet(null, tail, false, false));
+		last = head;
+		count = new AtomicInteger (0);
+		unbound = new AtomicInteger (0);
+		bounds = new AtomicLong (pack (0, Integer.MAX_VALUE));
+	}
+	
+	private static long pack (int epoch, int bound) {
+		return (((long) epoch) << 32) | (((long) bound) & 0xFFFFFFFFL);
+	}
+	
+	private static int epochOf (long value) {
+		return (int) (value >>> 32);
+	}
+	
+	private static int boundOf (long value) {
+		return (int) value;
+	}
+	
+	/* Starts a new epoch, with a bound of at most `bound` */
+	private void lowerBound (int bound) {
+		long value;
+		do {
+			value = bounds.get();
+		} while (! bounds.compareAndSet(value, pack (epochOf (value) + 1, Math.min(boundOf (value), bound))));
 	}
 	
 	/*
-	 * Inserts task at the end of the queue (lock-free)
+	 * Inserts task at the end of the queue (lock-free for workers; producers,
+	 * i.e. task dispatchers, serialise among themselves)
 	 */
 	public boolean add (AbstractTask task) {
-		while (true) {
-			TaskWindow window = TaskWindow.findTail (head);
-			AbstractTask pred = window.pred;
-			AbstractTask curr = window.curr;
-			if (curr.taskId != Integer.MAX_VALUE) {
-				return false;
-			} else {
-				task.next.set(curr, false);
-				if (pred.next.compareAndSet(curr, task, false, false)) {
-					return true; 
+		/* Account for the task before it becomes visible to workers */
+		count.incrementAndGet();
+		if (TaskWindow.requiresReplica (task)) {
+			lowerBound (task.lowerBound);
+		} else {
+			unbound.incrementAndGet();
+			bounds.addAndGet(1L << 32);
+		}
+		synchronized (producers) {
+			/*
+			 * Tasks are only linked here, so if `last` is unmarked and still
+			 * points to the tail, it is the last task in the queue. (If `last`
+			 * is the task itself, it has been removed and recycled.)
+			 */
+			task.next.set(tail, false);
+			if (last == task || (! last.next.compareAndSet(tail, task, false, false))) {
+				while (true) {
+					TaskWindow window = TaskWindow.findTail (head);
+					AbstractTask pred = window.pred;
+					AbstractTask curr = window.curr;
+					if (curr.taskId != Integer.MAX_VALUE) {
+						count.decrementAndGet();
+						if (! TaskWindow.requiresReplica (task))
+							unbound.decrementAndGet();
+						return false;
+					} else {
+						task.next.set(curr, false);
+						if (pred.next.compareAndSet(curr, task, false, false))
+							break;
+					}
 				}
 			}
+			last = task;
+			
+			if (TaskWindow.requiresReplica (task))
+				lowerBound (task.lowerBound);
 		}
+		return true;
+	}
+	
+	/* Returns true if no queued task can be selected by the worker */
+	private boolean skip (Integer replicaId, int clock) {
+		if (unbound.get() > 0)
+			return false;
+		if (replicaId == null)
+			return true;
+		return (clock < boundOf (bounds.get()));
 	}
 	
 	private AbstractTask getNextTask (int [][] matrix, int p, Integer replicaId, int clock) {
 		boolean snip;
+		int [] bound = { Integer.MAX_VALUE };
 		while (true) {
 			
+			long value = bounds.get();
+			
 			TaskWindow window;
 			if (policy == SchedulingPolicy.HLS)
-				window = TaskWindow.findNextSkipCost(head, matrix, p, replicaId, clock);
+				window = TaskWindow.findNextSkipCost(head, matrix, p, replicaId, clock, bound);
 			else
-				window = TaskWindow.find (head, replicaId, clock);
+				window = TaskWindow.find (head, replicaId, clock, bound);
 			
 			AbstractTask pred = window.pred;
 			AbstractTask curr = window.curr;
 			
 			/* Check if `curr` is not the tail of the queue */
 			if (curr.taskId == Integer.MAX_VALUE) {
+				/* Tighten the bound, unless a task has been added since we read it */
+				if (bound[0] > boundOf (value))
+					bounds.compareAndSet(value, pack (epochOf (value), bound[0]));
 				return null;
 			} else {
 				/* Mark `curr` as logically removed */
@@ -61,8 +166,11 @@ public class TaskQueue {
 				snip = curr.next.compareAndSet(succ, succ, false, true);
 				if (!snip)
 					continue;
-				pred.next.compareAndSet(curr, succ, false, false); 
+				pred.next.compareAndSet(curr, succ, false, false);
 				/* Nodes are rewired */
+				count.decrementAndGet();
+				if (! TaskWindow.requiresReplica (curr))
+					unbound.decrementAndGet();
 				return curr;
 			}
 		}
@@ -71,26 +179,20 @@ public class TaskQueue {
 	public AbstractTask poll (int [][] matrix, int p, Integer replicaId, int clock) {
 		if (policy == SchedulingPolicy.NULL)
 			return null;
+		if (skip (replicaId, clock))
+			return null;
 		return getNextTask(matrix, p, replicaId, clock);
 	}
 	
-	/* 
-	 * Wait-free, but approximate queue size 
+	/*
+	 * Wait-free, but approximate queue size
 	 */
 	public int size () {
-		boolean [] marked = { false };
-		int count = 0;
-		AbstractTask t;
-		for (t = head.next.getReference(); t != null && !marked[0]; t = t.next.get(marked)) {
-			if (t.taskId < Integer.MAX_VALUE) {
-				count ++;
-			}
-		}
-		return count;
+		return Math.max(0, count.get());
 	}
 	
-	/* 
-	 * Wait-free, but approximate print out (for debugging) 
+	/*
+	 * Wait-free, but approximate print out (for debugging)
 	 */
 	public void dump (int limit) {
 		boolean [] marked = { false };
@@ -86,6 +86,14 @@ class TaskWindow {
 		}
 	}
 	
+	/* 
+	 * True if task `t` can only run on a worker that holds a model replica
+	 * with a clock of at least `t.lowerBound` (see cases 3 & 7 below)
+	 */
+	public static boolean requiresReplica (AbstractTask t) {
+		return (t.replicaId == null && t.access.compareTo(ModelAccess.NA) > 0);
+	}
+	
 	private static boolean select (AbstractTask t, Integer replicaId, int clock) {
 		//
 		// There are the following basic options:
@@ -127,7 +135,7 @@ class TaskWindow {
 		// The worker's replica does not matter. X is released early.
 		//
 		// System.out.println(String.format("[DBG] select: t %04d t.lowerBound=%d t.replica=%s worker.replica=%s clock=%d", t.taskid, t.lowerBound, t.replicaId, replicaId, clock));
-		if (t.replicaId == null && t.access.compareTo(ModelAccess.NA) > 0) {
+		if (requiresReplica (t)) {
 			// System.out.println(String.format("[DBG] select: t %04d t.replica=%s worker.replica=%s clock=%d", t.taskid, t.replicaId, replicaId, clock));
 			if (replicaId == null) {
 				return false;
@@ -146,13 +154,18 @@ class TaskWindow {
 		return true;
 	}
 	
-	public static TaskWindow find (AbstractTask head, Integer replicaId, int clock) {
+	/*
+	 * If no task is selected, `bound[0]` holds the smallest lower bound of
+	 * the tasks that require a replica (or Integer.MAX_VALUE if there are none).
+	 */
+	public static TaskWindow find (AbstractTask head, Integer replicaId, int clock, int [] bound) {
 		AbstractTask pred = null;
 		AbstractTask curr = null;
 		AbstractTask succ = null;
 		boolean [] marked = { false };
 		boolean snip;
 		retry: while (true) {
+			bound[0] = Integer.MAX_VALUE;
 			pred = head;
 			curr = pred.next.getReference();
 			while (true) {
@@ -175,13 +188,16 @@ class TaskWindow {
 				if (select(curr, replicaId, clock))
 					return new TaskWindow (pred, curr);
 				
+				if (requiresReplica (curr) && curr.lowerBound < bound[0])
+					bound[0] = curr.lowerBound;
+				
 				pred = curr;
 				curr = succ;
 			}
 		}
 	}
 	
-	public static TaskWindow findNextSkipCost (AbstractTask head, int[][] policy, int p, Integer replicaId, int clock) {
+	public static TaskWindow findNextSkipCost (AbstractTask head, int[][] policy, int p, Integer replicaId, int clock, int [] bound) {
 		AbstractTask pred = null;
 		AbstractTask curr = null;
 		AbstractTask succ = null;
@@ -190,6 +206,7 @@ class TaskWindow {
 		int _p = (p + 1) % 2; /* The other processor */
 		double skip_cost = 0.;
 		retry: while (true) {
+			bound[0] = Integer.MAX_VALUE;
 			pred = head;
 			curr = pred.next.getReference();
 			if (curr.taskId == Integer.MAX_VALUE)
@@ -219,6 +236,9 @@ class TaskWindow {
 				
 				skip_cost += 1. / (double) policy[_p][curr.graphId];
 				
+				if (requiresReplica (curr) && curr.lowerBound < bound[0])
+					bound[0] = curr.lowerBound;
+				
 				pred = curr;
 				curr = succ;
 			}
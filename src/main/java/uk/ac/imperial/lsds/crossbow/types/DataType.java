@@ -1,8 +1,13 @@
 package uk.ac.imperial.lsds.crossbow.types;
 
+/*
+ * Types `UINT8`, `INT8` and `FP16` are compact, on-disk types for dataset
+ * examples: they are widened to `FLOAT` (see `DataTransform`) as a batch is
+ * processed, scaled and shifted by the factors stored in dataset metadata.
+ */
 public enum DataType {
 	
-	INT (0), FLOAT (1);
+	INT (0), FLOAT (1), UINT8 (2), INT8 (3), FP16 (4);
 	
 	private int id;
 	
@@ -11,9 +16,20 @@ public enum DataType {
 		this.id = id;
 	}
 	
+	public int getId () {
+		
+		return id;
+	}
+	
 	public int sizeOf () {
 		
-		return 4;
+		switch (id) {
+		case 2:
+		case 3: return 1;
+		case 4: return 2;
+		default:
+			return 4;
+		}
 	}
 	
 	public String toString () {
@@ -21,6 +37,9 @@ public enum DataType {
 		switch (id) {
 		case 0: return   "int";
 		case 1: return "float";
+		case 2: return "uint8";
+		case 3: return  "int8";
+		case 4: return  "fp16";
 		default:
 			throw new IllegalArgumentException ("error: invalid data type");
 		}
@@ -36,6 +55,12 @@ public enum DataType {
 		return (id == 1);
 	}
 	
+	/* True if values must be widened to float before use */
+	public boolean isCompact () {
+		
+		return (id > 1);
+	}
+	
 	public static DataType fromString (String type) {
 		
 		if ("int".equals(type)) {
@@ -44,6 +69,15 @@ public enum DataType {
 		else if ("float".equals(type)) {
 			return FLOAT;
 		}
+		else if ("uint8".equals(type)) {
+			return UINT8;
+		}
+		else if ("int8".equals(type)) {
+			return INT8;
+		}
+		else if ("fp16".equals(type)) {
+			return FP16;
+		}
 		else {
 			throw new IllegalArgumentException (String.format("error: invalid data type: %s", type));
 		}
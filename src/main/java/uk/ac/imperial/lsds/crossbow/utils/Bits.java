@@ -1,6 +1,8 @@
 package uk.ac.imperial.lsds.crossbow.utils;
 
 import java.lang.reflect.Field;
+import java.nio.Buffer;
+import java.nio.ByteBuffer;
 import java.nio.ByteOrder;
 import java.security.AccessController;
 
@@ -14,6 +16,8 @@ import sun.misc.Unsafe;
 public class Bits {
 
 	private static final Unsafe unsafe;
+	
+	private static final long addressOffset;
 
 	private static final ByteOrder byteOrder;
 	
@@ -31,6 +35,8 @@ public class Bits {
 			Field theUnsafe = Unsafe.class.getDeclaredField("theUnsafe");
 			theUnsafe.setAccessible(true);
 			unsafe = (Unsafe) theUnsafe.get (null);
+			
+			addressOffset = unsafe.objectFieldOffset (Buffer.class.getDeclaredField("address"));
 		} 
 		catch (Exception e) {
 			throw new AssertionError(e);
@@ -41,6 +47,13 @@ public class Bits {
 		return unsafe;
 	}
 	
+	/* The native address of a direct byte buffer */
+	public static long address (ByteBuffer buffer) {
+		if (! buffer.isDirect())
+			throw new IllegalArgumentException ("error: byte buffer is not direct");
+		return unsafe.getLong (buffer, addressOffset);
+	}
+	
 	public static boolean unaligned () {
 
 		if (unalignedKnown)
@@ -0,0 +1,79 @@
+package uk.ac.imperial.lsds.crossbow.utils;
+
+/*
+ * Conversions between single and IEEE 754 half-precision floating-point
+ * values (for `DataType.FP16` dataset examples).
+ */
+public class HalfPrecision {
+
+	private HalfPrecision () {
+
+	}
+
+	public static float toFloat (short value) {
+
+		int h = value & 0xFFFF;
+
+		int sign = (h & 0x8000) << 16;
+		int exponent = (h >>> 10) & 0x1F;
+		int mantissa = h & 0x3FF;
+
+		if (exponent == 0x1F) {
+			/* Infinity or NaN */
+			return Float.intBitsToFloat (sign | 0x7F800000 | (mantissa << 13));
+		}
+		if (exponent == 0) {
+			/* Zero or subnormal: mantissa x 2^-24 */
+			float f = mantissa * 5.9604644775390625e-8F;
+			return (sign == 0) ? f : -f;
+		}
+		return Float.intBitsToFloat (sign | ((exponent + 112) << 23) | (mantissa << 13));
+	}
+
+	/* Rounds to the nearest half-precision value (ties to even) */
+	public static short fromFloat (float value) {
+
+		int bits = Float.floatToRawIntBits (value);
+
+		int sign = (bits >>> 16) & 0x8000;
+		int exponent = (bits >>> 23) & 0xFF;
+		int mantissa = bits & 0x7FFFFF;
+
+		if (exponent == 0xFF) {
+			/* Infinity or NaN */
+			return (short) (sign | 0x7C00 | ((mantissa != 0) ? 0x200 : 0));
+		}
+
+		/* Re-bias exponent */
+		int e = exponent - 112;
+
+		if (e >= 0x1F) {
+			/* Overflow */
+			return (short) (sign | 0x7C00);
+		}
+
+		int half, rest, mid;
+
+		if (e <= 0) {
+			/* Subnormal (or zero) */
+			if (e < -10)
+				return (short) sign;
+			mantissa |= 0x800000;
+			int shift = 14 - e;
+			half = mantissa >>> shift;
+			rest = mantissa & ((1 << shift) - 1);
+			mid = 1 << (shift - 1);
+		}
+		else {
+			half = (e << 10) | (mantissa >>> 13);
+			rest = mantissa & 0x1FFF;
+			mid = 0x1000;
+		}
+
+		/* A carry may round up into the exponent (or to infinity), as it should */
+		if ((rest > mid) || ((rest == mid) && ((half & 1) != 0)))
+			half++;
+
+		return (short) (sign | half);
+	}
+}
@@ -0,0 +1,63 @@
+package uk.ac.imperial.lsds.crossbow.utils;
+
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
+
+/*
+ * Philox-4x32-10, a counter-based random number generator: block i of a
+ * stream is a pure function of its counter (first + i, epoch, stream, 0)
+ * and its key (the random seed), so streams are reproducible, need no
+ * shared state, and can be generated in bulk. The native implementation
+ * (cpukernels/philox.c) produces the same values.
+ */
+public class Philox {
+
+	private static final int M0 = 0xD2511F53;
+	private static final int M1 = 0xCD9E8D57;
+	private static final int W0 = 0x9E3779B9;
+	private static final int W1 = 0xBB67AE85;
+
+	private Philox () {
+
+	}
+
+	/* Fills `y` with `blocks` blocks of 4 words each */
+	public static void fill (int [] y, int blocks, int first, int epoch, int stream, long seed) {
+
+		if (CPUKernels.getInstance().isEnabled()) {
+			CPUKernels.getInstance().philox (y, blocks, first, epoch, stream, seed);
+			return;
+		}
+
+		int k0 = (int) seed, k1 = (int) (seed >>> 32);
+
+		for (int i = 0; i < blocks; ++i) {
+
+			int c0 = first + i, c1 = epoch, c2 = stream, c3 = 0;
+			int key0 = k0, key1 = k1;
+
+			for (int round = 0; round < 10; ++round) {
+
+				long p0 = (M0 & 0xFFFFFFFFL) * (c0 & 0xFFFFFFFFL);
+				long p1 = (M1 & 0xFFFFFFFFL) * (c2 & 0xFFFFFFFFL);
+
+				c0 = ((int) (p1 >>> 32)) ^ c1 ^ key0;
+				c1 = (int) p1;
+				c2 = ((int) (p0 >>> 32)) ^ c3 ^ key1;
+				c3 = (int) p0;
+
+				key0 += W0;
+				key1 += W1;
+			}
+			y [4 * i    ] = c0;
+			y [4 * i + 1] = c1;
+			y [4 * i + 2] = c2;
+			y [4 * i + 3] = c3;
+		}
+	}
+
+	/* Maps a random word to [0, n) */
+	public static int bounded (int x, int n) {
+
+		return (int) (((x & 0xFFFFFFFFL) * n) >>> 32);
+	}
+}
@@ -44,6 +44,9 @@ public class MatrixFactorisation {
 		int __wpc = 637; // 2267; // 10000000;
 		int __slack = 0;
 		
+		boolean __sparse = false;
+		boolean __striped_locks = false;
+		
 		long startTime, dt;
 		
 		for (i = 0; i < args.length; ) {
@@ -83,6 +86,12 @@ public class MatrixFactorisation {
 			} else
 			if (args[i].equals("--slack")) {
 				__slack = Integer.parseInt(args[j]);
+			} else
+			if (args[i].equals("--sparse")) {
+				__sparse = Boolean.parseBoolean(args[j]);
+			} else
+			if (args[i].equals("--striped-locks")) {
+				__striped_locks = Boolean.parseBoolean(args[j]);
 			} else {
 				System.err.println(String.format("error: unknown flag %s %s", args[i], args[j]));
 				System.exit(1);
@@ -114,7 +123,9 @@ public class MatrixFactorisation {
 			.setNumberOfRows(U)
 			.setNumberOfColumns(D)
 			.setLambda(lambda)
-			.setLearningRateEta0(rate);
+			.setLearningRateEta0(rate)
+			.setSparseUpdates(__sparse)
+			.setStripedLocks(__striped_locks);
 		
 		Operator op1 = new Operator ("MatFact", new MatFact(conf));
 		
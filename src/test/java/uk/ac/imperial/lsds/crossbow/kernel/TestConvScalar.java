@@ -0,0 +1,140 @@
+package uk.ac.imperial.lsds.crossbow.kernel;
+
+import uk.ac.imperial.lsds.crossbow.Batch;
+import uk.ac.imperial.lsds.crossbow.DataflowNode;
+import uk.ac.imperial.lsds.crossbow.Operator;
+import uk.ac.imperial.lsds.crossbow.SystemConf;
+import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
+import uk.ac.imperial.lsds.crossbow.device.blas.BLAS;
+import uk.ac.imperial.lsds.crossbow.device.kernel.CPUKernels;
+import uk.ac.imperial.lsds.crossbow.device.random.RandomGenerator;
+import uk.ac.imperial.lsds.crossbow.kernel.conf.ConvConf;
+import uk.ac.imperial.lsds.crossbow.model.InitialiserConf;
+import uk.ac.imperial.lsds.crossbow.model.Model;
+import uk.ac.imperial.lsds.crossbow.model.Shape;
+import uk.ac.imperial.lsds.crossbow.model.Variable;
+import uk.ac.imperial.lsds.crossbow.task.ITask;
+import uk.ac.imperial.lsds.crossbow.types.InitialiserType;
+import uk.ac.imperial.lsds.crossbow.types.Phase;
+
+/*
+ * Checks that a (1 x 1) convolution computes the same output whether it
+ * multiplies its input directly (the scalar path) or lowers it first with
+ * im2col (which, for a 1 x 1 kernel, is the identity).
+ */
+public class TestConvScalar {
+
+	private static ITask task = new ITask () {
+
+		public void outputBatchResult (Batch batch) {
+		}
+
+		public boolean isValidationTask () {
+			return false;
+		}
+
+		public Phase getPhase () {
+			return Phase.TRAIN;
+		}
+
+		public boolean isGPUTask () {
+			return false;
+		}
+
+		public Operator getPrevious (Operator operator) {
+			return null;
+		}
+
+		public boolean isMostDownstream (Operator operator) {
+			return true;
+		}
+
+		public boolean isMostUpstream (Operator operator) {
+			return true;
+		}
+	};
+
+	private static float [] compute (Operator operator, Model model, IDataBuffer input, int bytes) {
+
+		Batch batch = new Batch (0, 0, new IDataBuffer [] { input, null }, null, new long [] { 0L, 0L }, new long [] { bytes, 0L }, null, Operator.cardinality());
+
+		operator.getKernel().compute (null, batch, model, task);
+
+		IDataBuffer output = batch.getOutput(operator.getId()).peek();
+
+		float [] result = new float [operator.getOutputShape().countAllElements()];
+		for (int i = 0; i < result.length; ++i)
+			result [i] = output.getFloat(i * 4);
+
+		return result;
+	}
+
+	public static void main (String [] args) throws Exception {
+
+		int batchSize = 8;
+		int channels = 16;
+		int outputs = 32;
+		int height = 7, width = 7;
+
+		SystemConf.getInstance().setCPU(true).setGPU(false);
+
+		BLAS.getInstance().init();
+		CPUKernels.getInstance().load();
+		CPUKernels.getInstance().init();
+
+		RandomGenerator.getInstance().load();
+		RandomGenerator.getInstance().init(SystemConf.getInstance().getRandomSeed());
+
+		ConvConf conf = new ConvConf ();
+
+		conf.setNumberOfOutputs (outputs);
+		conf.setBias (true);
+
+		conf.setKernelSize (2).setKernelHeight (1).setKernelWidth (1);
+		conf.setStrideSize (2).setStrideHeight (1).setStrideWidth (1);
+		conf.setPaddingSize (2).setPaddingHeight (0).setPaddingWidth (0);
+
+		conf.setWeightInitialiser (new InitialiserConf().setType(InitialiserType.GAUSSIAN).setStd(0.1F));
+		conf.setBiasInitialiser   (new InitialiserConf().setType(InitialiserType.CONSTANT).setValue(0.5F));
+
+		Conv kernel = new Conv (conf);
+		Operator conv = new Operator ("conv", kernel);
+		conv.setDataflowNode (Phase.TRAIN, new DataflowNode (conv));
+
+		Shape shape = new Shape (new int [] { batchSize, channels, height, width });
+
+		Model model = new Model ();
+		conv.init (new Shape [] { shape }, model);
+		model.finalise (Operator.cardinality());
+
+		if (! kernel.scalar)
+			throw new IllegalStateException ("error: expected a scalar (1 x 1) convolution");
+
+		Variable input = new Variable ("input", shape, false);
+		input.initialise (new InitialiserConf().setType(InitialiserType.GAUSSIAN).setStd(1F));
+
+		int bytes = shape.countAllElements() * 4;
+
+		float [] expected, actual;
+
+		kernel.scalar = false;
+		expected = compute (conv, model, input.getDataBuffer(), bytes);
+
+		kernel.scalar = true;
+		actual = compute (conv, model, input.getDataBuffer(), bytes);
+
+		int errors = 0;
+		for (int i = 0; i < expected.length; ++i) {
+			if (Math.abs(expected[i] - actual[i]) > 1e-4F * Math.max(1F, Math.abs(expected[i]))) {
+				if (errors < 10)
+					System.out.println(String.format("output[%d] is %.6f (expected %.6f)", i, actual[i], expected[i]));
+				errors ++;
+			}
+		}
+
+		System.out.println(String.format("%d out of %d outputs differ", errors, expected.length));
+
+		System.out.println("Bye.");
+		System.exit((errors == 0) ? 0 : 1);
+	}
+}
@@ -0,0 +1,149 @@
+package uk.ac.imperial.lsds.crossbow.kernel;
+
+import java.util.Random;
+
+import uk.ac.imperial.lsds.crossbow.Batch;
+import uk.ac.imperial.lsds.crossbow.DataflowNode;
+import uk.ac.imperial.lsds.crossbow.ModelConf;
+import uk.ac.imperial.lsds.crossbow.Operator;
+import uk.ac.imperial.lsds.crossbow.SystemConf;
+import uk.ac.imperial.lsds.crossbow.data.DataBuffer;
+import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
+import uk.ac.imperial.lsds.crossbow.device.blas.BLAS;
+import uk.ac.imperial.lsds.crossbow.device.random.RandomGenerator;
+import uk.ac.imperial.lsds.crossbow.kernel.conf.MatFactConf;
+import uk.ac.imperial.lsds.crossbow.model.Model;
+import uk.ac.imperial.lsds.crossbow.model.Shape;
+import uk.ac.imperial.lsds.crossbow.model.VariableGradient;
+import uk.ac.imperial.lsds.crossbow.task.ITask;
+import uk.ac.imperial.lsds.crossbow.types.DataType;
+import uk.ac.imperial.lsds.crossbow.types.Phase;
+
+/*
+ * Checks that the MatFact kernel computes the same gradient whether its
+ * model variables have dense or row-sparse gradients.
+ */
+public class TestMatFactGradient {
+
+	private static final int USERS = 100, ITEMS = 80, LATENTS = 16;
+
+	private static final int EXAMPLES = 32;
+
+	private static ITask task = new ITask () {
+
+		public void outputBatchResult (Batch batch) {
+		}
+
+		public boolean isValidationTask () {
+			return false;
+		}
+
+		public Phase getPhase () {
+			return Phase.TRAIN;
+		}
+
+		public boolean isGPUTask () {
+			return false;
+		}
+
+		public Operator getPrevious (Operator operator) {
+			return null;
+		}
+
+		public boolean isMostDownstream (Operator operator) {
+			return true;
+		}
+
+		public boolean isMostUpstream (Operator operator) {
+			return true;
+		}
+	};
+
+	/* Returns the user and item gradients of one batch, with the given sparse gradient threshold */
+	private static float [][] compute (float threshold, IDataBuffer examples, IDataBuffer labels) {
+
+		ModelConf.getInstance().setSparseGradientThreshold (threshold);
+
+		MatFactConf conf = new MatFactConf ()
+			.setNumberOfLatentVariables (LATENTS)
+			.setNumberOfRows (USERS)
+			.setNumberOfColumns (ITEMS)
+			.setLambda (0.1F)
+			.setLearningRateEta0 (0.01F);
+
+		MatFact kernel = new MatFact (conf);
+		Operator matfact = new Operator ("matfact", kernel);
+		matfact.setDataflowNode (Phase.TRAIN, new DataflowNode (matfact));
+
+		Model model = new Model ();
+		matfact.init (new Shape [] { new Shape (new int [] { EXAMPLES, 2 }) }, model);
+		model.finalise (Operator.cardinality());
+
+		/* Same (random) model in every run */
+		Random random = new Random (1L);
+		for (int order = 1; order <= 2; ++order) {
+			IDataBuffer buffer = model.getVariable (matfact.getId(), order).getDataBuffer();
+			for (int offset = 0; offset < buffer.limit(); offset += 4)
+				buffer.putFloat (offset, random.nextFloat());
+		}
+
+		Batch batch = new Batch (0, 0, new IDataBuffer [] { examples, labels }, null, new long [] { 0L, 0L }, new long [] { examples.limit(), labels.limit() }, null, Operator.cardinality());
+
+		kernel.compute (null, batch, model, task);
+
+		float [][] result = new float [2][];
+		for (int order = 1; order <= 2; ++order) {
+			VariableGradient gradient = batch.getModelGradient().getVariableGradient (matfact.getId(), order);
+			/* Untouched rows of a sparse gradient are stale */
+			gradient.densify ();
+			IDataBuffer buffer = gradient.getDataBuffer();
+			result [order - 1] = new float [buffer.limit() / 4];
+			for (int i = 0; i < result [order - 1].length; ++i)
+				result [order - 1][i] = buffer.getFloat(i * 4);
+		}
+		return result;
+	}
+
+	public static void main (String [] args) throws Exception {
+
+		SystemConf.getInstance().setCPU(true).setGPU(false);
+
+		BLAS.getInstance().init();
+
+		RandomGenerator.getInstance().load();
+		RandomGenerator.getInstance().init(SystemConf.getInstance().getRandomSeed());
+
+		/* Few distinct users and items, so that rows are updated more than once */
+		Random random = new Random (2L);
+
+		IDataBuffer examples = new DataBuffer (EXAMPLES * 8, DataType.INT);
+		IDataBuffer labels   = new DataBuffer (EXAMPLES * 4, DataType.FLOAT);
+		examples.finalise (EXAMPLES * 8);
+		labels.finalise (EXAMPLES * 4);
+
+		for (int i = 0; i < EXAMPLES; ++i) {
+			examples.putInt (i * 8,     1 + random.nextInt (10));
+			examples.putInt (i * 8 + 4, 1 + random.nextInt (10));
+			labels.putFloat (i * 4, 1F + 4F * random.nextFloat());
+		}
+
+		float [][] dense  = compute (0F,   examples, labels);
+		float [][] sparse = compute (0.5F, examples, labels);
+
+		int errors = 0;
+		for (int k = 0; k < 2; ++k) {
+			for (int i = 0; i < dense [k].length; ++i) {
+				if (Math.abs(dense [k][i] - sparse [k][i]) > 1e-6F * Math.max(1F, Math.abs(dense [k][i]))) {
+					if (errors < 10)
+						System.out.println(String.format("%s gradient[%d] is %.6f (expected %.6f)", ((k == 0) ? "user" : "item"), i, sparse [k][i], dense [k][i]));
+					errors ++;
+				}
+			}
+		}
+
+		System.out.println(String.format("%d out of %d gradient values differ", errors, dense[0].length + dense[1].length));
+
+		System.out.println("Bye.");
+		System.exit((errors == 0) ? 0 : 1);
+	}
+}
@@ -0,0 +1,80 @@
+package uk.ac.imperial.lsds.crossbow.microbenchmarks.queues;
+
+import java.util.concurrent.atomic.AtomicMarkableReference;
+
+import uk.ac.imperial.lsds.crossbow.Batch;
+import uk.ac.imperial.lsds.crossbow.Operator;
+import uk.ac.imperial.lsds.crossbow.task.AbstractTask;
+import uk.ac.imperial.lsds.crossbow.task.TaskQueue;
+import uk.ac.imperial.lsds.crossbow.types.ModelAccess;
+import uk.ac.imperial.lsds.crossbow.utils.Queued;
+
+/*
+ * The executor's task queue, wrapped so that it can be compared with the
+ * other implementations. Items are carried by tasks that require R/W
+ * access to a model replica, as training tasks do.
+ */
+public class ExecutorTaskQueueImpl<T extends Queued> implements ITaskQueue<T> {
+
+	class QueuedTask extends AbstractTask {
+
+		T item;
+
+		QueuedTask (T item) {
+
+			this.item = item;
+
+			taskId = item.getKey();
+			graphId = 0;
+
+			access = ModelAccess.RW;
+			replicaId = null;
+			lowerBound = 0;
+
+			next = new AtomicMarkableReference<AbstractTask>(null, false);
+		}
+
+		public int run () { return 0; }
+
+		public void free () { }
+
+		public void outputBatchResult (Batch batch) { }
+
+		public Operator getPrevious (Operator operator) { return null; }
+
+		public boolean isMostDownstream (Operator operator) { return false; }
+
+		public boolean isMostUpstream (Operator operator) { return false; }
+	}
+
+	private TaskQueue queue;
+
+	/* Single processor class, with equal preference for every task */
+	private int [][] matrix = { { 1 }, { 1 } };
+
+	public ExecutorTaskQueueImpl () {
+		queue = new TaskQueue ();
+	}
+
+	public int size () {
+		return queue.size();
+	}
+
+	public boolean add (T item) {
+		return queue.add(new QueuedTask (item));
+	}
+
+	/* A worker that holds an up-to-date model replica */
+	@SuppressWarnings("unchecked")
+	public T poll () {
+		AbstractTask task = queue.poll(matrix, 0, Integer.valueOf(0), Integer.MAX_VALUE);
+		return (task == null) ? null : ((QueuedTask) task).item;
+	}
+
+	/* A worker that has failed to acquire a model replica: it never gets a task */
+	public T pollWithoutReplica () {
+		if (queue.poll(matrix, 0, null, -1) != null)
+			throw new IllegalStateException ("error: task selected without a model replica");
+		return null;
+	}
+}
@@ -138,6 +138,43 @@ public class TestTaskQueue {
 		}
 	}
 	
+	/*
+	 * Polls the executor's queue on behalf of a worker without a model
+	 * replica (e.g. a CPU worker whose replicas are all reserved), which
+	 * should cost little regardless of queue depth.
+	 */
+	static class IdlePoller implements Runnable {
+		
+		private ExecutorTaskQueueImpl<Example> queue;
+		
+		private volatile boolean stop = false;
+		
+		private AtomicLong count = new AtomicLong(0);
+		
+		public IdlePoller (ExecutorTaskQueueImpl<Example> queue) {
+			
+			this.queue = queue;
+		}
+		
+		public long getPolls () {
+			return count.get();
+		}
+		
+		public void run () {
+			
+			while (! stop) {
+				
+				queue.pollWithoutReplica();
+				count.incrementAndGet();
+			}
+		}
+		
+		public void shutdown () {
+			
+			stop = true;
+		}
+	}
+	
 	public static void main (String [] args) throws InterruptedException {
 		
 		int N = 8;
@@ -145,7 +182,13 @@ public class TestTaskQueue {
 		
 		long duration = 0L;
 		
-		int type = 3;
+		int type = 4;
+		
+		/* Keep at most `depth` tasks queued, as the dispatchers do (0 means no limit) */
+		int depth = 1000;
+		
+		/* Number of idle pollers (only for the executor's queue) */
+		int idle = 4;
 		
 		ITaskQueue<Example> queue;
 		
@@ -163,6 +206,11 @@ public class TestTaskQueue {
 		{
 			queue = new LockFreeTaskQueueImpl<Example>();
 		}
+		else 
+		if (4 == type)
+		{
+			queue = new ExecutorTaskQueueImpl<Example>();
+		}
 		else
 		{
 			queue = new BaseTaskQueueImpl<Example>();
@@ -185,6 +233,15 @@ public class TestTaskQueue {
 			executor.execute(workers[i]);
 		}
 		
+		IdlePoller [] pollers = new IdlePoller [(4 == type) ? idle : 0];
+		
+		for (int i = 0; i < pollers.length; ++i) {
+			
+			pollers[i] = new IdlePoller ((ExecutorTaskQueueImpl<Example>) queue);
+			
+			executor.execute(pollers[i]);
+		}
+		
 		Thread monitor = new Thread (new Monitor (queue, workers));
 		monitor.start();
 		
@@ -200,10 +257,9 @@ public class TestTaskQueue {
 			example.setId(id);
 			example.setPool(pool);
 			
-			/*
-			while (queue.size() > 1000)
-				;
-			*/
+			while (depth > 0 && queue.size() >= depth)
+				Thread.yield();
+			
 			if (! queue.add(example))
 				throw new IllegalStateException("error: failed to add task");
 			
@@ -217,6 +273,14 @@ public class TestTaskQueue {
 		long dt = System.nanoTime() - start;
 		System.out.println(String.format("dt = %.5f msecs\n", (double) dt / 1000000D));
 		
+		long polls = 0;
+		for (int i = 0; i < pollers.length; ++i) {
+			pollers[i].shutdown();
+			polls += pollers[i].getPolls();
+		}
+		if (pollers.length > 0)
+			System.out.println(String.format("%d idle polls (%.3f polls/s)", polls, (double) polls / ((double) dt / 1000000000D)));
+		
 		System.out.println("Shutting down...");
 		
 		CountDownLatch signal = new CountDownLatch (N);
@@ -0,0 +1,136 @@
+package uk.ac.imperial.lsds.crossbow.model;
+
+import java.io.File;
+import java.nio.file.Files;
+import java.util.Random;
+
+import uk.ac.imperial.lsds.crossbow.data.IDataBuffer;
+
+/*
+ * Writes full and incremental checkpoints of a model that changes between
+ * them, and checks that restoring a checkpoint (and the chain of checkpoints
+ * it depends on) recovers the model as it was at that clock.
+ */
+public class TestModelCheckpointer {
+
+	private static final int ROWS = 1000, COLUMNS = 16;
+
+	/* Every 3rd checkpoint is full */
+	private static final int FULL_CHECKPOINT_INTERVAL = 3;
+
+	private static final int CHECKPOINTS = 5;
+
+	private static Model createModel () {
+
+		Model model = new Model (1);
+		model.register (0, new Variable ("weights", new Shape (new int [] { ROWS, COLUMNS }), false));
+		model.register (0, new Variable ("bias",    new Shape (new int [] { COLUMNS }), false));
+		return model.finalise (1);
+	}
+
+	private static float [][] copy (Model model) {
+
+		Variable [] v = new Variable [model.getSize()];
+		ModelIterator<Variable> m = model.iterator();
+		for (int i = 0; m.hasNext(); ++i)
+			v[i] = m.next();
+
+		float [][] values = new float [v.length][];
+		for (int i = 0; i < v.length; ++i) {
+			IDataBuffer buffer = v[i].getDataBuffer();
+			values [i] = new float [buffer.limit() / 4];
+			for (int j = 0; j < values [i].length; ++j)
+				values [i][j] = buffer.getFloat(j * 4);
+		}
+		return values;
+	}
+
+	/* Returns the number of values that differ */
+	private static int compare (float [][] expected, float [][] actual) {
+
+		int errors = 0;
+		for (int i = 0; i < expected.length; ++i)
+			for (int j = 0; j < expected [i].length; ++j)
+				if (expected [i][j] != actual [i][j])
+					errors ++;
+		return errors;
+	}
+
+	private static int restore (File directory, int clock, float [][] expected) throws Exception {
+
+		Model model = createModel ();
+		int restored = ModelCheckpointer.restore (model, new File (directory, String.format("model-%d.ckpt", clock)));
+		int errors = compare (expected, copy (model));
+		if (restored != clock)
+			errors ++;
+		System.out.println(String.format("Restored checkpoint %d: %d values differ", restored, errors));
+		return errors;
+	}
+
+	public static void main (String [] args) throws Exception {
+
+		File directory = Files.createTempDirectory("crossbow-checkpoints").toFile();
+
+		Model model = createModel ();
+
+		Random random = new Random (1L);
+
+		ModelIterator<Variable> m = model.iterator();
+		while (m.hasNext()) {
+			IDataBuffer buffer = m.next().getDataBuffer();
+			for (int offset = 0; offset < buffer.limit(); offset += 4)
+				buffer.putFloat (offset, random.nextFloat());
+		}
+
+		ModelCheckpointer checkpointer = new ModelCheckpointer (model, directory.getPath(), FULL_CHECKPOINT_INTERVAL, 0);
+
+		float [][][] snapshots = new float [CHECKPOINTS][][];
+
+		int errors = 0;
+		for (int clock = 0; clock < CHECKPOINTS; ++clock) {
+
+			/* Change a few values, so that incremental checkpoints store only some blocks */
+			if (clock > 0) {
+				IDataBuffer weights = model.getVariable (0, 1).getDataBuffer();
+				for (int k = 0; k < 4; ++k)
+					weights.putFloat (random.nextInt (ROWS * COLUMNS) * 4, random.nextFloat());
+				model.getVariable (0, 2).getDataBuffer().putFloat (0, (float) clock);
+			}
+
+			snapshots [clock] = copy (model);
+
+			if (! checkpointer.checkpoint (clock))
+				throw new IllegalStateException (String.format("error: checkpoint at clock %d was skipped", clock));
+			checkpointer.flush ();
+
+			/* Checkpoint 2 depends on checkpoints 1 and 0, which are deleted by the next full one */
+			if (clock == 2)
+				errors += restore (directory, clock, snapshots [clock]);
+		}
+
+		checkpointer.close ();
+
+		if (ModelCheckpointer.latest (directory.getPath()) == null || ! ModelCheckpointer.latest (directory.getPath()).getName().equals("model-4.ckpt"))
+			errors ++;
+
+		/* Checkpoint 4 is incremental, since full checkpoint 3 */
+		errors += restore (directory, 4, snapshots [4]);
+
+		/* Earlier checkpoints are superseded */
+		for (int clock = 0; clock < 3; ++clock) {
+			if (new File (directory, String.format("model-%d.ckpt", clock)).exists()) {
+				System.out.println(String.format("Checkpoint %d was not deleted", clock));
+				errors ++;
+			}
+		}
+
+		for (File f: directory.listFiles())
+			f.delete();
+		directory.delete();
+
+		System.out.println(String.format("%d errors", errors));
+
+		System.out.println("Bye.");
+		System.exit((errors == 0) ? 0 : 1);
+	}
+}